@@ -2,7 +2,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#include "mcp2221_display.h"
 #include "mcp2221_i2c_slave.h"
 #include "mcp2221_constants.h"
 #include "mcp2221.h"
@@ -112,17 +114,8 @@ static const uint8_t font6x8[][FONT6X8_WIDTH] = {
 	{0x44, 0x64, 0x54, 0x4C, 0x44, 0x00}  /* z */
 };
 
-// framebuffer (128 × 32 = 512 bytes)
-static uint8_t fb[SSD1306_WIDTH * SSD1306_PAGES];
-
-// SSD1306 command
-static mcp2221_error_code_t ssd1306_cmd(mcp2221_i2c_slave_t *display, uint8_t command) {
-	uint8_t buffer[2] = {0x00, command};
-	return mcp2221_i2c_slave_write(display, buffer, sizeof(buffer));
-}
-
 // initialize
-static mcp2221_error_code_t ssd1306_init(mcp2221_i2c_slave_t *display) {
+static mcp2221_error_code_t ssd1306_init(mcp2221_display_t *display) {
 	static const uint8_t init_commands[] = {
 		0xAE,                         // Display OFF
 		0xD5, 0x80,                  // clock divide ratio
@@ -143,22 +136,19 @@ static mcp2221_error_code_t ssd1306_init(mcp2221_i2c_slave_t *display) {
 		0xAF                         // Display ON
 	};
 
-	for (size_t i = 0; i < sizeof(init_commands); ++i) {
-		mcp2221_error_code_t err = ssd1306_cmd(display, init_commands[i]);
-		if (err != MCP2221_ERR_OK)
-			return err;
-	}
-
-	return MCP2221_ERR_OK;
+	// All commands fit into one I2C write.
+	return mcp2221_display_send_commands(display, init_commands, sizeof(init_commands));
 }
 
-// clear framebuffer
-void ssd1306_clear() {
-	memset(fb, 0x00, sizeof(fb));
+// clear a text line (8 pixel rows starting at y)
+static void ssd1306_clear_line(mcp2221_display_t *display, int y) {
+	for (int row = y; row < y + (int)FONT6X8_HEIGHT; row++)
+		for (int x = 0; x < SSD1306_WIDTH; x++)
+			mcp2221_display_set_pixel(display, x, row, 0);
 }
 
 // draw character
-void ssd1306_draw_char(int x, int y, char c) {
+static void ssd1306_draw_char(mcp2221_display_t *display, int x, int y, char c) {
 	unsigned int ch = (unsigned char)c;
 	size_t glyph_count = sizeof(font6x8) / sizeof(font6x8[0]);
 
@@ -170,59 +160,21 @@ void ssd1306_draw_char(int x, int y, char c) {
 
 	for (int col = 0; col < FONT6X8_WIDTH; col++) {
 		for (int row = 0; row < FONT6X8_HEIGHT; row++) {
-			if (glyph[col] & (1 << row)) {
-				int px = x + col;
-				int py = y + row;
-				if (px < 0 || px >= SSD1306_WIDTH)
-					continue;
-				if (py < 0 || py >= SSD1306_HEIGHT)
-					continue;
-
-				int page = py / 8;
-				fb[page * SSD1306_WIDTH + px] |= (1 << (py % 8));
-			}
+			if (glyph[col] & (1 << row))
+				mcp2221_display_set_pixel(display, x + col, y + row, 1);
 		}
 	}
 }
 
 // print string
-void ssd1306_draw_text(int x, int y, const char *s) {
+static void ssd1306_draw_text(mcp2221_display_t *display, int x, int y, const char *s) {
 	while (*s) {
-		ssd1306_draw_char(x, y, *s);
+		ssd1306_draw_char(display, x, y, *s);
 		x += FONT6X8_WIDTH;
 		s++;
 	}
 }
 
-// framebuffer to display
-static mcp2221_error_code_t ssd1306_flush(mcp2221_i2c_slave_t *display) {
-	for (int page = 0; page < SSD1306_PAGES; ++page) {
-		mcp2221_error_code_t err = ssd1306_cmd(display, 0xB0 + page);
-		if (err != MCP2221_ERR_OK)
-			return err;
-
-		err = ssd1306_cmd(display, 0x00);
-		if (err != MCP2221_ERR_OK)
-			return err;
-
-		err = ssd1306_cmd(display, 0x10);
-		if (err != MCP2221_ERR_OK)
-			return err;
-
-		for (int column = 0; column < SSD1306_WIDTH; column += 16) {
-			uint8_t chunk[1 + 16];
-			chunk[0] = 0x40;
-			memcpy(&chunk[1], &fb[page * SSD1306_WIDTH + column], 16);
-
-			err = mcp2221_i2c_slave_write(display, chunk, sizeof(chunk));
-			if (err != MCP2221_ERR_OK)
-				return err;
-		}
-	}
-
-	return MCP2221_ERR_OK;
-}
-
 // main
 int main(void) {
 	mcp2221_t *dev = NULL;
@@ -254,26 +206,62 @@ int main(void) {
 		return EXIT_FAILURE;
 	}
 
-	err = ssd1306_init(&oled);
+	mcp2221_display_t *display = NULL;
+	mcp2221_display_config_t config = {
+		.controller = MCP2221_DISPLAY_SSD1306,
+		.width = SSD1306_WIDTH,
+		.height = SSD1306_HEIGHT,
+		.column_offset = 0
+	};
+	err = mcp2221_display_create(&oled, &config, &display);
+	if (err != MCP2221_ERR_OK) {
+		fprintf(stderr, "Failed to create framebuffer: %s\n",
+				mcp2221_error_code_to_string(err));
+		mcp2221_close(dev);
+		return EXIT_FAILURE;
+	}
+
+	err = ssd1306_init(display);
 	if (err != MCP2221_ERR_OK) {
 		fprintf(stderr, "Failed to initialize OLED: %s\n",
 				mcp2221_error_code_to_string(err));
+		mcp2221_display_destroy(display);
 		mcp2221_close(dev);
 		return EXIT_FAILURE;
 	}
 
-	ssd1306_clear();
-	ssd1306_draw_text(0, 0, "Hello World!");
+	mcp2221_display_clear(display);
+	ssd1306_draw_text(display, 0, 0, "Hello World!");
+
+	// The first flush sends the whole frame; later ones only the changes.
+	for (int count = 0; count <= 10 && err == MCP2221_ERR_OK; count++) {
+		char line[24];
+		snprintf(line, sizeof(line), "Count: %d", count);
+		ssd1306_clear_line(display, 16);
+		ssd1306_draw_text(display, 0, 16, line);
+
+		err = mcp2221_display_flush(display);
+
+		struct timespec delay = {0, 200000000L};
+		nanosleep(&delay, NULL);
+	}
 
-	err = ssd1306_flush(&oled);
 	if (err != MCP2221_ERR_OK) {
 		fprintf(stderr, "Failed to update OLED: %s\n",
 				mcp2221_error_code_to_string(err));
+		mcp2221_display_destroy(display);
 		mcp2221_close(dev);
 		return EXIT_FAILURE;
 	}
 
+	mcp2221_display_stats_t stats;
+	mcp2221_display_get_stats(display, &stats);
+	printf("%llu flushes, %llu command writes, %llu data writes, %llu data bytes\n",
+	       (unsigned long long)stats.flushes, (unsigned long long)stats.command_writes,
+	       (unsigned long long)stats.data_writes, (unsigned long long)stats.data_bytes);
+
 	printf("Done.\n");
+	mcp2221_display_destroy(display);
 	mcp2221_close(dev);
 	return EXIT_SUCCESS;
 }
@@ -15,13 +15,23 @@
 #include "mcp2221_constants.h"
 #include "mcp2221_gpio.h"
 #include "mcp2221_gpio_poll.h"
+#include "mcp2221_gpio_monitor.h"
 #include "mcp2221_pin.h"
 #include "mcp2221_sram.h"
 #include "mcp2221_flash.h"
 #include "mcp2221_flash_info.h"
 #include "mcp2221_flash_settings.h"
 #include "mcp2221_analog.h"
+#include "mcp2221_sample.h"
+#include "mcp2221_adc_stream.h"
+#include "mcp2221_config_txn.h"
+#include "mcp2221_profile.h"
+#include "mcp2221_flash_image.h"
 #include "mcp2221_i2c_slave.h"
+#include "mcp2221_bus.h"
+#include "mcp2221_acq.h"
+#include "mcp2221_eeprom.h"
+#include "mcp2221_display.h"
 #include "mcp2221_smbus.h"
 #include "mcp2221_usb.h"
 #include "mcp2221_errors.h"
@@ -0,0 +1,213 @@
+/**
+ * @file mcp2221_acq.h
+ * @brief Periodic sensor acquisition scheduler.
+ */
+
+#ifndef MCP2221_ACQ_H
+#define MCP2221_ACQ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_i2c_slave.h"
+
+MCP2221_BEGIN_DECLS
+
+/** @brief Largest register block one acquisition job may read. */
+#define MCP2221_ACQ_SAMPLE_MAX 32
+
+/** @brief Let the scheduler choose a job's phase to spread bus load. */
+#define MCP2221_ACQ_PHASE_AUTO (-1)
+
+/**
+ * @brief Job flag: allow the read to be combined with neighboring registers.
+ *
+ * When set on two jobs that are due together on the same target, the
+ * scheduler may read both with one register-read transaction spanning the
+ * registers in between. Only set this for targets that auto-increment the
+ * register address on sequential reads and whose registers have no read side
+ * effects.
+ */
+#define MCP2221_ACQ_JOB_MERGE 0x01u
+
+/**
+ * @brief Opaque periodic acquisition scheduler.
+ *
+ * The scheduler runs periodic register reads on a dedicated worker thread.
+ * Each job reads @ref mcp2221_acq_job_t::length bytes from one target
+ * register every @ref mcp2221_acq_job_t::period_us microseconds. Jobs that
+ * are due at the same time are executed as one batch, and mergeable reads on
+ * the same target are coalesced into a single transaction. Timestamped
+ * results are queued in a lock-free ring that the application drains with
+ * mcp2221_acq_drain().
+ *
+ * Each release of a job has an implicit deadline of one period. A release
+ * that completes later, or that is skipped because the worker fell more than
+ * a period behind, is counted as a missed deadline. Missed releases are not
+ * caught up in a burst.
+ *
+ * While the scheduler is running, its worker thread performs I2C transfers
+ * on the MCP2221 handle. The application must not use the handle
+ * concurrently.
+ */
+typedef struct mcp2221_acq mcp2221_acq_t;
+
+/**
+ * @brief Description of one periodic read job.
+ */
+typedef struct {
+	/** Target to read from. The context is copied by mcp2221_acq_add_job(). */
+	const mcp2221_i2c_slave_t *slave;
+	/** Target behind a multiplexer, or `NULL`. When set, it is copied instead of @ref slave. */
+	const mcp2221_i2c_muxed_slave_t *muxed;
+	/** Register address, encoded with the target's default width and byte order. */
+	uint32_t reg;
+	/** Number of bytes to read, from 1 through MCP2221_ACQ_SAMPLE_MAX. */
+	size_t length;
+	/** Release period in microseconds; must be nonzero. */
+	uint32_t period_us;
+	/** Offset of the first release, in microseconds, or MCP2221_ACQ_PHASE_AUTO. */
+	int32_t phase_us;
+	/** Combination of MCP2221_ACQ_JOB_* flags. */
+	unsigned flags;
+} mcp2221_acq_job_t;
+
+/**
+ * @brief One acquired sample.
+ *
+ * Timestamps use the monotonic clock (`CLOCK_MONOTONIC`), in nanoseconds.
+ */
+typedef struct {
+	int job;                              /**< Job identifier returned by mcp2221_acq_add_job(). */
+	mcp2221_error_code_t status;          /**< Result of the read; @ref data is valid only for MCP2221_ERR_OK. */
+	uint64_t release_ns;                  /**< Scheduled release time. */
+	uint64_t timestamp_ns;                /**< Time the read completed. */
+	size_t length;                        /**< Number of valid bytes in @ref data. */
+	uint8_t data[MCP2221_ACQ_SAMPLE_MAX]; /**< Register contents. */
+} mcp2221_acq_sample_t;
+
+/**
+ * @brief Per-job statistics.
+ */
+typedef struct {
+	uint64_t releases;          /**< Scheduled releases since start, including skipped ones. */
+	uint64_t samples;           /**< Successful reads. */
+	uint64_t errors;            /**< Failed reads. */
+	uint64_t missed_deadlines;  /**< Releases completed late or skipped. */
+	uint64_t max_latency_us;    /**< Largest time from release to completion. */
+	double achieved_rate_hz;    /**< Successful reads per second since start. */
+	uint32_t phase_us;          /**< Phase used for the job. */
+} mcp2221_acq_job_stats_t;
+
+/**
+ * @brief Scheduler-wide statistics.
+ */
+typedef struct {
+	uint64_t batches;         /**< Batches of due jobs executed. */
+	uint64_t transactions;    /**< Register-read transactions issued. */
+	uint64_t ring_overruns;   /**< Samples dropped because the ring was full. */
+	uint32_t tick_us;         /**< Planning tick used to place phases. */
+} mcp2221_acq_stats_t;
+
+/**
+ * @brief Create an acquisition scheduler.
+ *
+ * The scheduler borrows @p dev; mcp2221_acq_destroy() does not close it.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] ring_capacity Minimum number of samples the result ring can
+ *                          hold. It is rounded up to a power of two.
+ * @param[out] out_acq Receives the new scheduler.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_NO_MEMORY if allocation fails.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_acq_create(mcp2221_t *dev, size_t ring_capacity, mcp2221_acq_t **out_acq);
+
+/**
+ * @brief Stop and free an acquisition scheduler.
+ *
+ * @param[in] acq Scheduler to destroy, or `NULL`.
+ */
+MCP2221_API void mcp2221_acq_destroy(mcp2221_acq_t *acq);
+
+/**
+ * @brief Register a periodic read job.
+ *
+ * Jobs can only be added while the scheduler is stopped.
+ *
+ * @param[in] acq Scheduler.
+ * @param[in] job Job description. The target context must use the same
+ *                MCP2221 handle as the scheduler.
+ * @param[out] out_job Optional; receives the job identifier.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, MCP2221_ERR_BUSY if the scheduler is running, or
+ *         MCP2221_ERR_NO_MEMORY if allocation fails.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_acq_add_job(mcp2221_acq_t *acq, const mcp2221_acq_job_t *job, int *out_job);
+
+/**
+ * @brief Plan phases and start the worker thread.
+ *
+ * Statistics are reset. Samples queued before the start are discarded by the
+ * next mcp2221_acq_drain(), so draining may continue concurrently.
+ *
+ * @param[in] acq Scheduler.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID if no job is
+ *         registered, MCP2221_ERR_BUSY if already running, or another
+ *         mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_acq_start(mcp2221_acq_t *acq);
+
+/**
+ * @brief Stop the worker thread.
+ *
+ * Samples already queued remain available to mcp2221_acq_drain().
+ *
+ * @param[in] acq Scheduler. Stopping a stopped scheduler has no effect.
+ */
+MCP2221_API void mcp2221_acq_stop(mcp2221_acq_t *acq);
+
+/**
+ * @brief Move queued samples to the caller.
+ *
+ * This function may be called from one consumer thread while the scheduler
+ * is running.
+ *
+ * @param[in] acq Scheduler.
+ * @param[out] out Sample buffer.
+ * @param[in] max Maximum number of samples to return.
+ *
+ * @return Number of samples written on success; otherwise a negative
+ *         mcp2221_error_code_t value.
+ */
+MCP2221_API int mcp2221_acq_drain(mcp2221_acq_t *acq, mcp2221_acq_sample_t *out, size_t max);
+
+/**
+ * @brief Read the statistics of one job.
+ *
+ * @param[in] acq Scheduler.
+ * @param[in] job Job identifier.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_acq_get_job_stats(mcp2221_acq_t *acq, int job, mcp2221_acq_job_stats_t *stats);
+
+/**
+ * @brief Read scheduler-wide statistics.
+ *
+ * @param[in] acq Scheduler.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_acq_get_stats(mcp2221_acq_t *acq, mcp2221_acq_stats_t *stats);
+
+MCP2221_END_DECLS
+#endif // MCP2221_ACQ_H
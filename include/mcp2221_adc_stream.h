@@ -0,0 +1,140 @@
+/**
+ * @file mcp2221_adc_stream.h
+ * @brief Continuous ADC acquisition into a ring buffer.
+ */
+
+#ifndef MCP2221_ADC_STREAM_H
+#define MCP2221_ADC_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+
+MCP2221_BEGIN_DECLS
+
+/**
+ * @brief Opaque continuous ADC stream.
+ *
+ * The stream reads the three ADC channels at a fixed rate on a dedicated
+ * worker thread, scheduled against `CLOCK_MONOTONIC`, and queues timestamped
+ * samples in a preallocated lock-free ring that the application drains with
+ * mcp2221_adc_stream_drain(). Nothing is allocated per sample.
+ *
+ * Other operations on the MCP2221 handle are not serialized against the
+ * worker thread.
+ */
+typedef struct mcp2221_adc_stream mcp2221_adc_stream_t;
+
+/** @brief Highest acquisition rate accepted by mcp2221_adc_stream_create(). */
+#define MCP2221_ADC_STREAM_MAX_RATE_HZ 1000000u
+
+/**
+ * @brief ADC stream configuration.
+ */
+typedef struct {
+	/** Acquisition rate in samples per second, from 1 through MCP2221_ADC_STREAM_MAX_RATE_HZ. */
+	uint32_t rate_hz;
+	/** Minimum number of samples the ring can hold, rounded up to a power of two; must be nonzero. */
+	size_t ring_capacity;
+	/**
+	 * Number of acquisitions averaged into one queued sample. 0 and 1 queue
+	 * every acquisition.
+	 */
+	uint32_t decimation;
+} mcp2221_adc_stream_config_t;
+
+/**
+ * @brief One queued ADC sample.
+ */
+typedef struct {
+	/** Time the first averaged acquisition was issued, from `CLOCK_MONOTONIC`, in nanoseconds. */
+	uint64_t time_ns;
+	/** Raw 10-bit results of ADC channels 0 through 2, averaged and rounded when decimating. */
+	uint16_t raw[3];
+} mcp2221_adc_stream_sample_t;
+
+/**
+ * @brief ADC stream statistics.
+ */
+typedef struct {
+	uint64_t acquisitions;    /**< Successful ADC reads. */
+	uint64_t samples;         /**< Samples produced after decimation. */
+	uint64_t errors;          /**< Failed ADC reads. */
+	uint64_t missed_periods;  /**< Acquisition periods skipped because the worker fell behind. */
+	uint64_t overruns;        /**< Samples dropped because the ring was full. */
+	double effective_rate_hz; /**< Measured acquisition rate since the stream was started. */
+	mcp2221_error_code_t last_error; /**< Error of the last failed read. */
+} mcp2221_adc_stream_stats_t;
+
+/**
+ * @brief Create an ADC stream.
+ *
+ * The stream borrows @p dev; mcp2221_adc_stream_destroy() does not close it.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] config Stream configuration.
+ * @param[out] out_stream Receives the new stream.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_NO_MEMORY if allocation fails.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_adc_stream_create(mcp2221_t *dev, const mcp2221_adc_stream_config_t *config,
+							   mcp2221_adc_stream_t **out_stream);
+
+/**
+ * @brief Stop and free an ADC stream.
+ *
+ * @param[in] stream Stream to destroy, or `NULL`.
+ */
+MCP2221_API void mcp2221_adc_stream_destroy(mcp2221_adc_stream_t *stream);
+
+/**
+ * @brief Start acquiring.
+ *
+ * Statistics are reset. Samples queued before the start are discarded by the
+ * next mcp2221_adc_stream_drain(), so draining may continue concurrently.
+ *
+ * @param[in] stream Stream.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, MCP2221_ERR_BUSY if already running, or another
+ *         mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_adc_stream_start(mcp2221_adc_stream_t *stream);
+
+/**
+ * @brief Stop acquiring. Queued samples remain available.
+ *
+ * A partially accumulated decimation block is discarded.
+ *
+ * @param[in] stream Stream, or `NULL`.
+ */
+MCP2221_API void mcp2221_adc_stream_stop(mcp2221_adc_stream_t *stream);
+
+/**
+ * @brief Move queued samples to the caller.
+ *
+ * Call from one thread at a time.
+ *
+ * @param[in] stream Stream.
+ * @param[out] out Sample buffer. May be `NULL` only when @p max is 0.
+ * @param[in] max Maximum number of samples to move.
+ *
+ * @return Number of samples moved, or a negative mcp2221_error_code_t value.
+ */
+MCP2221_API int mcp2221_adc_stream_drain(mcp2221_adc_stream_t *stream, mcp2221_adc_stream_sample_t *out, size_t max);
+
+/**
+ * @brief Read stream statistics.
+ *
+ * @param[in] stream Stream.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_adc_stream_get_stats(mcp2221_adc_stream_t *stream, mcp2221_adc_stream_stats_t *stats);
+
+MCP2221_END_DECLS
+#endif	// MCP2221_ADC_STREAM_H
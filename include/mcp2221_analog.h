@@ -6,6 +6,7 @@
 #ifndef MCP2221_ANALOG_H
 #define MCP2221_ANALOG_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "mcp2221.h"
@@ -101,8 +102,9 @@ MCP2221_API mcp2221_error_code_t mcp2221_adc_read_normalized(
 /**
  * @brief Read the three ADC channels as voltages.
  *
- * The current ADC reference is read from device SRAM. Fixed internal
- * references are resolved automatically. If VDD is selected, a supply voltage
+ * The current ADC reference and its voltage come from the SRAM settings
+ * cache, so a call normally costs one command. Fixed internal references are
+ * resolved automatically. If VDD is selected, a supply voltage
  * must first have been provided with mcp2221_analog_set_vdd(). An OFF
  * reference cannot be converted to volts.
  *
@@ -195,10 +197,12 @@ MCP2221_API mcp2221_error_code_t mcp2221_dac_write_normalized(
 /**
  * @brief Write a DAC output voltage.
  *
- * The current DAC reference is read from device SRAM. Fixed internal
- * references are resolved automatically. If VDD is selected, a supply voltage
- * must first have been provided with mcp2221_analog_set_vdd(). An OFF
- * reference cannot be converted to a voltage.
+ * The current DAC reference comes from the SRAM settings cache and the code
+ * from a lookup table for that reference, so a call normally costs one
+ * command. Fixed internal references are resolved automatically. If VDD is
+ * selected, a supply voltage must first have been provided with
+ * mcp2221_analog_set_vdd(). An OFF reference cannot be converted to a
+ * voltage.
  *
  * The largest accepted voltage is 31.0/32.0 of the selected reference voltage.
  * Values between two DAC steps are truncated to the lower raw output code.
@@ -253,6 +257,163 @@ MCP2221_API mcp2221_error_code_t mcp2221_ioc_read(mcp2221_t *dev, uint8_t *flag)
  */
 MCP2221_API mcp2221_error_code_t mcp2221_ioc_clear(mcp2221_t *dev);
 
+/**
+ * @brief Convert an array of raw ADC results to normalized values.
+ *
+ * Each element is converted exactly as by mcp2221_adc_read_normalized(),
+ * `raw / 1024.0`, and the results are bit-identical to it. The loop uses SSE2
+ * or AArch64 NEON where the compiler targets them. The input is validated
+ * before anything is written.
+ *
+ * @param[in] in Raw 10-bit ADC results, 0 through 1023.
+ * @param[out] out Array of @p n normalized values.
+ * @param[in] n Number of elements. @p in and @p out may be `NULL` when 0.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments or an out-of-range raw value, in which case @p out is
+ *         unchanged.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_adc_raw_to_normalized_n(const uint16_t *in, double *out, size_t n);
+
+/**
+ * @brief Convert an array of raw ADC results to volts.
+ *
+ * Each element is converted exactly as by mcp2221_adc_read_volts(),
+ * `raw / 1024.0 * reference_voltage`; otherwise as
+ * mcp2221_adc_raw_to_normalized_n().
+ *
+ * @param[in] in Raw 10-bit ADC results, 0 through 1023.
+ * @param[out] out Array of @p n voltages.
+ * @param[in] n Number of elements. @p in and @p out may be `NULL` when 0.
+ * @param[in] reference_voltage ADC reference voltage; must be positive.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments or an out-of-range raw value, in which case @p out is
+ *         unchanged.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_adc_raw_to_volts_n(const uint16_t *in, double *out, size_t n,
+							    double reference_voltage);
+
+/**
+ * @brief Convert an array of DAC output voltages to raw codes.
+ *
+ * Each element is converted exactly as by mcp2221_dac_write_volts(): values
+ * between two steps are truncated to the lower code, and values outside
+ * 0 through 31/32 of @p reference_voltage are rejected. Otherwise as
+ * mcp2221_adc_raw_to_normalized_n().
+ *
+ * @param[in] in Voltages.
+ * @param[out] out Array of @p n raw codes.
+ * @param[in] n Number of elements. @p in and @p out may be `NULL` when 0.
+ * @param[in] reference_voltage DAC reference voltage; must be positive.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments or an out-of-range voltage, in which case @p out is
+ *         unchanged.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_dac_volts_to_raw_n(const double *in, uint8_t *out, size_t n,
+							    double reference_voltage);
+
+/** @brief Highest sample rate accepted by mcp2221_dac_play(). */
+#define MCP2221_DAC_PLAY_MAX_RATE_HZ 1000000u
+
+/**
+ * @brief Timing statistics of one mcp2221_dac_play() call.
+ *
+ * The lag of a command is how far it was issued behind its slot's target time.
+ */
+typedef struct {
+	uint64_t slots_played;       /**< Sample slots played, including skipped ones. */
+	uint64_t commands_sent;      /**< SET_SRAM_SETTINGS commands sent. */
+	uint64_t duplicates_skipped; /**< Slots whose code equalled the code already output. */
+	uint64_t missed_slots;       /**< Slots skipped because they were over before their command could be sent. */
+	uint64_t late_commands;      /**< Commands whose reply arrived after the end of their slot. */
+	uint64_t duration_us;        /**< Time from the start until the end of the last slot. */
+	double achieved_rate_hz;     /**< Slots per second over @ref duration_us. */
+	uint64_t mean_lag_us;        /**< Mean lag of the sent commands. */
+	uint64_t max_lag_us;         /**< Largest lag. */
+	uint64_t jitter_us;          /**< Difference between the largest and smallest lag. */
+} mcp2221_dac_play_stats_t;
+
+/**
+ * @brief Play a sequence of raw DAC codes at a fixed rate.
+ *
+ * Each code is written with the same SET_SRAM_SETTINGS command as
+ * mcp2221_dac_write_raw(); the packets for all 32 codes are built before
+ * playback starts. Slot @c i starts at the start time plus @c i / @p rate_hz
+ * on `CLOCK_MONOTONIC`, and each command sleeps until its absolute target, so
+ * round-trip time and wakeup latency do not accumulate. A code equal to the
+ * one already output sends no command. A slot that is over before its
+ * command could be sent is skipped, so that the rest of the waveform stays on
+ * schedule; the last slot is always sent. The call returns at the end of the
+ * last slot.
+ *
+ * A USB round trip takes about a millisecond, which bounds the useful rate.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] codes Raw DAC codes from 0 through 31.
+ * @param[in] n Number of codes; must be nonzero.
+ * @param[in] rate_hz Slots per second, from 1 through MCP2221_DAC_PLAY_MAX_RATE_HZ.
+ * @param[in] loops Number of passes over @p codes; must be nonzero.
+ * @param[out] stats Optional timing statistics, also filled in on failure.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments or codes, or another mcp2221_error_code_t value on
+ *         failure. Playback stops at the first failing command.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_dac_play(mcp2221_t *dev, const uint8_t *codes, size_t n, uint32_t rate_hz,
+						  uint32_t loops, mcp2221_dac_play_stats_t *stats);
+
+/**
+ * @brief Fill a buffer with one period of a sine wave.
+ *
+ * Code @c i is `(low + high) / 2 + (high - low) / 2 * sin(2 * pi * i / n)`,
+ * rounded to the nearest code.
+ *
+ * @param[out] codes Buffer of @p n codes.
+ * @param[in] n Number of codes per period; must be nonzero.
+ * @param[in] low Lowest code.
+ * @param[in] high Highest code, from @p low through 31.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_dac_wave_sine(uint8_t *codes, size_t n, uint8_t low, uint8_t high);
+
+/**
+ * @brief Fill a buffer with a linear ramp.
+ *
+ * The first code is @p from and the last @p to; the codes in between are
+ * rounded to the nearest code. @p to may be below @p from.
+ *
+ * @param[out] codes Buffer of @p n codes.
+ * @param[in] n Number of codes; must be nonzero.
+ * @param[in] from First code, from 0 through 31.
+ * @param[in] to Last code, from 0 through 31.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_dac_wave_ramp(uint8_t *codes, size_t n, uint8_t from, uint8_t to);
+
+/**
+ * @brief Convert an arbitrary waveform from volts to DAC codes.
+ *
+ * Each voltage is converted as by mcp2221_dac_write_volts(), for the current
+ * DAC reference.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] volts Voltages.
+ * @param[in] n Number of voltages; must be nonzero.
+ * @param[out] codes Buffer of @p n codes.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, an unresolved reference or a voltage out of range, or
+ *         another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_dac_wave_from_volts(mcp2221_t *dev, const double *volts, size_t n,
+							     uint8_t *codes);
+
 /**
  * @brief Configure interrupt-on-change edge detection.
  *
@@ -0,0 +1,216 @@
+/**
+ * @file mcp2221_bus.h
+ * @brief Multi-client I2C bus manager with priorities and fair queueing.
+ */
+
+#ifndef MCP2221_BUS_H
+#define MCP2221_BUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_i2c_slave.h"
+
+MCP2221_BEGIN_DECLS
+
+/**
+ * @brief Opaque I2C bus manager.
+ *
+ * A bus manager owns one MCP2221 handle and serializes I2C transactions
+ * submitted by any number of logical clients, possibly from different
+ * threads. Transactions are executed by a dedicated worker thread in the
+ * following order:
+ *
+ * - clients with a higher priority are always served first;
+ * - clients with equal priority share the bus by weighted fair queueing, so
+ *   that over time each client receives bus bytes in proportion to its
+ *   weight.
+ *
+ * Scheduling happens between transactions. Register reads and writes
+ * longer than 256 bytes are split by the manager into 256-byte
+ * sub-transactions that are queued one after another, so a long EEPROM dump
+ * does not hold up latency-critical clients. Plain reads and writes are
+ * never split.
+ */
+typedef struct mcp2221_bus mcp2221_bus_t;
+
+/**
+ * @brief Opaque bus-manager client.
+ *
+ * A client represents one I2C target, described by an
+ * mcp2221_i2c_slave_t, together with its scheduling parameters.
+ */
+typedef struct mcp2221_bus_client mcp2221_bus_client_t;
+
+/**
+ * @brief Per-client transaction and queueing-delay statistics.
+ *
+ * The queueing delay is the time between submitting a transaction and the
+ * start of its execution on the bus.
+ */
+typedef struct {
+	uint64_t transactions;         /**< Completed transactions and sub-transactions, including failed ones. */
+	uint64_t errors;               /**< Transactions that returned an error. */
+	uint64_t bytes;                /**< Payload bytes transferred by successful transactions. */
+	uint64_t queue_delay_total_us; /**< Sum of all queueing delays, in microseconds. */
+	uint64_t queue_delay_max_us;   /**< Largest observed queueing delay, in microseconds. */
+} mcp2221_bus_client_stats_t;
+
+/**
+ * @brief Create a bus manager for an open MCP2221 handle.
+ *
+ * On success the bus manager takes over the caller's reference to @p dev and
+ * releases it in mcp2221_bus_close(). On failure the caller keeps the
+ * reference.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[out] out_bus Receives the new bus manager.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, MCP2221_ERR_NO_MEMORY if allocation fails, or
+ *         MCP2221_ERR_GENERIC if the worker thread cannot be started.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_bus_open(mcp2221_t *dev, mcp2221_bus_t **out_bus);
+
+/**
+ * @brief Stop a bus manager and release its MCP2221 handle.
+ *
+ * Remaining clients are released as well. No transaction may be in progress
+ * when this function is called.
+ *
+ * @param[in] bus Bus manager to close, or `NULL`.
+ */
+MCP2221_API void mcp2221_bus_close(mcp2221_bus_t *bus);
+
+/**
+ * @brief Return the MCP2221 handle owned by a bus manager.
+ *
+ * Use the handle to initialize mcp2221_i2c_slave_t contexts for
+ * mcp2221_bus_client_add(). Do not perform I2C transfers on it directly while
+ * the bus manager is in use.
+ *
+ * @param[in] bus Bus manager.
+ *
+ * @return The owned handle, or `NULL` if @p bus is `NULL`.
+ */
+MCP2221_API mcp2221_t *mcp2221_bus_get_device(mcp2221_bus_t *bus);
+
+/**
+ * @brief Register a logical client with a bus manager.
+ *
+ * @p slave is copied; it must have been initialized with the handle returned
+ * by mcp2221_bus_get_device().
+ *
+ * @param[in] bus Bus manager.
+ * @param[in] slave Initialized I2C target context.
+ * @param[in] priority Scheduling class. Clients with a higher value are
+ *                     always served before clients with a lower value.
+ * @param[in] weight Relative bandwidth share among clients of the same
+ *                   priority. A value of 0 is treated as 1.
+ * @param[out] out_client Receives the new client.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_NO_MEMORY if allocation fails.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_bus_client_add(mcp2221_bus_t *bus, const mcp2221_i2c_slave_t *slave, int priority, unsigned weight,
+							 mcp2221_bus_client_t **out_client);
+
+/**
+ * @brief Unregister and free a client.
+ *
+ * No transaction of this client may be in progress.
+ *
+ * @param[in] client Client to remove, or `NULL`.
+ */
+MCP2221_API void mcp2221_bus_client_remove(mcp2221_bus_client_t *client);
+
+/**
+ * @brief Read bytes starting at a target register through the bus manager.
+ *
+ * Behaves like mcp2221_i2c_slave_read_register() with the client's default
+ * register width and byte order. Reads longer than 256 bytes are split into
+ * 256-byte reads at consecutive register addresses, scheduled separately.
+ * The call blocks until all of them have been executed or one has failed.
+ *
+ * @param[in] client Bus-manager client.
+ * @param[in] reg Register address.
+ * @param[out] buffer Buffer receiving @p length bytes.
+ * @param[in] length Number of bytes to read.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID if a register
+ *         address of the split read does not fit the client's register
+ *         width, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_bus_read_register(mcp2221_bus_client_t *client, uint32_t reg, uint8_t *buffer, size_t length);
+
+/**
+ * @brief Write a register address followed by data through the bus manager.
+ *
+ * Behaves like mcp2221_i2c_slave_write_register() with the client's default
+ * register width and byte order. Writes longer than 256 bytes are split into
+ * 256-byte writes at consecutive register addresses, scheduled separately.
+ * The split does not follow the target's page boundaries; for EEPROMs with
+ * smaller pages, write one page per call. The call blocks until all writes
+ * have been executed or one has failed.
+ *
+ * @param[in] client Bus-manager client.
+ * @param[in] reg Register address.
+ * @param[in] data Bytes to write after the register address. May be `NULL`
+ *                 only when @p length is 0.
+ * @param[in] length Number of data bytes.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID if a register
+ *         address of the split write does not fit the client's register
+ *         width, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_bus_write_register(mcp2221_bus_client_t *client, uint32_t reg, const uint8_t *data, size_t length);
+
+/**
+ * @brief Read bytes directly from the client's target through the bus
+ *        manager.
+ *
+ * @param[in] client Bus-manager client.
+ * @param[out] buffer Buffer receiving @p length bytes.
+ * @param[in] length Number of bytes to read.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_bus_read(mcp2221_bus_client_t *client, uint8_t *buffer, size_t length);
+
+/**
+ * @brief Write bytes directly to the client's target through the bus manager.
+ *
+ * @param[in] client Bus-manager client.
+ * @param[in] data Bytes to write.
+ * @param[in] length Number of bytes to write.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_bus_write(mcp2221_bus_client_t *client, const uint8_t *data, size_t length);
+
+/**
+ * @brief Read a client's statistics.
+ *
+ * @param[in] client Bus-manager client.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID if an argument is
+ *         `NULL`.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_bus_client_get_stats(mcp2221_bus_client_t *client, mcp2221_bus_client_stats_t *stats);
+
+/**
+ * @brief Reset a client's statistics to zero.
+ *
+ * @param[in] client Bus-manager client.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID if @p client is
+ *         `NULL`.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_bus_client_reset_stats(mcp2221_bus_client_t *client);
+
+MCP2221_END_DECLS
+#endif // MCP2221_BUS_H
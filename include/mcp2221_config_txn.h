@@ -0,0 +1,165 @@
+/**
+ * @file mcp2221_config_txn.h
+ * @brief Transactional runtime configuration with minimal SET_SRAM_SETTINGS traffic.
+ */
+
+#ifndef MCP2221_CONFIG_TXN_H
+#define MCP2221_CONFIG_TXN_H
+
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_pin.h"
+
+MCP2221_BEGIN_DECLS
+
+/**
+ * @brief Pending runtime configuration changes.
+ *
+ * A transaction collects pin-function, ADC reference, DAC, clock-output and
+ * interrupt-on-change changes without talking to the device.
+ * mcp2221_config_txn_commit() then compares them with the current SRAM
+ * settings and sends only what differs, in as few SET_SRAM_SETTINGS commands
+ * as the MCP2221 allows.
+ *
+ * Initialize with mcp2221_config_txn_init() and change only through the
+ * mcp2221_config_txn_set_*() functions; the fields hold register encodings
+ * and are not part of the stable API.
+ */
+typedef struct {
+	uint8_t gp_mask;      /**< Pins with a pending GP byte; bit 0 through bit 3 correspond to GP0 through GP3. */
+	uint8_t gp[4];        /**< Pending GP bytes. */
+	int clk_output;       /**< Pending clock-output bits, or -1. */
+	int dac_ref;          /**< Pending DAC reference bits, or -1. */
+	int dac_value;        /**< Pending DAC code, or -1. */
+	int adc_ref;          /**< Pending ADC reference bits, or -1. */
+	int int_edges;        /**< Pending interrupt-edge bits, or -1. */
+	int clear_ioc_flag;   /**< Nonzero to clear the interrupt flag. */
+} mcp2221_config_txn_t;
+
+/**
+ * @brief Start an empty transaction.
+ *
+ * @param[out] txn Transaction to initialize.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID if @p txn is
+ *         `NULL`.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_config_txn_init(mcp2221_config_txn_t *txn);
+
+/**
+ * @brief Set the function of one GP pin.
+ *
+ * Accepts the same functions and output values as
+ * mcp2221_pin_set_functions(); MCP2221_PIN_FUNC_KEEP is rejected. A later
+ * call for the same pin replaces the earlier one.
+ *
+ * @param[in,out] txn Transaction.
+ * @param[in] pin GP pin to configure.
+ * @param[in] function Requested pin function.
+ * @param[in] out_value Initial output value: 0, or 1 for
+ *                      MCP2221_PIN_FUNC_GPIO_OUT only.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments; the transaction is unchanged on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_config_txn_set_pin(mcp2221_config_txn_t *txn, mcp2221_gpio_pin_t pin,
+							    mcp2221_pin_function_t function, int out_value);
+
+/**
+ * @brief Set the ADC reference.
+ *
+ * @param[in,out] txn Transaction.
+ * @param[in] ref_str Reference name, as accepted by mcp2221_adc_config().
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments; the transaction is unchanged on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_config_txn_set_adc(mcp2221_config_txn_t *txn, const char *ref_str);
+
+/**
+ * @brief Set the DAC reference and/or output code.
+ *
+ * @param[in,out] txn Transaction.
+ * @param[in] ref_str Reference name, as accepted by mcp2221_dac_config(), or
+ *                    `NULL` to keep the reference.
+ * @param[in] out_code DAC code 0 through 31, or -1 to keep the code.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments; the transaction is unchanged on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_config_txn_set_dac(mcp2221_config_txn_t *txn, const char *ref_str, int out_code);
+
+/**
+ * @brief Set the clock output.
+ *
+ * @param[in,out] txn Transaction.
+ * @param[in] duty_percent Duty cycle, as accepted by mcp2221_clock_config().
+ * @param[in] freq_str Frequency, as accepted by mcp2221_clock_config().
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments; the transaction is unchanged on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_config_txn_set_clock(mcp2221_config_txn_t *txn, int duty_percent,
+							      const char *freq_str);
+
+/**
+ * @brief Set the interrupt-on-change edges.
+ *
+ * @param[in,out] txn Transaction.
+ * @param[in] edge Edge name, as accepted by mcp2221_ioc_config().
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments; the transaction is unchanged on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_config_txn_set_ioc(mcp2221_config_txn_t *txn, const char *edge);
+
+/**
+ * @brief Clear the interrupt-on-change flag as part of the commit.
+ *
+ * Unlike the settings, the clear is always sent.
+ *
+ * @param[in,out] txn Transaction.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID if @p txn is
+ *         `NULL`.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_config_txn_clear_ioc(mcp2221_config_txn_t *txn);
+
+/**
+ * @brief Apply a transaction.
+ *
+ * The current settings come from the SRAM settings cache (see
+ * mcp2221_sram_cache_set_max_age()) and, for the GP pins, from the
+ * library's GPIO state, as in mcp2221_sram_config(). Settings equal to the
+ * current ones are dropped; references are compared by meaning, so VRM bits
+ * left behind under a VDD reference do not count as a change. An empty
+ * difference sends nothing.
+ *
+ * Everything else goes into one SET_SRAM_SETTINGS command. A second command
+ * follows only when a hardware quirk requires it:
+ * - a DAC reference change first turns the DAC reference off and the code to
+ *   0, as mcp2221_dac_config_out() does;
+ * - a GP designation change while the DAC or ADC uses the internal VRM may
+ *   reset that reference to VDD, so the affected reference is turned off in
+ *   the first command and reclaimed in the second, as mcp2221_sram_config()
+ *   does. References on VDD are left alone.
+ *
+ * The transaction itself is not modified and may be committed again, for
+ * example to another device.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] txn Transaction to apply.
+ * @param[out] out_commands Optional; receives the number of
+ *                          SET_SRAM_SETTINGS commands sent (0 through 2),
+ *                          including on failure.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or another mcp2221_error_code_t value on failure. A
+ *         failure of the second command leaves the first applied.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_config_txn_commit(mcp2221_t *dev, const mcp2221_config_txn_t *txn,
+							   int *out_commands);
+
+MCP2221_END_DECLS
+#endif	// MCP2221_CONFIG_TXN_H
@@ -0,0 +1,185 @@
+/**
+ * @file mcp2221_display.h
+ * @brief Framebuffer with incremental flushing for page-organized I2C displays.
+ */
+
+#ifndef MCP2221_DISPLAY_H
+#define MCP2221_DISPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_i2c_slave.h"
+
+MCP2221_BEGIN_DECLS
+
+/** @brief Largest number of command bytes accepted by mcp2221_display_send_commands(). */
+#define MCP2221_DISPLAY_COMMANDS_MAX 255
+
+/**
+ * @brief Display controller family.
+ */
+typedef enum {
+	/**
+	 * SSD1306 and compatible controllers. Updates use a column/page address
+	 * window and require horizontal addressing mode (command 0x20, 0x00).
+	 */
+	MCP2221_DISPLAY_SSD1306 = 0,
+
+	/**
+	 * SH1106 and compatible controllers, which only support page
+	 * addressing. Updates are sent page by page.
+	 */
+	MCP2221_DISPLAY_SH1106 = 1
+} mcp2221_display_controller_t;
+
+/**
+ * @brief Opaque framebuffer bound to one display.
+ *
+ * The framebuffer uses the controller's memory layout: one byte holds eight
+ * vertically stacked pixels, the least significant bit on top, and rows of
+ * eight pixels ("pages") are stored one after another. The display keeps a
+ * copy of the last flushed frame. mcp2221_display_flush() compares the two
+ * and sends only the changed columns of the changed pages.
+ *
+ * The display borrows the MCP2221 handle of its target context. Operations
+ * are not serialized; use a display from one thread at a time.
+ */
+typedef struct mcp2221_display mcp2221_display_t;
+
+/**
+ * @brief Display geometry.
+ */
+typedef struct {
+	/** Controller family. */
+	mcp2221_display_controller_t controller;
+	/** Visible width in pixels. */
+	int width;
+	/** Visible height in pixels; a multiple of 8, at most 64. */
+	int height;
+	/**
+	 * Controller column of the leftmost visible pixel. 132-column SH1106
+	 * modules usually need 2. @ref width plus the offset must not exceed
+	 * 128 for SSD1306 or 132 for SH1106.
+	 */
+	int column_offset;
+} mcp2221_display_config_t;
+
+/**
+ * @brief Display transfer statistics.
+ */
+typedef struct {
+	uint64_t flushes;         /**< mcp2221_display_flush() calls. */
+	uint64_t regions;         /**< Address windows or pages updated. */
+	uint64_t command_writes;  /**< I2C writes carrying commands. */
+	uint64_t data_writes;     /**< I2C writes carrying pixel data. */
+	uint64_t data_bytes;      /**< Pixel data bytes sent. */
+} mcp2221_display_stats_t;
+
+/**
+ * @brief Create a framebuffer for a display.
+ *
+ * The framebuffer starts cleared. No I2C traffic is generated; the first
+ * flush sends the complete frame.
+ *
+ * @param[in] slave Initialized display target context. It is copied.
+ * @param[in] config Display geometry.
+ * @param[out] out_display Receives the new display.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_NO_MEMORY if allocation fails.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_display_create(const mcp2221_i2c_slave_t *slave, const mcp2221_display_config_t *config,
+							  mcp2221_display_t **out_display);
+
+/**
+ * @brief Destroy a display. Unflushed changes are discarded.
+ *
+ * @param[in] display Display to destroy, or `NULL`.
+ */
+MCP2221_API void mcp2221_display_destroy(mcp2221_display_t *display);
+
+/**
+ * @brief Access the framebuffer.
+ *
+ * The buffer holds `width * height / 8` bytes; byte `page * width + x`
+ * covers pixels `(x, page * 8)` through `(x, page * 8 + 7)`. It may be
+ * modified freely between flushes.
+ *
+ * @param[in] display Display.
+ * @param[out] out_size Receives the buffer size in bytes. May be `NULL`.
+ *
+ * @return Pointer to the framebuffer, or `NULL` if @p display is `NULL`.
+ */
+MCP2221_API uint8_t *mcp2221_display_buffer(mcp2221_display_t *display, size_t *out_size);
+
+/**
+ * @brief Clear the framebuffer.
+ *
+ * @param[in] display Display.
+ */
+MCP2221_API void mcp2221_display_clear(mcp2221_display_t *display);
+
+/**
+ * @brief Set or clear one pixel. Coordinates outside the display are ignored.
+ *
+ * @param[in] display Display.
+ * @param[in] x Column.
+ * @param[in] y Row.
+ * @param[in] on Nonzero to light the pixel.
+ */
+MCP2221_API void mcp2221_display_set_pixel(mcp2221_display_t *display, int x, int y, int on);
+
+/**
+ * @brief Send the changes since the last flush to the display.
+ *
+ * For each page, the changed columns are found by comparing against the
+ * last flushed frame. SSD1306 updates combine neighboring changed pages into
+ * one address window when that costs fewer bytes than separate windows. The
+ * window is set with a single command write, and pixel data follows in
+ * writes of up to 255 bytes.
+ *
+ * If a transfer fails, the next flush sends the complete frame.
+ *
+ * @param[in] display Display.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_display_flush(mcp2221_display_t *display);
+
+/**
+ * @brief Make the next flush send the complete frame.
+ *
+ * Use this after the display was reset or written by other code.
+ *
+ * @param[in] display Display.
+ */
+MCP2221_API void mcp2221_display_invalidate(mcp2221_display_t *display);
+
+/**
+ * @brief Send a sequence of commands in one I2C write.
+ *
+ * @param[in] display Display.
+ * @param[in] commands Command bytes, including their parameters.
+ * @param[in] count Number of bytes, from 1 to MCP2221_DISPLAY_COMMANDS_MAX.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_display_send_commands(mcp2221_display_t *display, const uint8_t *commands, size_t count);
+
+/**
+ * @brief Retrieve transfer statistics.
+ *
+ * @param[in] display Display.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_display_get_stats(const mcp2221_display_t *display, mcp2221_display_stats_t *stats);
+
+MCP2221_END_DECLS
+#endif	// MCP2221_DISPLAY_H
@@ -0,0 +1,182 @@
+/**
+ * @file mcp2221_eeprom.h
+ * @brief Cached byte-addressable view of an I2C EEPROM.
+ */
+
+#ifndef MCP2221_EEPROM_H
+#define MCP2221_EEPROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_i2c_slave.h"
+
+MCP2221_BEGIN_DECLS
+
+/** @brief Largest supported EEPROM write page, in bytes. */
+#define MCP2221_EEPROM_PAGE_MAX 256
+
+/**
+ * @brief Opaque EEPROM map.
+ *
+ * The map presents a 24xx-style I2C EEPROM as a flat byte range, much like a
+ * memory-mapped file. Reads are served from a cache of EEPROM pages; a miss
+ * fetches the missing page, plus read-ahead pages when the access pattern is
+ * sequential, with one multi-report register read. Writes only update the
+ * cache and mark the page dirty. Dirty bytes are written back, one write per
+ * page, when mcp2221_eeprom_map_sync() is called, when a dirty page is
+ * evicted, and when the map is destroyed.
+ *
+ * After each page write the map does not wait for the EEPROM's internal
+ * write cycle. Instead, the next access to the EEPROM first polls the device
+ * address until it is acknowledged again, so the write cycle overlaps with
+ * host-side work. mcp2221_eeprom_map_sync() waits for the last write cycle
+ * before it returns.
+ *
+ * The register-address width of the target context selects the EEPROM
+ * address width. Devices that take address bits from the I2C address, such
+ * as the 24C04 to 24C16, must be mapped as one map per 256-byte block.
+ *
+ * The map assumes it is the only writer of the EEPROM. Operations are not
+ * serialized; use a map from one thread at a time.
+ */
+typedef struct mcp2221_eeprom_map mcp2221_eeprom_map_t;
+
+/**
+ * @brief EEPROM geometry and cache parameters.
+ */
+typedef struct {
+	/** Mapped size in bytes; a multiple of @ref page_size. */
+	size_t size;
+	/** Write page size in bytes; a power of two up to MCP2221_EEPROM_PAGE_MAX. */
+	size_t page_size;
+	/** Number of cached pages; 0 selects 16. */
+	size_t cache_pages;
+	/** Pages fetched ahead of a sequential miss; must be less than the cache size. */
+	size_t read_ahead_pages;
+	/** Longest write cycle to wait for in ACK polling, in milliseconds; 0 selects 10. */
+	int write_cycle_ms;
+} mcp2221_eeprom_map_config_t;
+
+/**
+ * @brief EEPROM map statistics.
+ */
+typedef struct {
+	uint64_t read_hits;          /**< Page lookups served from the cache. */
+	uint64_t read_misses;        /**< Page lookups that required a fetch. */
+	uint64_t read_transactions;  /**< Register reads issued. */
+	uint64_t read_ahead_pages;   /**< Pages fetched before they were requested. */
+	uint64_t write_calls;        /**< mcp2221_eeprom_map_write() calls. */
+	uint64_t write_transactions; /**< Page writes issued. */
+	uint64_t bytes_written;      /**< Payload bytes written to the EEPROM. */
+	uint64_t evictions;          /**< Pages evicted from the cache. */
+	uint64_t dirty_evictions;    /**< Evictions that forced a write-back. */
+	uint64_t ack_polls;          /**< Address probes issued while waiting for write cycles. */
+	size_t dirty_pages;          /**< Pages currently holding unwritten data. */
+	size_t dirty_bytes;          /**< Bytes covered by the dirty ranges of those pages. */
+} mcp2221_eeprom_map_stats_t;
+
+/**
+ * @brief Create an EEPROM map.
+ *
+ * No I2C traffic is generated.
+ *
+ * @param[in] slave Initialized EEPROM target context. It is copied; a
+ *                  multiplexer it refers to must outlive the map.
+ * @param[in] config Geometry and cache parameters.
+ * @param[out] out_map Receives the new map.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_NO_MEMORY if allocation fails.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_eeprom_map_create(const mcp2221_i2c_slave_t *slave, const mcp2221_eeprom_map_config_t *config,
+							     mcp2221_eeprom_map_t **out_map);
+
+/**
+ * @brief Write back dirty pages and destroy an EEPROM map.
+ *
+ * The map is released even if the write-back fails.
+ *
+ * @param[in] map Map to destroy, or `NULL`.
+ *
+ * @return MCP2221_ERR_OK on success, or the first write-back error.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_eeprom_map_destroy(mcp2221_eeprom_map_t *map);
+
+/**
+ * @brief Read bytes through the page cache.
+ *
+ * Pending writes are visible to reads before they are written back.
+ *
+ * @param[in] map EEPROM map.
+ * @param[in] offset First byte to read.
+ * @param[out] buffer Receives @p length bytes.
+ * @param[in] length Number of bytes to read. The range must lie within the
+ *                   mapped size.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_eeprom_map_read(mcp2221_eeprom_map_t *map, size_t offset, uint8_t *buffer, size_t length);
+
+/**
+ * @brief Buffer a write in the page cache.
+ *
+ * The bytes are written to the EEPROM later. Writes to the same page are
+ * coalesced into one page write. Partially written pages that are not
+ * cached are not read first unless a later write leaves a gap in the dirty
+ * range.
+ *
+ * @param[in] map EEPROM map.
+ * @param[in] offset First byte to write.
+ * @param[in] data Bytes to write.
+ * @param[in] length Number of bytes to write. The range must lie within the
+ *                   mapped size.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         if making room in the cache fails.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_eeprom_map_write(mcp2221_eeprom_map_t *map, size_t offset, const uint8_t *data, size_t length);
+
+/**
+ * @brief Write back all dirty pages and wait for the last write cycle.
+ *
+ * Pages are written in address order. A page whose write fails stays dirty.
+ *
+ * @param[in] map EEPROM map.
+ *
+ * @return MCP2221_ERR_OK once everything is stored, or the first error.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_eeprom_map_sync(mcp2221_eeprom_map_t *map);
+
+/**
+ * @brief Drop all clean pages from the cache.
+ *
+ * Dirty pages are kept. Use this when the EEPROM may have been written by
+ * someone else.
+ *
+ * @param[in] map EEPROM map.
+ */
+MCP2221_API void mcp2221_eeprom_map_invalidate(mcp2221_eeprom_map_t *map);
+
+/**
+ * @brief Retrieve statistics.
+ *
+ * @param[in] map EEPROM map.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_eeprom_map_get_stats(const mcp2221_eeprom_map_t *map, mcp2221_eeprom_map_stats_t *stats);
+
+/**
+ * @brief Reset the counters; the dirty page and byte counts are kept.
+ *
+ * @param[in] map EEPROM map.
+ */
+MCP2221_API void mcp2221_eeprom_map_reset_stats(mcp2221_eeprom_map_t *map);
+
+MCP2221_END_DECLS
+#endif	// MCP2221_EEPROM_H
@@ -39,7 +39,8 @@ typedef enum {
 	MCP2221_ERR_USB_OPEN = -20,       /**< USB device open failed. */
 	MCP2221_ERR_USB_CLAIM = -21,      /**< USB interface claim failed. */
 	MCP2221_ERR_COMMAND_FAILED = -22, /**< MCP2221 rejected or failed a command. */
-	MCP2221_ERR_PROTOCOL = -23        /**< Invalid or mismatched MCP2221 protocol response. */
+	MCP2221_ERR_PROTOCOL = -23,       /**< Invalid or mismatched MCP2221 protocol response. */
+	MCP2221_ERR_PEC = -24             /**< SMBus Packet Error Checking byte did not match. */
 } mcp2221_error_code_t;
 
 #endif // MCP2221_ERROR_CODES_H
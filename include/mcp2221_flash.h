@@ -70,5 +70,21 @@ MCP2221_API mcp2221_error_code_t mcp2221_flash_write(mcp2221_t *dev, uint8_t sec
  */
 MCP2221_API mcp2221_error_code_t mcp2221_flash_send_password(mcp2221_t *dev, const uint8_t pwd[8]);
 
+/**
+ * @brief Discard the cached flash sections so that the next reader asks the device.
+ *
+ * Every device handle caches the USB manufacturer, product and serial-number
+ * strings and the factory serial number from each read of those sections.
+ * mcp2221_flash_read_info() answers from this cache, and every write of a
+ * section through the handle, including raw commands sent with
+ * mcp2221_send_cmd(), discards that section. Changes made by other processes
+ * are not seen; call this function when that matters.
+ *
+ * mcp2221_flash_read() always reads the device.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ */
+MCP2221_API void mcp2221_flash_cache_invalidate(mcp2221_t *dev);
+
 MCP2221_END_DECLS
 #endif	// MCP2221_FLASH_H
\ No newline at end of file
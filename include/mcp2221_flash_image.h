@@ -0,0 +1,202 @@
+/**
+ * @file mcp2221_flash_image.h
+ * @brief Flash provisioning images: capture, verify and apply, also to many devices at once.
+ */
+
+#ifndef MCP2221_FLASH_IMAGE_H
+#define MCP2221_FLASH_IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+
+MCP2221_BEGIN_DECLS
+
+/** @brief Image section: chip settings. */
+#define MCP2221_FLASH_IMAGE_CHIP_SETTINGS    0x01u
+/** @brief Image section: GP settings. */
+#define MCP2221_FLASH_IMAGE_GP_SETTINGS      0x02u
+/** @brief Image section: USB manufacturer string. */
+#define MCP2221_FLASH_IMAGE_USB_MANUFACTURER 0x04u
+/** @brief Image section: USB product string. */
+#define MCP2221_FLASH_IMAGE_USB_PRODUCT      0x08u
+/** @brief Image section: USB serial-number string template. */
+#define MCP2221_FLASH_IMAGE_USB_SERIAL       0x10u
+/** @brief Image section: flash access password, stored with the chip settings. */
+#define MCP2221_FLASH_IMAGE_PASSWORD         0x20u
+/** @brief Every section mcp2221_flash_image_capture() can read. */
+#define MCP2221_FLASH_IMAGE_ALL              0x1Fu
+
+/** @brief Maximum length of a USB string, in UTF-16 code units. */
+#define MCP2221_FLASH_IMAGE_STRING_MAX 30
+
+/**
+ * @brief Contents of the writable MCP2221 flash sections.
+ *
+ * Only the sections listed in @ref sections are compared or written. The
+ * factory serial number is read-only and not part of an image.
+ *
+ * The chip and GP settings are raw payloads as returned by
+ * mcp2221_flash_read(). Of the chip settings, the bytes from CDC/security
+ * through the requested USB current are compared and written; the password
+ * bytes come from @ref password or, without MCP2221_FLASH_IMAGE_PASSWORD, from
+ * the device's current password. Images that would permanently lock the
+ * chip are rejected, as are images that enable password protection without
+ * MCP2221_FLASH_IMAGE_PASSWORD.
+ *
+ * Strings are UTF-8 of at most MCP2221_FLASH_IMAGE_STRING_MAX UTF-16 code
+ * units. In @ref usb_serial, the first run of '#' characters is replaced by
+ * the device's serial number in decimal, zero-padded to the width of the run:
+ * with "LINE4-#####", serial number 42 becomes "LINE4-00042".
+ */
+typedef struct {
+	unsigned sections;           /**< MCP2221_FLASH_IMAGE_* bits of the sections present. */
+	uint8_t chip_settings[60];   /**< Chip-settings payload. */
+	uint8_t gp_settings[60];     /**< GP-settings payload. */
+	char usb_manufacturer[128];  /**< USB manufacturer string. */
+	char usb_product[128];       /**< USB product string. */
+	char usb_serial[128];        /**< USB serial-number template. */
+	uint8_t password[8];         /**< Flash access password. */
+} mcp2221_flash_image_t;
+
+/**
+ * @brief Outcome of applying an image to one device.
+ */
+typedef struct {
+	mcp2221_error_code_t error; /**< Result of the apply for this device. */
+	unsigned written;           /**< Sections programmed and verified by read-back. */
+	unsigned skipped;           /**< Sections that already matched and were not programmed. */
+	char usb_serial[128];       /**< Serial number for this device, after templating. */
+} mcp2221_flash_image_result_t;
+
+/**
+ * @brief Read the writable flash sections of a device into an image.
+ *
+ * The password cannot be read back, so the image never contains
+ * MCP2221_FLASH_IMAGE_PASSWORD and its password bytes are zero; add the
+ * password before applying an image captured from a protected device.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[out] image Receives the image, with MCP2221_FLASH_IMAGE_ALL sections.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_flash_image_capture(mcp2221_t *dev, mcp2221_flash_image_t *image);
+
+/**
+ * @brief Expand the serial-number template of an image.
+ *
+ * @param[in] image Image.
+ * @param[in] serial_number Number substituted for the run of '#' characters.
+ * @param[out] out Receives the serial number.
+ * @param[in] out_len Size of @p out in bytes.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments, when @p serial_number does not fit the run of '#'
+ *         characters, or when the result does not fit @p out or the flash.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_flash_image_expand_serial(const mcp2221_flash_image_t *image, uint32_t serial_number,
+								   char *out, size_t out_len);
+
+/**
+ * @brief Compare a device's flash with an image.
+ *
+ * Every section is read from the device, bypassing the flash cache. The
+ * password cannot be read back and is not compared.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] image Image to compare with.
+ * @param[in] serial_number Serial number for the serial-number template.
+ * @param[out] out_mismatch Receives the MCP2221_FLASH_IMAGE_* bits of the
+ *                          sections that differ, or 0.
+ *
+ * @return MCP2221_ERR_OK when the comparison completed, whether or not the
+ *         flash matches, MCP2221_ERR_INVALID for invalid arguments or an
+ *         invalid image, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_flash_image_verify(mcp2221_t *dev, const mcp2221_flash_image_t *image,
+							    uint32_t serial_number, unsigned *out_mismatch);
+
+/**
+ * @brief Program a device from an image.
+ *
+ * Each section is compared with flash first and programmed only when it
+ * differs; every programmed section is read back and compared. The chip
+ * settings go last, so that enabling password protection does not lock out
+ * the other sections. A device that is already password protected is
+ * unlocked with the image password first; without one, nothing is written.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] image Image to apply.
+ * @param[in] serial_number Serial number for the serial-number template.
+ * @param[out] result Optional; receives the sections written and skipped,
+ *                    also on failure.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments or an invalid image, MCP2221_ERR_FLASH_PASSWD when the
+ *         device is protected and the image has no password or the device
+ *         rejects it, MCP2221_ERR_ACCESS when the device is permanently
+ *         locked, MCP2221_ERR_FLASH_WRITE when a read-back differs, or
+ *         another mcp2221_error_code_t value on failure. Sections written
+ *         before a failure stay written.
+ *
+ * @warning This function performs persistent flash writes.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_flash_image_apply(mcp2221_t *dev, const mcp2221_flash_image_t *image,
+							   uint32_t serial_number, mcp2221_flash_image_result_t *result);
+
+/**
+ * @brief Program several devices from one image in parallel.
+ *
+ * Runs mcp2221_flash_image_apply() for every device on its own thread; device
+ * @c i gets serial number @p first_serial + @c i. Each handle must be used by
+ * no other thread until the call returns, and may appear only once.
+ *
+ * @param[in] devs Open MCP2221 device handles.
+ * @param[in] count Number of handles.
+ * @param[in] image Image to apply.
+ * @param[in] first_serial Serial number of the first device.
+ * @param[out] results Array of @p count results, one per device.
+ *
+ * @return MCP2221_ERR_OK when every device succeeded, MCP2221_ERR_INVALID for
+ *         invalid arguments, or otherwise the error of the first failing
+ *         device in array order. @p results holds the outcome of every device.
+ *
+ * @warning This function performs persistent flash writes.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_flash_image_apply_many(mcp2221_t *const *devs, size_t count,
+								const mcp2221_flash_image_t *image, uint32_t first_serial,
+								mcp2221_flash_image_result_t *results);
+
+/**
+ * @brief Write an image to a file.
+ *
+ * The file holds, little-endian: the magic "MCPF", a version byte (1), the
+ * sections byte, two zero bytes, the chip and GP settings (60 bytes each),
+ * the three strings (128 bytes each, NUL-padded), the password (8 bytes) and
+ * a CRC-32 (IEEE 802.3) of everything before it: 524 bytes in all.
+ *
+ * @param[in] path File to create or replace.
+ * @param[in] image Image to write.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_GENERIC if the file cannot be written.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_flash_image_save(const char *path, const mcp2221_flash_image_t *image);
+
+/**
+ * @brief Read an image from a file written by mcp2221_flash_image_save().
+ *
+ * @param[in] path File to read.
+ * @param[out] image Receives the image.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_NOT_FOUND if the file cannot
+ *         be opened, or MCP2221_ERR_INVALID for invalid arguments or a file
+ *         with the wrong size, magic, version or checksum.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_flash_image_load(const char *path, mcp2221_flash_image_t *image);
+
+MCP2221_END_DECLS
+#endif	// MCP2221_FLASH_IMAGE_H
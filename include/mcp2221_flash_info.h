@@ -69,6 +69,11 @@ typedef struct {
  * are read. USB-style wide-character structures are decoded to UTF-8 on a
  * best-effort basis.
  *
+ * The chip and GP settings are always read from the device. The USB string
+ * and factory serial sections come from the handle's flash cache once they
+ * have been read, so repeated calls send two commands instead of six; see
+ * mcp2221_flash_cache_invalidate().
+ *
  * @param[in] dev Open MCP2221 device handle.
  * @param[out] info Receives raw flash sections and decoded strings.
  *
@@ -83,7 +88,8 @@ MCP2221_API mcp2221_error_code_t mcp2221_flash_read_info(mcp2221_t *dev, mcp2221
  * The function updates the persistent chip-settings and GP-settings sections
  * from the current device SRAM state. GPIO values are taken from the library's
  * cached GPIO state when available so that changes made through the GPIO API
- * are retained.
+ * are retained. Sections whose contents would not change are not written; see
+ * mcp2221_flash_save_config_ex().
  *
  * Enumeration-time USB power attributes and requested-current values remain
  * unchanged unless the corresponding USB setter has staged an explicit
@@ -99,5 +105,29 @@ MCP2221_API mcp2221_error_code_t mcp2221_flash_read_info(mcp2221_t *dev, mcp2221
  */
 MCP2221_API mcp2221_error_code_t mcp2221_flash_save_config(mcp2221_t *dev);
 
+/** @brief mcp2221_flash_save_config_ex() wrote the chip-settings section. */
+#define MCP2221_FLASH_SAVED_CHIP_SETTINGS 0x01u
+/** @brief mcp2221_flash_save_config_ex() wrote the GP-settings section. */
+#define MCP2221_FLASH_SAVED_GP_SETTINGS   0x02u
+
+/**
+ * @brief Save the current runtime configuration and report what was written.
+ *
+ * Behaves like mcp2221_flash_save_config(), which calls it. Each section is
+ * compared with its current flash contents and written only when it would
+ * change, so saving an unchanged configuration programs no flash.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[out] out_written Optional; receives a combination of
+ *                         MCP2221_FLASH_SAVED_CHIP_SETTINGS and
+ *                         MCP2221_FLASH_SAVED_GP_SETTINGS for the sections
+ *                         written, including on failure, or 0 if neither was.
+ *
+ * @return As for mcp2221_flash_save_config().
+ *
+ * @warning This function may perform persistent flash writes.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_flash_save_config_ex(mcp2221_t *dev, unsigned *out_written);
+
 MCP2221_END_DECLS
 #endif // MCP2221_FLASH_INFO_H
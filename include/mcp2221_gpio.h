@@ -6,6 +6,7 @@
 #ifndef MCP2221_GPIO_H
 #define MCP2221_GPIO_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "mcp2221.h"
@@ -53,9 +54,116 @@ typedef struct {
  *
  * @note The library updates its cached GPIO output state for pins successfully
  *       accepted by the device.
+ *
+ * @see mcp2221_gpio_set_write_elision()
  */
 MCP2221_API mcp2221_error_code_t mcp2221_gpio_write(mcp2221_t *dev, const mcp2221_gpio_write_t *wr);
 
+/**
+ * @brief GPIO write statistics of one device.
+ */
+typedef struct {
+	uint64_t commands;  /**< SET_GPIO_OUTPUT_VALUES commands sent. */
+	uint64_t elided;    /**< mcp2221_gpio_write() calls answered without a command. */
+} mcp2221_gpio_write_stats_t;
+
+/**
+ * @brief Enable or disable GPIO write elision.
+ *
+ * The library remembers the output level of every pin that the device
+ * accepted through mcp2221_gpio_write(). With elision enabled, a write whose
+ * requested pins all already drive the requested levels returns
+ * MCP2221_ERR_OK without sending a command, so toggling chip-select, LED or
+ * reset lines costs a USB round trip only for real transitions.
+ *
+ * Elision also keeps mcp2221_gpio_write() from reading the SRAM settings to
+ * load the cached GPIO configuration; the cache is then only updated when it
+ * is already loaded.
+ *
+ * A pin's remembered level is forgotten when a write to it fails, when pin
+ * configuration is changed through the SRAM helpers and when the chip is
+ * reset, and by every call of this function. Changes made by other
+ * processes or through mcp2221_send_cmd() are not seen; call this function
+ * again after such changes. Elision is disabled by default.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] enable Nonzero to enable elision.
+ */
+MCP2221_API void mcp2221_gpio_set_write_elision(mcp2221_t *dev, int enable);
+
+/**
+ * @brief Retrieve GPIO write statistics.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_get_write_stats(mcp2221_t *dev, mcp2221_gpio_write_stats_t *stats);
+
+/**
+ * @brief Reset GPIO write statistics to zero.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ */
+MCP2221_API void mcp2221_gpio_reset_write_stats(mcp2221_t *dev);
+
+/**
+ * @brief One step of a GPIO output sequence.
+ */
+typedef struct {
+	mcp2221_gpio_write_t write; /**< Output update applied by this step. */
+	uint32_t delay_us;          /**< Target time after the previous step's target, or after the start for the first step. */
+} mcp2221_gpio_step_t;
+
+/**
+ * @brief Timing statistics of one mcp2221_gpio_sequence_run() call.
+ *
+ * The lag of a step is how far its command was issued behind the step's
+ * target time.
+ */
+typedef struct {
+	size_t steps_sent;     /**< Steps whose command was sent. */
+	uint64_t duration_us;  /**< Time from the start until the last reply. */
+	uint64_t mean_lag_us;  /**< Mean lag of the sent steps. */
+	uint64_t max_lag_us;   /**< Largest lag. */
+	uint64_t jitter_us;    /**< Difference between the largest and smallest lag. */
+	size_t late_steps;     /**< Steps issued at or after the next step's target time. */
+} mcp2221_gpio_sequence_stats_t;
+
+/**
+ * @brief Play a timed sequence of GPIO output updates.
+ *
+ * All SET_GPIO_OUTPUT_VALUES packets are built and validated before the
+ * first one is sent. Target times are the start time plus the cumulative
+ * step delays on `CLOCK_MONOTONIC`, and each step sleeps until its absolute
+ * target, so round-trip time and scheduler wakeup latency do not accumulate
+ * over the sequence. A step that is already late is sent immediately, which
+ * lets the following steps catch up with the schedule.
+ *
+ * Steps are always sent, regardless of mcp2221_gpio_set_write_elision(), and
+ * the SRAM settings are not read while the sequence runs. Remembered output
+ * levels and the GPIO snapshot are updated as for mcp2221_gpio_write().
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] steps Steps to play. May be `NULL` only when @p n is 0.
+ * @param[in] n Number of steps.
+ * @param[out] out_offsets_us Optional @p n element array receiving the time
+ *                            each step's command was issued, relative to the
+ *                            start. Entries of unsent steps are not written.
+ * @param[out] stats Optional timing statistics, also filled in on failure.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments or member values, MCP2221_ERR_NO_MEMORY if the packets
+ *         cannot be allocated, MCP2221_ERR_GPIO_MODE when a requested pin
+ *         cannot be written as GPIO, or another mcp2221_error_code_t value on
+ *         failure. The sequence stops at the first failing step.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_sequence_run(mcp2221_t *dev, const mcp2221_gpio_step_t *steps, size_t n,
+							 uint64_t *out_offsets_us,
+							 mcp2221_gpio_sequence_stats_t *stats);
+
 /**
  * @brief Read the current state of GP0 through GP3.
  *
@@ -92,5 +200,85 @@ MCP2221_API mcp2221_error_code_t mcp2221_gpio_read(mcp2221_t *dev, int out_state
  */
 MCP2221_API mcp2221_error_code_t mcp2221_gpio_read_mask(mcp2221_t *dev, int out_state[4], uint8_t *out_valid_mask);
 
+/**
+ * @brief GPIO values with the time they were sampled.
+ */
+typedef struct {
+	/** -1 for non-GPIO pins, otherwise 0 or 1, as in mcp2221_gpio_read(). */
+	int values[4];
+	/** Bit n set when GPn is configured as GPIO. */
+	uint8_t valid_mask;
+	/**
+	 * CLOCK_MONOTONIC time, in microseconds, at which the GET_GPIO_VALUES
+	 * command that produced the values was issued.
+	 */
+	uint64_t timestamp_us;
+} mcp2221_gpio_snapshot_t;
+
+/**
+ * @brief Snapshot sharing statistics of one device.
+ */
+typedef struct {
+	uint64_t hits;       /**< Reads served from a stored response. */
+	uint64_t misses;     /**< Reads that issued GET_GPIO_VALUES. */
+	uint64_t coalesced;  /**< Reads that waited for another reader's command. */
+} mcp2221_gpio_snapshot_stats_t;
+
+/**
+ * @brief Read GPIO values, accepting a response up to a given age.
+ *
+ * Every device keeps the last GET_GPIO_VALUES response. A read is served from
+ * it when the response is younger than @p max_age_us. Otherwise, if another
+ * thread's command is already in flight and was issued within the window,
+ * the read waits for that response instead of sending its own command. Only
+ * when neither applies is a new command sent.
+ *
+ * mcp2221_gpio_read(), mcp2221_gpio_read_mask() and the polling helpers use
+ * the same snapshot with an age of 0, so they always observe a response
+ * issued after they were called, but they share it with concurrent readers.
+ *
+ * GPIO writes, pin configuration changes and chip resets made through this
+ * library discard the stored response. Changes on input pins are only seen
+ * once the stored response expires.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] max_age_us Largest acceptable age in microseconds. 0 always
+ *                       samples the pins.
+ * @param[out] out_snapshot Receives the values and their sample time.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or another mcp2221_error_code_t value on failure. A read
+ *         that shared another thread's command reports that command's error.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_snapshot(mcp2221_t *dev, uint32_t max_age_us, mcp2221_gpio_snapshot_t *out_snapshot);
+
+/**
+ * @brief Discard the stored GPIO response of a device.
+ *
+ * Use this after changing the pins by means the library does not see, for
+ * example raw commands sent with mcp2221_send_cmd().
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ */
+MCP2221_API void mcp2221_gpio_snapshot_invalidate(mcp2221_t *dev);
+
+/**
+ * @brief Retrieve snapshot sharing statistics.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_snapshot_get_stats(mcp2221_t *dev, mcp2221_gpio_snapshot_stats_t *stats);
+
+/**
+ * @brief Reset snapshot sharing statistics to zero.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ */
+MCP2221_API void mcp2221_gpio_snapshot_reset_stats(mcp2221_t *dev);
+
 MCP2221_END_DECLS
 #endif	// MCP2221_GPIO_H
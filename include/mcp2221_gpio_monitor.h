@@ -0,0 +1,175 @@
+/**
+ * @file mcp2221_gpio_monitor.h
+ * @brief Background GPIO edge monitor with callback dispatch.
+ */
+
+#ifndef MCP2221_GPIO_MONITOR_H
+#define MCP2221_GPIO_MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_gpio_poll.h"
+
+MCP2221_BEGIN_DECLS
+
+/** @brief Monitor flag: also record `CLOCK_REALTIME` for every event. */
+#define MCP2221_GPIO_MONITOR_REALTIME 0x01u
+
+/**
+ * @brief Opaque background GPIO monitor.
+ *
+ * The monitor samples GP0 through GP3 at a fixed period on a dedicated worker
+ * thread and turns level changes into edge events. Events are queued in a
+ * lock-free ring that the application drains with
+ * mcp2221_gpio_monitor_drain(), and are passed to the callbacks registered
+ * for their pin and edge. Events are fixed-size records; no memory is
+ * allocated and no text is formatted per event.
+ *
+ * Samples are taken through the device's shared GPIO snapshot, so GPIO reads
+ * made by other threads in the meantime share the monitor's commands.
+ * Other operations on the MCP2221 handle are not serialized against the
+ * worker thread.
+ */
+typedef struct mcp2221_gpio_monitor mcp2221_gpio_monitor_t;
+
+/**
+ * @brief Monitor configuration.
+ */
+typedef struct {
+	/** Sample period in microseconds; must be nonzero. */
+	uint32_t period_us;
+	/**
+	 * Minimum number of events the ring can hold, rounded up to a power of
+	 * two. 0 disables the ring; events then only reach callbacks.
+	 */
+	size_t ring_capacity;
+	/** Combination of MCP2221_GPIO_MONITOR_* flags. */
+	unsigned flags;
+} mcp2221_gpio_monitor_config_t;
+
+/**
+ * @brief One GPIO edge event.
+ */
+typedef struct {
+	/** Time the sampling command was issued, from `CLOCK_MONOTONIC`, in nanoseconds. */
+	uint64_t time_ns;
+	/** `CLOCK_REALTIME` of the sample in nanoseconds, or 0 without MCP2221_GPIO_MONITOR_REALTIME. */
+	uint64_t realtime_ns;
+	/** Time of the previous sample, from `CLOCK_MONOTONIC`; the edge happened in between. */
+	uint64_t prev_time_ns;
+	/** GP pin number from 0 through 3. */
+	uint8_t gpio;
+	/** MCP2221_GPIO_EVENT_RISE or MCP2221_GPIO_EVENT_FALL. */
+	uint8_t type;
+} mcp2221_gpio_monitor_event_t;
+
+/**
+ * @brief Event callback, called on the monitor's worker thread.
+ *
+ * Callbacks must return quickly and must not call mcp2221_gpio_monitor_stop()
+ * or mcp2221_gpio_monitor_destroy() on their own monitor.
+ */
+typedef void (*mcp2221_gpio_monitor_callback_t)(const mcp2221_gpio_monitor_event_t *event, void *user);
+
+/**
+ * @brief Monitor statistics.
+ */
+typedef struct {
+	uint64_t samples;         /**< Successful samples. */
+	uint64_t errors;          /**< Failed samples. */
+	uint64_t missed_periods;  /**< Sample periods skipped because the worker fell behind. */
+	uint64_t events;          /**< Edge events detected. */
+	uint64_t ring_overruns;   /**< Events dropped because the ring was full. */
+	mcp2221_error_code_t last_error; /**< Error of the last failed sample. */
+} mcp2221_gpio_monitor_stats_t;
+
+/**
+ * @brief Create a GPIO monitor.
+ *
+ * The monitor borrows @p dev; mcp2221_gpio_monitor_destroy() does not close it.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] config Monitor configuration.
+ * @param[out] out_monitor Receives the new monitor.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_NO_MEMORY if allocation fails.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_monitor_create(mcp2221_t *dev, const mcp2221_gpio_monitor_config_t *config,
+							       mcp2221_gpio_monitor_t **out_monitor);
+
+/**
+ * @brief Stop and free a GPIO monitor.
+ *
+ * @param[in] monitor Monitor to destroy, or `NULL`.
+ */
+MCP2221_API void mcp2221_gpio_monitor_destroy(mcp2221_gpio_monitor_t *monitor);
+
+/**
+ * @brief Register the callback for one pin and edge.
+ *
+ * Callbacks can only be changed while the monitor is stopped.
+ *
+ * @param[in] monitor Monitor.
+ * @param[in] gpio GP pin number from 0 through 3.
+ * @param[in] type MCP2221_GPIO_EVENT_RISE or MCP2221_GPIO_EVENT_FALL.
+ * @param[in] callback Callback, or `NULL` to remove it.
+ * @param[in] user Argument passed to @p callback.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_BUSY while the monitor is running.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_monitor_set_callback(mcp2221_gpio_monitor_t *monitor, int gpio,
+								     mcp2221_gpio_event_type_t type,
+								     mcp2221_gpio_monitor_callback_t callback, void *user);
+
+/**
+ * @brief Start the worker thread.
+ *
+ * The first sample establishes the initial levels and produces no events.
+ * Statistics are reset. Events queued before the start are discarded by the
+ * next mcp2221_gpio_monitor_drain(), so draining may continue concurrently.
+ *
+ * @param[in] monitor Monitor.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, MCP2221_ERR_BUSY if already running, or another
+ *         mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_monitor_start(mcp2221_gpio_monitor_t *monitor);
+
+/**
+ * @brief Stop the worker thread. Queued events remain available.
+ *
+ * @param[in] monitor Monitor, or `NULL`.
+ */
+MCP2221_API void mcp2221_gpio_monitor_stop(mcp2221_gpio_monitor_t *monitor);
+
+/**
+ * @brief Move queued events to the caller.
+ *
+ * Call from one thread at a time.
+ *
+ * @param[in] monitor Monitor.
+ * @param[out] out Event buffer. May be `NULL` only when @p max is 0.
+ * @param[in] max Maximum number of events to move.
+ *
+ * @return Number of events moved, or a negative mcp2221_error_code_t value.
+ */
+MCP2221_API int mcp2221_gpio_monitor_drain(mcp2221_gpio_monitor_t *monitor, mcp2221_gpio_monitor_event_t *out, size_t max);
+
+/**
+ * @brief Read monitor statistics.
+ *
+ * @param[in] monitor Monitor.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_monitor_get_stats(mcp2221_gpio_monitor_t *monitor, mcp2221_gpio_monitor_stats_t *stats);
+
+MCP2221_END_DECLS
+#endif	// MCP2221_GPIO_MONITOR_H
@@ -37,6 +37,49 @@ typedef struct {
 	int changed;
 } mcp2221_gpio_change_t;
 
+/**
+ * @brief Debounce and edge-counting state of one GP pin.
+ *
+ * Maintained by the polling functions; configure it with
+ * mcp2221_gpio_poll_set_debounce() and read it with
+ * mcp2221_gpio_poll_get_pin_stats().
+ */
+typedef struct {
+	/** @brief Consecutive samples a new level must be seen in; 0 or 1 accepts it at once. */
+	uint32_t debounce_samples;
+	/** @brief Time a new level must stay stable, in microseconds; 0 disables the check. */
+	uint32_t debounce_us;
+
+	/** @brief Level waiting to pass the debounce filter. */
+	int pending;
+	/** @brief Consecutive samples of @ref pending; 0 when nothing is pending. */
+	uint32_t pending_count;
+	/** @brief Monotonic time, in microseconds, @ref pending was first sampled. */
+	uint64_t pending_since_us;
+
+	/** @brief Debounced low-to-high transitions. */
+	uint64_t rises;
+	/** @brief Debounced high-to-low transitions. */
+	uint64_t falls;
+	/** @brief Monotonic time of the last debounced edge, in microseconds. */
+	uint64_t last_edge_us;
+	/** @brief Monotonic time of the last debounced rising edge, in microseconds. */
+	uint64_t last_rise_us;
+	/** @brief Smoothed rise-to-rise interval in microseconds; 0 until two rises were seen. */
+	double period_us;
+} mcp2221_gpio_pin_state_t;
+
+/**
+ * @brief Edge counters and frequency estimate of one GP pin.
+ */
+typedef struct {
+	uint64_t rises;        /**< Debounced low-to-high transitions. */
+	uint64_t falls;        /**< Debounced high-to-low transitions. */
+	uint64_t last_edge_us; /**< Monotonic time of the last edge in microseconds, or 0. */
+	double period_us;      /**< Estimated signal period in microseconds, or 0 if unknown. */
+	double frequency_hz;   /**< Estimated signal frequency, or 0 if unknown. */
+} mcp2221_gpio_pin_stats_t;
+
 /**
  * @brief Persistent state used by the GPIO polling helpers.
  *
@@ -72,6 +115,43 @@ typedef struct {
 	 * MCP2221_GPIO_POLL_MASK_RISE() and MCP2221_GPIO_POLL_MASK_FALL().
 	 */
 	uint16_t filter_mask;
+
+	/**
+	 * @brief Largest age, in microseconds, of a shared GPIO response a poll
+	 *        may use.
+	 *
+	 * 0, the default, samples the pins on every poll. See
+	 * mcp2221_gpio_snapshot() and mcp2221_gpio_poll_set_max_age().
+	 */
+	uint32_t max_age_us;
+
+	/**
+	 * @brief Nonzero when mcp2221_gpio_wait_events() also checks the
+	 *        interrupt-on-change flag.
+	 *
+	 * See mcp2221_gpio_poll_set_ioc_latch().
+	 */
+	int ioc_latch;
+
+	/** @brief Shortest interval between polls of mcp2221_gpio_wait_events(), in milliseconds. */
+	uint32_t wait_min_interval_ms;
+
+	/** @brief Longest interval between polls of mcp2221_gpio_wait_events(), in milliseconds. */
+	uint32_t wait_max_interval_ms;
+
+	/**
+	 * @brief Current interval between polls of mcp2221_gpio_wait_events().
+	 *
+	 * Reset to @ref wait_min_interval_ms after activity and doubled after
+	 * every idle poll, up to @ref wait_max_interval_ms.
+	 */
+	uint32_t wait_interval_ms;
+
+	/** @brief Per-pin debounce filters, edge counters and period estimates. */
+	mcp2221_gpio_pin_state_t pins[4];
+
+	/** @brief Monotonic time of the last sample, in microseconds. */
+	uint64_t last_sample_us;
 } mcp2221_gpio_poll_state_t;
 
 /**
@@ -80,6 +160,11 @@ typedef struct {
 typedef enum {
 	MCP2221_GPIO_EVENT_RISE = 0, /**< Low-to-high transition. */
 	MCP2221_GPIO_EVENT_FALL = 1, /**< High-to-low transition. */
+	/**
+	 * Interrupt-on-change flag was latched on GP1. Only reported by
+	 * mcp2221_gpio_wait_events() with the IOC latch enabled.
+	 */
+	MCP2221_GPIO_EVENT_IOC = 2,
 } mcp2221_gpio_event_type_t;
 
 /**
@@ -119,11 +204,25 @@ typedef struct {
  */
 #define MCP2221_GPIO_POLL_MASK_FALL(pin) (1u << ((pin) * 2 + 1))
 
+/**
+ * @brief Filter-mask bit for interrupt-on-change events.
+ */
+#define MCP2221_GPIO_POLL_MASK_IOC (1u << 8)
+
+/** @brief Default shortest interval between polls of mcp2221_gpio_wait_events(). */
+#define MCP2221_GPIO_WAIT_MIN_INTERVAL_MS 1u
+
+/** @brief Default longest interval between polls of mcp2221_gpio_wait_events(). */
+#define MCP2221_GPIO_WAIT_MAX_INTERVAL_MS 32u
+
 /**
  * @brief Initialize a GPIO polling state object.
  *
- * The filter is reset to 0, which accepts all edge events. Passing `NULL` is
- * a no-op.
+ * The filter is reset to 0, which accepts all edge events, and the maximum
+ * sample age to 0. The IOC latch is disabled and the wait intervals are set
+ * to MCP2221_GPIO_WAIT_MIN_INTERVAL_MS and MCP2221_GPIO_WAIT_MAX_INTERVAL_MS.
+ * Debouncing is disabled and all edge counters are cleared. Passing `NULL`
+ * is a no-op.
  *
  * @param[out] st Polling state to initialize.
  */
@@ -139,6 +238,109 @@ MCP2221_API void mcp2221_gpio_poll_init(mcp2221_gpio_poll_state_t *st);
  */
 MCP2221_API void mcp2221_gpio_poll_set_filter_mask(mcp2221_gpio_poll_state_t *st, uint16_t mask);
 
+/**
+ * @brief Let polls reuse a recent GPIO response.
+ *
+ * Polls then take their samples from the device's shared GPIO snapshot when
+ * it is younger than @p max_age_us, so several pollers of one device do not
+ * each send a command. Passing `NULL` is a no-op.
+ *
+ * @param[in,out] st Polling state to update.
+ * @param[in] max_age_us Largest acceptable age in microseconds; 0 samples on
+ *                       every poll.
+ *
+ * @see mcp2221_gpio_snapshot()
+ */
+MCP2221_API void mcp2221_gpio_poll_set_max_age(mcp2221_gpio_poll_state_t *st, uint32_t max_age_us);
+
+/**
+ * @brief Configure the debounce filter of one pin.
+ *
+ * A changed level is only accepted once it was seen in @p samples
+ * consecutive polls and has stayed stable for @p min_stable_us. Until then,
+ * the polling functions keep reporting the previous level. Accepted edges
+ * are timestamped with the first sample that showed the new level. Both
+ * limits may be combined; 0 for both disables debouncing, which is the
+ * default.
+ *
+ * @param[in,out] st Polling state to update.
+ * @param[in] pin GP pin number from 0 through 3.
+ * @param[in] samples Consecutive samples required.
+ * @param[in] min_stable_us Minimum stable time in microseconds.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_poll_set_debounce(mcp2221_gpio_poll_state_t *st, int pin, uint32_t samples,
+								 uint32_t min_stable_us);
+
+/**
+ * @brief Read the edge counters and frequency estimate of one pin.
+ *
+ * Every debounced edge seen by mcp2221_gpio_poll(),
+ * mcp2221_gpio_poll_events() or mcp2221_gpio_wait_events() is counted,
+ * whether or not it passes the event filter. The period is a running average
+ * of rise-to-rise intervals weighted towards recent edges. When no rising
+ * edge has been seen for longer than that period, the estimate is bounded by
+ * the time since the last rise, so a stopped signal decays towards 0 Hz.
+ *
+ * Edges are only seen at the polling rate. Signals faster than half the poll
+ * rate, or pulses shorter than the poll interval, are undercounted.
+ *
+ * @param[in] st Polling state.
+ * @param[in] pin GP pin number from 0 through 3.
+ * @param[out] stats Receives the counters and estimate.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_poll_get_pin_stats(const mcp2221_gpio_poll_state_t *st, int pin,
+								  mcp2221_gpio_pin_stats_t *stats);
+
+/**
+ * @brief Reset the edge counters and period estimates of all pins.
+ *
+ * Debounce settings and the sampled levels are kept. Passing `NULL` is a
+ * no-op.
+ *
+ * @param[in,out] st Polling state to update.
+ */
+MCP2221_API void mcp2221_gpio_poll_reset_counters(mcp2221_gpio_poll_state_t *st);
+
+/**
+ * @brief Let mcp2221_gpio_wait_events() check the interrupt-on-change flag.
+ *
+ * The MCP2221 latches edges on GP1 in its interrupt-on-change flag when GP1
+ * is configured for its interrupt function and edge detection is enabled with
+ * mcp2221_ioc_config(). The latch catches pulses shorter than the polling
+ * interval. With this option, every wait poll reads the flag, and a set flag
+ * is cleared and reported as an MCP2221_GPIO_EVENT_IOC event.
+ *
+ * When the filter mask selects only GP1 edges and IOC events, the GPIO values
+ * are read only after the flag was found set, so an idle line costs one USB
+ * transfer per poll as without the latch. With any other filter, including
+ * the default of all events, the flag read is an extra transfer per poll.
+ * Passing `NULL` is a no-op.
+ *
+ * @param[in,out] st Polling state to update.
+ * @param[in] enable Nonzero to check the flag.
+ */
+MCP2221_API void mcp2221_gpio_poll_set_ioc_latch(mcp2221_gpio_poll_state_t *st, int enable);
+
+/**
+ * @brief Set the polling interval range of mcp2221_gpio_wait_events().
+ *
+ * @param[in,out] st Polling state to update.
+ * @param[in] min_interval_ms Interval used right after activity; at least 1.
+ * @param[in] max_interval_ms Interval reached after a long idle period; at
+ *                            least @p min_interval_ms.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_gpio_poll_set_wait_interval(mcp2221_gpio_poll_state_t *st, uint32_t min_interval_ms,
+								      uint32_t max_interval_ms);
+
 /**
  * @brief Poll GP0 through GP3 and report per-pin state changes.
  *
@@ -194,5 +396,34 @@ MCP2221_API mcp2221_error_code_t mcp2221_gpio_poll(
 MCP2221_API int mcp2221_gpio_poll_events(mcp2221_t *dev, mcp2221_gpio_poll_state_t *st, const uint16_t *filter_mask_opt,
 							mcp2221_gpio_event_t *out_events, size_t max_events);
 
+/**
+ * @brief Wait until GPIO events are available.
+ *
+ * Polls like mcp2221_gpio_poll_events() with the filter stored in @p st
+ * until at least one event is produced or @p timeout_ms expires. The poll
+ * interval adapts to the input: it drops to the minimum interval after any
+ * pin change or latched interrupt, and doubles after every idle poll up to
+ * the maximum interval. The interval is kept in @p st, so a burst of
+ * activity is followed closely across calls while an idle line costs few
+ * USB transfers.
+ *
+ * With the IOC latch enabled, the interrupt-on-change flag is checked first
+ * on every poll and may replace the GPIO read; see
+ * mcp2221_gpio_poll_set_ioc_latch().
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in,out] st Initialized polling state.
+ * @param[out] out_events Event buffer. May be `NULL` only when
+ *                        @p max_events is 0.
+ * @param[in] max_events Maximum number of events that may be written.
+ * @param[in] timeout_ms Longest time to wait in milliseconds. 0 polls once,
+ *                       and a negative value waits without limit.
+ *
+ * @return Number of events written on success, 0 when the timeout expired,
+ *         otherwise a negative mcp2221_error_code_t value.
+ */
+MCP2221_API int mcp2221_gpio_wait_events(mcp2221_t *dev, mcp2221_gpio_poll_state_t *st, mcp2221_gpio_event_t *out_events,
+					 size_t max_events, int timeout_ms);
+
 MCP2221_END_DECLS
 #endif	// MCP2221_GPIO_POLL_H
@@ -33,6 +33,54 @@ typedef enum {
 	MCP2221_I2C_BYTE_ORDER_LITTLE = 1
 } mcp2221_i2c_byte_order_t;
 
+/**
+ * @brief Control-register encoding of an I2C multiplexer.
+ */
+typedef enum {
+	/**
+	 * One enable bit per channel, as used by the TCA9548A and the PCA9543,
+	 * PCA9545, PCA9546 and PCA9548 switches.
+	 */
+	MCP2221_I2C_MUX_SWITCH = 0,
+
+	/**
+	 * An enable bit (0x04) combined with the channel number, as used by the
+	 * PCA9540, PCA9542 and PCA9544 multiplexers.
+	 */
+	MCP2221_I2C_MUX_SELECTOR = 1
+} mcp2221_i2c_mux_type_t;
+
+/** @brief Value of mcp2221_i2c_mux_t::selected while the channel is unknown. */
+#define MCP2221_I2C_MUX_CHANNEL_UNKNOWN (-1)
+
+/** @brief Value of mcp2221_i2c_mux_t::selected while all channels are off. */
+#define MCP2221_I2C_MUX_CHANNEL_NONE (-2)
+
+/**
+ * @brief Caller-owned I2C multiplexer context.
+ *
+ * A multiplexer context is shared by all slave contexts behind that
+ * multiplexer, so it must outlive them. It caches the currently selected
+ * channel; slave helpers write the control register only when a different
+ * channel is needed.
+ *
+ * The cache assumes that all traffic to the multiplexer goes through this
+ * context. After the multiplexer may have been reset or accessed elsewhere,
+ * call mcp2221_i2c_mux_invalidate(). With several multiplexers on one bus,
+ * only the selected channel of each multiplexer is enabled, so identical
+ * targets behind different multiplexers must be separated with
+ * mcp2221_i2c_mux_deselect().
+ */
+typedef struct mcp2221_i2c_mux {
+	mcp2221_t *mcp;              /**< Borrowed MCP2221 device handle. */
+	uint8_t addr;                /**< 7-bit I2C address of the multiplexer. */
+	mcp2221_i2c_mux_type_t type; /**< Control-register encoding. */
+	int channels;                /**< Number of downstream channels, from 1 to 8. */
+	int selected;                /**< Cached channel, MCP2221_I2C_MUX_CHANNEL_UNKNOWN or MCP2221_I2C_MUX_CHANNEL_NONE. */
+	uint32_t select_writes;      /**< Control-register writes performed. */
+	uint32_t select_skips;       /**< Channel selections satisfied by the cache. */
+} mcp2221_i2c_mux_t;
+
 /**
  * @brief Caller-owned I2C target context.
  *
@@ -50,6 +98,33 @@ struct mcp2221_i2c_slave {
 	mcp2221_i2c_byte_order_t reg_byteorder;   /**< Default register-address byte order. */
 };
 
+/**
+ * @brief Caller-owned context for a target behind an I2C multiplexer.
+ *
+ * Pairs a target context with its multiplexer route. The route is kept out
+ * of mcp2221_i2c_slave_t, whose layout is part of the 2.0 ABI. Initialize it
+ * with mcp2221_i2c_slave_init_muxed() and use the mcp2221_i2c_muxed_slave_*
+ * helpers, which select the channel before each transfer. The plain slave
+ * helpers may be used on @ref slave after mcp2221_i2c_muxed_slave_select().
+ */
+typedef struct {
+	mcp2221_i2c_slave_t slave; /**< Target context on the multiplexer's MCP2221 handle. */
+	mcp2221_i2c_mux_t *mux;    /**< Borrowed multiplexer in front of the target. */
+	int channel;               /**< Multiplexer channel of the target. */
+} mcp2221_i2c_muxed_slave_t;
+
+/**
+ * @brief One request for mcp2221_i2c_slave_read_register_batch().
+ */
+typedef struct {
+	mcp2221_i2c_slave_t *slave;        /**< Initialized target context; ignored if @ref muxed is set. */
+	mcp2221_i2c_muxed_slave_t *muxed;  /**< Target behind a multiplexer, or `NULL`. */
+	uint32_t reg;                      /**< Register address, using the context defaults. */
+	uint8_t *buffer;                   /**< Buffer receiving @ref length bytes. */
+	size_t length;                     /**< Number of bytes to read, from 1 to 256. */
+	mcp2221_error_code_t status;       /**< Set to the result of this read. */
+} mcp2221_i2c_slave_read_t;
+
 /**
  * @brief Initialize a caller-owned I2C target context.
  *
@@ -77,6 +152,165 @@ struct mcp2221_i2c_slave {
 MCP2221_API mcp2221_error_code_t mcp2221_i2c_slave_init(mcp2221_i2c_slave_t *slave, mcp2221_t *mcp, uint8_t addr, int force, uint32_t i2c_speed_hz,
 						   int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder);
 
+/**
+ * @brief Initialize a caller-owned I2C multiplexer context.
+ *
+ * No I2C traffic is generated; the selected channel starts out unknown, so
+ * the first channel selection always writes the control register.
+ *
+ * @param[out] mux Caller-owned context to initialize. Must not be `NULL`.
+ * @param[in] mcp Open MCP2221 device handle.
+ * @param[in] addr 7-bit I2C address of the multiplexer.
+ * @param[in] type Control-register encoding.
+ * @param[in] channels Number of downstream channels, from 1 to 8. Selector
+ *                     type multiplexers support at most 4 channels.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_mux_init(mcp2221_i2c_mux_t *mux, mcp2221_t *mcp, uint8_t addr, mcp2221_i2c_mux_type_t type,
+							int channels);
+
+/**
+ * @brief Select a multiplexer channel.
+ *
+ * The control register is written only if @p channel differs from the cached
+ * selection. If the write fails, the cached selection becomes unknown.
+ *
+ * @param[in,out] mux Initialized multiplexer context.
+ * @param[in] channel Channel to enable.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_mux_select(mcp2221_i2c_mux_t *mux, int channel);
+
+/**
+ * @brief Disable all channels of a multiplexer.
+ *
+ * @param[in,out] mux Initialized multiplexer context.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_mux_deselect(mcp2221_i2c_mux_t *mux);
+
+/**
+ * @brief Forget the cached channel selection.
+ *
+ * The next selection writes the control register unconditionally.
+ *
+ * @param[in,out] mux Initialized multiplexer context, or `NULL`.
+ */
+MCP2221_API void mcp2221_i2c_mux_invalidate(mcp2221_i2c_mux_t *mux);
+
+/**
+ * @brief Initialize a context for a target behind an I2C multiplexer.
+ *
+ * Works like mcp2221_i2c_slave_init(), but every mcp2221_i2c_muxed_slave_*
+ * helper call on the returned context first selects @p channel on @p mux.
+ * The I2C clock is left unchanged.
+ *
+ * On failure, @p target is left invalid with `target->slave.mcp == NULL`.
+ *
+ * @param[out] target Caller-owned context to initialize. Must not be `NULL`.
+ * @param[in] mux Initialized multiplexer context. It is borrowed and must
+ *                outlive @p target.
+ * @param[in] channel Multiplexer channel the target is connected to.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[in] force Nonzero to skip the initial presence check.
+ * @param[in] reg_bytes Default register-address width. Values less than or
+ *                      equal to 0 select 1 byte.
+ * @param[in] reg_byteorder Default register-address byte order.
+ *                          MCP2221_I2C_BYTE_ORDER_DEFAULT selects big endian.
+ *
+ * @return MCP2221_ERR_OK on success. Returns MCP2221_ERR_NOT_ACK when the
+ *         presence check is enabled and the target does not acknowledge, or
+ *         another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_slave_init_muxed(mcp2221_i2c_muxed_slave_t *target, mcp2221_i2c_mux_t *mux, int channel,
+								 uint8_t addr, int force, int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder);
+
+/**
+ * @brief Route the bus to a target behind a multiplexer.
+ *
+ * Selects the target's channel through the multiplexer's cache.
+ *
+ * @param[in] target Initialized multiplexed target context.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_muxed_slave_select(mcp2221_i2c_muxed_slave_t *target);
+
+/**
+ * @brief Multiplexed variant of mcp2221_i2c_slave_check_present().
+ *
+ * @param[in] target Initialized multiplexed target context.
+ * @param[out] is_present Set to 1 on ACK and 0 on address NACK.
+ *
+ * @return MCP2221_ERR_OK when the presence check itself completed, or
+ *         another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_muxed_slave_check_present(mcp2221_i2c_muxed_slave_t *target, int *is_present);
+
+/**
+ * @brief Multiplexed variant of mcp2221_i2c_slave_read_register().
+ *
+ * @param[in] target Initialized multiplexed target context.
+ * @param[in] reg Register address to read from.
+ * @param[out] buffer Buffer receiving the data.
+ * @param[in] length Number of data bytes to read. Must be from 1 to 256.
+ * @param[in] reg_bytes Register-address width, or 0 for the context default.
+ * @param[in] reg_byteorder Byte order, or MCP2221_I2C_BYTE_ORDER_DEFAULT.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_muxed_slave_read_register(mcp2221_i2c_muxed_slave_t *target, uint32_t reg, uint8_t *buffer,
+									  size_t length, int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder);
+
+/**
+ * @brief Multiplexed variant of mcp2221_i2c_slave_read().
+ *
+ * @param[in] target Initialized multiplexed target context.
+ * @param[out] buffer Buffer receiving the data.
+ * @param[in] length Number of bytes to read. Must be from 1 to 256.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_muxed_slave_read(mcp2221_i2c_muxed_slave_t *target, uint8_t *buffer, size_t length);
+
+/**
+ * @brief Multiplexed variant of mcp2221_i2c_slave_write_register().
+ *
+ * @param[in] target Initialized multiplexed target context.
+ * @param[in] reg Register address to write.
+ * @param[in] data Data bytes to append after the register address. May be
+ *                 `NULL` when @p length is 0.
+ * @param[in] length Number of data bytes to write, from 0 to 256.
+ * @param[in] reg_bytes Register-address width, or 0 for the context default.
+ * @param[in] reg_byteorder Byte order, or MCP2221_I2C_BYTE_ORDER_DEFAULT.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_muxed_slave_write_register(mcp2221_i2c_muxed_slave_t *target, uint32_t reg, const uint8_t *data,
+									   size_t length, int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder);
+
+/**
+ * @brief Multiplexed variant of mcp2221_i2c_slave_write().
+ *
+ * @param[in] target Initialized multiplexed target context.
+ * @param[in] data Data to write.
+ * @param[in] length Number of bytes to write. Must be from 1 to 256.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_muxed_slave_write(mcp2221_i2c_muxed_slave_t *target, const uint8_t *data, size_t length);
+
 /**
  * @brief Check whether the configured I2C target acknowledges its address.
  *
@@ -193,5 +427,25 @@ MCP2221_API mcp2221_error_code_t mcp2221_i2c_slave_write_register(mcp2221_i2c_sl
  */
 MCP2221_API mcp2221_error_code_t mcp2221_i2c_slave_write(mcp2221_i2c_slave_t *slave, const uint8_t *data, size_t length);
 
+/**
+ * @brief Read registers from several targets, visiting each multiplexer
+ *        channel once.
+ *
+ * Requests are executed grouped by multiplexer and channel, with directly
+ * attached targets first, so each channel is selected at most once per call.
+ * Within a group, requests keep their array order. Every request is attempted
+ * even if an earlier one fails; its result is stored in
+ * mcp2221_i2c_slave_read_t::status.
+ *
+ * @param[in,out] reqs Array of read requests.
+ * @param[in] count Number of requests.
+ *
+ * @return MCP2221_ERR_OK if every read succeeded, MCP2221_ERR_INVALID for
+ *         invalid arguments, MCP2221_ERR_NO_MEMORY if the visiting order
+ *         cannot be allocated, or the status of the first failing request
+ *         in array order.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_i2c_slave_read_register_batch(mcp2221_i2c_slave_read_t *reqs, size_t count);
+
 MCP2221_END_DECLS
 #endif	// MCP2221_I2C_SLAVE_H
@@ -12,6 +12,7 @@
 
 #include "mcp2221.h"
 #include "mcp2221_error_codes.h"
+#include "mcp2221_pin.h"
 #include <stdint.h>
 
 MCP2221_BEGIN_DECLS
@@ -113,18 +114,141 @@ void mcp2221_internal_gpio_status_update_out(mcp2221_t *dev, int pin, int out_va
  */
 void mcp2221_internal_utf16le_to_utf8(const uint8_t *in, size_t in_len, char *out, size_t out_len);
 
+/**
+ * @internal
+ * @brief Converts a NUL-terminated UTF-8 string to UTF-16LE.
+ *
+ * Only code points in the Basic Multilingual Plane are accepted, matching
+ * mcp2221_internal_utf16le_to_utf8().
+ *
+ * @param in UTF-8 input string
+ * @param out Output buffer of at least 2 * max_units bytes, or NULL to only count
+ * @param max_units Maximum number of UTF-16 code units
+ * @return Number of code units written, or -1 for malformed or unsupported input or
+ *         when more than max_units code units would be needed
+ */
+int mcp2221_internal_utf8_to_utf16le(const char *in, uint8_t *out, size_t max_units);
+
 /**
  * @internal
  * @brief Parses MCP2221 flash wchar/string structures into UTF-8.
  *
- * MCP2221 flash string blocks store the byte length at buf[2] and UTF-16LE data starting at buf[4].
- * The parser caps the declared string payload at the 56 bytes available in the 60-byte flash payload.
+ * READ_FLASH_DATA string responses store the structure length at buf[2] and UTF-16LE data starting
+ * at buf[4]. The parser caps the declared string payload at the 60 bytes available in the response.
  *
- * @param buf 60-byte MCP2221 flash string block
+ * @param buf 64-byte READ_FLASH_DATA response, see mcp2221_internal_flash_read_response()
  * @param out Output buffer
  * @param out_len Output buffer size in bytes
  */
 void mcp2221_internal_parse_wchar_structure(const uint8_t *buf, char *out, size_t out_len);
 
+/**
+ * @internal
+ * @brief Decodes the I2C engine fields of a POLL_STATUS response.
+ *
+ * @param rbuf 64-byte POLL_STATUS_SET_PARAMETERS response
+ * @param st Status receiving the decoded fields
+ */
+void mcp2221_internal_i2c_status_decode(const uint8_t *rbuf, mcp2221_i2c_status_t *st);
+
+/**
+ * @internal
+ * @brief Computes the I2C clock-divider register value for a bus speed.
+ *
+ * Uses the same rounding as mcp2221_i2c_set_speed().
+ *
+ * @param i2c_speed_hz Requested bus speed in Hz
+ * @param divider Receives the divider register value
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for an unsupported speed
+ */
+mcp2221_error_code_t mcp2221_internal_i2c_speed_divider(uint32_t i2c_speed_hz, uint8_t *divider);
+
+/**
+ * @internal
+ * @brief Returns the device's SRAM settings, from the shadow when possible.
+ *
+ * The shadow holds the last GET_SRAM_SETTINGS response and is kept current
+ * by mcp2221_send_cmd() for every SET_SRAM_SETTINGS command. A new
+ * GET_SRAM_SETTINGS command is only sent when the shadow is invalid or
+ * older than the configured maximum age.
+ *
+ * @param dev Device handle
+ * @param resp 64-byte buffer receiving the GET_SRAM_SETTINGS response
+ * @return MCP2221_ERR_OK on success, another mcp2221_error_code_t value otherwise
+ */
+mcp2221_error_code_t mcp2221_internal_sram_read(mcp2221_t *dev, uint8_t *resp);
+
+/**
+ * @internal
+ * @brief Forgets the SRAM shadow so that the next read asks the device.
+ */
+void mcp2221_internal_sram_invalidate(mcp2221_t *dev);
+
+/**
+ * @internal
+ * @brief Sets the SRAM shadow age limit; see mcp2221_sram_cache_set_max_age().
+ */
+void mcp2221_internal_sram_set_max_age(mcp2221_t *dev, uint32_t max_age_ms);
+
+/**
+ * @internal
+ * @brief Reads the complete READ_FLASH_DATA response for a flash section.
+ *
+ * Unlike mcp2221_flash_read(), the structure length at byte 2 is kept, which
+ * string sections need. The USB string sections and the factory serial are
+ * cached by mcp2221_send_cmd() from every READ_FLASH_DATA response and
+ * forgotten by every WRITE_FLASH_DATA command for the same section; with
+ * @p cached nonzero, a cached response is returned without a command. Other
+ * sections are always read from the device.
+ *
+ * @param dev Device handle
+ * @param section Flash section identifier
+ * @param cached Nonzero to accept a cached response
+ * @param resp 64-byte buffer receiving the response
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_FLASH_READ when the device
+ *         rejects the command, another mcp2221_error_code_t value otherwise
+ */
+mcp2221_error_code_t mcp2221_internal_flash_read_response(mcp2221_t *dev, uint8_t section, int cached, uint8_t *resp);
+
+/**
+ * @internal
+ * @brief Forgets every cached flash section.
+ */
+void mcp2221_internal_flash_cache_invalidate(mcp2221_t *dev);
+
+/**
+ * @internal
+ * @brief Builds the SRAM GP byte selected by a high-level pin function.
+ *
+ * Applies the same validation and encoding as mcp2221_pin_set_functions().
+ *
+ * @param pin GP pin
+ * @param function Pin function; MCP2221_PIN_FUNC_KEEP is rejected
+ * @param out_value Initial output value, 0 or 1; 1 only for GPIO outputs
+ * @param gp_byte Receives the GP byte (function, direction and output value)
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID otherwise
+ */
+mcp2221_error_code_t mcp2221_internal_pin_gp_byte(
+	mcp2221_gpio_pin_t pin, mcp2221_pin_function_t function, int out_value, uint8_t *gp_byte);
+
+/**
+ * @internal
+ * @brief Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+uint64_t mcp2221_internal_monotonic_ns(void);
+
+/**
+ * @internal
+ * @brief Sleeps until an absolute CLOCK_MONOTONIC time.
+ *
+ * Sleeping to an absolute deadline keeps wakeup latency from accumulating
+ * in periodic loops. Interrupted sleeps are resumed; a deadline in the past
+ * returns at once. Workers that must notice a stop request pass a deadline
+ * at most one sleep slice ahead.
+ *
+ * @param deadline_ns Wakeup time, see mcp2221_internal_monotonic_ns()
+ */
+void mcp2221_internal_sleep_until_ns(uint64_t deadline_ns);
+
 MCP2221_END_DECLS
 #endif // MCP2221_INTERNAL_H
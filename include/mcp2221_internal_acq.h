@@ -0,0 +1,95 @@
+#ifndef MCP2221_INTERNAL_ACQ_H
+#define MCP2221_INTERNAL_ACQ_H
+
+/**
+ * @file mcp2221_internal_acq.h
+ * @brief Internal planning helpers for the periodic acquisition scheduler.
+ *
+ * This header is private to the library and must not be installed or used by
+ * applications. It contains the pure parts of the scheduler: phase assignment
+ * to spread load over time and coalescing of due register reads into as few
+ * I2C transactions as possible.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_error_codes.h"
+
+MCP2221_BEGIN_DECLS
+
+/** Smallest planning tick in microseconds. */
+#define MCP2221_INTERNAL_ACQ_TICK_MIN_US 1000u
+
+/** Largest number of ticks considered when spreading phases. */
+#define MCP2221_INTERNAL_ACQ_HORIZON_MAX 4096u
+
+/**
+ * Largest register gap bridged when merging reads on one target. Reading a
+ * few unused bytes is cheaper than an extra write/read transaction pair.
+ */
+#define MCP2221_INTERNAL_ACQ_MERGE_GAP 4u
+
+/**
+ * Largest merged read. 60 bytes is one MCP2221 I2C data report, so a merged
+ * read never needs an additional GET_I2C_DATA round trip.
+ */
+#define MCP2221_INTERNAL_ACQ_MERGE_MAX 60u
+
+/** Fixed per-transaction cost used when balancing phases. */
+#define MCP2221_INTERNAL_ACQ_TXN_COST 16u
+
+typedef struct {
+	uint32_t target;   /* Address, register width, byte order and mux route. */
+	uint32_t reg;
+	uint16_t length;
+	uint16_t job;
+	uint8_t mergeable;
+} mcp2221_internal_acq_req_t;
+
+typedef struct {
+	size_t first;      /* Index of the first request in the sorted array. */
+	size_t count;      /* Number of requests served by this transaction. */
+	uint32_t reg;      /* First register read. */
+	uint16_t length;   /* Bytes read. */
+} mcp2221_internal_acq_group_t;
+
+/**
+ * Sort @p reqs by target and register, then coalesce them into transactions.
+ *
+ * Requests on the same target are merged when both allow it, the register
+ * gap does not exceed MCP2221_INTERNAL_ACQ_MERGE_GAP and the merged read does
+ * not exceed MCP2221_INTERNAL_ACQ_MERGE_MAX bytes. @p groups must hold @p n
+ * entries.
+ *
+ * @return Number of groups written.
+ */
+size_t mcp2221_internal_acq_plan_groups(
+	mcp2221_internal_acq_req_t *reqs,
+	size_t n,
+	mcp2221_internal_acq_group_t *groups);
+
+/**
+ * Choose a planning tick and the phases of jobs that request automatic
+ * placement.
+ *
+ * The tick is the greatest common divisor of all periods, but at least
+ * MCP2221_INTERNAL_ACQ_TICK_MIN_US. Entries of @p phase_us that are negative
+ * are replaced by the tick-aligned offset within the job's period that keeps
+ * the peak per-tick cost lowest; non-negative entries are kept and counted as
+ * existing load. Shorter periods are placed first.
+ *
+ * @return MCP2221_ERR_OK, MCP2221_ERR_INVALID for a zero period, or
+ *         MCP2221_ERR_NO_MEMORY.
+ */
+mcp2221_error_code_t mcp2221_internal_acq_assign_phases(
+	const uint32_t *period_us,
+	const uint32_t *cost,
+	int64_t *phase_us,
+	size_t n,
+	uint32_t *out_tick_us);
+
+MCP2221_END_DECLS
+
+#endif // MCP2221_INTERNAL_ACQ_H
@@ -10,10 +10,12 @@
  * accessors for analog state stored in the opaque MCP2221 device handle.
  */
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "mcp2221.h"
 #include "mcp2221_error_codes.h"
+#include "mcp2221_internal_constants.h"
 
 MCP2221_BEGIN_DECLS
 
@@ -32,9 +34,48 @@ typedef enum {
 	MCP2221_ANALOG_VOLTAGE_REF_4_096V
 } mcp2221_analog_voltage_reference_t;
 
+/**
+ * DAC code lookup table for one reference voltage.
+ *
+ * threshold[k] is the smallest voltage that
+ * mcp2221_internal_analog_dac_volts_to_raw() converts to code k or above. The
+ * thresholds are found by bisecting that conversion, so a lookup returns the
+ * same code for every input.
+ */
+typedef struct {
+	int valid;
+	double reference_voltage;
+	double max_volts;
+	double threshold[MCP2221_DAC_LEVEL_COUNT];
+} mcp2221_internal_analog_dac_table_t;
+
 typedef struct {
 	double vdd;
 	int vdd_valid;
+
+	/*
+	 * ADC reference decoded from the last GET_SRAM_SETTINGS response or
+	 * SET_SRAM_SETTINGS command, and its voltage. adc_ref_time is the
+	 * now_seconds() time of that command, checked against the SRAM cache
+	 * age limit. adc_ref_volts_valid is 0 for the OFF reference and for
+	 * VDD without a configured VDD.
+	 */
+	int adc_ref_valid;
+	mcp2221_analog_voltage_reference_t adc_ref;
+	double adc_ref_time;
+	int adc_ref_volts_valid;
+	double adc_ref_volts;
+
+	/* DAC reference, cached like the ADC reference. */
+	int dac_ref_valid;
+	mcp2221_analog_voltage_reference_t dac_ref;
+	double dac_ref_time;
+
+	/*
+	 * DAC lookup tables indexed by reference, built on first use. The VDD
+	 * table is dropped when VDD changes.
+	 */
+	mcp2221_internal_analog_dac_table_t dac_tables[MCP2221_ANALOG_VOLTAGE_REF_4_096V + 1];
 } mcp2221_internal_analog_state_t;
 
 /**
@@ -47,6 +88,28 @@ mcp2221_error_code_t mcp2221_internal_analog_parse_voltage_reference(
 	const char *ref_str,
 	mcp2221_analog_voltage_reference_t *reference);
 
+/**
+ * Parse clock-output settings into SET_SRAM_SETTINGS clock bits.
+ *
+ * Accepted duty cycles are 0, 25, 50 and 75 percent. Accepted frequencies
+ * are "375kHz", "750kHz", "1.5MHz", "3MHz", "6MHz", "12MHz" and "24MHz",
+ * matched case-insensitively.
+ */
+mcp2221_error_code_t mcp2221_internal_analog_parse_clock(
+	int duty_percent,
+	const char *freq_str,
+	int *bits);
+
+/**
+ * Parse an interrupt-on-change edge name into SET_SRAM_SETTINGS interrupt bits.
+ *
+ * Accepted names are "none", "rising", "falling" and "both", matched
+ * case-insensitively. The interrupt-flag clear bit is not set.
+ */
+mcp2221_error_code_t mcp2221_internal_analog_parse_ioc_edge(
+	const char *edge,
+	int *bits);
+
 /**
  * Convert a semantic voltage reference to ADC SRAM register bits.
  */
@@ -98,6 +161,47 @@ mcp2221_error_code_t mcp2221_internal_analog_adc_raw_to_volts(
 	double reference_voltage,
 	double *volts);
 
+/**
+ * Convert an array of raw ADC results to normalized values.
+ *
+ * Gives bit-identical results to mcp2221_internal_analog_adc_raw_to_normalized()
+ * for every element, using SSE2 or NEON where available. Nothing is written
+ * when an element is rejected.
+ *
+ * @param in Raw ADC results in the range 0..1023
+ * @param out Output array of @p n values
+ * @param n Number of elements; @p in and @p out may be NULL when 0
+ * @return MCP2221_ERR_OK on success or MCP2221_ERR_INVALID for invalid input
+ */
+mcp2221_error_code_t mcp2221_internal_analog_adc_raw_to_normalized_n(
+	const uint16_t *in,
+	double *out,
+	size_t n);
+
+/**
+ * Convert an array of raw ADC results to volts.
+ *
+ * Bit-identical to mcp2221_internal_analog_adc_raw_to_volts() per element;
+ * otherwise as mcp2221_internal_analog_adc_raw_to_normalized_n().
+ */
+mcp2221_error_code_t mcp2221_internal_analog_adc_raw_to_volts_n(
+	const uint16_t *in,
+	double *out,
+	size_t n,
+	double reference_voltage);
+
+/**
+ * Convert an array of DAC output voltages to raw codes.
+ *
+ * Bit-identical to mcp2221_internal_analog_dac_volts_to_raw() per element;
+ * otherwise as mcp2221_internal_analog_adc_raw_to_normalized_n().
+ */
+mcp2221_error_code_t mcp2221_internal_analog_dac_volts_to_raw_n(
+	const double *in,
+	uint8_t *out,
+	size_t n,
+	double reference_voltage);
+
 /**
  * Convert a semantic voltage reference to DAC SRAM register bits.
  */
@@ -155,6 +259,33 @@ mcp2221_error_code_t mcp2221_internal_analog_dac_volts_to_raw(
 	double reference_voltage,
 	uint8_t *raw);
 
+/**
+ * Build the DAC lookup table for a reference voltage.
+ *
+ * @param table Table to fill
+ * @param reference_voltage Selected DAC reference voltage
+ * @return MCP2221_ERR_OK on success or MCP2221_ERR_INVALID for invalid input
+ */
+mcp2221_error_code_t mcp2221_internal_analog_dac_table_build(
+	mcp2221_internal_analog_dac_table_t *table,
+	double reference_voltage);
+
+/**
+ * Convert a DAC output voltage to a raw code with a lookup table.
+ *
+ * Gives the same result as mcp2221_internal_analog_dac_volts_to_raw() with
+ * the table's reference voltage, including rejection of invalid values.
+ *
+ * @param table Table built with mcp2221_internal_analog_dac_table_build()
+ * @param volts Requested DAC output voltage
+ * @param raw Output pointer receiving the raw DAC code in the range 0..31
+ * @return MCP2221_ERR_OK on success or MCP2221_ERR_INVALID for invalid input
+ */
+mcp2221_error_code_t mcp2221_internal_analog_dac_table_lookup(
+	const mcp2221_internal_analog_dac_table_t *table,
+	double volts,
+	uint8_t *raw);
+
 /**
  * Store the externally supplied device supply voltage.
  *
@@ -186,10 +317,101 @@ mcp2221_error_code_t mcp2221_internal_analog_get_reference_voltage(
 	mcp2221_analog_voltage_reference_t reference,
 	double *volts);
 
+/**
+ * Return the current ADC reference selection.
+ *
+ * The selection is decoded from the SRAM cache, so it normally costs no
+ * command.
+ */
+mcp2221_error_code_t mcp2221_internal_analog_get_adc_reference(
+	mcp2221_t *dev,
+	mcp2221_analog_voltage_reference_t *reference);
+
+/**
+ * Return the voltage of the current ADC reference.
+ *
+ * The reference and its voltage are cached in the device handle, so this
+ * normally costs no command. Returns MCP2221_ERR_INVALID for the OFF
+ * reference and for VDD when no VDD value has been configured.
+ */
+mcp2221_error_code_t mcp2221_internal_analog_get_adc_reference_voltage(
+	mcp2221_t *dev,
+	double *volts);
+
+/**
+ * Convert a DAC output voltage to a raw code for the current DAC reference.
+ *
+ * The reference is cached in the device handle like the ADC reference, and
+ * the conversion uses the lookup table of that reference, so this normally
+ * costs no command. Returns MCP2221_ERR_INVALID for the OFF reference, for
+ * VDD when no VDD value has been configured, and for voltages that
+ * mcp2221_internal_analog_dac_volts_to_raw() rejects.
+ */
+mcp2221_error_code_t mcp2221_internal_analog_get_dac_code(
+	mcp2221_t *dev,
+	double volts,
+	uint8_t *raw);
+
+/**
+ * Decode the three raw ADC results of a POLL_STATUS response.
+ *
+ * @param rbuf 64-byte POLL_STATUS_SET_PARAMETERS response
+ * @param out Three-element array receiving the raw 10-bit results
+ */
+void mcp2221_internal_analog_adc_decode(
+	const uint8_t *rbuf,
+	uint16_t out[3]);
+
 mcp2221_error_code_t mcp2221_internal_analog_state_set_vdd(
 	mcp2221_internal_analog_state_t *state,
 	double volts);
 
+/**
+ * Reset analog state to its power-on values: no VDD, no cached references.
+ */
+void mcp2221_internal_analog_state_init(
+	mcp2221_internal_analog_state_t *state);
+
+/**
+ * Cache an ADC reference from ADC SRAM register bits.
+ *
+ * @param state Analog state to update
+ * @param bits ADC reference bits, already shifted down from the SRAM byte
+ * @param now now_seconds() time at which the bits were read or written
+ */
+void mcp2221_internal_analog_state_set_adc_reference(
+	mcp2221_internal_analog_state_t *state,
+	uint8_t bits,
+	double now);
+
+/**
+ * Cache a DAC reference from DAC SRAM register bits.
+ *
+ * @param state Analog state to update
+ * @param bits DAC reference bits, already shifted down from the SRAM byte
+ * @param now now_seconds() time at which the bits were read or written
+ */
+void mcp2221_internal_analog_state_set_dac_reference(
+	mcp2221_internal_analog_state_t *state,
+	uint8_t bits,
+	double now);
+
+/**
+ * Forget the cached ADC and DAC references.
+ */
+void mcp2221_internal_analog_state_invalidate_references(
+	mcp2221_internal_analog_state_t *state);
+
+/**
+ * Return the DAC lookup table of the cached DAC reference, building it if
+ * needed.
+ *
+ * Returns NULL when the reference is not cached, is OFF, or is VDD and no
+ * VDD value has been configured.
+ */
+const mcp2221_internal_analog_dac_table_t *mcp2221_internal_analog_state_dac_table(
+	mcp2221_internal_analog_state_t *state);
+
 mcp2221_error_code_t mcp2221_internal_analog_state_get_vdd(
 	const mcp2221_internal_analog_state_t *state,
 	double *volts);
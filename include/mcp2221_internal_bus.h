@@ -0,0 +1,100 @@
+#ifndef MCP2221_INTERNAL_BUS_H
+#define MCP2221_INTERNAL_BUS_H
+
+/**
+ * @file mcp2221_internal_bus.h
+ * @brief Internal transaction scheduler for the I2C bus manager.
+ *
+ * This header is private to the library and must not be installed or used by
+ * applications. It implements strict-priority classes with self-clocked
+ * weighted fair queueing (SCFQ) inside each class. The scheduler only orders
+ * caller-owned transaction nodes; it performs no I/O and no locking.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+
+MCP2221_BEGIN_DECLS
+
+/**
+ * Fixed cost charged to every transaction in addition to its payload bytes.
+ *
+ * It approximates the USB command/status round trips of a short transfer, so
+ * that many one-byte transactions are not treated as free.
+ */
+#define MCP2221_INTERNAL_BUS_TXN_OVERHEAD 16u
+
+/**
+ * Largest register transfer executed as one transaction. Longer register
+ * reads and writes are split into sub-transactions of this size, each queued
+ * separately so that other clients are served in between.
+ */
+#define MCP2221_INTERNAL_BUS_MAX_CHUNK 256u
+
+/** Fixed-point scale of virtual finish tags. */
+#define MCP2221_INTERNAL_BUS_TAG_SCALE 65536u
+
+typedef struct mcp2221_internal_bus_flow mcp2221_internal_bus_flow_t;
+
+typedef struct mcp2221_internal_bus_node {
+	struct mcp2221_internal_bus_node *next;
+	mcp2221_internal_bus_flow_t *flow;
+	uint64_t finish_tag;
+	size_t cost;
+} mcp2221_internal_bus_node_t;
+
+struct mcp2221_internal_bus_flow {
+	mcp2221_internal_bus_flow_t *next_flow;
+	mcp2221_internal_bus_node_t *head;
+	mcp2221_internal_bus_node_t *tail;
+	uint64_t last_finish;
+	size_t queued;
+	int priority;
+	unsigned weight;
+};
+
+typedef struct {
+	mcp2221_internal_bus_flow_t *flows;
+	uint64_t virtual_time;
+	size_t queued;
+} mcp2221_internal_bus_sched_t;
+
+void mcp2221_internal_bus_sched_init(mcp2221_internal_bus_sched_t *sched);
+
+/**
+ * Register a flow. A weight of 0 is treated as 1. Higher priorities are
+ * always served before lower ones.
+ */
+void mcp2221_internal_bus_flow_attach(
+	mcp2221_internal_bus_sched_t *sched,
+	mcp2221_internal_bus_flow_t *flow,
+	int priority,
+	unsigned weight);
+
+/**
+ * Unregister a flow. The flow must not have queued nodes.
+ */
+void mcp2221_internal_bus_flow_detach(
+	mcp2221_internal_bus_sched_t *sched,
+	mcp2221_internal_bus_flow_t *flow);
+
+/**
+ * Queue @p node on @p flow with the given cost in bytes. The node must stay
+ * valid until it is returned by mcp2221_internal_bus_sched_pop().
+ */
+void mcp2221_internal_bus_sched_push(
+	mcp2221_internal_bus_sched_t *sched,
+	mcp2221_internal_bus_flow_t *flow,
+	mcp2221_internal_bus_node_t *node,
+	size_t cost);
+
+/**
+ * Remove and return the next node to serve, or `NULL` if nothing is queued.
+ */
+mcp2221_internal_bus_node_t *mcp2221_internal_bus_sched_pop(mcp2221_internal_bus_sched_t *sched);
+
+MCP2221_END_DECLS
+
+#endif // MCP2221_INTERNAL_BUS_H
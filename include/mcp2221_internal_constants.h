@@ -39,6 +39,7 @@
 #define MCP2221_FLASH_GP_SETTINGS_GP1        (3 - 2)
 #define MCP2221_FLASH_GP_SETTINGS_GP2        (4 - 2)
 #define MCP2221_FLASH_GP_SETTINGS_GP3        (5 - 2)
+#define MCP2221_SRAM_OFFSET_CHIP_SETTINGS    4  // GET_SRAM_SETTINGS response offset of the chip settings
 #define MCP2221_SRAM_CHIP_SETTINGS_CDCSEC    (4 - 4)
 #define MCP2221_SRAM_CHIP_SETTINGS_CLOCK     (5 - 4)
 #define MCP2221_SRAM_CHIP_SETTINGS_DAC       (6 - 4)
@@ -61,12 +62,15 @@
 #define MCP2221_SRAM_GP_SETTINGS_GP1        (23 - 4)
 #define MCP2221_SRAM_GP_SETTINGS_GP2        (24 - 4)
 #define MCP2221_SRAM_GP_SETTINGS_GP3        (25 - 4)
+#define MCP2221_SRAM_RESPONSE_CLOCK         5
 #define MCP2221_SRAM_RESPONSE_DAC           6
 #define MCP2221_SRAM_RESPONSE_INT_ADC       7
 #define MCP2221_SRAM_RESPONSE_GP0          22
 #define MCP2221_SRAM_RESPONSE_GP1          23
 #define MCP2221_SRAM_RESPONSE_GP2          24
 #define MCP2221_SRAM_RESPONSE_GP3          25
+#define MCP2221_SRAM_RESPONSE_INT_POS_EDGE  (1 << 6)  // Interrupt on positive edge enabled (INT_ADC byte)
+#define MCP2221_SRAM_RESPONSE_INT_NEG_EDGE  (1 << 5)  // Interrupt on negative edge enabled (INT_ADC byte)
 #define MCP2221_CDCSEC_CDCSNEN              (1 << 7)  // USB CDC Serial Number Enable bit
 #define MCP2221_CDCSEC_LEDURXINST           (1 << 6)  // LED UART RX Inactive State bit
 #define MCP2221_CDCSEC_LEDUTXINST           (1 << 5)  // LED UART TX Inactive State bit
@@ -0,0 +1,121 @@
+#ifndef MCP2221_INTERNAL_GPIO_H
+#define MCP2221_INTERNAL_GPIO_H
+
+/**
+ * @file mcp2221_internal_gpio.h
+ * @brief Internal GPIO value snapshot shared by all GPIO readers of a device.
+ *
+ * This header is private to the library and must not be installed or used by
+ * applications. The snapshot holds the last GET_GPIO_VALUES response together
+ * with the time the command was issued. Readers that accept a given age are
+ * served from it, and readers arriving while a command is in flight wait for
+ * that command instead of issuing their own.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_error_codes.h"
+#include "mcp2221_gpio.h"
+
+MCP2221_BEGIN_DECLS
+
+/** Fetches the four raw GP value bytes of a GET_GPIO_VALUES response. */
+typedef mcp2221_error_code_t (*mcp2221_internal_gpio_fetch_fn)(void *ctx, uint8_t values[4]);
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t done;
+
+	int valid;
+	uint8_t values[4];		// raw value bytes; 0xEE marks a non-GPIO pin
+	uint64_t issued_us;		// CLOCK_MONOTONIC issue time of @ref values
+
+	int in_flight;
+	uint64_t pending_issued_us;	// issue time of the command in flight
+	uint64_t pending_epoch;		// epoch at which the command in flight was issued
+	uint64_t generation;		// completed commands
+	uint64_t epoch;			// bumped by invalidation
+
+	// Result of the last completed command, stored or not, for waiting readers.
+	mcp2221_error_code_t last_error;
+	uint8_t last_values[4];
+	uint64_t last_issued_us;
+
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t coalesced;
+} mcp2221_internal_gpio_snapshot_t;
+
+void mcp2221_internal_gpio_snapshot_init(mcp2221_internal_gpio_snapshot_t *snap);
+void mcp2221_internal_gpio_snapshot_destroy(mcp2221_internal_gpio_snapshot_t *snap);
+
+/**
+ * Return GPIO values no older than @p max_age_us.
+ *
+ * The age of a response is measured from the time its command was issued,
+ * so a response is never credited with being newer than it is. Issue times
+ * strictly increase per snapshot, so callers can tell a shared response
+ * they have already seen from a new one. A
+ * @p max_age_us of 0 always issues a new command, but still shares it with
+ * concurrent readers that accept an older snapshot.
+ *
+ * @param snap Snapshot state.
+ * @param max_age_us Largest acceptable age in microseconds.
+ * @param fetch Issues GET_GPIO_VALUES; called without the lock held.
+ * @param ctx Argument for @p fetch.
+ * @param out_values Receives the four raw value bytes.
+ * @param out_issued_us Receives the issue time of the returned values; may be NULL.
+ * @return MCP2221_ERR_OK, or the error of the command this call relied on.
+ */
+mcp2221_error_code_t mcp2221_internal_gpio_snapshot_acquire(mcp2221_internal_gpio_snapshot_t *snap, uint32_t max_age_us,
+							   mcp2221_internal_gpio_fetch_fn fetch, void *ctx, uint8_t out_values[4],
+							   uint64_t *out_issued_us);
+
+/**
+ * Discard the stored values after the device state changed. A command in
+ * flight still completes for its waiters but is not stored.
+ */
+void mcp2221_internal_gpio_snapshot_invalidate(mcp2221_internal_gpio_snapshot_t *snap);
+
+void mcp2221_internal_gpio_snapshot_get_stats(mcp2221_internal_gpio_snapshot_t *snap, mcp2221_gpio_snapshot_stats_t *stats);
+void mcp2221_internal_gpio_snapshot_reset_stats(mcp2221_internal_gpio_snapshot_t *snap);
+
+/**
+ * Per-device bookkeeping of mcp2221_gpio_write().
+ *
+ * known_mask marks pins whose output level was accepted by the device through
+ * this handle since the last pin configuration change or reset; only those
+ * pins can have their writes elided.
+ */
+typedef struct {
+	int elide;
+	uint8_t known_mask;
+	uint8_t known_values;
+	uint64_t commands;
+	uint64_t elided;
+} mcp2221_internal_gpio_write_state_t;
+
+/**
+ * Access the snapshot stored in the opaque device handle.
+ * This accessor is internal and does not transfer ownership.
+ */
+mcp2221_internal_gpio_snapshot_t *mcp2221_internal_gpio_get_snapshot(mcp2221_t *dev);
+
+/**
+ * Access the GPIO write bookkeeping stored in the opaque device handle.
+ * This accessor is internal and does not transfer ownership.
+ */
+mcp2221_internal_gpio_write_state_t *mcp2221_internal_gpio_get_write_state(mcp2221_t *dev);
+
+/**
+ * Read the raw GP value bytes through the device snapshot.
+ * Implemented in src/mcp2221_gpio.c.
+ */
+mcp2221_error_code_t mcp2221_internal_gpio_read_values(mcp2221_t *dev, uint32_t max_age_us, uint8_t out_values[4],
+						      uint64_t *out_issued_us);
+
+MCP2221_END_DECLS
+
+#endif // MCP2221_INTERNAL_GPIO_H
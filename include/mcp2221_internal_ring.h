@@ -0,0 +1,50 @@
+#ifndef MCP2221_INTERNAL_RING_H
+#define MCP2221_INTERNAL_RING_H
+
+/**
+ * @file mcp2221_internal_ring.h
+ * @brief Internal single-producer/single-consumer ring buffer.
+ *
+ * This header is private to the library and must not be installed or used by
+ * applications. The ring stores fixed-size elements and is lock-free for
+ * exactly one producer thread and one consumer thread. When the ring is full,
+ * pushes fail and the producer decides how to account for the dropped
+ * element.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_error_codes.h"
+
+MCP2221_BEGIN_DECLS
+
+typedef struct {
+	unsigned char *slots;
+	size_t elem_size;
+	size_t mask;
+	size_t head; /* Next slot to write; written by the producer only. */
+	size_t tail; /* Next slot to read; written by the consumer only. */
+} mcp2221_internal_ring_t;
+
+/**
+ * Allocate a ring for at least @p capacity elements of @p elem_size bytes.
+ * The capacity is rounded up to a power of two.
+ */
+mcp2221_error_code_t mcp2221_internal_ring_init(mcp2221_internal_ring_t *ring, size_t elem_size, size_t capacity);
+
+void mcp2221_internal_ring_free(mcp2221_internal_ring_t *ring);
+
+/** Usable capacity in elements. */
+size_t mcp2221_internal_ring_capacity(const mcp2221_internal_ring_t *ring);
+
+/** Producer side: copy one element in. Returns 0 if the ring is full. */
+int mcp2221_internal_ring_push(mcp2221_internal_ring_t *ring, const void *elem);
+
+/** Consumer side: copy one element out. Returns 0 if the ring is empty. */
+int mcp2221_internal_ring_pop(mcp2221_internal_ring_t *ring, void *elem);
+
+MCP2221_END_DECLS
+
+#endif // MCP2221_INTERNAL_RING_H
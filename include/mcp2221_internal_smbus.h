@@ -0,0 +1,76 @@
+#ifndef MCP2221_INTERNAL_SMBUS_H
+#define MCP2221_INTERNAL_SMBUS_H
+
+/**
+ * @file mcp2221_internal_smbus.h
+ * @brief Internal SMBus helpers for libeasymcp2221.
+ *
+ * This header is private to the library and must not be installed or used by
+ * applications. It contains the SMBus Packet Error Checking (PEC) CRC kernel
+ * used by the PEC-enabled helpers in mcp2221_smbus.h and the block-length
+ * hint state.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_smbus.h"
+
+MCP2221_BEGIN_DECLS
+
+/** Initial CRC value for an SMBus PEC calculation. */
+#define MCP2221_INTERNAL_SMBUS_PEC_INIT 0x00u
+
+/**
+ * Update an SMBus PEC value (CRC-8, polynomial x^8 + x^2 + x + 1) with
+ * @p len bytes from @p data.
+ *
+ * The data is consumed in place, so a PEC covering several non-contiguous
+ * message parts is computed by chaining calls with the previous result.
+ * @p data may be `NULL` when @p len is 0.
+ */
+uint8_t mcp2221_internal_smbus_crc8_update(uint8_t crc, const uint8_t *data, size_t len);
+
+/**
+ * Update an SMBus PEC value with a single byte.
+ */
+uint8_t mcp2221_internal_smbus_crc8_byte(uint8_t crc, uint8_t value);
+
+/**
+ * Number of (address, command) slots in the block-length hint table. The
+ * table is direct-mapped: two pairs that map to the same slot evict each
+ * other.
+ */
+#define MCP2221_INTERNAL_SMBUS_BLOCK_HINT_SLOTS 16
+
+/** One remembered SMBus block length. */
+typedef struct mcp2221_internal_smbus_block_hint {
+	uint8_t addr;   // 7-bit I2C target address
+	uint8_t cmd;    // SMBus command/register byte
+	uint8_t length; // last payload length reported by the target
+	uint8_t valid;  // nonzero if this entry holds a remembered length
+} mcp2221_internal_smbus_block_hint_t;
+
+/**
+ * Block-length hint state of one device.
+ *
+ * It lives in the opaque device handle rather than in the caller-allocated
+ * mcp2221_smbus_t, whose layout is part of the ABI. A zeroed state has
+ * hinting disabled.
+ */
+typedef struct mcp2221_internal_smbus_hint_state {
+	int enabled;
+	mcp2221_internal_smbus_block_hint_t slots[MCP2221_INTERNAL_SMBUS_BLOCK_HINT_SLOTS];
+	mcp2221_smbus_block_hint_stats_t stats;
+} mcp2221_internal_smbus_hint_state_t;
+
+/**
+ * Access the block-length hint state stored in the opaque device handle.
+ * This accessor is internal and does not transfer ownership.
+ */
+mcp2221_internal_smbus_hint_state_t *mcp2221_internal_smbus_get_hint_state(mcp2221_t *dev);
+
+MCP2221_END_DECLS
+
+#endif // MCP2221_INTERNAL_SMBUS_H
@@ -0,0 +1,215 @@
+/**
+ * @file mcp2221_profile.h
+ * @brief Declarative device profiles for repeatable bring-up.
+ */
+
+#ifndef MCP2221_PROFILE_H
+#define MCP2221_PROFILE_H
+
+#include <stdint.h>
+
+#include "mcp2221.h"
+#include "mcp2221_pin.h"
+
+MCP2221_BEGIN_DECLS
+
+/**
+ * @brief ADC or DAC voltage reference in a profile.
+ */
+typedef enum {
+	MCP2221_PROFILE_REF_KEEP = -1, /**< Leave the reference unchanged. */
+	MCP2221_PROFILE_REF_OFF = 0,   /**< Internal VRM selected but off. */
+	MCP2221_PROFILE_REF_VDD,       /**< VDD. */
+	MCP2221_PROFILE_REF_1_024V,    /**< Internal VRM at 1.024 V. */
+	MCP2221_PROFILE_REF_2_048V,    /**< Internal VRM at 2.048 V. */
+	MCP2221_PROFILE_REF_4_096V     /**< Internal VRM at 4.096 V. */
+} mcp2221_profile_ref_t;
+
+/**
+ * @brief Interrupt-on-change edge selection in a profile.
+ */
+typedef enum {
+	MCP2221_PROFILE_IOC_KEEP = -1, /**< Leave the edges unchanged. */
+	MCP2221_PROFILE_IOC_NONE = 0,  /**< No edge detection. */
+	MCP2221_PROFILE_IOC_RISING,    /**< Rising edges. */
+	MCP2221_PROFILE_IOC_FALLING,   /**< Falling edges. */
+	MCP2221_PROFILE_IOC_BOTH       /**< Both edges. */
+} mcp2221_profile_ioc_t;
+
+/**
+ * @brief Desired device configuration.
+ *
+ * Every field has a "keep" value that leaves the corresponding setting alone,
+ * so a profile may describe as much or as little of the device as needed.
+ * mcp2221_profile_init() sets every field to its keep value.
+ *
+ * The text form, read by mcp2221_profile_load() and written by
+ * mcp2221_profile_save(), is INI-style:
+ *
+ * @code
+ * # '#' and ';' start comments
+ * [pins]
+ * gp0 = gpio_out_high      ; keep, gpio_in, gpio_out, gpio_out_high,
+ * gp1 = alt0               ; dedicated, alt0, alt1, alt2
+ * [analog]
+ * adc_ref = 2.048V         ; keep, OFF, VDD, 1.024V, 2.048V, 4.096V
+ * dac_ref = VDD
+ * dac_value = 16
+ * [clock]
+ * duty = 50                ; 0, 25, 50, 75
+ * freq = 12MHz             ; as accepted by mcp2221_clock_config()
+ * [ioc]
+ * edge = rising            ; keep, none, rising, falling, both
+ * [i2c]
+ * speed_hz = 400000
+ * [usb]
+ * remote_wakeup = 0
+ * self_powered = 0
+ * requested_current_ma = 100
+ * @endcode
+ *
+ * Omitted keys keep the current setting.
+ */
+typedef struct {
+	/** Function of GP0 through GP3, or MCP2221_PIN_FUNC_KEEP. */
+	mcp2221_pin_function_t gp[4];
+	/** Initial output of GPIO outputs: 0 or 1; must be 0 for other functions. */
+	int gp_out[4];
+	/** ADC reference. */
+	mcp2221_profile_ref_t adc_ref;
+	/** DAC reference. */
+	mcp2221_profile_ref_t dac_ref;
+	/** DAC code 0 through 31, or -1 to keep. */
+	int dac_value;
+	/** Clock-output duty cycle in percent (0, 25, 50 or 75), or -1 to keep. Set together with @ref clock_hz. */
+	int clock_duty_percent;
+	/** Clock-output frequency in Hz (375 kHz through 24 MHz in powers of two), or 0 to keep. */
+	uint32_t clock_hz;
+	/** Interrupt-on-change edges. */
+	mcp2221_profile_ioc_t ioc_edge;
+	/** I2C bus speed in Hz, or 0 to keep. */
+	uint32_t i2c_speed_hz;
+	/** USB Remote Wake-up capability, 0 or 1, or -1 to keep. Stored in flash only. */
+	int usb_remote_wakeup;
+	/** USB self-powered attribute, 0 or 1, or -1 to keep. Stored in flash only. */
+	int usb_self_powered;
+	/** Requested USB current in mA (even, 0 through 500), or -1 to keep. Stored in flash only. */
+	int usb_requested_current_ma;
+} mcp2221_profile_t;
+
+/** @brief mcp2221_profile_apply() flag: also store the result in flash. */
+#define MCP2221_PROFILE_PERSIST 0x01u
+
+/**
+ * @brief What mcp2221_profile_apply() did.
+ */
+typedef struct {
+	int sram_commands;     /**< SET_SRAM_SETTINGS commands sent (0 through 2). */
+	int i2c_speed_changed; /**< Nonzero when the I2C speed was set. */
+	int usb_changed;       /**< Nonzero when USB attributes differed from flash and were staged. */
+	int persisted;         /**< Nonzero when the settings were written to flash. */
+	uint64_t duration_us;  /**< Wall time of the apply, from `CLOCK_MONOTONIC`. */
+} mcp2221_profile_result_t;
+
+/**
+ * @brief Set every field of a profile to its keep value.
+ *
+ * @param[out] profile Profile to initialize.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID if @p profile
+ *         is `NULL`.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_profile_init(mcp2221_profile_t *profile);
+
+/**
+ * @brief Parse a profile from text.
+ *
+ * @p profile is initialized first; keys present in @p text override the keep
+ * values. Section and key names and symbolic values are case-insensitive.
+ *
+ * @param[in] text Profile text in the format described at mcp2221_profile_t.
+ * @param[out] profile Receives the profile.
+ * @param[out] out_line Optional; receives the 1-based line of the first
+ *                      error, or 0 on success.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID for invalid
+ *         arguments or an unknown section, key or value.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_profile_parse(const char *text, mcp2221_profile_t *profile, int *out_line);
+
+/**
+ * @brief Load a profile from a file.
+ *
+ * @param[in] path File to read.
+ * @param[out] profile Receives the profile.
+ * @param[out] out_line Optional; receives the 1-based line of the first
+ *                      error, or 0.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_NOT_FOUND if the file
+ *         cannot be opened, MCP2221_ERR_NO_MEMORY if it cannot be buffered,
+ *         or MCP2221_ERR_INVALID as for mcp2221_profile_parse().
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_profile_load(const char *path, mcp2221_profile_t *profile, int *out_line);
+
+/**
+ * @brief Write a profile to a file.
+ *
+ * Only fields that are not keep values are written, so loading the file
+ * yields an equal profile.
+ *
+ * @param[in] path File to create or replace.
+ * @param[in] profile Profile to write.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or MCP2221_ERR_GENERIC if the file cannot be written.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_profile_save(const char *path, const mcp2221_profile_t *profile);
+
+/**
+ * @brief Read the current configuration of a device into a profile.
+ *
+ * Pins, references, the DAC code, the clock output and the interrupt edges
+ * come from the SRAM settings cache and the library's GPIO state. The I2C
+ * speed is derived from the divider reported by one POLL_STATUS command.
+ * The USB attributes are read from flash, so values staged with the
+ * mcp2221_usb_set_*() functions but not yet saved are not reported.
+ * Settings that cannot be represented, such as a disabled clock divider,
+ * are captured as keep values.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[out] profile Receives the profile.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_profile_capture(mcp2221_t *dev, mcp2221_profile_t *profile);
+
+/**
+ * @brief Bring a device to the state described by a profile.
+ *
+ * Runtime settings are committed through a configuration transaction (see
+ * mcp2221_config_txn_commit()), so only differing fields are sent, in at most
+ * two SET_SRAM_SETTINGS commands. The I2C speed is set only when the current
+ * divider differs. USB attributes are compared with flash and staged with the
+ * mcp2221_usb_set_*() functions only when they differ.
+ *
+ * With MCP2221_PROFILE_PERSIST, the result is saved with
+ * mcp2221_flash_save_config_ex(), which writes only the flash sections that
+ * differ. Without it, staged USB attributes remain staged until the next
+ * mcp2221_flash_save_config().
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] profile Profile to apply.
+ * @param[in] flags 0 or MCP2221_PROFILE_PERSIST.
+ * @param[out] result Optional; receives what was done and how long it took,
+ *                    also on failure.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments or profile fields, or another mcp2221_error_code_t value
+ *         on failure. Steps completed before a failure stay applied.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_profile_apply(mcp2221_t *dev, const mcp2221_profile_t *profile, unsigned flags,
+						       mcp2221_profile_result_t *result);
+
+MCP2221_END_DECLS
+#endif	// MCP2221_PROFILE_H
@@ -0,0 +1,61 @@
+/**
+ * @file mcp2221_sample.h
+ * @brief Combined sampling of GPIO levels, ADC channels and status flags.
+ */
+
+#ifndef MCP2221_SAMPLE_H
+#define MCP2221_SAMPLE_H
+
+#include <stdint.h>
+
+#include "mcp2221.h"
+
+MCP2221_BEGIN_DECLS
+
+/**
+ * @brief One combined sample of the MCP2221 inputs.
+ */
+typedef struct {
+	/** Time the first command of the sample was issued, from `CLOCK_MONOTONIC`, in microseconds. */
+	uint64_t timestamp_us;
+	/** GP0 through GP3: -1 when the pin is not configured as GPIO, otherwise 0 or 1. */
+	int gpio[4];
+	/** Bit mask of GP pins configured as GPIO; bit 0 through bit 3 correspond to GP0 through GP3. */
+	uint8_t gpio_valid_mask;
+	/** Raw 10-bit results of ADC channels 0 through 2 (GP1 through GP3). */
+	uint16_t adc_raw[3];
+	/** ADC results in volts; only meaningful when @ref adc_volts_valid is nonzero. */
+	double adc_volts[3];
+	/** Nonzero when the ADC reference resolves to a voltage; see mcp2221_adc_read_volts(). */
+	int adc_volts_valid;
+	/** Interrupt-on-change flag; nonzero when an edge was latched. */
+	uint8_t ioc_flag;
+	/** I2C engine status, as returned by mcp2221_i2c_status(). */
+	mcp2221_i2c_status_t i2c;
+} mcp2221_sample_t;
+
+/**
+ * @brief Sample GPIO levels, ADC channels, the IOC flag and I2C status at once.
+ *
+ * A sample costs one POLL_STATUS_SET_PARAMETERS command, which carries the
+ * ADC results, the interrupt flag and the I2C engine state, and one
+ * GET_GPIO_VALUES command through the shared GPIO snapshot. Calling
+ * mcp2221_gpio_read(), mcp2221_adc_read_volts() and mcp2221_ioc_read()
+ * separately costs four commands.
+ *
+ * Volts use the ADC reference from the SRAM settings cache; see
+ * mcp2221_sram_cache_set_max_age(). A reference that cannot be resolved,
+ * such as OFF or VDD without mcp2221_analog_set_vdd(), leaves
+ * @ref mcp2221_sample_t::adc_volts_valid at 0 instead of failing the sample.
+ * The IOC flag is reported but not cleared.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[out] out_sample Receives the sample.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID for invalid
+ *         arguments, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_sample_all(mcp2221_t *dev, mcp2221_sample_t *out_sample);
+
+MCP2221_END_DECLS
+#endif	// MCP2221_SAMPLE_H
@@ -22,6 +22,23 @@ MCP2221_BEGIN_DECLS
  */
 #define MCP2221_I2C_SMBUS_BLOCK_MAX 255
 
+/**
+ * @brief SMBus block-length hint statistics.
+ *
+ * Every block read performed while hinting is enabled is counted exactly once
+ * in one of the three counters.
+ *
+ * @see mcp2221_smbus_get_block_hint_stats()
+ */
+typedef struct mcp2221_smbus_block_hint_stats {
+	/** Hinted reads whose single transfer covered the whole block. */
+	uint32_t hits;
+	/** Hinted reads that had to be repeated because the block grew. */
+	uint32_t misses;
+	/** Reads without a remembered length, performed at full length. */
+	uint32_t cold;
+} mcp2221_smbus_block_hint_stats_t;
+
 /**
  * @brief Caller-owned SMBus helper context.
  *
@@ -203,12 +220,58 @@ MCP2221_API mcp2221_error_code_t mcp2221_smbus_write_word_data(mcp2221_smbus_t *
  */
 MCP2221_API mcp2221_error_code_t mcp2221_smbus_process_call(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, int16_t value, int16_t *response);
 
+/**
+ * @brief Enable or disable SMBus block-length hinting.
+ *
+ * By default, mcp2221_smbus_read_block_data(),
+ * mcp2221_smbus_read_block_data_pec() and mcp2221_smbus_block_process_call()
+ * read the maximum possible block from the target, because the payload
+ * length is only known once the length byte has been received. With hinting
+ * enabled, the helpers remember the last length reported for each (address,
+ * command) pair and read just that many bytes the next time, which saves bus
+ * time and, for longer blocks, additional USB round trips.
+ *
+ * If the length byte reports a longer block than hinted, the transaction is
+ * repeated with the exact length. A repeated block process call is sent to
+ * the target twice, so enable hinting only for targets whose block commands
+ * have no side effects.
+ *
+ * Enabling or disabling hinting clears the remembered lengths and the
+ * statistics. Both are kept in the device handle, so every SMBus context
+ * using the same MCP2221 shares them; the table is direct-mapped with 16
+ * slots, and two (address, command) pairs that map to the same slot evict
+ * each other.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] enable Nonzero to enable hinting, zero to disable it.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID if @p bus is
+ *         `NULL` or not initialized.
+ *
+ * @see mcp2221_smbus_get_block_hint_stats()
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_set_block_hint(mcp2221_smbus_t *bus, int enable);
+
+/**
+ * @brief Read the SMBus block-length hint statistics.
+ *
+ * The hit rate is `hits / (hits + misses + cold)`.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[out] stats Receives the current statistics.
+ *
+ * @return MCP2221_ERR_OK on success, or MCP2221_ERR_INVALID if an argument is
+ *         `NULL` or @p bus is not initialized.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_get_block_hint_stats(const mcp2221_smbus_t *bus, mcp2221_smbus_block_hint_stats_t *stats);
+
 /**
  * @brief Read an SMBus length-prefixed block.
  *
  * Reads one length byte followed by up to MCP2221_I2C_SMBUS_BLOCK_MAX payload
  * bytes. The caller-provided @p buffer must be large enough for the maximum
- * payload.
+ * payload. See mcp2221_smbus_set_block_hint() for reading only the expected
+ * length.
  *
  * @param[in] bus Initialized SMBus context.
  * @param[in] addr 7-bit I2C target address.
@@ -301,5 +364,141 @@ MCP2221_API mcp2221_error_code_t mcp2221_smbus_read_i2c_block_data(mcp2221_smbus
 MCP2221_API mcp2221_error_code_t mcp2221_smbus_write_i2c_block_data(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, const uint8_t *data,
 									   size_t length);
 
+/**
+ * @brief Read one byte directly from an SMBus target with PEC.
+ *
+ * Like mcp2221_smbus_read_byte(), but also receives the Packet Error Checking
+ * byte sent by the target and verifies it against the address and data bytes.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[out] value Receives the byte read from the target. It is left
+ *                   unchanged when the PEC does not match.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_PEC if the received PEC does
+ *         not match, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_read_byte_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t *value);
+
+/**
+ * @brief Write one byte directly to an SMBus target with PEC.
+ *
+ * Like mcp2221_smbus_write_byte(), but appends the Packet Error Checking byte.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[in] value Byte to write.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_write_byte_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t value);
+
+/**
+ * @brief Read one byte from an SMBus command/register with PEC.
+ *
+ * Like mcp2221_smbus_read_byte_data(), but also receives the Packet Error
+ * Checking byte and verifies it over both address bytes, the command byte and
+ * the data byte.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[in] reg SMBus command/register byte.
+ * @param[out] value Receives the byte read from the target. It is left
+ *                   unchanged when the PEC does not match.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_PEC if the received PEC does
+ *         not match, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_read_byte_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, uint8_t *value);
+
+/**
+ * @brief Write one byte to an SMBus command/register with PEC.
+ *
+ * Like mcp2221_smbus_write_byte_data(), but appends the Packet Error Checking
+ * byte.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[in] reg SMBus command/register byte.
+ * @param[in] value Byte to write.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_write_byte_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, uint8_t value);
+
+/**
+ * @brief Read a 16-bit word from an SMBus command/register with PEC.
+ *
+ * Like mcp2221_smbus_read_word_data(), but also receives and verifies the
+ * Packet Error Checking byte.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[in] reg SMBus command/register byte.
+ * @param[out] value Receives the decoded signed 16-bit value. It is left
+ *                   unchanged when the PEC does not match.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_PEC if the received PEC does
+ *         not match, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_read_word_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, int16_t *value);
+
+/**
+ * @brief Write a 16-bit word to an SMBus command/register with PEC.
+ *
+ * Like mcp2221_smbus_write_word_data(), but appends the Packet Error Checking
+ * byte.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[in] reg SMBus command/register byte.
+ * @param[in] value Signed 16-bit value to write.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_write_word_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, int16_t value);
+
+/**
+ * @brief Read an SMBus length-prefixed block with PEC.
+ *
+ * Like mcp2221_smbus_read_block_data(), but also receives the Packet Error
+ * Checking byte that follows the payload and verifies it over both address
+ * bytes, the command byte, the length byte and the payload.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[in] reg SMBus command/register byte.
+ * @param[out] buffer Buffer receiving the payload. Must hold at least
+ *                    MCP2221_I2C_SMBUS_BLOCK_MAX bytes.
+ * @param[out] length Receives the payload length reported by the target.
+ *
+ * @return MCP2221_ERR_OK on success, MCP2221_ERR_INVALID if the reported
+ *         length is invalid, MCP2221_ERR_PEC if the received PEC does not
+ *         match, or another mcp2221_error_code_t value on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_read_block_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, uint8_t *buffer, size_t *length);
+
+/**
+ * @brief Write an SMBus length-prefixed block with PEC.
+ *
+ * Like mcp2221_smbus_write_block_data(), but appends the Packet Error
+ * Checking byte after the payload.
+ *
+ * @param[in] bus Initialized SMBus context.
+ * @param[in] addr 7-bit I2C target address.
+ * @param[in] reg SMBus command/register byte.
+ * @param[in] data Payload bytes to write. Must not be `NULL`.
+ * @param[in] length Payload length. Must not exceed
+ *                   MCP2221_I2C_SMBUS_BLOCK_MAX.
+ *
+ * @return MCP2221_ERR_OK on success, or another mcp2221_error_code_t value
+ *         on failure.
+ */
+MCP2221_API mcp2221_error_code_t mcp2221_smbus_write_block_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, const uint8_t *data,
+									  size_t length);
+
 MCP2221_END_DECLS
 #endif // MCP2221_SMBUS_H
@@ -206,9 +206,9 @@ typedef struct {
 /**
  * @brief Apply a runtime SRAM configuration.
  *
- * The function validates all fields, reads the current device SRAM state, and
- * applies the requested changes while preserving fields set to
- * MCP2221_CONFIG_KEEP.
+ * The function validates all fields, reads the current device SRAM state
+ * (from the SRAM cache when possible), and applies the requested changes
+ * while preserving fields set to MCP2221_CONFIG_KEEP.
  *
  * GPIO configuration is merged with the library's cached GPIO state when
  * available so that output changes made through the GPIO API are preserved.
@@ -225,5 +225,36 @@ typedef struct {
  */
 MCP2221_API mcp2221_error_code_t mcp2221_sram_config(mcp2221_t *dev, const mcp2221_sram_config_t *cfg);
 
+/** @brief SRAM cache age limit that never expires; the default. */
+#define MCP2221_SRAM_CACHE_FOREVER UINT32_MAX
+
+/**
+ * @brief Set how long the SRAM cache may answer without asking the device.
+ *
+ * Every device handle keeps the last GET_SRAM_SETTINGS response and updates
+ * it from each SET_SRAM_SETTINGS command sent through the handle, including
+ * raw commands sent with mcp2221_send_cmd(). The ADC, DAC, SRAM and GPIO
+ * helpers read their current settings from this cache instead of sending
+ * GET_SRAM_SETTINGS. Commands whose effect is not mirrored exactly, such as
+ * interrupt-edge or GP designation changes, and chip resets discard the
+ * cache.
+ *
+ * Changes made by other processes are not seen. Use a finite age limit or
+ * mcp2221_sram_cache_invalidate() when that matters.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ * @param[in] max_age_ms Maximum cache age in milliseconds,
+ *                       MCP2221_SRAM_CACHE_FOREVER, or 0 to read the device
+ *                       every time.
+ */
+MCP2221_API void mcp2221_sram_cache_set_max_age(mcp2221_t *dev, uint32_t max_age_ms);
+
+/**
+ * @brief Discard the SRAM cache so that the next reader asks the device.
+ *
+ * @param[in] dev Open MCP2221 device handle.
+ */
+MCP2221_API void mcp2221_sram_cache_invalidate(mcp2221_t *dev);
+
 MCP2221_END_DECLS
 #endif	// MCP2221_SRAM_H
@@ -1,6 +1,8 @@
 #include "mcp2221.h"
 #include "mcp2221_internal.h"
 #include "mcp2221_internal_analog.h"
+#include "mcp2221_internal_gpio.h"
+#include "mcp2221_internal_smbus.h"
 #include "mcp2221_internal_usb.h"
 
 #include <libusb.h>
@@ -13,6 +15,7 @@
 #include "mcp2221_constants.h"
 #include "mcp2221_internal_constants.h"
 #include "mcp2221_i2c_slave.h"
+#include "mcp2221_sram.h"
 #include "mcp2221_flash.h"
 
 struct mcp2221_device {
@@ -38,12 +41,31 @@ struct mcp2221_device {
 	uint8_t gpio_status[4];
 	int gpio_status_valid;
 
+	// Last GET_GPIO_VALUES response, shared by all GPIO readers.
+	mcp2221_internal_gpio_snapshot_t gpio_snapshot;
+	// Output levels written through this handle; drives optional write elision.
+	mcp2221_internal_gpio_write_state_t gpio_write;
+
+	// Last GET_SRAM_SETTINGS response, kept current by the SET_SRAM_SETTINGS commands sent through this handle.
+	uint8_t sram_shadow[MCP2221_PACKET_SIZE];
+	int sram_shadow_valid;
+	double sram_shadow_time;
+	uint32_t sram_max_age_ms;
+
+	// READ_FLASH_DATA responses for the sections that only change through WRITE_FLASH_DATA:
+	// the USB strings and the factory serial.
+	uint8_t flash_cache[4][MCP2221_PACKET_SIZE];
+	uint8_t flash_cache_mask;
+
 	// Application-supplied supply voltage used when ADC or DAC reference is VDD.
 	mcp2221_internal_analog_state_t analog;
 
 	// Enumeration-time USB settings that cannot be changed through the normal
 	// SRAM configuration command. Persisted by mcp2221_flash_save_config().
 	mcp2221_internal_usb_state_t usb;
+
+	// Remembered SMBus block lengths, shared by all SMBus contexts on this handle.
+	mcp2221_internal_smbus_hint_state_t smbus_hints;
 };
 
 mcp2221_internal_usb_state_t *mcp2221_internal_usb_get_state(mcp2221_t *dev) {
@@ -54,6 +76,18 @@ const mcp2221_internal_usb_state_t *mcp2221_internal_usb_get_state_const(const m
 	return dev ? &dev->usb : NULL;
 }
 
+mcp2221_internal_gpio_snapshot_t *mcp2221_internal_gpio_get_snapshot(mcp2221_t *dev) {
+	return dev ? &dev->gpio_snapshot : NULL;
+}
+
+mcp2221_internal_gpio_write_state_t *mcp2221_internal_gpio_get_write_state(mcp2221_t *dev) {
+	return dev ? &dev->gpio_write : NULL;
+}
+
+mcp2221_internal_smbus_hint_state_t *mcp2221_internal_smbus_get_hint_state(mcp2221_t *dev) {
+	return dev ? &dev->smbus_hints : NULL;
+}
+
 // Match Python's round() behaviour for non-negative values: ties-to-even.
 // Python: round(x) rounds halves to the nearest even integer.
 static long round_ties_to_even_pos(double x) {
@@ -177,9 +211,8 @@ mcp2221_error_code_t mcp2221_internal_ensure_gpio_status(mcp2221_t *dev) {
 	if (dev->gpio_status_valid)
 		return MCP2221_ERR_OK;
 
-	uint8_t cmd = MCP2221_CMD_GET_SRAM_SETTINGS;
 	uint8_t resp[MCP2221_PACKET_SIZE];
-	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_safe(dev, &cmd, 1, resp);
+	mcp2221_error_code_t err = mcp2221_internal_sram_read(dev, resp);
 	if (err != MCP2221_ERR_OK)
 		return err;
 
@@ -190,6 +223,13 @@ mcp2221_error_code_t mcp2221_internal_ensure_gpio_status(mcp2221_t *dev) {
 	dev->gpio_status[3] = resp[25];
 	dev->gpio_status_valid = 1;
 
+	// GET_SRAM_SETTINGS does not reflect SET_GPIO_OUTPUT_VALUES; writes sent
+	// while the cache was not loaded are only known to the write bookkeeping.
+	for (int pin = 0; pin < 4; pin++) {
+		if (dev->gpio_write.known_mask & (1u << pin))
+			mcp2221_internal_gpio_status_update_out(dev, pin, (dev->gpio_write.known_values >> pin) & 1u);
+	}
+
 	return MCP2221_ERR_OK;
 }
 
@@ -207,6 +247,9 @@ void mcp2221_internal_gpio_status_set(mcp2221_t *dev, const uint8_t gp[4]) {
 		return;
 	memcpy(dev->gpio_status, gp, 4);
 	dev->gpio_status_valid = 1;
+	// Pin directions or functions may have changed; so may the pin values.
+	mcp2221_internal_gpio_snapshot_invalidate(&dev->gpio_snapshot);
+	dev->gpio_write.known_mask = 0;
 }
 
 void mcp2221_internal_gpio_status_update_out(mcp2221_t *dev, int pin, int out_value) {
@@ -220,6 +263,110 @@ void mcp2221_internal_gpio_status_update_out(mcp2221_t *dev, int pin, int out_va
 		dev->gpio_status[pin] &= (uint8_t)~MCP2221_GPIO_OUT_VAL_1;
 }
 
+// --- Internal SRAM shadow ---
+
+// Helper: whether SRAM state captured at time `stamp` is still within the age limit.
+static int sram_cache_fresh(const mcp2221_t *dev, double stamp) {
+	return dev->sram_max_age_ms > 0 &&
+	       (dev->sram_max_age_ms == MCP2221_SRAM_CACHE_FOREVER ||
+		now_seconds() - stamp < dev->sram_max_age_ms / 1000.0);
+}
+
+mcp2221_error_code_t mcp2221_internal_sram_read(mcp2221_t *dev, uint8_t *resp) {
+	if (!dev || !resp)
+		return MCP2221_ERR_INVALID;
+
+	if (dev->sram_shadow_valid && sram_cache_fresh(dev, dev->sram_shadow_time)) {
+		memcpy(resp, dev->sram_shadow, MCP2221_PACKET_SIZE);
+		return MCP2221_ERR_OK;
+	}
+
+	// mcp2221_send_cmd() stores the response in the shadow.
+	uint8_t cmd = MCP2221_CMD_GET_SRAM_SETTINGS;
+	return mcp2221_internal_send_cmd_retry_safe(dev, &cmd, 1, resp);
+}
+
+void mcp2221_internal_sram_invalidate(mcp2221_t *dev) {
+	if (!dev)
+		return;
+	dev->sram_shadow_valid = 0;
+	mcp2221_internal_analog_state_invalidate_references(&dev->analog);
+}
+
+void mcp2221_internal_sram_set_max_age(mcp2221_t *dev, uint32_t max_age_ms) {
+	if (dev)
+		dev->sram_max_age_ms = max_age_ms;
+}
+
+// --- Internal flash section cache ---
+
+// Helper: cache slot of a flash section, or -1 for sections that are not cached.
+static int flash_cache_slot(uint8_t section) {
+	if (section < MCP2221_FLASH_DATA_USB_MANUFACTURER || section > MCP2221_FLASH_DATA_CHIP_SERIALNUM)
+		return -1;
+	return section - MCP2221_FLASH_DATA_USB_MANUFACTURER;
+}
+
+mcp2221_error_code_t mcp2221_internal_flash_read_response(mcp2221_t *dev, uint8_t section, int cached, uint8_t *resp) {
+	if (!dev || !resp)
+		return MCP2221_ERR_INVALID;
+
+	int slot = flash_cache_slot(section);
+	if (cached && slot >= 0 && (dev->flash_cache_mask & (1u << slot))) {
+		memcpy(resp, dev->flash_cache[slot], MCP2221_PACKET_SIZE);
+		return MCP2221_ERR_OK;
+	}
+
+	// mcp2221_send_cmd() stores the response in the cache.
+	uint8_t buf[2] = {MCP2221_CMD_READ_FLASH_DATA, section};
+	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_safe(dev, buf, sizeof(buf), resp);
+	if (err == MCP2221_ERR_COMMAND_FAILED)
+		return MCP2221_ERR_FLASH_READ;
+	return err;
+}
+
+void mcp2221_internal_flash_cache_invalidate(mcp2221_t *dev) {
+	if (dev)
+		dev->flash_cache_mask = 0;
+}
+
+// Helper: apply the fields a SET_SRAM_SETTINGS command alters to the shadow.
+static void sram_shadow_apply_set(mcp2221_t *dev, const uint8_t *buf, size_t len) {
+	uint8_t cmd[12] = {0};
+	memcpy(cmd, buf, len < sizeof(cmd) ? len : sizeof(cmd));
+	uint8_t *s = dev->sram_shadow;
+
+	/*
+	 * The GET_SRAM_SETTINGS encoding of the interrupt edges is not mirrored,
+	 * and changing the GP designation may reset the VRM selections; forget
+	 * everything in both cases. Clearing the interrupt flag alone changes no
+	 * setting.
+	 */
+	if (cmd[7] & MCP2221_ALTER_GPIO_CONF) {
+		mcp2221_internal_analog_state_invalidate_references(&dev->analog);
+	} else {
+		if (cmd[3] & MCP2221_ALTER_DAC_REF)
+			mcp2221_internal_analog_state_set_dac_reference(&dev->analog, cmd[3] & 0x07, now_seconds());
+		if (cmd[5] & MCP2221_ALTER_ADC_REF)
+			mcp2221_internal_analog_state_set_adc_reference(&dev->analog, cmd[5] & 0x07, now_seconds());
+	}
+
+	if (((cmd[6] & MCP2221_ALTER_INT_CONF) && (cmd[6] & ~(MCP2221_ALTER_INT_CONF | MCP2221_INT_FLAG_CLEAR))) ||
+	    (cmd[7] & MCP2221_ALTER_GPIO_CONF)) {
+		dev->sram_shadow_valid = 0;
+		return;
+	}
+
+	if (cmd[2] & MCP2221_ALTER_CLK_OUTPUT)
+		s[MCP2221_SRAM_RESPONSE_CLOCK] = (uint8_t)((s[MCP2221_SRAM_RESPONSE_CLOCK] & 0x80) | (cmd[2] & 0x7F));
+	if (cmd[3] & MCP2221_ALTER_DAC_REF)
+		s[MCP2221_SRAM_RESPONSE_DAC] = (uint8_t)((s[MCP2221_SRAM_RESPONSE_DAC] & 0x1F) | ((cmd[3] & 0x07) << 5));
+	if (cmd[4] & MCP2221_ALTER_DAC_VALUE)
+		s[MCP2221_SRAM_RESPONSE_DAC] = (uint8_t)((s[MCP2221_SRAM_RESPONSE_DAC] & 0xE0) | (cmd[4] & 0x1F));
+	if (cmd[5] & MCP2221_ALTER_ADC_REF)
+		s[MCP2221_SRAM_RESPONSE_INT_ADC] = (uint8_t)((s[MCP2221_SRAM_RESPONSE_INT_ADC] & ~(0x07u << 2)) | ((cmd[5] & 0x07) << 2));
+}
+
 // --- Internal analog state helpers ---
 
 mcp2221_error_code_t mcp2221_internal_analog_set_vdd(
@@ -244,6 +391,93 @@ mcp2221_error_code_t mcp2221_internal_analog_get_vdd(
 		volts);
 }
 
+// Helper: cache the ADC and DAC references of a GET_SRAM_SETTINGS response.
+static void analog_references_update(mcp2221_t *dev, const uint8_t *resp, double now) {
+	// The ADC reference occupies bits 2..4 of the INT/ADC byte, the DAC reference bits 5..7 of the DAC byte.
+	mcp2221_internal_analog_state_set_adc_reference(
+		&dev->analog,
+		(uint8_t)((resp[MCP2221_SRAM_RESPONSE_INT_ADC] >> 2) & 0x07),
+		now);
+	mcp2221_internal_analog_state_set_dac_reference(
+		&dev->analog,
+		(uint8_t)((resp[MCP2221_SRAM_RESPONSE_DAC] >> 5) & 0x07),
+		now);
+}
+
+// Helper: make the cached references current, reading SRAM if `valid` and `stamp` say they are not.
+static mcp2221_error_code_t analog_references_refresh(mcp2221_t *dev, int valid, double stamp) {
+	if (valid && sram_cache_fresh(dev, stamp))
+		return MCP2221_ERR_OK;
+
+	uint8_t resp[MCP2221_PACKET_SIZE];
+	mcp2221_error_code_t err = mcp2221_internal_sram_read(dev, resp);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	analog_references_update(dev, resp, dev->sram_shadow_time);
+	return MCP2221_ERR_OK;
+}
+
+// Helper: make the cached ADC reference current.
+static mcp2221_error_code_t adc_reference_refresh(mcp2221_t *dev) {
+	mcp2221_error_code_t err =
+		analog_references_refresh(dev, dev->analog.adc_ref_valid, dev->analog.adc_ref_time);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	return dev->analog.adc_ref_valid ? MCP2221_ERR_OK : MCP2221_ERR_INVALID;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_get_adc_reference(
+	mcp2221_t *dev,
+	mcp2221_analog_voltage_reference_t *reference) {
+	if (!dev || !reference)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_error_code_t err = adc_reference_refresh(dev);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	*reference = dev->analog.adc_ref;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_get_adc_reference_voltage(
+	mcp2221_t *dev,
+	double *volts) {
+	if (!dev || !volts)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_error_code_t err = adc_reference_refresh(dev);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	if (!dev->analog.adc_ref_volts_valid)
+		return MCP2221_ERR_INVALID;
+
+	*volts = dev->analog.adc_ref_volts;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_get_dac_code(
+	mcp2221_t *dev,
+	double volts,
+	uint8_t *raw) {
+	if (!dev || !raw)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_error_code_t err =
+		analog_references_refresh(dev, dev->analog.dac_ref_valid, dev->analog.dac_ref_time);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	const mcp2221_internal_analog_dac_table_t *table = mcp2221_internal_analog_state_dac_table(&dev->analog);
+	if (!table)
+		return MCP2221_ERR_INVALID;
+
+	return mcp2221_internal_analog_dac_table_lookup(table, volts, raw);
+}
+
 static mcp2221_error_code_t map_libusb_discovery_error(int libusb_error, mcp2221_error_code_t fallback) {
 	switch (libusb_error) {
 		case LIBUSB_ERROR_NO_MEM:
@@ -382,8 +616,8 @@ static mcp2221_error_code_t open_by_vid_pid(uint16_t vid, uint16_t pid, int devn
 					tmp.usb_read_timeout_ms = 500;
 					tmp.cmd_retries = 0;
 
-					uint8_t raw[60];
-					if (mcp2221_flash_read(&tmp, MCP2221_FLASH_DATA_USB_SERIALNUM, raw) == MCP2221_ERR_OK) {
+					uint8_t raw[MCP2221_PACKET_SIZE];
+					if (mcp2221_internal_flash_read_response(&tmp, MCP2221_FLASH_DATA_USB_SERIALNUM, 0, raw) == MCP2221_ERR_OK) {
 						char parsed[128] = {0};
 						mcp2221_internal_parse_wchar_structure(raw, parsed, sizeof(parsed));
 						if (parsed[0] && strcmp(parsed, usbserial) == 0) {
@@ -493,10 +727,13 @@ static mcp2221_t *allocate_device_context(libusb_device_handle *handle, int ifac
 	dev->refcount = 1;
 	dev->kernel_driver_detached = kernel_driver_detached;
 	dev->gpio_status_valid = 0;
+	mcp2221_internal_gpio_snapshot_init(&dev->gpio_snapshot);
 
 	/* Analog state */
-	dev->analog.vdd = 0.0;
-	dev->analog.vdd_valid = 0;
+	mcp2221_internal_analog_state_init(&dev->analog);
+	dev->sram_shadow_valid = 0;
+	dev->sram_max_age_ms = MCP2221_SRAM_CACHE_FOREVER;
+	dev->flash_cache_mask = 0;
 
 	return dev;
 }
@@ -661,6 +898,7 @@ void mcp2221_close(mcp2221_t *dev) {
 		libusb_close(dev->handle);
 	}
 	catalog_remove(dev);
+	mcp2221_internal_gpio_snapshot_destroy(&dev->gpio_snapshot);
 	free(dev);
 	libusb_context_release();
 	mcp2221_global_state_unlock();
@@ -702,6 +940,50 @@ static mcp2221_error_code_t usb_read_report(mcp2221_t *dev, uint8_t *data) {
 	return MCP2221_ERR_OK;
 }
 
+// Helper: read and check the response to the command in buf; keeps GET_SRAM_SETTINGS responses in the shadow.
+static mcp2221_error_code_t read_response(mcp2221_t *dev, const uint8_t *buf, uint8_t *response) {
+	uint8_t in[MCP2221_PACKET_SIZE];
+	mcp2221_error_code_t err = usb_read_report(dev, in);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	if (dev->trace_packets) {
+		printf("RES:");
+		for (size_t i = 0; i < MCP2221_PACKET_SIZE; ++i)
+			printf(" %02X", in[i]);
+		printf("\n");
+	}
+
+	if (in[MCP2221_RESPONSE_ECHO_BYTE] != buf[0]) {
+		if (response)
+			memcpy(response, in, MCP2221_PACKET_SIZE);
+		return MCP2221_ERR_PROTOCOL;
+	}
+
+	if (response)
+		memcpy(response, in, MCP2221_PACKET_SIZE);
+
+	if (in[MCP2221_RESPONSE_STATUS_BYTE] != MCP2221_RESPONSE_RESULT_OK)
+		return MCP2221_ERR_COMMAND_FAILED;
+
+	if (buf[0] == MCP2221_CMD_GET_SRAM_SETTINGS) {
+		memcpy(dev->sram_shadow, in, MCP2221_PACKET_SIZE);
+		dev->sram_shadow_valid = 1;
+		dev->sram_shadow_time = now_seconds();
+		analog_references_update(dev, in, dev->sram_shadow_time);
+	}
+
+	if (buf[0] == MCP2221_CMD_READ_FLASH_DATA) {
+		int slot = flash_cache_slot(buf[1]);
+		if (slot >= 0) {
+			memcpy(dev->flash_cache[slot], in, MCP2221_PACKET_SIZE);
+			dev->flash_cache_mask |= (uint8_t)(1u << slot);
+		}
+	}
+
+	return MCP2221_ERR_OK;
+}
+
 // send_cmd: Port of Device.send_cmd()
 
 mcp2221_error_code_t mcp2221_send_cmd(mcp2221_t *dev, const uint8_t *buf, size_t len, uint8_t *response) {
@@ -719,39 +1001,36 @@ mcp2221_error_code_t mcp2221_send_cmd(mcp2221_t *dev, const uint8_t *buf, size_t
 		printf("\n");
 	}
 
+	// Forget a section before writing it; a failed write may still have changed it.
+	if (out[0] == MCP2221_CMD_WRITE_FLASH_DATA) {
+		int slot = flash_cache_slot(out[1]);
+		if (slot >= 0)
+			dev->flash_cache_mask &= (uint8_t)~(1u << slot);
+	}
+
 	mcp2221_error_code_t err = usb_write_report(dev, out, MCP2221_PACKET_SIZE);
-	if (err != MCP2221_ERR_OK)
+	if (err != MCP2221_ERR_OK) {
+		if (buf[0] == MCP2221_CMD_SET_SRAM_SETTINGS)
+			mcp2221_internal_sram_invalidate(dev);
 		return err;
+	}
 
 	// Reset
-	if (buf[0] == MCP2221_CMD_RESET_CHIP)
+	if (buf[0] == MCP2221_CMD_RESET_CHIP) {
+		mcp2221_internal_gpio_snapshot_invalidate(&dev->gpio_snapshot);
+		dev->gpio_write.known_mask = 0;
+		mcp2221_internal_sram_invalidate(dev);
 		return MCP2221_ERR_OK;
-
-	uint8_t in[MCP2221_PACKET_SIZE];
-	err = usb_read_report(dev, in);
-	if (err != MCP2221_ERR_OK)
-		return err;
-
-	if (dev->trace_packets) {
-		printf("RES:");
-		for (size_t i = 0; i < MCP2221_PACKET_SIZE; ++i)
-			printf(" %02X", in[i]);
-		printf("\n");
 	}
 
-	if (in[MCP2221_RESPONSE_ECHO_BYTE] != buf[0]) {
-		if (response)
-			memcpy(response, in, MCP2221_PACKET_SIZE);
-		return MCP2221_ERR_PROTOCOL;
+	err = read_response(dev, out, response);
+	if (buf[0] == MCP2221_CMD_SET_SRAM_SETTINGS) {
+		if (err == MCP2221_ERR_OK)
+			sram_shadow_apply_set(dev, buf, len);
+		else
+			mcp2221_internal_sram_invalidate(dev);
 	}
-
-	if (response)
-		memcpy(response, in, MCP2221_PACKET_SIZE);
-
-	if (in[MCP2221_RESPONSE_STATUS_BYTE] != MCP2221_RESPONSE_RESULT_OK)
-		return MCP2221_ERR_COMMAND_FAILED;
-
-	return MCP2221_ERR_OK;
+	return err;
 }
 
 /*
@@ -833,6 +1112,11 @@ mcp2221_error_code_t mcp2221_i2c_status(mcp2221_t *dev, mcp2221_i2c_status_t *st
 	if (err != MCP2221_ERR_OK)
 		return err;
 
+	mcp2221_internal_i2c_status_decode(rbuf, st);
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_internal_i2c_status_decode(const uint8_t *rbuf, mcp2221_i2c_status_t *st) {
 	memset(st, 0, sizeof(*st));
 
 	st->rlen = (rbuf[MCP2221_I2C_POLL_RESP_REQ_LEN_H] << 8) + rbuf[MCP2221_I2C_POLL_RESP_REQ_LEN_L];
@@ -850,8 +1134,6 @@ mcp2221_error_code_t mcp2221_i2c_status(mcp2221_t *dev, mcp2221_i2c_status_t *st
 	st->confused =
 		(rbuf[MCP2221_I2C_POLL_RESP_UNDOCUMENTED_18] == MCP2221_I2C_CONFUSED_MARKER && rbuf[MCP2221_I2C_POLL_RESP_STATUS] != MCP2221_I2C_ST_WRITEDATA_END_NOSTOP);
 	st->initialized = (rbuf[MCP2221_I2C_POLL_RESP_UNDOCUMENTED_21] != 0);
-
-	return MCP2221_ERR_OK;
 }
 
 // _i2c_release
@@ -916,19 +1198,32 @@ mcp2221_error_code_t mcp2221_i2c_release(mcp2221_t *dev) {
 
 // I2C_speed
 
-mcp2221_error_code_t mcp2221_i2c_set_speed(mcp2221_t *dev, uint32_t i2c_speed_hz) {
-	if (!dev)
+mcp2221_error_code_t mcp2221_internal_i2c_speed_divider(uint32_t i2c_speed_hz, uint8_t *divider) {
+	if (!divider)
 		return MCP2221_ERR_INVALID;
 
 	// bus_speed = round(12_000_000 / speed) - 2
 	if (i2c_speed_hz == 0 || i2c_speed_hz > MCP2221_I2C_SPEED_MAX_HZ)
 		return MCP2221_ERR_INVALID;
 	long rounded = round_ties_to_even_pos(MCP2221_I2C_BASE_CLOCK_HZ / (double)i2c_speed_hz);
-	int bus_speed = (int)(rounded - MCP2221_I2C_CLOCK_DIVIDER_OFFSET);
+	long bus_speed = rounded - MCP2221_I2C_CLOCK_DIVIDER_OFFSET;
 
 	if (bus_speed < 0 || bus_speed > MCP2221_I2C_CLOCK_DIVIDER_MAX)
 		return MCP2221_ERR_INVALID;
 
+	*divider = (uint8_t)bus_speed;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_set_speed(mcp2221_t *dev, uint32_t i2c_speed_hz) {
+	if (!dev)
+		return MCP2221_ERR_INVALID;
+
+	uint8_t bus_speed;
+	mcp2221_error_code_t err = mcp2221_internal_i2c_speed_divider(i2c_speed_hz, &bus_speed);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
 	uint8_t buf[5] = {0};
 	uint8_t rbuf[MCP2221_PACKET_SIZE];
 
@@ -936,9 +1231,9 @@ mcp2221_error_code_t mcp2221_i2c_set_speed(mcp2221_t *dev, uint32_t i2c_speed_hz
 	buf[1] = 0;
 	buf[2] = 0;
 	buf[3] = MCP2221_I2C_CMD_SET_BUS_SPEED;
-	buf[4] = (uint8_t)bus_speed;
+	buf[4] = bus_speed;
 
-	mcp2221_error_code_t err = mcp2221_send_cmd(dev, buf, 5, rbuf);
+	err = mcp2221_send_cmd(dev, buf, 5, rbuf);
 	if (err != MCP2221_ERR_OK) {
 		dev->i2c_dirty = 1;
 		return err;
@@ -0,0 +1,355 @@
+#include "mcp2221_acq.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_acq.h"
+#include "mcp2221_internal_ring.h"
+
+/* Longest single sleep, so that mcp2221_acq_stop() is noticed promptly. */
+#define ACQ_SLEEP_SLICE_NS 10000000ull
+
+typedef struct {
+	mcp2221_i2c_muxed_slave_t target;	// mux is NULL for directly attached targets
+	uint32_t reg;
+	uint16_t length;
+	uint32_t period_us;
+	int32_t requested_phase_us;
+	unsigned flags;
+	uint64_t next_release_ns;
+	mcp2221_acq_job_stats_t stats;
+} acq_job_t;
+
+struct mcp2221_acq {
+	mcp2221_t *dev;
+	acq_job_t *jobs;
+	size_t job_count;
+	mcp2221_internal_ring_t ring;
+	mcp2221_acq_stats_t stats;
+	uint64_t start_ns;
+	uint64_t stop_ns;
+	pthread_mutex_t stats_lock;
+	pthread_t worker;
+	int running;
+	int stop;
+
+	// Per-batch scratch space, sized for job_count.
+	mcp2221_internal_acq_req_t *reqs;
+	mcp2221_internal_acq_group_t *groups;
+	uint64_t *release_ns;
+};
+
+/*
+ * Multiplexer route in the high bits: identical sensors on different channels
+ * stay apart, and sorting by key visits each channel once per batch.
+ */
+static uint32_t target_key(const mcp2221_i2c_muxed_slave_t *target) {
+	const mcp2221_i2c_slave_t *slave = &target->slave;
+	uint32_t key = (uint32_t)slave->addr | ((uint32_t)slave->reg_bytes << 8) | ((uint32_t)slave->reg_byteorder << 12);
+
+	if (target->mux)
+		key |= ((uint32_t)target->mux->addr << 16) | ((uint32_t)(target->channel + 1) << 24);
+	return key;
+}
+
+static void run_batch(mcp2221_acq_t *acq, size_t due) {
+	size_t group_count = mcp2221_internal_acq_plan_groups(acq->reqs, due, acq->groups);
+
+	for (size_t g = 0; g < group_count; g++) {
+		const mcp2221_internal_acq_group_t *group = &acq->groups[g];
+		acq_job_t *lead = &acq->jobs[acq->reqs[group->first].job];
+		uint8_t buffer[MCP2221_INTERNAL_ACQ_MERGE_MAX > MCP2221_ACQ_SAMPLE_MAX ? MCP2221_INTERNAL_ACQ_MERGE_MAX
+										       : MCP2221_ACQ_SAMPLE_MAX];
+
+		mcp2221_error_code_t err;
+		if (lead->target.mux)
+			err = mcp2221_i2c_muxed_slave_read_register(&lead->target, group->reg, buffer, group->length, 0,
+								    MCP2221_I2C_BYTE_ORDER_DEFAULT);
+		else
+			err = mcp2221_i2c_slave_read_register(&lead->target.slave, group->reg, buffer, group->length, 0,
+							      MCP2221_I2C_BYTE_ORDER_DEFAULT);
+		uint64_t done_ns = mcp2221_internal_monotonic_ns();
+
+		pthread_mutex_lock(&acq->stats_lock);
+		acq->stats.transactions++;
+
+		for (size_t k = group->first; k < group->first + group->count; k++) {
+			const mcp2221_internal_acq_req_t *req = &acq->reqs[k];
+			acq_job_t *job = &acq->jobs[req->job];
+			mcp2221_acq_sample_t sample;
+
+			sample.job = req->job;
+			sample.status = err;
+			sample.release_ns = acq->release_ns[req->job];
+			sample.timestamp_ns = done_ns;
+			sample.length = err == MCP2221_ERR_OK ? req->length : 0;
+			if (sample.length)
+				memcpy(sample.data, &buffer[req->reg - group->reg], sample.length);
+
+			if (!mcp2221_internal_ring_push(&acq->ring, &sample))
+				acq->stats.ring_overruns++;
+
+			uint64_t latency_us = (done_ns - sample.release_ns) / 1000u;
+			job->stats.releases++;
+			if (err == MCP2221_ERR_OK)
+				job->stats.samples++;
+			else
+				job->stats.errors++;
+			if (latency_us > job->stats.max_latency_us)
+				job->stats.max_latency_us = latency_us;
+			if (latency_us > job->period_us)
+				job->stats.missed_deadlines++;
+		}
+		pthread_mutex_unlock(&acq->stats_lock);
+	}
+
+	pthread_mutex_lock(&acq->stats_lock);
+	acq->stats.batches++;
+	pthread_mutex_unlock(&acq->stats_lock);
+}
+
+static void *acq_worker(void *arg) {
+	mcp2221_acq_t *acq = arg;
+
+	while (!__atomic_load_n(&acq->stop, __ATOMIC_ACQUIRE)) {
+		uint64_t now = mcp2221_internal_monotonic_ns();
+		uint64_t next = UINT64_MAX;
+		size_t due = 0;
+
+		for (size_t i = 0; i < acq->job_count; i++) {
+			acq_job_t *job = &acq->jobs[i];
+			uint64_t period_ns = (uint64_t)job->period_us * 1000u;
+
+			if (job->next_release_ns > now) {
+				if (job->next_release_ns < next)
+					next = job->next_release_ns;
+				continue;
+			}
+
+			// Releases more than a period in the past are skipped, not
+			// executed back to back.
+			uint64_t behind = (now - job->next_release_ns) / period_ns;
+			if (behind) {
+				pthread_mutex_lock(&acq->stats_lock);
+				job->stats.releases += behind;
+				job->stats.missed_deadlines += behind;
+				pthread_mutex_unlock(&acq->stats_lock);
+				job->next_release_ns += behind * period_ns;
+			}
+
+			acq->release_ns[i] = job->next_release_ns;
+			job->next_release_ns += period_ns;
+
+			mcp2221_internal_acq_req_t *req = &acq->reqs[due++];
+			req->target = target_key(&job->target);
+			req->reg = job->reg;
+			req->length = job->length;
+			req->job = (uint16_t)i;
+			req->mergeable = (job->flags & MCP2221_ACQ_JOB_MERGE) != 0;
+		}
+
+		if (due)
+			run_batch(acq, due);
+		else
+			mcp2221_internal_sleep_until_ns(next - now > ACQ_SLEEP_SLICE_NS ? now + ACQ_SLEEP_SLICE_NS : next);
+	}
+
+	return NULL;
+}
+
+mcp2221_error_code_t mcp2221_acq_create(mcp2221_t *dev, size_t ring_capacity, mcp2221_acq_t **out_acq) {
+	if (!out_acq)
+		return MCP2221_ERR_INVALID;
+
+	*out_acq = NULL;
+
+	if (!dev || ring_capacity == 0)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_acq_t *acq = calloc(1, sizeof(*acq));
+	if (!acq)
+		return MCP2221_ERR_NO_MEMORY;
+
+	mcp2221_error_code_t err = mcp2221_internal_ring_init(&acq->ring, sizeof(mcp2221_acq_sample_t), ring_capacity);
+	if (err != MCP2221_ERR_OK) {
+		free(acq);
+		return err;
+	}
+
+	if (pthread_mutex_init(&acq->stats_lock, NULL) != 0) {
+		mcp2221_internal_ring_free(&acq->ring);
+		free(acq);
+		return MCP2221_ERR_GENERIC;
+	}
+
+	acq->dev = dev;
+	*out_acq = acq;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_acq_destroy(mcp2221_acq_t *acq) {
+	if (!acq)
+		return;
+
+	mcp2221_acq_stop(acq);
+	pthread_mutex_destroy(&acq->stats_lock);
+	mcp2221_internal_ring_free(&acq->ring);
+	free(acq->release_ns);
+	free(acq->groups);
+	free(acq->reqs);
+	free(acq->jobs);
+	free(acq);
+}
+
+mcp2221_error_code_t mcp2221_acq_add_job(mcp2221_acq_t *acq, const mcp2221_acq_job_t *job, int *out_job) {
+	if (!acq || !job)
+		return MCP2221_ERR_INVALID;
+
+	const mcp2221_i2c_slave_t *slave = job->muxed ? &job->muxed->slave : job->slave;
+	if (!slave || slave->mcp != acq->dev || (job->muxed && !job->muxed->mux) || job->length == 0 ||
+	    job->length > MCP2221_ACQ_SAMPLE_MAX || job->period_us == 0 ||
+	    (job->phase_us < 0 && job->phase_us != MCP2221_ACQ_PHASE_AUTO))
+		return MCP2221_ERR_INVALID;
+	if (acq->running)
+		return MCP2221_ERR_BUSY;
+	if (acq->job_count >= UINT16_MAX)
+		return MCP2221_ERR_NO_MEMORY;
+
+	size_t n = acq->job_count + 1;
+	acq_job_t *jobs = realloc(acq->jobs, n * sizeof(*jobs));
+	if (!jobs)
+		return MCP2221_ERR_NO_MEMORY;
+	acq->jobs = jobs;
+
+	acq_job_t *entry = &acq->jobs[acq->job_count];
+	memset(entry, 0, sizeof(*entry));
+	if (job->muxed)
+		entry->target = *job->muxed;
+	else
+		entry->target.slave = *job->slave;
+	entry->reg = job->reg;
+	entry->length = (uint16_t)job->length;
+	entry->period_us = job->period_us;
+	entry->requested_phase_us = job->phase_us;
+	entry->flags = job->flags;
+
+	if (out_job)
+		*out_job = (int)acq->job_count;
+	acq->job_count = n;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_acq_start(mcp2221_acq_t *acq) {
+	if (!acq || acq->job_count == 0)
+		return MCP2221_ERR_INVALID;
+	if (acq->running)
+		return MCP2221_ERR_BUSY;
+
+	size_t n = acq->job_count;
+	uint32_t *periods = malloc(n * sizeof(*periods));
+	uint32_t *costs = malloc(n * sizeof(*costs));
+	int64_t *phases = malloc(n * sizeof(*phases));
+	mcp2221_internal_acq_req_t *reqs = realloc(acq->reqs, n * sizeof(*reqs));
+	if (reqs)
+		acq->reqs = reqs;
+	mcp2221_internal_acq_group_t *groups = realloc(acq->groups, n * sizeof(*groups));
+	if (groups)
+		acq->groups = groups;
+	uint64_t *release_ns = realloc(acq->release_ns, n * sizeof(*release_ns));
+	if (release_ns)
+		acq->release_ns = release_ns;
+
+	mcp2221_error_code_t err = MCP2221_ERR_NO_MEMORY;
+	if (periods && costs && phases && reqs && groups && release_ns) {
+		for (size_t i = 0; i < n; i++) {
+			periods[i] = acq->jobs[i].period_us;
+			costs[i] = acq->jobs[i].length;
+			phases[i] = acq->jobs[i].requested_phase_us;
+		}
+		err = mcp2221_internal_acq_assign_phases(periods, costs, phases, n, &acq->stats.tick_us);
+	}
+
+	if (err == MCP2221_ERR_OK) {
+		uint32_t tick_us = acq->stats.tick_us;
+		memset(&acq->stats, 0, sizeof(acq->stats));
+		acq->stats.tick_us = tick_us;
+
+		/*
+		 * The ring belongs to the consumer side, which may be draining
+		 * right now, so samples from a previous run are not cleared here
+		 * but skipped by mcp2221_acq_drain(). Every release of this run
+		 * is at or after start_ns.
+		 */
+		uint64_t start_ns = mcp2221_internal_monotonic_ns();
+		__atomic_store_n(&acq->start_ns, start_ns, __ATOMIC_RELEASE);
+		acq->stop_ns = 0;
+		for (size_t i = 0; i < n; i++) {
+			acq_job_t *job = &acq->jobs[i];
+			memset(&job->stats, 0, sizeof(job->stats));
+			job->stats.phase_us = (uint32_t)phases[i];
+			job->next_release_ns = start_ns + (uint64_t)phases[i] * 1000u;
+		}
+
+		__atomic_store_n(&acq->stop, 0, __ATOMIC_RELEASE);
+		if (pthread_create(&acq->worker, NULL, acq_worker, acq) != 0)
+			err = MCP2221_ERR_GENERIC;
+		else
+			acq->running = 1;
+	}
+
+	free(phases);
+	free(costs);
+	free(periods);
+	return err;
+}
+
+void mcp2221_acq_stop(mcp2221_acq_t *acq) {
+	if (!acq || !acq->running)
+		return;
+
+	__atomic_store_n(&acq->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(acq->worker, NULL);
+	acq->stop_ns = mcp2221_internal_monotonic_ns();
+	acq->running = 0;
+}
+
+int mcp2221_acq_drain(mcp2221_acq_t *acq, mcp2221_acq_sample_t *out, size_t max) {
+	if (!acq || (!out && max > 0))
+		return MCP2221_ERR_INVALID;
+
+	uint64_t start_ns = __atomic_load_n(&acq->start_ns, __ATOMIC_ACQUIRE);
+	int count = 0;
+	while ((size_t)count < max && count < INT_MAX && mcp2221_internal_ring_pop(&acq->ring, &out[count])) {
+		if (out[count].release_ns >= start_ns)
+			count++;
+	}
+
+	return count;
+}
+
+mcp2221_error_code_t mcp2221_acq_get_job_stats(mcp2221_acq_t *acq, int job, mcp2221_acq_job_stats_t *stats) {
+	if (!acq || !stats || job < 0 || (size_t)job >= acq->job_count)
+		return MCP2221_ERR_INVALID;
+
+	pthread_mutex_lock(&acq->stats_lock);
+	*stats = acq->jobs[job].stats;
+	pthread_mutex_unlock(&acq->stats_lock);
+
+	uint64_t end_ns = acq->running ? mcp2221_internal_monotonic_ns() : acq->stop_ns;
+	uint64_t elapsed_ns = end_ns > acq->start_ns ? end_ns - acq->start_ns : 0;
+	stats->achieved_rate_hz = elapsed_ns ? (double)stats->samples * 1e9 / (double)elapsed_ns : 0.0;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_acq_get_stats(mcp2221_acq_t *acq, mcp2221_acq_stats_t *stats) {
+	if (!acq || !stats)
+		return MCP2221_ERR_INVALID;
+
+	pthread_mutex_lock(&acq->stats_lock);
+	*stats = acq->stats;
+	pthread_mutex_unlock(&acq->stats_lock);
+	return MCP2221_ERR_OK;
+}
@@ -0,0 +1,193 @@
+#include "mcp2221_adc_stream.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mcp2221_analog.h"
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_ring.h"
+
+/* Longest single sleep, so that mcp2221_adc_stream_stop() is noticed promptly. */
+#define ADC_STREAM_SLEEP_SLICE_NS 10000000ull
+
+struct mcp2221_adc_stream {
+	mcp2221_t *dev;
+	uint64_t period_ns;
+	uint32_t decimation;
+	mcp2221_internal_ring_t ring;
+	mcp2221_adc_stream_stats_t stats;
+	uint64_t first_ns;	// issue time of the first and last acquisition, for the effective rate
+	uint64_t last_ns;
+	uint64_t start_ns;	// samples older than the last start are stale; read by the consumer
+	pthread_mutex_t stats_lock;
+	pthread_t worker;
+	int running;
+	int stop;
+};
+
+static void *adc_stream_worker(void *arg) {
+	mcp2221_adc_stream_t *stream = arg;
+	uint64_t next_ns = mcp2221_internal_monotonic_ns();
+	uint32_t sum[3] = {0, 0, 0};
+	uint32_t accumulated = 0;
+	mcp2221_adc_stream_sample_t sample = {0, {0, 0, 0}};
+
+	while (!__atomic_load_n(&stream->stop, __ATOMIC_ACQUIRE)) {
+		uint64_t now = mcp2221_internal_monotonic_ns();
+		if (now < next_ns) {
+			mcp2221_internal_sleep_until_ns(next_ns - now > ADC_STREAM_SLEEP_SLICE_NS ? now + ADC_STREAM_SLEEP_SLICE_NS : next_ns);
+			continue;
+		}
+
+		// Periods more than one behind are skipped, not sampled back to back.
+		uint64_t behind = (now - next_ns) / stream->period_ns;
+		next_ns += (behind + 1) * stream->period_ns;
+
+		uint16_t raw[3];
+		uint64_t time_ns = mcp2221_internal_monotonic_ns();
+		mcp2221_error_code_t err = mcp2221_adc_read_raw(stream->dev, raw);
+
+		int produced = 0, overrun = 0;
+		if (err == MCP2221_ERR_OK) {
+			if (accumulated == 0)
+				sample.time_ns = time_ns;
+			for (int i = 0; i < 3; i++)
+				sum[i] += raw[i];
+
+			if (++accumulated == stream->decimation) {
+				for (int i = 0; i < 3; i++)
+					sample.raw[i] = (uint16_t)((sum[i] + accumulated / 2) / accumulated);
+				overrun = !mcp2221_internal_ring_push(&stream->ring, &sample);
+				produced = 1;
+				memset(sum, 0, sizeof(sum));
+				accumulated = 0;
+			}
+		}
+
+		pthread_mutex_lock(&stream->stats_lock);
+		stream->stats.missed_periods += behind;
+		if (err == MCP2221_ERR_OK) {
+			if (stream->stats.acquisitions++ == 0)
+				stream->first_ns = time_ns;
+			stream->last_ns = time_ns;
+			stream->stats.samples += (uint64_t)produced;
+			stream->stats.overruns += (uint64_t)overrun;
+		} else {
+			stream->stats.errors++;
+			stream->stats.last_error = err;
+		}
+		pthread_mutex_unlock(&stream->stats_lock);
+	}
+
+	return NULL;
+}
+
+mcp2221_error_code_t mcp2221_adc_stream_create(mcp2221_t *dev, const mcp2221_adc_stream_config_t *config,
+					       mcp2221_adc_stream_t **out_stream) {
+	if (!out_stream)
+		return MCP2221_ERR_INVALID;
+
+	*out_stream = NULL;
+
+	if (!dev || !config || config->rate_hz == 0 || config->rate_hz > MCP2221_ADC_STREAM_MAX_RATE_HZ ||
+	    config->ring_capacity == 0)
+		return MCP2221_ERR_INVALID;
+	// Keeps the per-channel sums of 10-bit results within 32 bits.
+	if (config->decimation > (UINT32_MAX >> 10))
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_adc_stream_t *stream = calloc(1, sizeof(*stream));
+	if (!stream)
+		return MCP2221_ERR_NO_MEMORY;
+
+	mcp2221_error_code_t err = mcp2221_internal_ring_init(&stream->ring, sizeof(mcp2221_adc_stream_sample_t),
+							      config->ring_capacity);
+	if (err != MCP2221_ERR_OK) {
+		free(stream);
+		return err;
+	}
+
+	if (pthread_mutex_init(&stream->stats_lock, NULL) != 0) {
+		mcp2221_internal_ring_free(&stream->ring);
+		free(stream);
+		return MCP2221_ERR_GENERIC;
+	}
+
+	stream->dev = dev;
+	stream->period_ns = (1000000000u + config->rate_hz / 2) / config->rate_hz;
+	stream->decimation = config->decimation ? config->decimation : 1;
+	*out_stream = stream;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_adc_stream_destroy(mcp2221_adc_stream_t *stream) {
+	if (!stream)
+		return;
+
+	mcp2221_adc_stream_stop(stream);
+	pthread_mutex_destroy(&stream->stats_lock);
+	mcp2221_internal_ring_free(&stream->ring);
+	free(stream);
+}
+
+mcp2221_error_code_t mcp2221_adc_stream_start(mcp2221_adc_stream_t *stream) {
+	if (!stream)
+		return MCP2221_ERR_INVALID;
+	if (stream->running)
+		return MCP2221_ERR_BUSY;
+
+	memset(&stream->stats, 0, sizeof(stream->stats));
+	stream->first_ns = 0;
+	stream->last_ns = 0;
+	/*
+	 * The ring belongs to the consumer side, which may be draining right
+	 * now, so samples from a previous run are not cleared here but skipped
+	 * by mcp2221_adc_stream_drain().
+	 */
+	__atomic_store_n(&stream->start_ns, mcp2221_internal_monotonic_ns(), __ATOMIC_RELEASE);
+
+	__atomic_store_n(&stream->stop, 0, __ATOMIC_RELEASE);
+	if (pthread_create(&stream->worker, NULL, adc_stream_worker, stream) != 0)
+		return MCP2221_ERR_GENERIC;
+
+	stream->running = 1;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_adc_stream_stop(mcp2221_adc_stream_t *stream) {
+	if (!stream || !stream->running)
+		return;
+
+	__atomic_store_n(&stream->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(stream->worker, NULL);
+	stream->running = 0;
+}
+
+int mcp2221_adc_stream_drain(mcp2221_adc_stream_t *stream, mcp2221_adc_stream_sample_t *out, size_t max) {
+	if (!stream || (!out && max > 0))
+		return MCP2221_ERR_INVALID;
+
+	uint64_t start_ns = __atomic_load_n(&stream->start_ns, __ATOMIC_ACQUIRE);
+	int count = 0;
+	while ((size_t)count < max && count < INT_MAX && mcp2221_internal_ring_pop(&stream->ring, &out[count])) {
+		if (out[count].time_ns >= start_ns)
+			count++;
+	}
+
+	return count;
+}
+
+mcp2221_error_code_t mcp2221_adc_stream_get_stats(mcp2221_adc_stream_t *stream, mcp2221_adc_stream_stats_t *stats) {
+	if (!stream || !stats)
+		return MCP2221_ERR_INVALID;
+
+	pthread_mutex_lock(&stream->stats_lock);
+	*stats = stream->stats;
+	if (stats->acquisitions > 1 && stream->last_ns > stream->first_ns)
+		stats->effective_rate_hz = (double)(stats->acquisitions - 1) * 1e9 /
+					   (double)(stream->last_ns - stream->first_ns);
+	pthread_mutex_unlock(&stream->stats_lock);
+	return MCP2221_ERR_OK;
+}
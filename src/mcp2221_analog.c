@@ -1,6 +1,6 @@
 #include "mcp2221_analog.h"
 
-#include <strings.h>
+#include <string.h>
 
 #include "mcp2221_internal_constants.h"
 #include "mcp2221_internal.h"
@@ -32,10 +32,8 @@
  * cmd[8..11] = 0
  */
 
-static mcp2221_error_code_t set_sram_fields_preserve_gpio(mcp2221_t *dev, int clk_output, /* -1 = keep, else use value */
-							  int dac_ref, int dac_value, int adc_ref, int int_conf) {
-	uint8_t cmd[12] = {0};
-
+static void build_sram_fields_preserve_gpio(uint8_t cmd[12], int clk_output, /* -1 = keep, else use value */
+					    int dac_ref, int dac_value, int adc_ref, int int_conf) {
 	cmd[0] = MCP2221_CMD_SET_SRAM_SETTINGS;
 	cmd[1] = 0;
 
@@ -75,6 +73,12 @@ static mcp2221_error_code_t set_sram_fields_preserve_gpio(mcp2221_t *dev, int cl
 	cmd[9] = 0;
 	cmd[10] = 0;
 	cmd[11] = 0;
+}
+
+static mcp2221_error_code_t set_sram_fields_preserve_gpio(mcp2221_t *dev, int clk_output, int dac_ref, int dac_value,
+							  int adc_ref, int int_conf) {
+	uint8_t cmd[12];
+	build_sram_fields_preserve_gpio(cmd, clk_output, dac_ref, dac_value, adc_ref, int_conf);
 
 	uint8_t resp[MCP2221_PACKET_SIZE];
 	mcp2221_error_code_t err = mcp2221_send_cmd(dev, cmd, sizeof(cmd), resp);
@@ -141,14 +145,7 @@ mcp2221_error_code_t mcp2221_adc_read_raw(mcp2221_t *dev, uint16_t out[3]) {
 	if (err)
 		return err;
 
-	uint16_t adc1 = buf[MCP2221_I2C_POLL_RESP_ADC_CH0_LSB] + ((uint16_t)buf[MCP2221_I2C_POLL_RESP_ADC_CH0_MSB] << 8);
-	uint16_t adc2 = buf[MCP2221_I2C_POLL_RESP_ADC_CH1_LSB] + ((uint16_t)buf[MCP2221_I2C_POLL_RESP_ADC_CH1_MSB] << 8);
-	uint16_t adc3 = buf[MCP2221_I2C_POLL_RESP_ADC_CH2_LSB] + ((uint16_t)buf[MCP2221_I2C_POLL_RESP_ADC_CH2_MSB] << 8);
-
-	out[0] = adc1;
-	out[1] = adc2;
-	out[2] = adc3;
-
+	mcp2221_internal_analog_adc_decode(buf, out);
 	return MCP2221_ERR_OK;
 }
 
@@ -180,30 +177,12 @@ mcp2221_error_code_t mcp2221_adc_read_volts(
 	if (!dev || !out)
 		return MCP2221_ERR_INVALID;
 
-	/*
-	 * Read the currently configured ADC reference from SRAM.
-	 * Byte 7 contains the interrupt and ADC reference settings.
-	 */
-	uint8_t cmd = MCP2221_CMD_GET_SRAM_SETTINGS;
-	uint8_t resp[MCP2221_PACKET_SIZE];
-
-	mcp2221_error_code_t err =
-		mcp2221_internal_send_cmd_retry_safe(dev, &cmd, 1, resp);
-	if (err != MCP2221_ERR_OK)
-		return err;
-
-	mcp2221_analog_voltage_reference_t reference;
-	err = mcp2221_internal_analog_adc_reference_from_bits(
-		resp[MCP2221_SRAM_RESPONSE_INT_ADC],
-		&reference);
-	if (err != MCP2221_ERR_OK)
-		return err;
-
+	// The reference voltage is cached; only the ADC results cost a command.
 	double reference_voltage;
-	err = mcp2221_internal_analog_get_reference_voltage(
-		dev,
-		reference,
-		&reference_voltage);
+	mcp2221_error_code_t err =
+		mcp2221_internal_analog_get_adc_reference_voltage(
+			dev,
+			&reference_voltage);
 	if (err != MCP2221_ERR_OK)
 		return err;
 
@@ -224,6 +203,14 @@ mcp2221_error_code_t mcp2221_adc_read_volts(
 	return MCP2221_ERR_OK;
 }
 
+mcp2221_error_code_t mcp2221_adc_raw_to_normalized_n(const uint16_t *in, double *out, size_t n) {
+	return mcp2221_internal_analog_adc_raw_to_normalized_n(in, out, n);
+}
+
+mcp2221_error_code_t mcp2221_adc_raw_to_volts_n(const uint16_t *in, double *out, size_t n, double reference_voltage) {
+	return mcp2221_internal_analog_adc_raw_to_volts_n(in, out, n, reference_voltage);
+}
+
 // DAC
 
 mcp2221_error_code_t mcp2221_dac_config_out(
@@ -252,9 +239,8 @@ mcp2221_error_code_t mcp2221_dac_config_out(
 		return MCP2221_ERR_INVALID;
 
 	// Read current DAC ref/value from SRAM (as Python uses self.status)
-	uint8_t cmd = MCP2221_CMD_GET_SRAM_SETTINGS;
 	uint8_t resp[MCP2221_PACKET_SIZE];
-	err = mcp2221_internal_send_cmd_retry_safe(dev, &cmd, 1, resp);
+	err = mcp2221_internal_sram_read(dev, resp);
 	if (err != MCP2221_ERR_OK)
 		return err;
 
@@ -326,46 +312,161 @@ mcp2221_error_code_t mcp2221_dac_write_volts(
 	if (!dev)
 		return MCP2221_ERR_INVALID;
 
-	uint8_t cmd = MCP2221_CMD_GET_SRAM_SETTINGS;
-	uint8_t resp[MCP2221_PACKET_SIZE];
-
+	// The reference and its code table are cached; only the write costs a command.
+	uint8_t raw;
 	mcp2221_error_code_t err =
-		mcp2221_internal_send_cmd_retry_safe(dev, &cmd, 1, resp);
+		mcp2221_internal_analog_get_dac_code(
+			dev,
+			volts,
+			&raw);
 	if (err != MCP2221_ERR_OK)
 		return err;
 
-	/*
-	 * The DAC reference occupies bits 5..7 of the SRAM DAC byte.
-	 * Shift it down to the register-bit representation used by the
-	 * internal reference decoder.
-	 */
-	uint8_t reference_bits =
-		(uint8_t)((resp[MCP2221_SRAM_RESPONSE_DAC] >> 5) & 0x07);
+	return mcp2221_dac_write_raw(dev, raw);
+}
 
-	mcp2221_analog_voltage_reference_t reference;
-	err = mcp2221_internal_analog_dac_reference_from_bits(
-		reference_bits,
-		&reference);
-	if (err != MCP2221_ERR_OK)
-		return err;
+mcp2221_error_code_t mcp2221_dac_volts_to_raw_n(const double *in, uint8_t *out, size_t n, double reference_voltage) {
+	return mcp2221_internal_analog_dac_volts_to_raw_n(in, out, n, reference_voltage);
+}
 
-	double reference_voltage;
-	err = mcp2221_internal_analog_get_reference_voltage(
-		dev,
-		reference,
-		&reference_voltage);
-	if (err != MCP2221_ERR_OK)
-		return err;
+// DAC waveforms
 
-	uint8_t raw;
-	err = mcp2221_internal_analog_dac_volts_to_raw(
-		volts,
-		reference_voltage,
-		&raw);
-	if (err != MCP2221_ERR_OK)
-		return err;
+// Helper: offset of sample slot `index` from the start, without accumulating rounding.
+static uint64_t dac_slot_us(uint64_t index, uint32_t rate_hz) {
+	return index / rate_hz * 1000000u + index % rate_hz * 1000000u / rate_hz;
+}
 
-	return mcp2221_dac_write_raw(dev, raw);
+mcp2221_error_code_t mcp2221_dac_play(mcp2221_t *dev, const uint8_t *codes, size_t n, uint32_t rate_hz, uint32_t loops,
+				      mcp2221_dac_play_stats_t *stats) {
+	if (stats)
+		memset(stats, 0, sizeof(*stats));
+	if (!dev || !codes || n == 0 || rate_hz == 0 || rate_hz > MCP2221_DAC_PLAY_MAX_RATE_HZ || loops == 0)
+		return MCP2221_ERR_INVALID;
+	for (size_t i = 0; i < n; ++i) {
+		if (codes[i] > MCP2221_DAC_RAW_MAX)
+			return MCP2221_ERR_INVALID;
+	}
+
+	// One packet per code, so nothing is built while playing.
+	uint8_t packets[MCP2221_DAC_LEVEL_COUNT][12];
+	for (unsigned code = 0; code < MCP2221_DAC_LEVEL_COUNT; ++code)
+		build_sram_fields_preserve_gpio(packets[code], -1, -1, (int)code, -1, -1);
+
+	mcp2221_error_code_t err = MCP2221_ERR_OK;
+	uint64_t total = (uint64_t)n * loops;
+	uint64_t start_us = mcp2221_internal_monotonic_ns() / 1000u;
+	uint64_t lag_sum = 0, lag_min = UINT64_MAX, lag_max = 0;
+	uint64_t slot = 0, sent = 0, duplicates = 0, missed = 0, late = 0;
+	int previous = -1;
+
+	for (; slot < total; ++slot) {
+		uint8_t code = codes[slot % n];
+		uint64_t target_us = start_us + dac_slot_us(slot, rate_hz);
+		uint64_t next_us = start_us + dac_slot_us(slot + 1, rate_hz);
+
+		if (code == previous) {
+			duplicates++;
+			continue;
+		}
+
+		uint64_t now = mcp2221_internal_monotonic_ns() / 1000u;
+		if (now < target_us) {
+			mcp2221_internal_sleep_until_ns(target_us * 1000u);
+		} else if (now >= next_us && slot + 1 < total) {
+			// The slot is already over; play the next code on time instead.
+			missed++;
+			continue;
+		}
+
+		uint64_t issued_us = mcp2221_internal_monotonic_ns() / 1000u;
+		uint8_t resp[MCP2221_PACKET_SIZE];
+		err = mcp2221_send_cmd(dev, packets[code], sizeof(packets[code]), resp);
+		if (err != MCP2221_ERR_OK)
+			break;
+
+		uint64_t lag = issued_us > target_us ? issued_us - target_us : 0;
+		lag_sum += lag;
+		if (lag < lag_min)
+			lag_min = lag;
+		if (lag > lag_max)
+			lag_max = lag;
+		if (mcp2221_internal_monotonic_ns() / 1000u >= next_us)
+			late++;
+		sent++;
+		previous = code;
+	}
+
+	// Hold the last code for its full slot, so the waveform lasts n * loops periods.
+	if (err == MCP2221_ERR_OK)
+		mcp2221_internal_sleep_until_ns((start_us + dac_slot_us(total, rate_hz)) * 1000u);
+
+	if (stats) {
+		stats->slots_played = slot;
+		stats->commands_sent = sent;
+		stats->duplicates_skipped = duplicates;
+		stats->missed_slots = missed;
+		stats->late_commands = late;
+		stats->duration_us = mcp2221_internal_monotonic_ns() / 1000u - start_us;
+		if (stats->duration_us > 0)
+			stats->achieved_rate_hz = (double)slot * 1e6 / (double)stats->duration_us;
+		if (sent > 0) {
+			stats->mean_lag_us = lag_sum / sent;
+			stats->max_lag_us = lag_max;
+			stats->jitter_us = lag_max - lag_min;
+		}
+	}
+
+	return err;
+}
+
+// Helper: sin(2 * pi * t) for t in [0, 1). The library does not require libm.
+static double sine_turns(double t) {
+	// Reduce to [-1/4, 1/4] turn, where the odd Taylor series below is accurate to about 1e-7.
+	if (t > 0.75)
+		t -= 1.0;
+	else if (t > 0.25)
+		t = 0.5 - t;
+
+	double x = t * 6.283185307179586;
+	double x2 = x * x;
+	return x * (1.0 - x2 / 6.0 * (1.0 - x2 / 20.0 * (1.0 - x2 / 42.0 * (1.0 - x2 / 72.0 * (1.0 - x2 / 110.0)))));
+}
+
+mcp2221_error_code_t mcp2221_dac_wave_sine(uint8_t *codes, size_t n, uint8_t low, uint8_t high) {
+	if (!codes || n == 0 || low > high || high > MCP2221_DAC_RAW_MAX)
+		return MCP2221_ERR_INVALID;
+
+	double mid = (low + high) / 2.0;
+	double amplitude = (high - low) / 2.0;
+	for (size_t i = 0; i < n; ++i)
+		codes[i] = (uint8_t)(mid + amplitude * sine_turns((double)i / (double)n) + 0.5);
+
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_dac_wave_ramp(uint8_t *codes, size_t n, uint8_t from, uint8_t to) {
+	if (!codes || n == 0 || from > MCP2221_DAC_RAW_MAX || to > MCP2221_DAC_RAW_MAX)
+		return MCP2221_ERR_INVALID;
+
+	for (size_t i = 0; i < n; ++i) {
+		double position = n > 1 ? (double)i / (double)(n - 1) : 0.0;
+		codes[i] = (uint8_t)(from + (to - from) * position + 0.5);
+	}
+
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_dac_wave_from_volts(mcp2221_t *dev, const double *volts, size_t n, uint8_t *codes) {
+	if (!dev || !volts || !codes || n == 0)
+		return MCP2221_ERR_INVALID;
+
+	for (size_t i = 0; i < n; ++i) {
+		mcp2221_error_code_t err = mcp2221_internal_analog_get_dac_code(dev, volts[i], &codes[i]);
+		if (err != MCP2221_ERR_OK)
+			return err;
+	}
+
+	return MCP2221_ERR_OK;
 }
 
 // Clock output
@@ -374,37 +475,10 @@ mcp2221_error_code_t mcp2221_clock_config(mcp2221_t *dev, int duty_percent, cons
 	if (!dev || !freq_str)
 		return MCP2221_ERR_INVALID;
 
-	int duty_bits;
-	if (duty_percent == 0)
-		duty_bits = MCP2221_CLK_DUTY_0;
-	else if (duty_percent == 25)
-		duty_bits = MCP2221_CLK_DUTY_25;
-	else if (duty_percent == 50)
-		duty_bits = MCP2221_CLK_DUTY_50;
-	else if (duty_percent == 75)
-		duty_bits = MCP2221_CLK_DUTY_75;
-	else
-		return MCP2221_ERR_INVALID; /* like ValueError in Python */
-
-	int div_bits;
-	if (strcasecmp(freq_str, "375kHz") == 0)
-		div_bits = MCP2221_CLK_FREQ_375kHz;
-	else if (strcasecmp(freq_str, "750kHz") == 0)
-		div_bits = MCP2221_CLK_FREQ_750kHz;
-	else if (strcasecmp(freq_str, "1.5MHz") == 0)
-		div_bits = MCP2221_CLK_FREQ_1_5MHz;
-	else if (strcasecmp(freq_str, "3MHz") == 0)
-		div_bits = MCP2221_CLK_FREQ_3MHz;
-	else if (strcasecmp(freq_str, "6MHz") == 0)
-		div_bits = MCP2221_CLK_FREQ_6MHz;
-	else if (strcasecmp(freq_str, "12MHz") == 0)
-		div_bits = MCP2221_CLK_FREQ_12MHz;
-	else if (strcasecmp(freq_str, "24MHz") == 0)
-		div_bits = MCP2221_CLK_FREQ_24MHz;
-	else
-		return MCP2221_ERR_INVALID;
-
-	int clk_output = duty_bits | div_bits;
+	int clk_output;
+	mcp2221_error_code_t err = mcp2221_internal_analog_parse_clock(duty_percent, freq_str, &clk_output);
+	if (err != MCP2221_ERR_OK)
+		return err;
 
 	return set_sram_fields_preserve_gpio(dev, clk_output, /* set clk_output */
 							  -1,			   /* keep dac_ref */
@@ -447,17 +521,9 @@ mcp2221_error_code_t mcp2221_ioc_config(mcp2221_t *dev, const char *edge) {
 		return MCP2221_ERR_INVALID;
 
 	int conf;
-
-	if (strcasecmp(edge, "none") == 0)
-		conf = MCP2221_INT_POS_EDGE_DISABLE | MCP2221_INT_NEG_EDGE_DISABLE;
-	else if (strcasecmp(edge, "rising") == 0)
-		conf = MCP2221_INT_POS_EDGE_ENABLE | MCP2221_INT_NEG_EDGE_DISABLE;
-	else if (strcasecmp(edge, "falling") == 0)
-		conf = MCP2221_INT_POS_EDGE_DISABLE | MCP2221_INT_NEG_EDGE_ENABLE;
-	else if (strcasecmp(edge, "both") == 0)
-		conf = MCP2221_INT_POS_EDGE_ENABLE | MCP2221_INT_NEG_EDGE_ENABLE;
-	else
-		return MCP2221_ERR_INVALID;
+	mcp2221_error_code_t err = mcp2221_internal_analog_parse_ioc_edge(edge, &conf);
+	if (err != MCP2221_ERR_OK)
+		return err;
 
 	return set_sram_fields_preserve_gpio(dev, -1, /* keep clk_output */
 							  -1,	   /* keep dac_ref */
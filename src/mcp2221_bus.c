@@ -0,0 +1,331 @@
+#include "mcp2221_bus.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_bus.h"
+
+typedef enum {
+	BUS_OP_READ_REGISTER,
+	BUS_OP_WRITE_REGISTER,
+	BUS_OP_READ,
+	BUS_OP_WRITE
+} bus_op_t;
+
+/*
+ * One pending transaction. It lives on the submitting thread's stack, which
+ * blocks until the worker marks it done. Register transfers longer than
+ * MCP2221_INTERNAL_BUS_MAX_CHUNK are executed one chunk at a time; the
+ * worker requeues the node after each chunk.
+ */
+typedef struct {
+	mcp2221_internal_bus_node_t node;
+	bus_op_t op;
+	uint32_t reg;
+	uint8_t *rx;
+	const uint8_t *tx;
+	size_t length;
+	size_t offset;
+	size_t chunk;
+	uint64_t submit_ns;
+	mcp2221_error_code_t result;
+	int done;
+} bus_txn_t;
+
+struct mcp2221_bus_client {
+	mcp2221_internal_bus_flow_t flow;
+	mcp2221_bus_t *bus;
+	mcp2221_i2c_slave_t slave;
+	mcp2221_bus_client_stats_t stats;
+};
+
+struct mcp2221_bus {
+	mcp2221_t *dev;
+	pthread_t worker;
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	mcp2221_internal_bus_sched_t sched;
+	int stop;
+};
+
+static size_t next_chunk(const bus_txn_t *txn) {
+	size_t remaining = txn->length - txn->offset;
+
+	if (txn->op != BUS_OP_READ_REGISTER && txn->op != BUS_OP_WRITE_REGISTER)
+		return remaining;
+	return remaining < MCP2221_INTERNAL_BUS_MAX_CHUNK ? remaining : MCP2221_INTERNAL_BUS_MAX_CHUNK;
+}
+
+/*
+ * Check up front that the register address of the last chunk still fits the
+ * client's register width, so a split transfer never fails halfway.
+ */
+static int chunk_registers_fit(const mcp2221_bus_client_t *client, uint32_t reg, size_t length) {
+	if (length <= MCP2221_INTERNAL_BUS_MAX_CHUNK)
+		return 1;
+
+	uint64_t last = (uint64_t)reg + (length - 1) / MCP2221_INTERNAL_BUS_MAX_CHUNK * MCP2221_INTERNAL_BUS_MAX_CHUNK;
+	int reg_bytes = client->slave.reg_bytes;
+	if (reg_bytes < 1 || reg_bytes > 4)
+		return 0;
+	return last < ((uint64_t)1 << (8 * reg_bytes));
+}
+
+static mcp2221_error_code_t execute_txn(mcp2221_bus_client_t *client, bus_txn_t *txn) {
+	switch (txn->op) {
+		case BUS_OP_READ_REGISTER:
+			return mcp2221_i2c_slave_read_register(&client->slave, txn->reg + (uint32_t)txn->offset, txn->rx + txn->offset,
+							       txn->chunk, 0, MCP2221_I2C_BYTE_ORDER_DEFAULT);
+		case BUS_OP_WRITE_REGISTER:
+			return mcp2221_i2c_slave_write_register(&client->slave, txn->reg + (uint32_t)txn->offset,
+								txn->tx ? txn->tx + txn->offset : NULL, txn->chunk, 0,
+								MCP2221_I2C_BYTE_ORDER_DEFAULT);
+		case BUS_OP_READ:
+			return mcp2221_i2c_slave_read(&client->slave, txn->rx, txn->length);
+		case BUS_OP_WRITE:
+			return mcp2221_i2c_slave_write(&client->slave, txn->tx, txn->length);
+	}
+
+	return MCP2221_ERR_INVALID;
+}
+
+static void *bus_worker(void *arg) {
+	mcp2221_bus_t *bus = arg;
+
+	pthread_mutex_lock(&bus->lock);
+	for (;;) {
+		mcp2221_internal_bus_node_t *node;
+		while (!bus->stop && (node = mcp2221_internal_bus_sched_pop(&bus->sched)) == NULL)
+			pthread_cond_wait(&bus->work, &bus->lock);
+		if (bus->stop)
+			break;
+
+		bus_txn_t *txn = (bus_txn_t *)node;
+		mcp2221_bus_client_t *client = (mcp2221_bus_client_t *)node->flow;
+		uint64_t start_ns = mcp2221_internal_monotonic_ns();
+
+		pthread_mutex_unlock(&bus->lock);
+		mcp2221_error_code_t err = execute_txn(client, txn);
+		pthread_mutex_lock(&bus->lock);
+
+		uint64_t delay_us = (start_ns - txn->submit_ns) / 1000u;
+		client->stats.transactions++;
+		client->stats.queue_delay_total_us += delay_us;
+		if (delay_us > client->stats.queue_delay_max_us)
+			client->stats.queue_delay_max_us = delay_us;
+		if (err == MCP2221_ERR_OK)
+			client->stats.bytes += txn->chunk;
+		else
+			client->stats.errors++;
+
+		if (err == MCP2221_ERR_OK && txn->offset + txn->chunk < txn->length) {
+			txn->offset += txn->chunk;
+			txn->chunk = next_chunk(txn);
+			txn->submit_ns = mcp2221_internal_monotonic_ns();
+			mcp2221_internal_bus_sched_push(&bus->sched, &client->flow, &txn->node, txn->chunk);
+			continue;
+		}
+
+		txn->result = err;
+		txn->done = 1;
+		pthread_cond_broadcast(&bus->done);
+	}
+	pthread_mutex_unlock(&bus->lock);
+
+	return NULL;
+}
+
+static mcp2221_error_code_t submit(mcp2221_bus_client_t *client, bus_txn_t *txn) {
+	mcp2221_bus_t *bus = client->bus;
+
+	txn->done = 0;
+	txn->result = MCP2221_ERR_GENERIC;
+	txn->offset = 0;
+	txn->chunk = next_chunk(txn);
+
+	pthread_mutex_lock(&bus->lock);
+	txn->submit_ns = mcp2221_internal_monotonic_ns();
+	mcp2221_internal_bus_sched_push(&bus->sched, &client->flow, &txn->node, txn->chunk);
+	pthread_cond_signal(&bus->work);
+	while (!txn->done)
+		pthread_cond_wait(&bus->done, &bus->lock);
+	pthread_mutex_unlock(&bus->lock);
+
+	return txn->result;
+}
+
+mcp2221_error_code_t mcp2221_bus_open(mcp2221_t *dev, mcp2221_bus_t **out_bus) {
+	if (!dev || !out_bus)
+		return MCP2221_ERR_INVALID;
+
+	*out_bus = NULL;
+
+	mcp2221_bus_t *bus = calloc(1, sizeof(*bus));
+	if (!bus)
+		return MCP2221_ERR_NO_MEMORY;
+
+	bus->dev = dev;
+	mcp2221_internal_bus_sched_init(&bus->sched);
+
+	if (pthread_mutex_init(&bus->lock, NULL) != 0) {
+		free(bus);
+		return MCP2221_ERR_GENERIC;
+	}
+	if (pthread_cond_init(&bus->work, NULL) != 0) {
+		pthread_mutex_destroy(&bus->lock);
+		free(bus);
+		return MCP2221_ERR_GENERIC;
+	}
+	if (pthread_cond_init(&bus->done, NULL) != 0) {
+		pthread_cond_destroy(&bus->work);
+		pthread_mutex_destroy(&bus->lock);
+		free(bus);
+		return MCP2221_ERR_GENERIC;
+	}
+	if (pthread_create(&bus->worker, NULL, bus_worker, bus) != 0) {
+		pthread_cond_destroy(&bus->done);
+		pthread_cond_destroy(&bus->work);
+		pthread_mutex_destroy(&bus->lock);
+		free(bus);
+		return MCP2221_ERR_GENERIC;
+	}
+
+	*out_bus = bus;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_bus_close(mcp2221_bus_t *bus) {
+	if (!bus)
+		return;
+
+	pthread_mutex_lock(&bus->lock);
+	bus->stop = 1;
+	pthread_cond_signal(&bus->work);
+	pthread_mutex_unlock(&bus->lock);
+	pthread_join(bus->worker, NULL);
+
+	while (bus->sched.flows) {
+		mcp2221_bus_client_t *client = (mcp2221_bus_client_t *)bus->sched.flows;
+		mcp2221_internal_bus_flow_detach(&bus->sched, &client->flow);
+		free(client);
+	}
+
+	pthread_cond_destroy(&bus->done);
+	pthread_cond_destroy(&bus->work);
+	pthread_mutex_destroy(&bus->lock);
+	mcp2221_close(bus->dev);
+	free(bus);
+}
+
+mcp2221_t *mcp2221_bus_get_device(mcp2221_bus_t *bus) {
+	return bus ? bus->dev : NULL;
+}
+
+mcp2221_error_code_t mcp2221_bus_client_add(mcp2221_bus_t *bus, const mcp2221_i2c_slave_t *slave, int priority, unsigned weight,
+					    mcp2221_bus_client_t **out_client) {
+	if (!out_client)
+		return MCP2221_ERR_INVALID;
+
+	*out_client = NULL;
+
+	if (!bus || !slave || slave->mcp != bus->dev)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_bus_client_t *client = calloc(1, sizeof(*client));
+	if (!client)
+		return MCP2221_ERR_NO_MEMORY;
+
+	client->bus = bus;
+	client->slave = *slave;
+
+	pthread_mutex_lock(&bus->lock);
+	mcp2221_internal_bus_flow_attach(&bus->sched, &client->flow, priority, weight);
+	pthread_mutex_unlock(&bus->lock);
+
+	*out_client = client;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_bus_client_remove(mcp2221_bus_client_t *client) {
+	if (!client)
+		return;
+
+	mcp2221_bus_t *bus = client->bus;
+	pthread_mutex_lock(&bus->lock);
+	mcp2221_internal_bus_flow_detach(&bus->sched, &client->flow);
+	pthread_mutex_unlock(&bus->lock);
+	free(client);
+}
+
+mcp2221_error_code_t mcp2221_bus_read_register(mcp2221_bus_client_t *client, uint32_t reg, uint8_t *buffer, size_t length) {
+	if (!client || !buffer || length == 0 || !chunk_registers_fit(client, reg, length))
+		return MCP2221_ERR_INVALID;
+
+	bus_txn_t txn = {
+		.op = BUS_OP_READ_REGISTER,
+		.reg = reg,
+		.rx = buffer,
+		.length = length
+	};
+	return submit(client, &txn);
+}
+
+mcp2221_error_code_t mcp2221_bus_write_register(mcp2221_bus_client_t *client, uint32_t reg, const uint8_t *data, size_t length) {
+	if (!client || (length > 0 && !data) || !chunk_registers_fit(client, reg, length))
+		return MCP2221_ERR_INVALID;
+
+	bus_txn_t txn = {
+		.op = BUS_OP_WRITE_REGISTER,
+		.reg = reg,
+		.tx = data,
+		.length = length
+	};
+	return submit(client, &txn);
+}
+
+mcp2221_error_code_t mcp2221_bus_read(mcp2221_bus_client_t *client, uint8_t *buffer, size_t length) {
+	if (!client || !buffer || length == 0)
+		return MCP2221_ERR_INVALID;
+
+	bus_txn_t txn = {
+		.op = BUS_OP_READ,
+		.rx = buffer,
+		.length = length
+	};
+	return submit(client, &txn);
+}
+
+mcp2221_error_code_t mcp2221_bus_write(mcp2221_bus_client_t *client, const uint8_t *data, size_t length) {
+	if (!client || !data || length == 0)
+		return MCP2221_ERR_INVALID;
+
+	bus_txn_t txn = {
+		.op = BUS_OP_WRITE,
+		.tx = data,
+		.length = length
+	};
+	return submit(client, &txn);
+}
+
+mcp2221_error_code_t mcp2221_bus_client_get_stats(mcp2221_bus_client_t *client, mcp2221_bus_client_stats_t *stats) {
+	if (!client || !stats)
+		return MCP2221_ERR_INVALID;
+
+	pthread_mutex_lock(&client->bus->lock);
+	*stats = client->stats;
+	pthread_mutex_unlock(&client->bus->lock);
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_bus_client_reset_stats(mcp2221_bus_client_t *client) {
+	if (!client)
+		return MCP2221_ERR_INVALID;
+
+	pthread_mutex_lock(&client->bus->lock);
+	memset(&client->stats, 0, sizeof(client->stats));
+	pthread_mutex_unlock(&client->bus->lock);
+	return MCP2221_ERR_OK;
+}
@@ -0,0 +1,248 @@
+#include "mcp2221_config_txn.h"
+
+#include <string.h>
+
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_analog.h"
+#include "mcp2221_internal_constants.h"
+
+#define GP_BYTE_MASK 0x1Fu	// function, direction and output value
+
+mcp2221_error_code_t mcp2221_config_txn_init(mcp2221_config_txn_t *txn) {
+	if (!txn)
+		return MCP2221_ERR_INVALID;
+
+	memset(txn, 0, sizeof(*txn));
+	txn->clk_output = -1;
+	txn->dac_ref = -1;
+	txn->dac_value = -1;
+	txn->adc_ref = -1;
+	txn->int_edges = -1;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_config_txn_set_pin(mcp2221_config_txn_t *txn, mcp2221_gpio_pin_t pin,
+						mcp2221_pin_function_t function, int out_value) {
+	if (!txn)
+		return MCP2221_ERR_INVALID;
+
+	uint8_t gp_byte;
+	mcp2221_error_code_t err = mcp2221_internal_pin_gp_byte(pin, function, out_value, &gp_byte);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	txn->gp[pin] = gp_byte;
+	txn->gp_mask |= (uint8_t)(1u << pin);
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_config_txn_set_adc(mcp2221_config_txn_t *txn, const char *ref_str) {
+	if (!txn)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_analog_voltage_reference_t reference;
+	mcp2221_error_code_t err = mcp2221_internal_analog_parse_voltage_reference(ref_str, &reference);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	return mcp2221_internal_analog_adc_reference_to_bits(reference, &txn->adc_ref);
+}
+
+mcp2221_error_code_t mcp2221_config_txn_set_dac(mcp2221_config_txn_t *txn, const char *ref_str, int out_code) {
+	if (!txn || out_code < -1 || out_code > 31)
+		return MCP2221_ERR_INVALID;
+
+	int ref_bits = txn->dac_ref;
+	if (ref_str) {
+		mcp2221_analog_voltage_reference_t reference;
+		mcp2221_error_code_t err = mcp2221_internal_analog_parse_voltage_reference(ref_str, &reference);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		err = mcp2221_internal_analog_dac_reference_to_bits(reference, &ref_bits);
+		if (err != MCP2221_ERR_OK)
+			return err;
+	}
+
+	txn->dac_ref = ref_bits;
+	if (out_code >= 0)
+		txn->dac_value = out_code;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_config_txn_set_clock(mcp2221_config_txn_t *txn, int duty_percent, const char *freq_str) {
+	if (!txn)
+		return MCP2221_ERR_INVALID;
+
+	int bits;
+	mcp2221_error_code_t err = mcp2221_internal_analog_parse_clock(duty_percent, freq_str, &bits);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	txn->clk_output = bits;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_config_txn_set_ioc(mcp2221_config_txn_t *txn, const char *edge) {
+	if (!txn)
+		return MCP2221_ERR_INVALID;
+
+	int bits;
+	mcp2221_error_code_t err = mcp2221_internal_analog_parse_ioc_edge(edge, &bits);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	txn->int_edges = bits;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_config_txn_clear_ioc(mcp2221_config_txn_t *txn) {
+	if (!txn)
+		return MCP2221_ERR_INVALID;
+
+	txn->clear_ioc_flag = 1;
+	return MCP2221_ERR_OK;
+}
+
+static int adc_ref_differs(uint8_t current, int desired) {
+	mcp2221_analog_voltage_reference_t a, b;
+	if (mcp2221_internal_analog_adc_reference_from_bits(current, &a) != MCP2221_ERR_OK ||
+	    mcp2221_internal_analog_adc_reference_from_bits((uint8_t)desired, &b) != MCP2221_ERR_OK)
+		return 1;
+	return a != b;
+}
+
+static int dac_ref_differs(uint8_t current, int desired) {
+	mcp2221_analog_voltage_reference_t a, b;
+	if (mcp2221_internal_analog_dac_reference_from_bits(current, &a) != MCP2221_ERR_OK ||
+	    mcp2221_internal_analog_dac_reference_from_bits((uint8_t)desired, &b) != MCP2221_ERR_OK)
+		return 1;
+	return a != b;
+}
+
+/*
+ * Interrupt bits for the edges that differ from the current settings. The
+ * SET_SRAM_SETTINGS fields are "alter" bit 4 (2) plus the enable bit 3 (1);
+ * a cleared alter bit leaves that edge alone.
+ */
+static int changed_int_edges(uint8_t current, int desired) {
+	int pos_bits = (desired >> 3) & 0x03;
+	int neg_bits = (desired >> 1) & 0x03;
+	int cur_pos = (current & MCP2221_SRAM_RESPONSE_INT_POS_EDGE) != 0;
+	int cur_neg = (current & MCP2221_SRAM_RESPONSE_INT_NEG_EDGE) != 0;
+	int bits = 0;
+
+	if ((pos_bits & 0x02) && (pos_bits & 0x01) != cur_pos)
+		bits |= pos_bits << 3;
+	if ((neg_bits & 0x02) && (neg_bits & 0x01) != cur_neg)
+		bits |= neg_bits << 1;
+	return bits;
+}
+
+static mcp2221_error_code_t send_set_sram(mcp2221_t *dev, const uint8_t cmd[12], int *sent) {
+	uint8_t resp[MCP2221_PACKET_SIZE];
+	mcp2221_error_code_t err = mcp2221_send_cmd(dev, cmd, 12, resp);
+	(*sent)++;
+	return err;
+}
+
+mcp2221_error_code_t mcp2221_config_txn_commit(mcp2221_t *dev, const mcp2221_config_txn_t *txn, int *out_commands) {
+	int sent = 0;
+	if (out_commands)
+		*out_commands = 0;
+	if (!dev || !txn || txn->gp_mask > 0x0F || txn->dac_value > 31)
+		return MCP2221_ERR_INVALID;
+
+	if (txn->gp_mask)
+		(void)mcp2221_internal_ensure_gpio_status(dev);
+
+	uint8_t resp[MCP2221_PACKET_SIZE];
+	mcp2221_error_code_t err = mcp2221_internal_sram_read(dev, resp);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	uint8_t cur_clk = resp[MCP2221_SRAM_RESPONSE_CLOCK] & 0x7F;
+	uint8_t cur_dac_ref = (resp[MCP2221_SRAM_RESPONSE_DAC] >> 5) & 0x07;
+	uint8_t cur_dac_value = resp[MCP2221_SRAM_RESPONSE_DAC] & 0x1F;
+	uint8_t cur_adc_ref = (resp[MCP2221_SRAM_RESPONSE_INT_ADC] >> 2) & 0x07;
+
+	int clk_changed = txn->clk_output >= 0 && (uint8_t)txn->clk_output != cur_clk;
+	int dac_ref_changed = txn->dac_ref >= 0 && dac_ref_differs(cur_dac_ref, txn->dac_ref);
+	int dac_value_changed = txn->dac_value >= 0 && (uint8_t)txn->dac_value != cur_dac_value;
+	int adc_ref_changed = txn->adc_ref >= 0 && adc_ref_differs(cur_adc_ref, txn->adc_ref);
+	int int_bits = txn->int_edges >= 0 ? changed_int_edges(resp[MCP2221_SRAM_RESPONSE_INT_ADC], txn->int_edges) : 0;
+	if (txn->clear_ioc_flag)
+		int_bits |= MCP2221_INT_FLAG_CLEAR;
+
+	// GP bytes: prefer the cached ones, which include GPIO output writes.
+	uint8_t gp_cur[4];
+	if (mcp2221_internal_gpio_status_get(dev, gp_cur) != MCP2221_ERR_OK)
+		memcpy(gp_cur, &resp[MCP2221_SRAM_RESPONSE_GP0], sizeof(gp_cur));
+
+	uint8_t gp_new[4];
+	int gp_changed = 0;
+	for (int i = 0; i < 4; i++) {
+		gp_new[i] = gp_cur[i];
+		if ((txn->gp_mask & (1u << i)) && (gp_cur[i] & GP_BYTE_MASK) != txn->gp[i]) {
+			gp_new[i] = (uint8_t)((gp_cur[i] & ~GP_BYTE_MASK) | txn->gp[i]);
+			gp_changed = 1;
+		}
+	}
+
+	if (!clk_changed && !dac_ref_changed && !dac_value_changed && !adc_ref_changed && !int_bits && !gp_changed)
+		return MCP2221_ERR_OK;
+
+	// Final references, for deciding whether a GP change puts a VRM at risk.
+	uint8_t dac_ref = txn->dac_ref >= 0 ? (uint8_t)txn->dac_ref : cur_dac_ref;
+	uint8_t dac_value = txn->dac_value >= 0 ? (uint8_t)txn->dac_value : cur_dac_value;
+	uint8_t adc_ref = txn->adc_ref >= 0 ? (uint8_t)txn->adc_ref : cur_adc_ref;
+
+	int dac_reclaim = dac_ref_changed || (gp_changed && (dac_ref & MCP2221_DAC_REF_VRM));
+	int adc_reclaim = gp_changed && (adc_ref & MCP2221_ADC_REF_VRM);
+
+	uint8_t cmd[12] = {0};
+	cmd[0] = MCP2221_CMD_SET_SRAM_SETTINGS;
+	cmd[2] = clk_changed ? (uint8_t)(MCP2221_ALTER_CLK_OUTPUT | txn->clk_output) : MCP2221_PRESERVE_CLK_OUTPUT;
+
+	// A changed DAC reference is always reached through OFF, so it is set in the second command.
+	cmd[3] = dac_reclaim ? (uint8_t)(MCP2221_ALTER_DAC_REF | MCP2221_DAC_REF_VRM | MCP2221_DAC_VRM_OFF)
+			     : MCP2221_PRESERVE_DAC_REF;
+
+	if (dac_ref_changed)
+		cmd[4] = MCP2221_ALTER_DAC_VALUE;	// value 0 while the reference changes
+	else if (dac_value_changed)
+		cmd[4] = (uint8_t)(MCP2221_ALTER_DAC_VALUE | dac_value);
+	else
+		cmd[4] = MCP2221_PRESERVE_DAC_VALUE;
+
+	if (adc_reclaim)
+		cmd[5] = MCP2221_ALTER_ADC_REF | MCP2221_ADC_REF_VRM | MCP2221_ADC_VRM_OFF;
+	else if (adc_ref_changed)
+		cmd[5] = (uint8_t)(MCP2221_ALTER_ADC_REF | adc_ref);
+	else
+		cmd[5] = MCP2221_PRESERVE_ADC_REF;
+
+	cmd[6] = int_bits ? (uint8_t)(MCP2221_ALTER_INT_CONF | int_bits) : MCP2221_PRESERVE_INT_CONF;
+	cmd[7] = gp_changed ? MCP2221_ALTER_GPIO_CONF : MCP2221_PRESERVE_GPIO_CONF;
+	if (gp_changed)
+		memcpy(&cmd[8], gp_new, sizeof(gp_new));
+
+	err = send_set_sram(dev, cmd, &sent);
+	if (err == MCP2221_ERR_OK && gp_changed)
+		mcp2221_internal_gpio_status_set(dev, gp_new);
+
+	if (err == MCP2221_ERR_OK && (dac_reclaim || adc_reclaim)) {
+		uint8_t reclaim[12] = {0};
+		reclaim[0] = MCP2221_CMD_SET_SRAM_SETTINGS;
+		reclaim[2] = MCP2221_PRESERVE_CLK_OUTPUT;
+		reclaim[3] = dac_reclaim ? (uint8_t)(MCP2221_ALTER_DAC_REF | dac_ref) : MCP2221_PRESERVE_DAC_REF;
+		reclaim[4] = dac_reclaim ? (uint8_t)(MCP2221_ALTER_DAC_VALUE | dac_value) : MCP2221_PRESERVE_DAC_VALUE;
+		reclaim[5] = adc_reclaim ? (uint8_t)(MCP2221_ALTER_ADC_REF | adc_ref) : MCP2221_PRESERVE_ADC_REF;
+		reclaim[6] = MCP2221_PRESERVE_INT_CONF;
+		reclaim[7] = MCP2221_PRESERVE_GPIO_CONF;
+		err = send_set_sram(dev, reclaim, &sent);
+	}
+
+	if (out_commands)
+		*out_commands = sent;
+	return err;
+}
@@ -0,0 +1,310 @@
+#include "mcp2221_display.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DISPLAY_CONTROL_COMMAND 0x00
+#define DISPLAY_CONTROL_DATA 0x40
+/* Largest slave-helper write, minus the control byte. */
+#define DISPLAY_DATA_CHUNK 255
+#define DISPLAY_MAX_PAGES 8
+#define SSD1306_COLUMNS 128
+#define SH1106_COLUMNS 132
+
+#define SSD1306_SET_COLUMN_ADDRESS 0x21
+#define SSD1306_SET_PAGE_ADDRESS 0x22
+#define SH1106_SET_PAGE 0xB0
+#define SH1106_SET_COLUMN_LOW 0x00
+#define SH1106_SET_COLUMN_HIGH 0x10
+
+/*
+ * Byte-equivalent cost of starting another address window: one extra
+ * command write plus one extra data write, each a full USB round trip.
+ * Merging two pages into one window is worthwhile while it sends fewer
+ * redundant bytes than this.
+ */
+#define DISPLAY_WINDOW_COST 64
+
+typedef struct {
+	int lo;
+	int hi;	// inclusive; lo > hi marks an unchanged page
+} display_span_t;
+
+struct mcp2221_display {
+	mcp2221_i2c_slave_t slave;
+	mcp2221_display_controller_t controller;
+	int width;
+	int pages;
+	int column_offset;
+	size_t size;
+	uint8_t *frame;
+	uint8_t *shadow;
+	int shadow_valid;
+	mcp2221_display_stats_t stats;
+	uint8_t tx[1 + DISPLAY_DATA_CHUNK];
+	size_t tx_len;
+};
+
+static mcp2221_error_code_t send_commands(mcp2221_display_t *display, const uint8_t *commands, size_t count) {
+	display->tx[0] = DISPLAY_CONTROL_COMMAND;
+	memcpy(display->tx + 1, commands, count);
+	display->stats.command_writes++;
+	return mcp2221_i2c_slave_write(&display->slave, display->tx, count + 1);
+}
+
+static mcp2221_error_code_t flush_data(mcp2221_display_t *display) {
+	if (display->tx_len == 0)
+		return MCP2221_ERR_OK;
+
+	display->tx[0] = DISPLAY_CONTROL_DATA;
+	display->stats.data_writes++;
+	display->stats.data_bytes += display->tx_len;
+	mcp2221_error_code_t err = mcp2221_i2c_slave_write(&display->slave, display->tx, display->tx_len + 1);
+	display->tx_len = 0;
+	return err;
+}
+
+// Helper: append one page row to the data stream, writing full chunks as they fill up.
+static mcp2221_error_code_t queue_data(mcp2221_display_t *display, int page, int lo, int hi) {
+	const uint8_t *src = display->frame + (size_t)page * (size_t)display->width + (size_t)lo;
+	size_t remaining = (size_t)(hi - lo + 1);
+
+	while (remaining > 0) {
+		size_t n = DISPLAY_DATA_CHUNK - display->tx_len;
+		if (n > remaining)
+			n = remaining;
+		memcpy(display->tx + 1 + display->tx_len, src, n);
+		display->tx_len += n;
+		src += n;
+		remaining -= n;
+
+		if (display->tx_len == DISPLAY_DATA_CHUNK) {
+			mcp2221_error_code_t err = flush_data(display);
+			if (err != MCP2221_ERR_OK)
+				return err;
+		}
+	}
+	return MCP2221_ERR_OK;
+}
+
+static void find_spans(const mcp2221_display_t *display, display_span_t *spans) {
+	for (int page = 0; page < display->pages; ++page) {
+		const uint8_t *cur = display->frame + (size_t)page * (size_t)display->width;
+		const uint8_t *old = display->shadow + (size_t)page * (size_t)display->width;
+
+		spans[page].lo = 1;
+		spans[page].hi = 0;
+		if (!display->shadow_valid) {
+			spans[page].lo = 0;
+			spans[page].hi = display->width - 1;
+			continue;
+		}
+		if (memcmp(cur, old, (size_t)display->width) == 0)
+			continue;
+
+		int lo = 0;
+		while (cur[lo] == old[lo])
+			lo++;
+		int hi = display->width - 1;
+		while (cur[hi] == old[hi])
+			hi--;
+		spans[page].lo = lo;
+		spans[page].hi = hi;
+	}
+}
+
+static int span_width(display_span_t span) {
+	return span.hi - span.lo + 1;
+}
+
+static mcp2221_error_code_t flush_ssd1306(mcp2221_display_t *display, const display_span_t *spans) {
+	int page = 0;
+	while (page < display->pages) {
+		if (spans[page].lo > spans[page].hi) {
+			page++;
+			continue;
+		}
+
+		// Grow the window downwards while that is cheaper than a new window.
+		int first = page;
+		int last = page;
+		display_span_t rect = spans[page];
+		while (last + 1 < display->pages && spans[last + 1].lo <= spans[last + 1].hi) {
+			display_span_t next = spans[last + 1];
+			display_span_t merged = {rect.lo < next.lo ? rect.lo : next.lo, rect.hi > next.hi ? rect.hi : next.hi};
+			int merged_cost = (last - first + 2) * span_width(merged);
+			int separate_cost = (last - first + 1) * span_width(rect) + span_width(next) + DISPLAY_WINDOW_COST;
+			if (merged_cost > separate_cost)
+				break;
+			rect = merged;
+			last++;
+		}
+
+		const uint8_t window[] = {
+			SSD1306_SET_COLUMN_ADDRESS,
+			(uint8_t)(rect.lo + display->column_offset),
+			(uint8_t)(rect.hi + display->column_offset),
+			SSD1306_SET_PAGE_ADDRESS,
+			(uint8_t)first,
+			(uint8_t)last
+		};
+		mcp2221_error_code_t err = send_commands(display, window, sizeof(window));
+		if (err != MCP2221_ERR_OK)
+			return err;
+
+		display->stats.regions++;
+		for (int p = first; p <= last; ++p) {
+			err = queue_data(display, p, rect.lo, rect.hi);
+			if (err != MCP2221_ERR_OK)
+				return err;
+		}
+		err = flush_data(display);
+		if (err != MCP2221_ERR_OK)
+			return err;
+
+		page = last + 1;
+	}
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_error_code_t flush_sh1106(mcp2221_display_t *display, const display_span_t *spans) {
+	for (int page = 0; page < display->pages; ++page) {
+		if (spans[page].lo > spans[page].hi)
+			continue;
+
+		int column = spans[page].lo + display->column_offset;
+		const uint8_t position[] = {
+			(uint8_t)(SH1106_SET_PAGE | page),
+			(uint8_t)(SH1106_SET_COLUMN_LOW | (column & 0x0F)),
+			(uint8_t)(SH1106_SET_COLUMN_HIGH | (column >> 4))
+		};
+		mcp2221_error_code_t err = send_commands(display, position, sizeof(position));
+		if (err != MCP2221_ERR_OK)
+			return err;
+
+		display->stats.regions++;
+		err = queue_data(display, page, spans[page].lo, spans[page].hi);
+		if (err == MCP2221_ERR_OK)
+			err = flush_data(display);
+		if (err != MCP2221_ERR_OK)
+			return err;
+	}
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_display_create(const mcp2221_i2c_slave_t *slave, const mcp2221_display_config_t *config,
+					    mcp2221_display_t **out_display) {
+	if (!out_display)
+		return MCP2221_ERR_INVALID;
+	*out_display = NULL;
+
+	if (!slave || !slave->mcp || !config)
+		return MCP2221_ERR_INVALID;
+
+	int columns;
+	if (config->controller == MCP2221_DISPLAY_SSD1306)
+		columns = SSD1306_COLUMNS;
+	else if (config->controller == MCP2221_DISPLAY_SH1106)
+		columns = SH1106_COLUMNS;
+	else
+		return MCP2221_ERR_INVALID;
+
+	if (config->width <= 0 || config->column_offset < 0 || config->width > columns - config->column_offset)
+		return MCP2221_ERR_INVALID;
+	if (config->height <= 0 || config->height % 8 != 0 || config->height / 8 > DISPLAY_MAX_PAGES)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_display_t *display = calloc(1, sizeof(*display));
+	if (!display)
+		return MCP2221_ERR_NO_MEMORY;
+
+	display->slave = *slave;
+	display->controller = config->controller;
+	display->width = config->width;
+	display->pages = config->height / 8;
+	display->column_offset = config->column_offset;
+	display->size = (size_t)display->width * (size_t)display->pages;
+	display->frame = calloc(1, display->size);
+	display->shadow = calloc(1, display->size);
+	if (!display->frame || !display->shadow) {
+		mcp2221_display_destroy(display);
+		return MCP2221_ERR_NO_MEMORY;
+	}
+
+	*out_display = display;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_display_destroy(mcp2221_display_t *display) {
+	if (!display)
+		return;
+
+	free(display->frame);
+	free(display->shadow);
+	free(display);
+}
+
+uint8_t *mcp2221_display_buffer(mcp2221_display_t *display, size_t *out_size) {
+	if (out_size)
+		*out_size = display ? display->size : 0;
+	return display ? display->frame : NULL;
+}
+
+void mcp2221_display_clear(mcp2221_display_t *display) {
+	if (display)
+		memset(display->frame, 0, display->size);
+}
+
+void mcp2221_display_set_pixel(mcp2221_display_t *display, int x, int y, int on) {
+	if (!display || x < 0 || x >= display->width || y < 0 || y >= display->pages * 8)
+		return;
+
+	uint8_t *cell = display->frame + (size_t)(y / 8) * (size_t)display->width + (size_t)x;
+	uint8_t mask = (uint8_t)(1u << (y % 8));
+	if (on)
+		*cell |= mask;
+	else
+		*cell &= (uint8_t)~mask;
+}
+
+mcp2221_error_code_t mcp2221_display_flush(mcp2221_display_t *display) {
+	if (!display)
+		return MCP2221_ERR_INVALID;
+
+	display_span_t spans[DISPLAY_MAX_PAGES];
+	find_spans(display, spans);
+
+	display->stats.flushes++;
+	display->tx_len = 0;
+	mcp2221_error_code_t err = (display->controller == MCP2221_DISPLAY_SSD1306) ? flush_ssd1306(display, spans)
+										      : flush_sh1106(display, spans);
+	if (err != MCP2221_ERR_OK) {
+		// Part of the frame may have been sent; resend everything next time.
+		display->shadow_valid = 0;
+		return err;
+	}
+
+	memcpy(display->shadow, display->frame, display->size);
+	display->shadow_valid = 1;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_display_invalidate(mcp2221_display_t *display) {
+	if (display)
+		display->shadow_valid = 0;
+}
+
+mcp2221_error_code_t mcp2221_display_send_commands(mcp2221_display_t *display, const uint8_t *commands, size_t count) {
+	if (!display || !commands || count == 0 || count > MCP2221_DISPLAY_COMMANDS_MAX)
+		return MCP2221_ERR_INVALID;
+
+	return send_commands(display, commands, count);
+}
+
+mcp2221_error_code_t mcp2221_display_get_stats(const mcp2221_display_t *display, mcp2221_display_stats_t *stats) {
+	if (!display || !stats)
+		return MCP2221_ERR_INVALID;
+
+	*stats = display->stats;
+	return MCP2221_ERR_OK;
+}
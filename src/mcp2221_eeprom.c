@@ -0,0 +1,411 @@
+#include "mcp2221_eeprom.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mcp2221_internal.h"
+
+#define EEPROM_DEFAULT_CACHE_PAGES 16
+#define EEPROM_DEFAULT_WRITE_CYCLE_MS 10
+/* Longest register read issued by one fetch, matching the slave helper limit. */
+#define EEPROM_FETCH_MAX 256
+#define EEPROM_NO_PAGE ((size_t)-1)
+
+typedef enum {
+	SLOT_EMPTY = 0,
+	SLOT_VALID,	// whole page cached
+	SLOT_PARTIAL	// only the dirty range is known
+} slot_state_t;
+
+typedef struct {
+	size_t page;
+	uint64_t last_use;
+	size_t dirty_lo;
+	size_t dirty_hi;	// dirty range is [dirty_lo, dirty_hi); empty when equal
+	slot_state_t state;
+	uint8_t *data;
+} eeprom_slot_t;
+
+struct mcp2221_eeprom_map {
+	mcp2221_i2c_slave_t slave;
+	size_t size;
+	size_t page_size;
+	size_t page_count;
+	size_t read_ahead;
+	int write_cycle_ms;
+
+	eeprom_slot_t *slots;
+	size_t slot_count;
+	uint8_t *page_data;
+	uint8_t fetch[EEPROM_FETCH_MAX];
+
+	uint64_t clock;
+	size_t next_page;	// page following the previous access
+	int write_pending;	// a write cycle may still be running
+	mcp2221_eeprom_map_stats_t stats;
+};
+
+static int slot_is_dirty(const eeprom_slot_t *slot) {
+	return slot->dirty_hi > slot->dirty_lo;
+}
+
+static int range_is_valid(const mcp2221_eeprom_map_t *map, size_t offset, size_t length) {
+	return offset <= map->size && length <= map->size - offset;
+}
+
+static eeprom_slot_t *find_slot(mcp2221_eeprom_map_t *map, size_t page) {
+	for (size_t i = 0; i < map->slot_count; ++i) {
+		if (map->slots[i].state != SLOT_EMPTY && map->slots[i].page == page)
+			return &map->slots[i];
+	}
+	return NULL;
+}
+
+static void touch_slot(mcp2221_eeprom_map_t *map, eeprom_slot_t *slot) {
+	slot->last_use = ++map->clock;
+}
+
+/*
+ * Wait until the EEPROM acknowledges its address again. A write cycle is
+ * only waited for right before the next transaction, so it overlaps with
+ * whatever the application does in between.
+ */
+static mcp2221_error_code_t wait_write_cycle(mcp2221_eeprom_map_t *map) {
+	if (!map->write_pending)
+		return MCP2221_ERR_OK;
+
+	uint64_t deadline = mcp2221_internal_monotonic_ns() / 1000000u + (uint64_t)map->write_cycle_ms;
+	for (;;) {
+		int present = 0;
+		mcp2221_error_code_t err = mcp2221_i2c_slave_check_present(&map->slave, &present);
+		map->stats.ack_polls++;
+		if (err != MCP2221_ERR_OK)
+			return err;
+		if (present) {
+			map->write_pending = 0;
+			return MCP2221_ERR_OK;
+		}
+		if (mcp2221_internal_monotonic_ns() / 1000000u > deadline)
+			return MCP2221_ERR_TIMEOUT;
+	}
+}
+
+static mcp2221_error_code_t device_read(mcp2221_eeprom_map_t *map, size_t offset, uint8_t *buffer, size_t length) {
+	mcp2221_error_code_t err = wait_write_cycle(map);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	map->stats.read_transactions++;
+	return mcp2221_i2c_slave_read_register(&map->slave, (uint32_t)offset, buffer, length, 0, MCP2221_I2C_BYTE_ORDER_DEFAULT);
+}
+
+static mcp2221_error_code_t write_back(mcp2221_eeprom_map_t *map, eeprom_slot_t *slot) {
+	if (!slot_is_dirty(slot))
+		return MCP2221_ERR_OK;
+
+	mcp2221_error_code_t err = wait_write_cycle(map);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	size_t length = slot->dirty_hi - slot->dirty_lo;
+	size_t offset = slot->page * map->page_size + slot->dirty_lo;
+	err = mcp2221_i2c_slave_write_register(&map->slave, (uint32_t)offset, slot->data + slot->dirty_lo, length, 0,
+					      MCP2221_I2C_BYTE_ORDER_DEFAULT);
+	map->stats.write_transactions++;
+	/* Even a failed write may have started a write cycle. */
+	map->write_pending = 1;
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	map->stats.bytes_written += length;
+	slot->dirty_lo = slot->dirty_hi = 0;
+	// Bytes outside the written range were never loaded.
+	if (slot->state == SLOT_PARTIAL)
+		slot->state = SLOT_EMPTY;
+	return MCP2221_ERR_OK;
+}
+
+// Helper: claim a slot for @p page, evicting the least recently used page.
+static mcp2221_error_code_t alloc_slot(mcp2221_eeprom_map_t *map, size_t page, eeprom_slot_t **out) {
+	eeprom_slot_t *victim = NULL;
+
+	for (size_t i = 0; i < map->slot_count; ++i) {
+		eeprom_slot_t *slot = &map->slots[i];
+		if (slot->state == SLOT_EMPTY) {
+			victim = slot;
+			break;
+		}
+		if (!victim || slot->last_use < victim->last_use)
+			victim = slot;
+	}
+
+	if (victim->state != SLOT_EMPTY) {
+		if (slot_is_dirty(victim)) {
+			mcp2221_error_code_t err = write_back(map, victim);
+			if (err != MCP2221_ERR_OK)
+				return err;
+			map->stats.dirty_evictions++;
+		}
+		map->stats.evictions++;
+	}
+
+	victim->page = page;
+	victim->state = SLOT_EMPTY;
+	victim->dirty_lo = victim->dirty_hi = 0;
+	touch_slot(map, victim);
+	*out = victim;
+	return MCP2221_ERR_OK;
+}
+
+// Helper: complete a partially written page with the device contents.
+static mcp2221_error_code_t fill_partial(mcp2221_eeprom_map_t *map, eeprom_slot_t *slot) {
+	mcp2221_error_code_t err = device_read(map, slot->page * map->page_size, map->fetch, map->page_size);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	memcpy(slot->data, map->fetch, slot->dirty_lo);
+	memcpy(slot->data + slot->dirty_hi, map->fetch + slot->dirty_hi, map->page_size - slot->dirty_hi);
+	slot->state = SLOT_VALID;
+	return MCP2221_ERR_OK;
+}
+
+/*
+ * Fetch @p first and the following uncached pages up to @p last, extended by
+ * the read-ahead window for sequential access, using as few register reads
+ * as possible.
+ */
+static mcp2221_error_code_t fetch_pages(mcp2221_eeprom_map_t *map, size_t first, size_t last) {
+	size_t end = last + 1;
+	if (first == map->next_page && first + 1 + map->read_ahead > end)
+		end = first + 1 + map->read_ahead;
+	if (end > map->page_count)
+		end = map->page_count;
+	if (end - first > map->slot_count)
+		end = first + map->slot_count;
+
+	size_t stop = first + 1;
+	while (stop < end && !find_slot(map, stop))
+		stop++;
+
+	size_t chunk_pages = EEPROM_FETCH_MAX / map->page_size;
+	for (size_t page = first; page < stop; page += chunk_pages) {
+		size_t pages = stop - page < chunk_pages ? stop - page : chunk_pages;
+		mcp2221_error_code_t err = device_read(map, page * map->page_size, map->fetch, pages * map->page_size);
+		if (err != MCP2221_ERR_OK)
+			return err;
+
+		for (size_t i = 0; i < pages; ++i) {
+			eeprom_slot_t *slot;
+			err = alloc_slot(map, page + i, &slot);
+			if (err != MCP2221_ERR_OK)
+				return err;
+			memcpy(slot->data, map->fetch + i * map->page_size, map->page_size);
+			slot->state = SLOT_VALID;
+			if (page + i > last)
+				map->stats.read_ahead_pages++;
+		}
+	}
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_eeprom_map_create(const mcp2221_i2c_slave_t *slave, const mcp2221_eeprom_map_config_t *config,
+					       mcp2221_eeprom_map_t **out_map) {
+	if (!out_map)
+		return MCP2221_ERR_INVALID;
+	*out_map = NULL;
+
+	if (!slave || !slave->mcp || !config)
+		return MCP2221_ERR_INVALID;
+
+	size_t page_size = config->page_size;
+	if (page_size == 0 || page_size > MCP2221_EEPROM_PAGE_MAX || (page_size & (page_size - 1)) != 0)
+		return MCP2221_ERR_INVALID;
+	if (config->size == 0 || config->size % page_size != 0)
+		return MCP2221_ERR_INVALID;
+	if (slave->reg_bytes < 4 && config->size > ((size_t)1 << (8 * slave->reg_bytes)))
+		return MCP2221_ERR_INVALID;
+	if ((uint64_t)(config->size - 1) > UINT32_MAX)
+		return MCP2221_ERR_INVALID;
+
+	size_t cache_pages = config->cache_pages ? config->cache_pages : EEPROM_DEFAULT_CACHE_PAGES;
+	if (config->read_ahead_pages >= cache_pages || cache_pages > SIZE_MAX / page_size)
+		return MCP2221_ERR_INVALID;
+	if (config->write_cycle_ms < 0)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_eeprom_map_t *map = calloc(1, sizeof(*map));
+	if (!map)
+		return MCP2221_ERR_NO_MEMORY;
+
+	map->slots = calloc(cache_pages, sizeof(*map->slots));
+	map->page_data = malloc(cache_pages * page_size);
+	if (!map->slots || !map->page_data) {
+		free(map->slots);
+		free(map->page_data);
+		free(map);
+		return MCP2221_ERR_NO_MEMORY;
+	}
+
+	map->slave = *slave;
+	map->size = config->size;
+	map->page_size = page_size;
+	map->page_count = config->size / page_size;
+	map->read_ahead = config->read_ahead_pages;
+	map->write_cycle_ms = config->write_cycle_ms ? config->write_cycle_ms : EEPROM_DEFAULT_WRITE_CYCLE_MS;
+	map->slot_count = cache_pages;
+	map->next_page = EEPROM_NO_PAGE;
+	for (size_t i = 0; i < cache_pages; ++i)
+		map->slots[i].data = map->page_data + i * page_size;
+
+	*out_map = map;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_eeprom_map_destroy(mcp2221_eeprom_map_t *map) {
+	if (!map)
+		return MCP2221_ERR_OK;
+
+	mcp2221_error_code_t err = mcp2221_eeprom_map_sync(map);
+	free(map->slots);
+	free(map->page_data);
+	free(map);
+	return err;
+}
+
+mcp2221_error_code_t mcp2221_eeprom_map_read(mcp2221_eeprom_map_t *map, size_t offset, uint8_t *buffer, size_t length) {
+	if (!map || (length > 0 && !buffer) || !range_is_valid(map, offset, length))
+		return MCP2221_ERR_INVALID;
+
+	size_t last = length ? (offset + length - 1) / map->page_size : 0;
+	while (length > 0) {
+		size_t page = offset / map->page_size;
+		size_t in = offset % map->page_size;
+		size_t n = map->page_size - in < length ? map->page_size - in : length;
+
+		eeprom_slot_t *slot = find_slot(map, page);
+		if (slot && (slot->state == SLOT_VALID || (in >= slot->dirty_lo && in + n <= slot->dirty_hi))) {
+			map->stats.read_hits++;
+		} else {
+			map->stats.read_misses++;
+			mcp2221_error_code_t err = slot ? fill_partial(map, slot) : fetch_pages(map, page, last);
+			if (err != MCP2221_ERR_OK)
+				return err;
+			slot = find_slot(map, page);
+		}
+
+		memcpy(buffer, slot->data + in, n);
+		touch_slot(map, slot);
+		map->next_page = page + 1;
+		buffer += n;
+		offset += n;
+		length -= n;
+	}
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_eeprom_map_write(mcp2221_eeprom_map_t *map, size_t offset, const uint8_t *data, size_t length) {
+	if (!map || (length > 0 && !data) || !range_is_valid(map, offset, length))
+		return MCP2221_ERR_INVALID;
+
+	map->stats.write_calls++;
+	while (length > 0) {
+		size_t page = offset / map->page_size;
+		size_t in = offset % map->page_size;
+		size_t n = map->page_size - in < length ? map->page_size - in : length;
+		mcp2221_error_code_t err;
+
+		eeprom_slot_t *slot = find_slot(map, page);
+		if (!slot) {
+			err = alloc_slot(map, page, &slot);
+			if (err != MCP2221_ERR_OK)
+				return err;
+			slot->state = SLOT_PARTIAL;
+		} else if (slot->state == SLOT_PARTIAL && slot_is_dirty(slot) && (in > slot->dirty_hi || in + n < slot->dirty_lo)) {
+			// A gap of unknown bytes would end up inside the dirty range.
+			err = fill_partial(map, slot);
+			if (err != MCP2221_ERR_OK)
+				return err;
+		}
+
+		memcpy(slot->data + in, data, n);
+		if (!slot_is_dirty(slot)) {
+			slot->dirty_lo = in;
+			slot->dirty_hi = in + n;
+		} else {
+			if (in < slot->dirty_lo)
+				slot->dirty_lo = in;
+			if (in + n > slot->dirty_hi)
+				slot->dirty_hi = in + n;
+		}
+		if (slot->dirty_lo == 0 && slot->dirty_hi == map->page_size)
+			slot->state = SLOT_VALID;
+		touch_slot(map, slot);
+
+		data += n;
+		offset += n;
+		length -= n;
+	}
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_eeprom_map_sync(mcp2221_eeprom_map_t *map) {
+	if (!map)
+		return MCP2221_ERR_INVALID;
+
+	// Write back in address order; the cache is small, so select the next page by scanning.
+	size_t after = 0;
+	int first = 1;
+	for (;;) {
+		eeprom_slot_t *next = NULL;
+		for (size_t i = 0; i < map->slot_count; ++i) {
+			eeprom_slot_t *slot = &map->slots[i];
+			if (slot->state == SLOT_EMPTY || !slot_is_dirty(slot) || (!first && slot->page <= after))
+				continue;
+			if (!next || slot->page < next->page)
+				next = slot;
+		}
+		if (!next)
+			break;
+
+		after = next->page;
+		first = 0;
+		mcp2221_error_code_t err = write_back(map, next);
+		if (err != MCP2221_ERR_OK)
+			return err;
+	}
+
+	return wait_write_cycle(map);
+}
+
+void mcp2221_eeprom_map_invalidate(mcp2221_eeprom_map_t *map) {
+	if (!map)
+		return;
+
+	for (size_t i = 0; i < map->slot_count; ++i) {
+		if (!slot_is_dirty(&map->slots[i]))
+			map->slots[i].state = SLOT_EMPTY;
+	}
+	map->next_page = EEPROM_NO_PAGE;
+}
+
+mcp2221_error_code_t mcp2221_eeprom_map_get_stats(const mcp2221_eeprom_map_t *map, mcp2221_eeprom_map_stats_t *stats) {
+	if (!map || !stats)
+		return MCP2221_ERR_INVALID;
+
+	*stats = map->stats;
+	stats->dirty_pages = 0;
+	stats->dirty_bytes = 0;
+	for (size_t i = 0; i < map->slot_count; ++i) {
+		const eeprom_slot_t *slot = &map->slots[i];
+		if (slot->state != SLOT_EMPTY && slot_is_dirty(slot)) {
+			stats->dirty_pages++;
+			stats->dirty_bytes += slot->dirty_hi - slot->dirty_lo;
+		}
+	}
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_eeprom_map_reset_stats(mcp2221_eeprom_map_t *map) {
+	if (map)
+		memset(&map->stats, 0, sizeof(map->stats));
+}
@@ -48,6 +48,8 @@ const char *mcp2221_error_code_to_string(mcp2221_error_code_t code) {
 			return "CommandFailedError";
 		case MCP2221_ERR_PROTOCOL:
 			return "ProtocolError";
+		case MCP2221_ERR_PEC:
+			return "PECError";
 		case MCP2221_ERR_GENERIC:
 		default:
 			return "GenericError";
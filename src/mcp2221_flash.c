@@ -10,14 +10,8 @@ mcp2221_error_code_t mcp2221_flash_read(mcp2221_t *dev, uint8_t section, uint8_t
 	if (!dev || !out)
 		return MCP2221_ERR_INVALID;
 
-	uint8_t buf[MCP2221_PACKET_SIZE] = {0};
-	buf[0] = MCP2221_CMD_READ_FLASH_DATA;
-	buf[1] = section;
-
 	uint8_t resp[MCP2221_PACKET_SIZE];
-	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_safe(dev, buf, MCP2221_PACKET_SIZE, resp);
-	if (err == MCP2221_ERR_COMMAND_FAILED)
-		return MCP2221_ERR_FLASH_READ;
+	mcp2221_error_code_t err = mcp2221_internal_flash_read_response(dev, section, 0, resp);
 	if (err)
 		return err;
 
@@ -66,3 +60,7 @@ mcp2221_error_code_t mcp2221_flash_send_password(mcp2221_t *dev, const uint8_t p
 
 	return MCP2221_ERR_OK;
 }
+
+void mcp2221_flash_cache_invalidate(mcp2221_t *dev) {
+	mcp2221_internal_flash_cache_invalidate(dev);
+}
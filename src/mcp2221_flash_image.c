@@ -0,0 +1,510 @@
+#include "mcp2221_flash_image.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mcp2221_flash.h"
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_constants.h"
+
+// Chip-settings bytes compared and written from the image: CDC/security through the requested USB current.
+#define CHIP_COMPARED_BYTES (MCP2221_FLASH_CHIP_SETTINGS_USBMA + 1)
+#define CHIP_PROTECTION_MASK 0x03u
+
+#define IMAGE_SECTIONS_VALID (MCP2221_FLASH_IMAGE_ALL | MCP2221_FLASH_IMAGE_PASSWORD)
+
+// File layout, see mcp2221_flash_image_save().
+#define IMAGE_FILE_VERSION  1
+#define IMAGE_FILE_CHIP     8
+#define IMAGE_FILE_GP       (IMAGE_FILE_CHIP + 60)
+#define IMAGE_FILE_STRINGS  (IMAGE_FILE_GP + 60)
+#define IMAGE_FILE_PASSWORD (IMAGE_FILE_STRINGS + 3 * 128)
+#define IMAGE_FILE_CRC      (IMAGE_FILE_PASSWORD + 8)
+#define IMAGE_FILE_SIZE     (IMAGE_FILE_CRC + 4)
+
+static const uint8_t image_magic[4] = {'M', 'C', 'P', 'F'};
+
+// A USB string section as it is compared and written.
+typedef struct {
+	unsigned bit;
+	uint8_t section;
+	int units;
+	uint8_t utf16[2 * MCP2221_FLASH_IMAGE_STRING_MAX];
+} string_section_t;
+
+// An image validated and encoded for one device.
+typedef struct {
+	string_section_t strings[3];
+	int string_count;
+	char serial[128];
+} prepared_image_t;
+
+static uint32_t crc32_ieee(const uint8_t *data, size_t len) {
+	uint32_t crc = 0xFFFFFFFFu;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (0xEDB88320u & (uint32_t)-(int32_t)(crc & 1u));
+	}
+	return ~crc;
+}
+
+static int string_terminated(const char *s, size_t size) {
+	return memchr(s, '\0', size) != NULL;
+}
+
+mcp2221_error_code_t mcp2221_flash_image_expand_serial(const mcp2221_flash_image_t *image, uint32_t serial_number,
+						       char *out, size_t out_len) {
+	if (!image || !out || out_len == 0 || !string_terminated(image->usb_serial, sizeof(image->usb_serial)))
+		return MCP2221_ERR_INVALID;
+
+	const char *tmpl = image->usb_serial;
+	const char *run = strchr(tmpl, '#');
+	char serial[sizeof(image->usb_serial)];
+
+	if (!run) {
+		memcpy(serial, tmpl, strlen(tmpl) + 1);
+	} else {
+		size_t width = strspn(run, "#");
+		char digits[16];
+		int n = snprintf(digits, sizeof(digits), "%0*lu", (int)width, (unsigned long)serial_number);
+		if (n < 0 || (size_t)n != width)
+			return MCP2221_ERR_INVALID;
+		// The digits replace the run one for one, so the length is unchanged.
+		memcpy(serial, tmpl, strlen(tmpl) + 1);
+		memcpy(&serial[run - tmpl], digits, width);
+	}
+
+	if (strlen(serial) >= out_len || mcp2221_internal_utf8_to_utf16le(serial, NULL, MCP2221_FLASH_IMAGE_STRING_MAX) < 0)
+		return MCP2221_ERR_INVALID;
+
+	memcpy(out, serial, strlen(serial) + 1);
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_error_code_t add_string(prepared_image_t *prep, unsigned bit, uint8_t section, const char *text) {
+	string_section_t *s = &prep->strings[prep->string_count];
+	s->bit = bit;
+	s->section = section;
+	s->units = mcp2221_internal_utf8_to_utf16le(text, s->utf16, MCP2221_FLASH_IMAGE_STRING_MAX);
+	if (s->units < 0)
+		return MCP2221_ERR_INVALID;
+	prep->string_count++;
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_error_code_t prepare_image(const mcp2221_flash_image_t *image, uint32_t serial_number, prepared_image_t *prep) {
+	memset(prep, 0, sizeof(*prep));
+
+	if ((image->sections & ~IMAGE_SECTIONS_VALID) != 0)
+		return MCP2221_ERR_INVALID;
+
+	if (image->sections & MCP2221_FLASH_IMAGE_CHIP_SETTINGS) {
+		uint8_t protection = image->chip_settings[MCP2221_FLASH_CHIP_SETTINGS_CDCSEC] & CHIP_PROTECTION_MASK;
+		// Never lock a part for good, nor protect it with a password nobody knows.
+		if (protection == MCP2221_CDCSEC_CHIPPROT_LOCKED || protection == MCP2221_CDCSEC_CHIPPROT_RESERVED)
+			return MCP2221_ERR_INVALID;
+		if (protection == MCP2221_CDCSEC_CHIPPROT_PROTECTED && !(image->sections & MCP2221_FLASH_IMAGE_PASSWORD))
+			return MCP2221_ERR_INVALID;
+	}
+
+	mcp2221_error_code_t err = MCP2221_ERR_OK;
+	if (image->sections & MCP2221_FLASH_IMAGE_USB_MANUFACTURER) {
+		err = string_terminated(image->usb_manufacturer, sizeof(image->usb_manufacturer))
+			      ? add_string(prep, MCP2221_FLASH_IMAGE_USB_MANUFACTURER, MCP2221_FLASH_DATA_USB_MANUFACTURER,
+					   image->usb_manufacturer)
+			      : MCP2221_ERR_INVALID;
+	}
+	if (err == MCP2221_ERR_OK && (image->sections & MCP2221_FLASH_IMAGE_USB_PRODUCT)) {
+		err = string_terminated(image->usb_product, sizeof(image->usb_product))
+			      ? add_string(prep, MCP2221_FLASH_IMAGE_USB_PRODUCT, MCP2221_FLASH_DATA_USB_PRODUCT,
+					   image->usb_product)
+			      : MCP2221_ERR_INVALID;
+	}
+	if (err == MCP2221_ERR_OK && (image->sections & MCP2221_FLASH_IMAGE_USB_SERIAL)) {
+		err = mcp2221_flash_image_expand_serial(image, serial_number, prep->serial, sizeof(prep->serial));
+		if (err == MCP2221_ERR_OK)
+			err = add_string(prep, MCP2221_FLASH_IMAGE_USB_SERIAL, MCP2221_FLASH_DATA_USB_SERIALNUM, prep->serial);
+	}
+	return err;
+}
+
+static int string_matches(const string_section_t *s, const uint8_t *resp) {
+	return resp[2] == 2 * s->units + 2 && memcmp(&resp[4], s->utf16, 2 * (size_t)s->units) == 0;
+}
+
+static int chip_matches(const mcp2221_flash_image_t *image, const uint8_t chip[60]) {
+	return memcmp(chip, image->chip_settings, CHIP_COMPARED_BYTES) == 0;
+}
+
+static int gp_matches(const mcp2221_flash_image_t *image, const uint8_t gp[60]) {
+	return memcmp(&gp[MCP2221_FLASH_GP_SETTINGS_GP0], &image->gp_settings[MCP2221_FLASH_GP_SETTINGS_GP0], 4) == 0;
+}
+
+static mcp2221_error_code_t write_string(mcp2221_t *dev, const string_section_t *s) {
+	uint8_t buf[MCP2221_PACKET_SIZE] = {0};
+	buf[0] = MCP2221_CMD_WRITE_FLASH_DATA;
+	buf[1] = s->section;
+	buf[2] = (uint8_t)(2 * s->units + 2);
+	buf[3] = 0x03; // USB string descriptor type
+	memcpy(&buf[4], s->utf16, 2 * (size_t)s->units);
+
+	uint8_t resp[MCP2221_PACKET_SIZE];
+	mcp2221_error_code_t err = mcp2221_send_cmd(dev, buf, MCP2221_PACKET_SIZE, resp);
+	if (err == MCP2221_ERR_COMMAND_FAILED)
+		return MCP2221_ERR_FLASH_WRITE;
+	return err;
+}
+
+mcp2221_error_code_t mcp2221_flash_image_capture(mcp2221_t *dev, mcp2221_flash_image_t *image) {
+	if (!dev || !image)
+		return MCP2221_ERR_INVALID;
+
+	memset(image, 0, sizeof(*image));
+
+	mcp2221_error_code_t err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, image->chip_settings);
+	if (err == MCP2221_ERR_OK)
+		err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_GP_SETTINGS, image->gp_settings);
+	if (err != MCP2221_ERR_OK)
+		return err;
+	memset(&image->chip_settings[MCP2221_FLASH_CHIP_SETTINGS_PWD1], 0, 8);
+
+	static const struct {
+		uint8_t section;
+		size_t offset;
+	} strings[] = {
+		{MCP2221_FLASH_DATA_USB_MANUFACTURER, offsetof(mcp2221_flash_image_t, usb_manufacturer)},
+		{MCP2221_FLASH_DATA_USB_PRODUCT, offsetof(mcp2221_flash_image_t, usb_product)},
+		{MCP2221_FLASH_DATA_USB_SERIALNUM, offsetof(mcp2221_flash_image_t, usb_serial)},
+	};
+	for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+		uint8_t resp[MCP2221_PACKET_SIZE];
+		err = mcp2221_internal_flash_read_response(dev, strings[i].section, 1, resp);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		mcp2221_internal_parse_wchar_structure(resp, (char *)image + strings[i].offset, 128);
+	}
+
+	image->sections = MCP2221_FLASH_IMAGE_ALL;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_flash_image_verify(mcp2221_t *dev, const mcp2221_flash_image_t *image,
+						uint32_t serial_number, unsigned *out_mismatch) {
+	if (out_mismatch)
+		*out_mismatch = 0;
+	if (!dev || !image || !out_mismatch)
+		return MCP2221_ERR_INVALID;
+
+	prepared_image_t prep;
+	mcp2221_error_code_t err = prepare_image(image, serial_number, &prep);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	uint8_t data[60];
+	if (image->sections & MCP2221_FLASH_IMAGE_CHIP_SETTINGS) {
+		err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, data);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		if (!chip_matches(image, data))
+			*out_mismatch |= MCP2221_FLASH_IMAGE_CHIP_SETTINGS;
+	}
+
+	if (image->sections & MCP2221_FLASH_IMAGE_GP_SETTINGS) {
+		err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_GP_SETTINGS, data);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		if (!gp_matches(image, data))
+			*out_mismatch |= MCP2221_FLASH_IMAGE_GP_SETTINGS;
+	}
+
+	for (int i = 0; i < prep.string_count; i++) {
+		uint8_t resp[MCP2221_PACKET_SIZE];
+		err = mcp2221_internal_flash_read_response(dev, prep.strings[i].section, 0, resp);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		if (!string_matches(&prep.strings[i], resp))
+			*out_mismatch |= prep.strings[i].bit;
+	}
+
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_error_code_t apply_gp(mcp2221_t *dev, const mcp2221_flash_image_t *image, mcp2221_flash_image_result_t *r) {
+	uint8_t gp[60];
+	mcp2221_error_code_t err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_GP_SETTINGS, gp);
+	if (err != MCP2221_ERR_OK)
+		return err;
+	if (gp_matches(image, gp)) {
+		r->skipped |= MCP2221_FLASH_IMAGE_GP_SETTINGS;
+		return MCP2221_ERR_OK;
+	}
+
+	memcpy(&gp[MCP2221_FLASH_GP_SETTINGS_GP0], &image->gp_settings[MCP2221_FLASH_GP_SETTINGS_GP0], 4);
+	err = mcp2221_flash_write(dev, MCP2221_FLASH_DATA_GP_SETTINGS, gp);
+	if (err == MCP2221_ERR_OK)
+		err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_GP_SETTINGS, gp);
+	if (err != MCP2221_ERR_OK)
+		return err;
+	if (!gp_matches(image, gp))
+		return MCP2221_ERR_FLASH_WRITE;
+
+	r->written |= MCP2221_FLASH_IMAGE_GP_SETTINGS;
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_error_code_t apply_string(mcp2221_t *dev, const string_section_t *s, mcp2221_flash_image_result_t *r) {
+	uint8_t resp[MCP2221_PACKET_SIZE];
+	mcp2221_error_code_t err = mcp2221_internal_flash_read_response(dev, s->section, 0, resp);
+	if (err != MCP2221_ERR_OK)
+		return err;
+	if (string_matches(s, resp)) {
+		r->skipped |= s->bit;
+		return MCP2221_ERR_OK;
+	}
+
+	err = write_string(dev, s);
+	if (err == MCP2221_ERR_OK)
+		err = mcp2221_internal_flash_read_response(dev, s->section, 0, resp);
+	if (err != MCP2221_ERR_OK)
+		return err;
+	if (!string_matches(s, resp))
+		return MCP2221_ERR_FLASH_WRITE;
+
+	r->written |= s->bit;
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_error_code_t apply_chip(mcp2221_t *dev, const mcp2221_flash_image_t *image, const uint8_t current[60],
+				       int password_confirmed, mcp2221_flash_image_result_t *r) {
+	// The password cannot be read back; it is known to match only once the device accepted it.
+	int has_password = (image->sections & MCP2221_FLASH_IMAGE_PASSWORD) != 0;
+	if (chip_matches(image, current) && (!has_password || password_confirmed)) {
+		r->skipped |= MCP2221_FLASH_IMAGE_CHIP_SETTINGS;
+		return MCP2221_ERR_OK;
+	}
+
+	uint8_t chip[60];
+	memcpy(chip, current, sizeof(chip));
+	memcpy(chip, image->chip_settings, CHIP_COMPARED_BYTES);
+	if (has_password) {
+		memcpy(&chip[MCP2221_FLASH_CHIP_SETTINGS_PWD1], image->password, 8);
+	} else {
+		// Keep the current password, as mcp2221_flash_save_config() does.
+		uint8_t sram[MCP2221_PACKET_SIZE];
+		mcp2221_error_code_t err = mcp2221_internal_sram_read(dev, sram);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		memcpy(&chip[MCP2221_FLASH_CHIP_SETTINGS_PWD1],
+		       &sram[MCP2221_SRAM_OFFSET_CHIP_SETTINGS + MCP2221_SRAM_CHIP_SETTINGS_PWD1], 8);
+	}
+
+	mcp2221_error_code_t err = mcp2221_flash_write(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, chip);
+	if (err == MCP2221_ERR_OK)
+		err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, chip);
+	if (err != MCP2221_ERR_OK)
+		return err;
+	if (!chip_matches(image, chip))
+		return MCP2221_ERR_FLASH_WRITE;
+
+	r->written |= MCP2221_FLASH_IMAGE_CHIP_SETTINGS;
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_error_code_t apply_steps(mcp2221_t *dev, const mcp2221_flash_image_t *image, const prepared_image_t *prep,
+					mcp2221_flash_image_result_t *r) {
+	uint8_t chip[60];
+	mcp2221_error_code_t err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, chip);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	int password_confirmed = 0;
+	uint8_t protection = chip[MCP2221_FLASH_CHIP_SETTINGS_CDCSEC] & CHIP_PROTECTION_MASK;
+	if (protection == MCP2221_CDCSEC_CHIPPROT_LOCKED || protection == MCP2221_CDCSEC_CHIPPROT_RESERVED)
+		return MCP2221_ERR_ACCESS;
+	if (protection == MCP2221_CDCSEC_CHIPPROT_PROTECTED) {
+		if (!(image->sections & MCP2221_FLASH_IMAGE_PASSWORD))
+			return MCP2221_ERR_FLASH_PASSWD;
+		err = mcp2221_flash_send_password(dev, image->password);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		password_confirmed = 1;
+	}
+
+	if (image->sections & MCP2221_FLASH_IMAGE_GP_SETTINGS) {
+		err = apply_gp(dev, image, r);
+		if (err != MCP2221_ERR_OK)
+			return err;
+	}
+
+	for (int i = 0; i < prep->string_count; i++) {
+		err = apply_string(dev, &prep->strings[i], r);
+		if (err != MCP2221_ERR_OK)
+			return err;
+	}
+
+	// Last: it may enable password protection.
+	if (image->sections & MCP2221_FLASH_IMAGE_CHIP_SETTINGS)
+		err = apply_chip(dev, image, chip, password_confirmed, r);
+	return err;
+}
+
+mcp2221_error_code_t mcp2221_flash_image_apply(mcp2221_t *dev, const mcp2221_flash_image_t *image,
+					       uint32_t serial_number, mcp2221_flash_image_result_t *result) {
+	mcp2221_flash_image_result_t r;
+	memset(&r, 0, sizeof(r));
+
+	mcp2221_error_code_t err = MCP2221_ERR_INVALID;
+	prepared_image_t prep;
+	if (dev && image) {
+		err = prepare_image(image, serial_number, &prep);
+		if (err == MCP2221_ERR_OK) {
+			memcpy(r.usb_serial, prep.serial, sizeof(r.usb_serial));
+			err = apply_steps(dev, image, &prep, &r);
+		}
+	}
+
+	r.error = err;
+	if (result)
+		*result = r;
+	return err;
+}
+
+typedef struct {
+	mcp2221_t *dev;
+	const mcp2221_flash_image_t *image;
+	uint32_t serial_number;
+	mcp2221_flash_image_result_t *result;
+} apply_job_t;
+
+static void *apply_worker(void *arg) {
+	apply_job_t *job = arg;
+	mcp2221_flash_image_apply(job->dev, job->image, job->serial_number, job->result);
+	return NULL;
+}
+
+mcp2221_error_code_t mcp2221_flash_image_apply_many(mcp2221_t *const *devs, size_t count,
+						    const mcp2221_flash_image_t *image, uint32_t first_serial,
+						    mcp2221_flash_image_result_t *results) {
+	if (!devs || count == 0 || !image || !results)
+		return MCP2221_ERR_INVALID;
+
+	// A handle used by two workers at once would interleave their commands.
+	for (size_t i = 0; i < count; i++) {
+		if (!devs[i])
+			return MCP2221_ERR_INVALID;
+		for (size_t j = 0; j < i; j++) {
+			if (devs[i] == devs[j])
+				return MCP2221_ERR_INVALID;
+		}
+	}
+
+	apply_job_t *jobs = calloc(count, sizeof(*jobs));
+	pthread_t *threads = calloc(count, sizeof(*threads));
+	unsigned char *started = calloc(count, 1);
+	if (!jobs || !threads || !started) {
+		free(jobs);
+		free(threads);
+		free(started);
+		return MCP2221_ERR_NO_MEMORY;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		jobs[i].dev = devs[i];
+		jobs[i].image = image;
+		jobs[i].serial_number = first_serial + (uint32_t)i;
+		jobs[i].result = &results[i];
+		started[i] = pthread_create(&threads[i], NULL, apply_worker, &jobs[i]) == 0;
+	}
+
+	// Devices whose thread could not be created are programmed here, while the others run.
+	for (size_t i = 0; i < count; i++) {
+		if (!started[i])
+			apply_worker(&jobs[i]);
+	}
+
+	mcp2221_error_code_t err = MCP2221_ERR_OK;
+	for (size_t i = 0; i < count; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+	}
+	for (size_t i = 0; i < count && err == MCP2221_ERR_OK; i++)
+		err = results[i].error;
+
+	free(jobs);
+	free(threads);
+	free(started);
+	return err;
+}
+
+mcp2221_error_code_t mcp2221_flash_image_save(const char *path, const mcp2221_flash_image_t *image) {
+	if (!path || !image || (image->sections & ~IMAGE_SECTIONS_VALID) != 0 ||
+	    !string_terminated(image->usb_manufacturer, sizeof(image->usb_manufacturer)) ||
+	    !string_terminated(image->usb_product, sizeof(image->usb_product)) ||
+	    !string_terminated(image->usb_serial, sizeof(image->usb_serial)))
+		return MCP2221_ERR_INVALID;
+
+	uint8_t buf[IMAGE_FILE_SIZE] = {0};
+	memcpy(buf, image_magic, sizeof(image_magic));
+	buf[4] = IMAGE_FILE_VERSION;
+	buf[5] = (uint8_t)image->sections;
+	memcpy(&buf[IMAGE_FILE_CHIP], image->chip_settings, 60);
+	memcpy(&buf[IMAGE_FILE_GP], image->gp_settings, 60);
+	strcpy((char *)&buf[IMAGE_FILE_STRINGS], image->usb_manufacturer);
+	strcpy((char *)&buf[IMAGE_FILE_STRINGS + 128], image->usb_product);
+	strcpy((char *)&buf[IMAGE_FILE_STRINGS + 256], image->usb_serial);
+	memcpy(&buf[IMAGE_FILE_PASSWORD], image->password, 8);
+
+	uint32_t crc = crc32_ieee(buf, IMAGE_FILE_CRC);
+	for (int i = 0; i < 4; i++)
+		buf[IMAGE_FILE_CRC + i] = (uint8_t)(crc >> (8 * i));
+
+	FILE *f = fopen(path, "wb");
+	if (!f)
+		return MCP2221_ERR_GENERIC;
+	size_t written = fwrite(buf, 1, sizeof(buf), f);
+	if (fclose(f) != 0 || written != sizeof(buf))
+		return MCP2221_ERR_GENERIC;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_flash_image_load(const char *path, mcp2221_flash_image_t *image) {
+	if (!path || !image)
+		return MCP2221_ERR_INVALID;
+
+	FILE *f = fopen(path, "rb");
+	if (!f)
+		return MCP2221_ERR_NOT_FOUND;
+
+	// One byte more than an image, to detect longer files.
+	uint8_t buf[IMAGE_FILE_SIZE + 1];
+	size_t len = fread(buf, 1, sizeof(buf), f);
+	fclose(f);
+
+	if (len != IMAGE_FILE_SIZE || memcmp(buf, image_magic, sizeof(image_magic)) != 0 ||
+	    buf[4] != IMAGE_FILE_VERSION || (buf[5] & ~IMAGE_SECTIONS_VALID) != 0)
+		return MCP2221_ERR_INVALID;
+
+	uint32_t crc = 0;
+	for (int i = 0; i < 4; i++)
+		crc |= (uint32_t)buf[IMAGE_FILE_CRC + i] << (8 * i);
+	if (crc != crc32_ieee(buf, IMAGE_FILE_CRC))
+		return MCP2221_ERR_INVALID;
+
+	for (int i = 0; i < 3; i++) {
+		if (buf[IMAGE_FILE_STRINGS + 128 * i + 127] != '\0')
+			return MCP2221_ERR_INVALID;
+	}
+
+	memset(image, 0, sizeof(*image));
+	image->sections = buf[5];
+	memcpy(image->chip_settings, &buf[IMAGE_FILE_CHIP], 60);
+	memcpy(image->gp_settings, &buf[IMAGE_FILE_GP], 60);
+	memcpy(image->usb_manufacturer, &buf[IMAGE_FILE_STRINGS], 128);
+	memcpy(image->usb_product, &buf[IMAGE_FILE_STRINGS + 128], 128);
+	memcpy(image->usb_serial, &buf[IMAGE_FILE_STRINGS + 256], 128);
+	memcpy(image->password, &buf[IMAGE_FILE_PASSWORD], 8);
+	return MCP2221_ERR_OK;
+}
@@ -7,6 +7,22 @@
 #include "mcp2221_internal_constants.h"
 #include "mcp2221_flash.h"
 
+// Chip-settings bytes that decide whether the section is rewritten: CDC/security through the
+// requested USB current. The password bytes read back from flash are not the stored password.
+#define CHIP_COMPARED_BYTES (MCP2221_FLASH_CHIP_SETTINGS_USBMA + 1)
+
+// Helper: read a string section through the flash cache into its raw payload and decoded text.
+static mcp2221_error_code_t read_string_section(mcp2221_t *dev, uint8_t section, uint8_t raw[60], char *str, size_t str_len) {
+	uint8_t resp[MCP2221_PACKET_SIZE];
+	mcp2221_error_code_t err = mcp2221_internal_flash_read_response(dev, section, 1, resp);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	memcpy(raw, &resp[MCP2221_FLASH_OFFSET_READ], 60);
+	mcp2221_internal_parse_wchar_structure(resp, str, str_len);
+	return MCP2221_ERR_OK;
+}
+
 mcp2221_error_code_t mcp2221_flash_read_info(mcp2221_t *dev, mcp2221_flash_info_t *info) {
 	if (!dev || !info)
 		return MCP2221_ERR_INVALID;
@@ -22,31 +38,32 @@ mcp2221_error_code_t mcp2221_flash_read_info(mcp2221_t *dev, mcp2221_flash_info_
 	if (err != MCP2221_ERR_OK)
 		return err;
 
-	err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_USB_MANUFACTURER, info->usb_manufacturer);
+	err = read_string_section(dev, MCP2221_FLASH_DATA_USB_MANUFACTURER, info->usb_manufacturer,
+				  info->usb_manufacturer_str, sizeof(info->usb_manufacturer_str));
 	if (err != MCP2221_ERR_OK)
 		return err;
 
-	err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_USB_PRODUCT, info->usb_product);
+	err = read_string_section(dev, MCP2221_FLASH_DATA_USB_PRODUCT, info->usb_product,
+				  info->usb_product_str, sizeof(info->usb_product_str));
 	if (err != MCP2221_ERR_OK)
 		return err;
 
-	err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_USB_SERIALNUM, info->usb_serial);
+	err = read_string_section(dev, MCP2221_FLASH_DATA_USB_SERIALNUM, info->usb_serial,
+				  info->usb_serial_str, sizeof(info->usb_serial_str));
 	if (err != MCP2221_ERR_OK)
 		return err;
 
-	err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_CHIP_SERIALNUM, info->usb_factory_serial);
-	if (err != MCP2221_ERR_OK)
-		return err;
-
-	mcp2221_internal_parse_wchar_structure(info->usb_manufacturer, info->usb_manufacturer_str, sizeof(info->usb_manufacturer_str));
-	mcp2221_internal_parse_wchar_structure(info->usb_product, info->usb_product_str, sizeof(info->usb_product_str));
-	mcp2221_internal_parse_wchar_structure(info->usb_serial, info->usb_serial_str, sizeof(info->usb_serial_str));
-	mcp2221_internal_parse_wchar_structure(info->usb_factory_serial, info->usb_factory_serial_str, sizeof(info->usb_factory_serial_str));
-
-	return MCP2221_ERR_OK;
+	return read_string_section(dev, MCP2221_FLASH_DATA_CHIP_SERIALNUM, info->usb_factory_serial,
+				   info->usb_factory_serial_str, sizeof(info->usb_factory_serial_str));
 }
 
 mcp2221_error_code_t mcp2221_flash_save_config(mcp2221_t *dev) {
+	return mcp2221_flash_save_config_ex(dev, NULL);
+}
+
+mcp2221_error_code_t mcp2221_flash_save_config_ex(mcp2221_t *dev, unsigned *out_written) {
+	if (out_written)
+		*out_written = 0;
 	if (!dev)
 		return MCP2221_ERR_INVALID;
 
@@ -61,10 +78,13 @@ mcp2221_error_code_t mcp2221_flash_save_config(mcp2221_t *dev) {
 	if (err != MCP2221_ERR_OK)
 		return err;
 
+	uint8_t chip_flash[60], gp_flash[60];
+	memcpy(chip_flash, chip, sizeof(chip_flash));
+	memcpy(gp_flash, gp, sizeof(gp_flash));
+
 	// Read current SRAM
-	uint8_t cmd = MCP2221_CMD_GET_SRAM_SETTINGS;
 	uint8_t sram[64];
-	err = mcp2221_internal_send_cmd_retry_safe(dev, &cmd, 1, sram);
+	err = mcp2221_internal_sram_read(dev, sram);
 	if (err != MCP2221_ERR_OK)
 		return err;
 
@@ -83,22 +103,23 @@ mcp2221_error_code_t mcp2221_flash_save_config(mcp2221_t *dev) {
 	}
 
 	// Map SRAM -> Flash chip settings (see Python save_config)
-	chip[MCP2221_FLASH_CHIP_SETTINGS_CDCSEC] = sram[MCP2221_SRAM_CHIP_SETTINGS_CDCSEC];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_CLOCK] = sram[MCP2221_SRAM_CHIP_SETTINGS_CLOCK];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_DAC] = sram[MCP2221_SRAM_CHIP_SETTINGS_DAC];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_INT_ADC] = sram[MCP2221_SRAM_CHIP_SETTINGS_INT_ADC];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_LVID] = sram[MCP2221_SRAM_CHIP_SETTINGS_LVID];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_HVID] = sram[MCP2221_SRAM_CHIP_SETTINGS_HVID];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_LPID] = sram[MCP2221_SRAM_CHIP_SETTINGS_LPID];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_HPID] = sram[MCP2221_SRAM_CHIP_SETTINGS_HPID];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD1] = sram[MCP2221_SRAM_CHIP_SETTINGS_PWD1];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD2] = sram[MCP2221_SRAM_CHIP_SETTINGS_PWD2];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD3] = sram[MCP2221_SRAM_CHIP_SETTINGS_PWD3];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD4] = sram[MCP2221_SRAM_CHIP_SETTINGS_PWD4];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD5] = sram[MCP2221_SRAM_CHIP_SETTINGS_PWD5];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD6] = sram[MCP2221_SRAM_CHIP_SETTINGS_PWD6];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD7] = sram[MCP2221_SRAM_CHIP_SETTINGS_PWD7];
-	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD8] = sram[MCP2221_SRAM_CHIP_SETTINGS_PWD8];
+	const uint8_t *sram_chip = &sram[MCP2221_SRAM_OFFSET_CHIP_SETTINGS];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_CDCSEC] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_CDCSEC];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_CLOCK] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_CLOCK];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_DAC] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_DAC];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_INT_ADC] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_INT_ADC];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_LVID] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_LVID];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_HVID] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_HVID];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_LPID] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_LPID];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_HPID] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_HPID];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD1] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_PWD1];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD2] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_PWD2];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD3] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_PWD3];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD4] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_PWD4];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD5] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_PWD5];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD6] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_PWD6];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD7] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_PWD7];
+	chip[MCP2221_FLASH_CHIP_SETTINGS_PWD8] = sram_chip[MCP2221_SRAM_CHIP_SETTINGS_PWD8];
 
 	/*
 	 * USBPWRATTR and USBREQCRT are enumeration-time settings. Keep the values
@@ -125,13 +146,21 @@ mcp2221_error_code_t mcp2221_flash_save_config(mcp2221_t *dev) {
 		return err;
 	chip[MCP2221_FLASH_CHIP_SETTINGS_USBMA] = usb_value;
 
-	// Write back
-	err = mcp2221_flash_write(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, chip);
-	if (err != MCP2221_ERR_OK)
-		return err;
-	err = mcp2221_flash_write(dev, MCP2221_FLASH_DATA_GP_SETTINGS, gp);
-	if (err != MCP2221_ERR_OK)
-		return err;
+	// Write back only the sections that change; each program cycle wears the part
+	if (memcmp(chip, chip_flash, CHIP_COMPARED_BYTES) != 0) {
+		err = mcp2221_flash_write(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, chip);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		if (out_written)
+			*out_written |= MCP2221_FLASH_SAVED_CHIP_SETTINGS;
+	}
+	if (memcmp(gp, gp_flash, sizeof(gp)) != 0) {
+		err = mcp2221_flash_write(dev, MCP2221_FLASH_DATA_GP_SETTINGS, gp);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		if (out_written)
+			*out_written |= MCP2221_FLASH_SAVED_GP_SETTINGS;
+	}
 
 	// Clear staged USB settings only after the complete save succeeded.
 	mcp2221_internal_usb_state_clear(usb);
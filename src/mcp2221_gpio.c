@@ -1,8 +1,10 @@
 #include "mcp2221_gpio.h"
+#include <stdlib.h>
 #include <string.h>
 
 #include "mcp2221_internal_constants.h"
 #include "mcp2221_internal.h"
+#include "mcp2221_internal_gpio.h"
 
 // Internal helpers implemented in src/mcp2221.c (not part of the public API)
 
@@ -15,21 +17,35 @@
 #define MCP2221_GPIO_ALTER_VALUE 1
 #define MCP2221_GPIO_PRESERVE_VALUE 0
 #define MCP2221_GPIO_ERROR 0xEE
+#define MCP2221_GPIO_WRITE_PACKET_SIZE 18
 
 static int is_valid_gpio_write_value(int value) {
 	return value == MCP2221_GPIO_KEEP || value == 0 || value == 1;
 }
 
-mcp2221_error_code_t mcp2221_gpio_write(mcp2221_t *dev, const mcp2221_gpio_write_t *wr) {
-	if (!dev || !wr)
-		return MCP2221_ERR_INVALID;
-	if (!is_valid_gpio_write_value(wr->gp0) ||
-	    !is_valid_gpio_write_value(wr->gp1) ||
-	    !is_valid_gpio_write_value(wr->gp2) ||
-	    !is_valid_gpio_write_value(wr->gp3))
-		return MCP2221_ERR_INVALID;
+// Helper: nonzero when every requested pin already drives the requested level.
+static int write_is_redundant(const mcp2221_internal_gpio_write_state_t *ws, const int req[4]) {
+	for (int i = 0; i < 4; ++i) {
+		if (req[i] < 0)
+			continue;
+		if (!(ws->known_mask & (1u << i)))
+			return 0;
+		if (((ws->known_values >> i) & 1u) != (unsigned)req[i])
+			return 0;
+	}
+	return 1;
+}
 
-	uint8_t buf[18] = {0};
+static int is_valid_gpio_write(const mcp2221_gpio_write_t *wr) {
+	return is_valid_gpio_write_value(wr->gp0) &&
+	       is_valid_gpio_write_value(wr->gp1) &&
+	       is_valid_gpio_write_value(wr->gp2) &&
+	       is_valid_gpio_write_value(wr->gp3);
+}
+
+// Helper: build the SET_GPIO_OUTPUT_VALUES packet for one write request.
+static void build_gpio_write(const mcp2221_gpio_write_t *wr, uint8_t buf[MCP2221_GPIO_WRITE_PACKET_SIZE]) {
+	memset(buf, 0, MCP2221_GPIO_WRITE_PACKET_SIZE);
 
 	buf[0] = MCP2221_CMD_SET_GPIO_OUTPUT_VALUES;
 
@@ -48,52 +64,184 @@ mcp2221_error_code_t mcp2221_gpio_write(mcp2221_t *dev, const mcp2221_gpio_write
 	// GP3
 	buf[14] = (wr->gp3 < 0) ? MCP2221_GPIO_PRESERVE_VALUE : MCP2221_GPIO_ALTER_VALUE;
 	buf[15] = (wr->gp3 < 0) ? 0 : (wr->gp3 ? 1 : 0);
+}
 
-	uint8_t resp[64];
-	mcp2221_error_code_t err = mcp2221_send_cmd(dev, buf, sizeof(buf), resp);
+/*
+ * Helper: account for one sent SET_GPIO_OUTPUT_VALUES packet and map the
+ * per-pin replies to an error code.
+ */
+static mcp2221_error_code_t finish_gpio_write(mcp2221_t *dev, const uint8_t *buf, mcp2221_error_code_t err,
+					      const uint8_t *resp) {
+	mcp2221_internal_gpio_write_state_t *ws = mcp2221_internal_gpio_get_write_state(dev);
+
+	ws->commands++;
+	// Even a failed exchange may have reached the device.
+	mcp2221_internal_gpio_snapshot_invalidate(mcp2221_internal_gpio_get_snapshot(dev));
+	for (int i = 0; i < 4; ++i) {
+		if (buf[4 * i + 2] != MCP2221_GPIO_ALTER_VALUE)
+			continue;
+		uint8_t bit = (uint8_t)(1u << i);
+		if (err == MCP2221_ERR_OK && resp[4 * i + 3] != MCP2221_GPIO_ERROR) {
+			ws->known_mask |= bit;
+			ws->known_values = (uint8_t)((ws->known_values & ~bit) | (buf[4 * i + 3] ? bit : 0));
+		} else {
+			ws->known_mask &= (uint8_t)~bit;
+		}
+	}
 	if (err)
 		return err;
 
 	// Python behavior: update cached GPIO out state for those that did not error, then raise on first error.
-	// Cache is best-effort; if it can't be initialized, we still return success/failure based on the device reply.
-	(void)mcp2221_internal_ensure_gpio_status(dev);
-	if (wr->gp0 >= 0 && resp[3] != MCP2221_GPIO_ERROR)
-		mcp2221_internal_gpio_status_update_out(dev, 0, buf[3]);
-	if (wr->gp1 >= 0 && resp[7] != MCP2221_GPIO_ERROR)
-		mcp2221_internal_gpio_status_update_out(dev, 1, buf[7]);
-	if (wr->gp2 >= 0 && resp[11] != MCP2221_GPIO_ERROR)
-		mcp2221_internal_gpio_status_update_out(dev, 2, buf[11]);
-	if (wr->gp3 >= 0 && resp[15] != MCP2221_GPIO_ERROR)
-		mcp2221_internal_gpio_status_update_out(dev, 3, buf[15]);
-
-	if (wr->gp0 >= 0 && resp[3] == MCP2221_GPIO_ERROR)
-		return MCP2221_ERR_GPIO_MODE;
-	else if (wr->gp1 >= 0 && resp[7] == MCP2221_GPIO_ERROR)
-		return MCP2221_ERR_GPIO_MODE;
-	else if (wr->gp2 >= 0 && resp[11] == MCP2221_GPIO_ERROR)
-		return MCP2221_ERR_GPIO_MODE;
-	else if (wr->gp3 >= 0 && resp[15] == MCP2221_GPIO_ERROR)
-		return MCP2221_ERR_GPIO_MODE;
+	for (int i = 0; i < 4; ++i) {
+		if (buf[4 * i + 2] == MCP2221_GPIO_ALTER_VALUE && resp[4 * i + 3] != MCP2221_GPIO_ERROR)
+			mcp2221_internal_gpio_status_update_out(dev, i, buf[4 * i + 3]);
+	}
+
+	for (int i = 0; i < 4; ++i) {
+		if (buf[4 * i + 2] == MCP2221_GPIO_ALTER_VALUE && resp[4 * i + 3] == MCP2221_GPIO_ERROR)
+			return MCP2221_ERR_GPIO_MODE;
+	}
 
 	return MCP2221_ERR_OK;
 }
 
-mcp2221_error_code_t mcp2221_gpio_read(mcp2221_t *dev, int out_state[4]) {
-	if (!dev || !out_state)
+mcp2221_error_code_t mcp2221_gpio_write(mcp2221_t *dev, const mcp2221_gpio_write_t *wr) {
+	if (!dev || !wr)
+		return MCP2221_ERR_INVALID;
+	if (!is_valid_gpio_write(wr))
 		return MCP2221_ERR_INVALID;
 
-	uint8_t cmd[1] = {MCP2221_CMD_GET_GPIO_VALUES};
+	uint8_t buf[MCP2221_GPIO_WRITE_PACKET_SIZE];
+	build_gpio_write(wr, buf);
+
+	const int req[4] = {wr->gp0, wr->gp1, wr->gp2, wr->gp3};
+	mcp2221_internal_gpio_write_state_t *ws = mcp2221_internal_gpio_get_write_state(dev);
+	if (ws->elide && write_is_redundant(ws, req)) {
+		ws->elided++;
+		return MCP2221_ERR_OK;
+	}
+
+	// Cache is best-effort; if it can't be initialized, we still return success/failure based on the device reply.
+	// With write elision enabled the cache is only updated when already loaded, keeping SRAM reads off this path.
 	uint8_t resp[64];
+	mcp2221_error_code_t err = mcp2221_send_cmd(dev, buf, sizeof(buf), resp);
+	if (err == MCP2221_ERR_OK && !ws->elide)
+		(void)mcp2221_internal_ensure_gpio_status(dev);
+	return finish_gpio_write(dev, buf, err, resp);
+}
+
+mcp2221_error_code_t mcp2221_gpio_sequence_run(mcp2221_t *dev, const mcp2221_gpio_step_t *steps, size_t n,
+					       uint64_t *out_offsets_us, mcp2221_gpio_sequence_stats_t *stats) {
+	if (stats)
+		memset(stats, 0, sizeof(*stats));
+	if (!dev || (!steps && n > 0))
+		return MCP2221_ERR_INVALID;
+	if (n == 0)
+		return MCP2221_ERR_OK;
+	if (n > SIZE_MAX / MCP2221_GPIO_WRITE_PACKET_SIZE)
+		return MCP2221_ERR_NO_MEMORY;
+
+	for (size_t i = 0; i < n; ++i) {
+		if (!is_valid_gpio_write(&steps[i].write))
+			return MCP2221_ERR_INVALID;
+	}
+
+	uint8_t *packets = malloc(n * MCP2221_GPIO_WRITE_PACKET_SIZE);
+	if (!packets)
+		return MCP2221_ERR_NO_MEMORY;
+	for (size_t i = 0; i < n; ++i)
+		build_gpio_write(&steps[i].write, packets + i * MCP2221_GPIO_WRITE_PACKET_SIZE);
+
+	mcp2221_error_code_t err = MCP2221_ERR_OK;
+	uint64_t start_us = mcp2221_internal_monotonic_ns() / 1000u;
+	uint64_t target_us = start_us;
+	uint64_t lag_sum = 0, lag_min = UINT64_MAX, lag_max = 0;
+	size_t sent = 0, late = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		target_us += steps[i].delay_us;
+		if (mcp2221_internal_monotonic_ns() / 1000u < target_us)
+			mcp2221_internal_sleep_until_ns(target_us * 1000u);
+
+		uint64_t issued_us = mcp2221_internal_monotonic_ns() / 1000u;
+		const uint8_t *buf = packets + i * MCP2221_GPIO_WRITE_PACKET_SIZE;
+		uint8_t resp[64];
+		err = finish_gpio_write(dev, buf, mcp2221_send_cmd(dev, buf, MCP2221_GPIO_WRITE_PACKET_SIZE, resp), resp);
 
-	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_transport(dev, cmd, 1, resp);
+		uint64_t lag = issued_us > target_us ? issued_us - target_us : 0;
+		lag_sum += lag;
+		if (lag < lag_min)
+			lag_min = lag;
+		if (lag > lag_max)
+			lag_max = lag;
+		if (i + 1 < n && issued_us >= target_us + steps[i + 1].delay_us)
+			late++;
+		if (out_offsets_us)
+			out_offsets_us[i] = issued_us - start_us;
+		sent++;
+
+		if (err != MCP2221_ERR_OK)
+			break;
+	}
+
+	if (stats) {
+		stats->steps_sent = sent;
+		stats->duration_us = mcp2221_internal_monotonic_ns() / 1000u - start_us;
+		stats->mean_lag_us = lag_sum / sent;
+		stats->max_lag_us = lag_max;
+		stats->jitter_us = lag_max - lag_min;
+		stats->late_steps = late;
+	}
+
+	free(packets);
+	return err;
+}
+
+static mcp2221_error_code_t fetch_gpio_values(void *ctx, uint8_t values[4]) {
+	uint8_t cmd[1] = {MCP2221_CMD_GET_GPIO_VALUES};
+	uint8_t resp[MCP2221_PACKET_SIZE];
+
+	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_transport((mcp2221_t *)ctx, cmd, 1, resp);
 	if (err)
 		return err;
 
-	out_state[0] = (resp[MCP2221_GPIO_GET_RESP_GP0_VALUE] == MCP2221_GPIO_ERROR) ? -1 : resp[MCP2221_GPIO_GET_RESP_GP0_VALUE];
-	out_state[1] = (resp[MCP2221_GPIO_GET_RESP_GP1_VALUE] == MCP2221_GPIO_ERROR) ? -1 : resp[MCP2221_GPIO_GET_RESP_GP1_VALUE];
-	out_state[2] = (resp[MCP2221_GPIO_GET_RESP_GP2_VALUE] == MCP2221_GPIO_ERROR) ? -1 : resp[MCP2221_GPIO_GET_RESP_GP2_VALUE];
-	out_state[3] = (resp[MCP2221_GPIO_GET_RESP_GP3_VALUE] == MCP2221_GPIO_ERROR) ? -1 : resp[MCP2221_GPIO_GET_RESP_GP3_VALUE];
+	values[0] = resp[MCP2221_GPIO_GET_RESP_GP0_VALUE];
+	values[1] = resp[MCP2221_GPIO_GET_RESP_GP1_VALUE];
+	values[2] = resp[MCP2221_GPIO_GET_RESP_GP2_VALUE];
+	values[3] = resp[MCP2221_GPIO_GET_RESP_GP3_VALUE];
+	return MCP2221_ERR_OK;
+}
 
+mcp2221_error_code_t mcp2221_internal_gpio_read_values(mcp2221_t *dev, uint32_t max_age_us, uint8_t out_values[4],
+						      uint64_t *out_issued_us) {
+	return mcp2221_internal_gpio_snapshot_acquire(mcp2221_internal_gpio_get_snapshot(dev), max_age_us, fetch_gpio_values,
+						      dev, out_values, out_issued_us);
+}
+
+static uint8_t decode_gpio_values(const uint8_t values[4], int out_state[4]) {
+	uint8_t mask = 0;
+
+	for (int i = 0; i < 4; ++i) {
+		if (values[i] == MCP2221_GPIO_ERROR) {
+			out_state[i] = -1;
+		} else {
+			out_state[i] = values[i];
+			mask |= (uint8_t)(1u << i);
+		}
+	}
+	return mask;
+}
+
+mcp2221_error_code_t mcp2221_gpio_read(mcp2221_t *dev, int out_state[4]) {
+	if (!dev || !out_state)
+		return MCP2221_ERR_INVALID;
+
+	uint8_t values[4];
+	mcp2221_error_code_t err = mcp2221_internal_gpio_read_values(dev, 0, values, NULL);
+	if (err)
+		return err;
+
+	(void)decode_gpio_values(values, out_state);
 	return MCP2221_ERR_OK;
 }
 
@@ -101,29 +249,69 @@ mcp2221_error_code_t mcp2221_gpio_read_mask(mcp2221_t *dev, int out_state[4], ui
 	if (!dev || !out_state || !out_valid_mask)
 		return MCP2221_ERR_INVALID;
 
-	uint8_t cmd[1] = {MCP2221_CMD_GET_GPIO_VALUES};
-	uint8_t resp[MCP2221_PACKET_SIZE];
+	uint8_t values[4];
+	mcp2221_error_code_t err = mcp2221_internal_gpio_read_values(dev, 0, values, NULL);
+	if (err)
+		return err;
 
-	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_transport(dev, cmd, 1, resp);
+	*out_valid_mask = decode_gpio_values(values, out_state);
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_gpio_snapshot(mcp2221_t *dev, uint32_t max_age_us, mcp2221_gpio_snapshot_t *out_snapshot) {
+	if (!dev || !out_snapshot)
+		return MCP2221_ERR_INVALID;
+
+	uint8_t values[4];
+	uint64_t issued_us = 0;
+	mcp2221_error_code_t err = mcp2221_internal_gpio_read_values(dev, max_age_us, values, &issued_us);
 	if (err)
 		return err;
 
-	uint8_t mask = 0;
+	out_snapshot->valid_mask = decode_gpio_values(values, out_snapshot->values);
+	out_snapshot->timestamp_us = issued_us;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_gpio_set_write_elision(mcp2221_t *dev, int enable) {
+	if (!dev)
+		return;
+	mcp2221_internal_gpio_write_state_t *ws = mcp2221_internal_gpio_get_write_state(dev);
+	ws->elide = enable ? 1 : 0;
+	ws->known_mask = 0;
+}
+
+mcp2221_error_code_t mcp2221_gpio_get_write_stats(mcp2221_t *dev, mcp2221_gpio_write_stats_t *stats) {
+	if (!dev || !stats)
+		return MCP2221_ERR_INVALID;
+
+	const mcp2221_internal_gpio_write_state_t *ws = mcp2221_internal_gpio_get_write_state(dev);
+	stats->commands = ws->commands;
+	stats->elided = ws->elided;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_gpio_reset_write_stats(mcp2221_t *dev) {
+	if (!dev)
+		return;
+
+	mcp2221_internal_gpio_write_state_t *ws = mcp2221_internal_gpio_get_write_state(dev);
+	ws->commands = 0;
+	ws->elided = 0;
+}
+
+void mcp2221_gpio_snapshot_invalidate(mcp2221_t *dev) {
+	mcp2221_internal_gpio_snapshot_invalidate(mcp2221_internal_gpio_get_snapshot(dev));
+}
+
+mcp2221_error_code_t mcp2221_gpio_snapshot_get_stats(mcp2221_t *dev, mcp2221_gpio_snapshot_stats_t *stats) {
+	if (!dev || !stats)
+		return MCP2221_ERR_INVALID;
 
-	if (resp[MCP2221_GPIO_GET_RESP_GP0_VALUE] != MCP2221_GPIO_ERROR)
-		mask |= (1u << 0);
-	if (resp[MCP2221_GPIO_GET_RESP_GP1_VALUE] != MCP2221_GPIO_ERROR)
-		mask |= (1u << 1);
-	if (resp[MCP2221_GPIO_GET_RESP_GP2_VALUE] != MCP2221_GPIO_ERROR)
-		mask |= (1u << 2);
-	if (resp[MCP2221_GPIO_GET_RESP_GP3_VALUE] != MCP2221_GPIO_ERROR)
-		mask |= (1u << 3);
-
-	out_state[0] = (resp[MCP2221_GPIO_GET_RESP_GP0_VALUE] == MCP2221_GPIO_ERROR) ? -1 : resp[MCP2221_GPIO_GET_RESP_GP0_VALUE];
-	out_state[1] = (resp[MCP2221_GPIO_GET_RESP_GP1_VALUE] == MCP2221_GPIO_ERROR) ? -1 : resp[MCP2221_GPIO_GET_RESP_GP1_VALUE];
-	out_state[2] = (resp[MCP2221_GPIO_GET_RESP_GP2_VALUE] == MCP2221_GPIO_ERROR) ? -1 : resp[MCP2221_GPIO_GET_RESP_GP2_VALUE];
-	out_state[3] = (resp[MCP2221_GPIO_GET_RESP_GP3_VALUE] == MCP2221_GPIO_ERROR) ? -1 : resp[MCP2221_GPIO_GET_RESP_GP3_VALUE];
-
-	*out_valid_mask = mask;
+	mcp2221_internal_gpio_snapshot_get_stats(mcp2221_internal_gpio_get_snapshot(dev), stats);
 	return MCP2221_ERR_OK;
 }
+
+void mcp2221_gpio_snapshot_reset_stats(mcp2221_t *dev) {
+	mcp2221_internal_gpio_snapshot_reset_stats(mcp2221_internal_gpio_get_snapshot(dev));
+}
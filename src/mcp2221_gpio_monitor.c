@@ -0,0 +1,237 @@
+#include "mcp2221_gpio_monitor.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_gpio.h"
+#include "mcp2221_internal_ring.h"
+
+/* Longest single sleep, so that mcp2221_gpio_monitor_stop() is noticed promptly. */
+#define MONITOR_SLEEP_SLICE_NS 10000000ull
+
+#define MONITOR_GPIO_ERROR 0xEE
+
+typedef struct {
+	mcp2221_gpio_monitor_callback_t callback;
+	void *user;
+} monitor_handler_t;
+
+struct mcp2221_gpio_monitor {
+	mcp2221_t *dev;
+	uint32_t period_us;
+	unsigned flags;
+	int has_ring;
+	mcp2221_internal_ring_t ring;
+	monitor_handler_t handlers[4][2];	// [gpio][rise, fall]
+	mcp2221_gpio_monitor_stats_t stats;
+	pthread_mutex_t stats_lock;
+	uint64_t start_ns;	// events older than the last start are stale; read by the consumer
+	pthread_t worker;
+	int running;
+	int stop;
+};
+
+static uint64_t realtime_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void emit_event(mcp2221_gpio_monitor_t *monitor, const mcp2221_gpio_monitor_event_t *event) {
+	int overrun = monitor->has_ring && !mcp2221_internal_ring_push(&monitor->ring, event);
+
+	pthread_mutex_lock(&monitor->stats_lock);
+	monitor->stats.events++;
+	if (overrun)
+		monitor->stats.ring_overruns++;
+	pthread_mutex_unlock(&monitor->stats_lock);
+
+	const monitor_handler_t *handler = &monitor->handlers[event->gpio][event->type == MCP2221_GPIO_EVENT_FALL];
+	if (handler->callback)
+		handler->callback(event, handler->user);
+}
+
+static void *monitor_worker(void *arg) {
+	mcp2221_gpio_monitor_t *monitor = arg;
+	uint64_t period_ns = (uint64_t)monitor->period_us * 1000u;
+	uint64_t next_ns = mcp2221_internal_monotonic_ns();
+	uint64_t prev_time_ns = 0;
+	uint8_t prev[4];
+	int have_prev = 0;
+
+	while (!__atomic_load_n(&monitor->stop, __ATOMIC_ACQUIRE)) {
+		uint64_t now = mcp2221_internal_monotonic_ns();
+		if (now < next_ns) {
+			mcp2221_internal_sleep_until_ns(next_ns - now > MONITOR_SLEEP_SLICE_NS ? now + MONITOR_SLEEP_SLICE_NS : next_ns);
+			continue;
+		}
+
+		// Periods more than one behind are skipped, not sampled back to back.
+		uint64_t behind = (now - next_ns) / period_ns;
+		next_ns += (behind + 1) * period_ns;
+
+		uint8_t values[4];
+		uint64_t issued_us = 0;
+		mcp2221_error_code_t err = mcp2221_internal_gpio_read_values(monitor->dev, 0, values, &issued_us);
+
+		pthread_mutex_lock(&monitor->stats_lock);
+		monitor->stats.missed_periods += behind;
+		if (err == MCP2221_ERR_OK) {
+			monitor->stats.samples++;
+		} else {
+			monitor->stats.errors++;
+			monitor->stats.last_error = err;
+		}
+		pthread_mutex_unlock(&monitor->stats_lock);
+
+		if (err != MCP2221_ERR_OK)
+			continue;
+
+		uint64_t time_ns = issued_us * 1000u;
+		if (have_prev) {
+			mcp2221_gpio_monitor_event_t event;
+			event.time_ns = time_ns;
+			event.realtime_ns = (monitor->flags & MCP2221_GPIO_MONITOR_REALTIME) ? realtime_ns() : 0;
+			event.prev_time_ns = prev_time_ns;
+
+			for (uint8_t i = 0; i < 4; i++) {
+				// Pins that are not GPIO on either side have no edges.
+				if (values[i] == prev[i] || values[i] == MONITOR_GPIO_ERROR || prev[i] == MONITOR_GPIO_ERROR)
+					continue;
+
+				event.gpio = i;
+				event.type = (uint8_t)(values[i] ? MCP2221_GPIO_EVENT_RISE : MCP2221_GPIO_EVENT_FALL);
+				emit_event(monitor, &event);
+			}
+		}
+
+		memcpy(prev, values, sizeof(prev));
+		prev_time_ns = time_ns;
+		have_prev = 1;
+	}
+
+	return NULL;
+}
+
+mcp2221_error_code_t mcp2221_gpio_monitor_create(mcp2221_t *dev, const mcp2221_gpio_monitor_config_t *config,
+						 mcp2221_gpio_monitor_t **out_monitor) {
+	if (!out_monitor)
+		return MCP2221_ERR_INVALID;
+
+	*out_monitor = NULL;
+
+	if (!dev || !config || config->period_us == 0)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_gpio_monitor_t *monitor = calloc(1, sizeof(*monitor));
+	if (!monitor)
+		return MCP2221_ERR_NO_MEMORY;
+
+	if (config->ring_capacity > 0) {
+		mcp2221_error_code_t err = mcp2221_internal_ring_init(&monitor->ring, sizeof(mcp2221_gpio_monitor_event_t),
+								      config->ring_capacity);
+		if (err != MCP2221_ERR_OK) {
+			free(monitor);
+			return err;
+		}
+		monitor->has_ring = 1;
+	}
+
+	if (pthread_mutex_init(&monitor->stats_lock, NULL) != 0) {
+		mcp2221_internal_ring_free(&monitor->ring);
+		free(monitor);
+		return MCP2221_ERR_GENERIC;
+	}
+
+	monitor->dev = dev;
+	monitor->period_us = config->period_us;
+	monitor->flags = config->flags;
+	*out_monitor = monitor;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_gpio_monitor_destroy(mcp2221_gpio_monitor_t *monitor) {
+	if (!monitor)
+		return;
+
+	mcp2221_gpio_monitor_stop(monitor);
+	pthread_mutex_destroy(&monitor->stats_lock);
+	mcp2221_internal_ring_free(&monitor->ring);
+	free(monitor);
+}
+
+mcp2221_error_code_t mcp2221_gpio_monitor_set_callback(mcp2221_gpio_monitor_t *monitor, int gpio,
+						       mcp2221_gpio_event_type_t type,
+						       mcp2221_gpio_monitor_callback_t callback, void *user) {
+	if (!monitor || gpio < 0 || gpio > 3 || (type != MCP2221_GPIO_EVENT_RISE && type != MCP2221_GPIO_EVENT_FALL))
+		return MCP2221_ERR_INVALID;
+	if (monitor->running)
+		return MCP2221_ERR_BUSY;
+
+	monitor_handler_t *handler = &monitor->handlers[gpio][type == MCP2221_GPIO_EVENT_FALL];
+	handler->callback = callback;
+	handler->user = callback ? user : NULL;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_gpio_monitor_start(mcp2221_gpio_monitor_t *monitor) {
+	if (!monitor)
+		return MCP2221_ERR_INVALID;
+	if (monitor->running)
+		return MCP2221_ERR_BUSY;
+
+	memset(&monitor->stats, 0, sizeof(monitor->stats));
+	/*
+	 * The ring belongs to the consumer side, which may be draining right
+	 * now, so events from a previous run are not cleared here but skipped
+	 * by mcp2221_gpio_monitor_drain(). Event times have microsecond
+	 * resolution.
+	 */
+	__atomic_store_n(&monitor->start_ns, mcp2221_internal_monotonic_ns() / 1000u * 1000u, __ATOMIC_RELEASE);
+
+	__atomic_store_n(&monitor->stop, 0, __ATOMIC_RELEASE);
+	if (pthread_create(&monitor->worker, NULL, monitor_worker, monitor) != 0)
+		return MCP2221_ERR_GENERIC;
+
+	monitor->running = 1;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_gpio_monitor_stop(mcp2221_gpio_monitor_t *monitor) {
+	if (!monitor || !monitor->running)
+		return;
+
+	__atomic_store_n(&monitor->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(monitor->worker, NULL);
+	monitor->running = 0;
+}
+
+int mcp2221_gpio_monitor_drain(mcp2221_gpio_monitor_t *monitor, mcp2221_gpio_monitor_event_t *out, size_t max) {
+	if (!monitor || (!out && max > 0))
+		return MCP2221_ERR_INVALID;
+	if (!monitor->has_ring)
+		return 0;
+
+	uint64_t start_ns = __atomic_load_n(&monitor->start_ns, __ATOMIC_ACQUIRE);
+	int count = 0;
+	while ((size_t)count < max && count < INT_MAX && mcp2221_internal_ring_pop(&monitor->ring, &out[count])) {
+		if (out[count].time_ns >= start_ns)
+			count++;
+	}
+
+	return count;
+}
+
+mcp2221_error_code_t mcp2221_gpio_monitor_get_stats(mcp2221_gpio_monitor_t *monitor, mcp2221_gpio_monitor_stats_t *stats) {
+	if (!monitor || !stats)
+		return MCP2221_ERR_INVALID;
+
+	pthread_mutex_lock(&monitor->stats_lock);
+	*stats = monitor->stats;
+	pthread_mutex_unlock(&monitor->stats_lock);
+	return MCP2221_ERR_OK;
+}
@@ -2,21 +2,19 @@
 
 #include <time.h>
 #include <stdio.h>
+#include <string.h>
+
+#include "mcp2221_analog.h"
 
 #include "mcp2221_internal_constants.h"
 #include "mcp2221_internal.h"
+#include "mcp2221_internal_gpio.h"
 
 #define MCP2221_GPIO_ERROR 0xEE
 
-static void decode_gpio_values(const uint8_t resp[MCP2221_PACKET_SIZE], int values[4]) {
-	values[0] = (resp[MCP2221_GPIO_GET_RESP_GP0_VALUE] == MCP2221_GPIO_ERROR)
-		? -1 : resp[MCP2221_GPIO_GET_RESP_GP0_VALUE];
-	values[1] = (resp[MCP2221_GPIO_GET_RESP_GP1_VALUE] == MCP2221_GPIO_ERROR)
-		? -1 : resp[MCP2221_GPIO_GET_RESP_GP1_VALUE];
-	values[2] = (resp[MCP2221_GPIO_GET_RESP_GP2_VALUE] == MCP2221_GPIO_ERROR)
-		? -1 : resp[MCP2221_GPIO_GET_RESP_GP2_VALUE];
-	values[3] = (resp[MCP2221_GPIO_GET_RESP_GP3_VALUE] == MCP2221_GPIO_ERROR)
-		? -1 : resp[MCP2221_GPIO_GET_RESP_GP3_VALUE];
+static void decode_gpio_values(const uint8_t raw[4], int values[4]) {
+	for (int i = 0; i < 4; i++)
+		values[i] = (raw[i] == MCP2221_GPIO_ERROR) ? -1 : raw[i];
 }
 
 static double wall_time_seconds(void) {
@@ -29,6 +27,11 @@ static double wall_time_seconds(void) {
 #endif
 }
 
+static void sleep_ms(uint32_t ms) {
+	struct timespec ts = {(time_t)(ms / 1000u), (long)(ms % 1000u) * 1000000L};
+	nanosleep(&ts, NULL);
+}
+
 void mcp2221_gpio_poll_init(mcp2221_gpio_poll_state_t *st) {
 	if (!st)
 		return;
@@ -38,6 +41,13 @@ void mcp2221_gpio_poll_init(mcp2221_gpio_poll_state_t *st) {
 	st->initialized = 0;
 	st->last_time = 0.0;
 	st->filter_mask = 0; /* 0 = accept all, like Python's default [] */
+	st->max_age_us = 0;
+	st->ioc_latch = 0;
+	st->wait_min_interval_ms = MCP2221_GPIO_WAIT_MIN_INTERVAL_MS;
+	st->wait_max_interval_ms = MCP2221_GPIO_WAIT_MAX_INTERVAL_MS;
+	st->wait_interval_ms = MCP2221_GPIO_WAIT_MIN_INTERVAL_MS;
+	memset(st->pins, 0, sizeof(st->pins));
+	st->last_sample_us = 0;
 }
 
 void mcp2221_gpio_poll_set_filter_mask(mcp2221_gpio_poll_state_t *st, uint16_t mask) {
@@ -46,6 +56,135 @@ void mcp2221_gpio_poll_set_filter_mask(mcp2221_gpio_poll_state_t *st, uint16_t m
 	st->filter_mask = mask;
 }
 
+void mcp2221_gpio_poll_set_max_age(mcp2221_gpio_poll_state_t *st, uint32_t max_age_us) {
+	if (!st)
+		return;
+	st->max_age_us = max_age_us;
+}
+
+void mcp2221_gpio_poll_set_ioc_latch(mcp2221_gpio_poll_state_t *st, int enable) {
+	if (!st)
+		return;
+	st->ioc_latch = enable ? 1 : 0;
+}
+
+mcp2221_error_code_t mcp2221_gpio_poll_set_wait_interval(mcp2221_gpio_poll_state_t *st, uint32_t min_interval_ms,
+							  uint32_t max_interval_ms) {
+	if (!st || min_interval_ms == 0 || max_interval_ms < min_interval_ms)
+		return MCP2221_ERR_INVALID;
+
+	st->wait_min_interval_ms = min_interval_ms;
+	st->wait_max_interval_ms = max_interval_ms;
+	st->wait_interval_ms = min_interval_ms;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_gpio_poll_set_debounce(mcp2221_gpio_poll_state_t *st, int pin, uint32_t samples,
+						   uint32_t min_stable_us) {
+	if (!st || pin < 0 || pin > 3)
+		return MCP2221_ERR_INVALID;
+
+	st->pins[pin].debounce_samples = samples;
+	st->pins[pin].debounce_us = min_stable_us;
+	st->pins[pin].pending_count = 0;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_gpio_poll_get_pin_stats(const mcp2221_gpio_poll_state_t *st, int pin,
+						    mcp2221_gpio_pin_stats_t *stats) {
+	if (!st || !stats || pin < 0 || pin > 3)
+		return MCP2221_ERR_INVALID;
+
+	const mcp2221_gpio_pin_state_t *ps = &st->pins[pin];
+	stats->rises = ps->rises;
+	stats->falls = ps->falls;
+	stats->last_edge_us = ps->last_edge_us;
+	stats->period_us = ps->period_us;
+
+	// A signal that stopped has a period of at least the time since its last rise.
+	if (ps->period_us > 0.0 && st->last_sample_us > ps->last_rise_us) {
+		double quiet_us = (double)(st->last_sample_us - ps->last_rise_us);
+		if (quiet_us > stats->period_us)
+			stats->period_us = quiet_us;
+	}
+	stats->frequency_hz = stats->period_us > 0.0 ? 1e6 / stats->period_us : 0.0;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_gpio_poll_reset_counters(mcp2221_gpio_poll_state_t *st) {
+	if (!st)
+		return;
+
+	for (int i = 0; i < 4; i++) {
+		mcp2221_gpio_pin_state_t *ps = &st->pins[i];
+		ps->rises = 0;
+		ps->falls = 0;
+		ps->last_edge_us = 0;
+		ps->last_rise_us = 0;
+		ps->period_us = 0.0;
+	}
+}
+
+static void count_edge(mcp2221_gpio_pin_state_t *ps, int old_value, int new_value, uint64_t edge_us) {
+	// Pins entering or leaving GPIO mode have no edge.
+	if (old_value < 0 || new_value < 0)
+		return;
+
+	ps->last_edge_us = edge_us;
+	if (new_value == 0) {
+		ps->falls++;
+		return;
+	}
+
+	if (ps->rises > 0 && edge_us > ps->last_rise_us) {
+		double interval = (double)(edge_us - ps->last_rise_us);
+		// Weight recent intervals by 1/4 so the estimate follows speed changes.
+		ps->period_us = ps->period_us > 0.0 ? ps->period_us + (interval - ps->period_us) / 4.0 : interval;
+	}
+	ps->rises++;
+	ps->last_rise_us = edge_us;
+}
+
+/*
+ * Replace raw samples by debounced levels and count the accepted edges.
+ * Called once per sample after the state is initialized, so mcp2221_gpio_poll()
+ * and mcp2221_gpio_poll_events() see the same filtered levels.
+ */
+static void filter_sample(mcp2221_gpio_poll_state_t *st, int now[4], uint64_t sample_us) {
+	// A shared snapshot seen again is not a new sample.
+	if (sample_us == st->last_sample_us) {
+		for (int i = 0; i < 4; i++)
+			now[i] = st->prev[i];
+		return;
+	}
+
+	for (int i = 0; i < 4; i++) {
+		mcp2221_gpio_pin_state_t *ps = &st->pins[i];
+
+		if (now[i] == st->prev[i]) {
+			ps->pending_count = 0;
+			continue;
+		}
+
+		if (ps->pending_count == 0 || ps->pending != now[i]) {
+			ps->pending = now[i];
+			ps->pending_count = 0;
+			ps->pending_since_us = sample_us;
+		}
+		if (ps->pending_count < UINT32_MAX)
+			ps->pending_count++;
+
+		if (ps->pending_count < ps->debounce_samples || sample_us - ps->pending_since_us < ps->debounce_us) {
+			now[i] = st->prev[i];
+			continue;
+		}
+
+		ps->pending_count = 0;
+		count_edge(ps, st->prev[i], now[i], ps->pending_since_us);
+	}
+	st->last_sample_us = sample_us;
+}
+
 mcp2221_error_code_t mcp2221_gpio_poll(
     mcp2221_t *dev,
     mcp2221_gpio_poll_state_t *st,
@@ -54,15 +193,14 @@ mcp2221_error_code_t mcp2221_gpio_poll(
 	if (!dev || !st || !out)
 		return MCP2221_ERR_INVALID;
 
-	uint8_t cmd = MCP2221_CMD_GET_GPIO_VALUES;
-	uint8_t resp[MCP2221_PACKET_SIZE];
-
-	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_transport(dev, &cmd, 1, resp);
+	uint8_t raw[4];
+	uint64_t sample_us = 0;
+	mcp2221_error_code_t err = mcp2221_internal_gpio_read_values(dev, st->max_age_us, raw, &sample_us);
 	if (err)
 		return err;
 
 	int now[4];
-	decode_gpio_values(resp, now);
+	decode_gpio_values(raw, now);
 
 	// first call: initialize state, no changes reported
 	if (!st->initialized) {
@@ -73,9 +211,12 @@ mcp2221_error_code_t mcp2221_gpio_poll(
 			out[i].changed = 0;
 		}
 		st->initialized = 1;
+		st->last_sample_us = sample_us;
 		return MCP2221_ERR_OK;
 	}
 
+	filter_sample(st, now, sample_us);
+
 	// detect changes
 	for (int i = 0; i < 4; i++) {
 		if (now[i] != st->prev[i]) {
@@ -99,6 +240,8 @@ mcp2221_error_code_t mcp2221_gpio_poll(
 static int mask_allows(uint16_t mask, int pin, mcp2221_gpio_event_type_t type) {
 	if (mask == 0)
 		return 1; /* 0 = all events, mirroring Python filter=[] */
+	if (type == MCP2221_GPIO_EVENT_IOC)
+		return (mask & MCP2221_GPIO_POLL_MASK_IOC) != 0;
 	int bit = pin * 2 + (type == MCP2221_GPIO_EVENT_FALL ? 1 : 0);
 	return (mask & (1u << bit)) != 0;
 }
@@ -108,15 +251,14 @@ int mcp2221_gpio_poll_events(mcp2221_t *dev, mcp2221_gpio_poll_state_t *st, cons
 	if (!dev || !st || (!out_events && max_events > 0))
 		return MCP2221_ERR_INVALID;
 
-	uint8_t cmd = MCP2221_CMD_GET_GPIO_VALUES;
-	uint8_t resp[MCP2221_PACKET_SIZE];
-
-	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_transport(dev, &cmd, 1, resp);
+	uint8_t raw[4];
+	uint64_t sample_us = 0;
+	mcp2221_error_code_t err = mcp2221_internal_gpio_read_values(dev, st->max_age_us, raw, &sample_us);
 	if (err)
 		return err;
 
 	int now[4];
-	decode_gpio_values(resp, now);
+	decode_gpio_values(raw, now);
 
 	double current_time = wall_time_seconds();
 
@@ -130,9 +272,12 @@ int mcp2221_gpio_poll_events(mcp2221_t *dev, mcp2221_gpio_poll_state_t *st, cons
 			st->prev[i] = now[i];
 		st->initialized = 1;
 		st->last_time = current_time;
+		st->last_sample_us = sample_us;
 		return 0;
 	}
 
+	filter_sample(st, now, sample_us);
+
 	size_t written = 0;
 
 	for (int i = 0; i < 4; i++) {
@@ -167,3 +312,99 @@ int mcp2221_gpio_poll_events(mcp2221_t *dev, mcp2221_gpio_poll_state_t *st, cons
 
 	return (int)written;
 }
+
+// Helper: read and clear the interrupt-on-change latch. Sets *latched when it was set.
+static mcp2221_error_code_t take_ioc_latch(mcp2221_t *dev, int *latched) {
+	uint8_t flag = 0;
+	mcp2221_error_code_t err = mcp2221_ioc_read(dev, &flag);
+	if (err)
+		return err;
+
+	*latched = flag != 0;
+	if (!*latched)
+		return MCP2221_ERR_OK;
+	return mcp2221_ioc_clear(dev);
+}
+
+/* The IOC flag only watches GP1, so it can stand in for the GPIO read only
+ * when the filter asks for nothing but GP1 edges and IOC events. */
+static int ioc_latch_covers_filter(uint16_t mask) {
+	uint16_t gp1 = MCP2221_GPIO_POLL_MASK_RISE(1) | MCP2221_GPIO_POLL_MASK_FALL(1) | MCP2221_GPIO_POLL_MASK_IOC;
+	return mask != 0 && (mask & ~gp1) == 0;
+}
+
+int mcp2221_gpio_wait_events(mcp2221_t *dev, mcp2221_gpio_poll_state_t *st, mcp2221_gpio_event_t *out_events,
+			     size_t max_events, int timeout_ms) {
+	if (!dev || !st || (!out_events && max_events > 0))
+		return MCP2221_ERR_INVALID;
+	if (st->wait_min_interval_ms == 0 || st->wait_max_interval_ms < st->wait_min_interval_ms)
+		return MCP2221_ERR_INVALID;
+
+	uint64_t start = mcp2221_internal_monotonic_ns() / 1000000u;
+
+	for (;;) {
+		size_t written = 0;
+		int activity = 0;
+		int read_levels = 1;
+
+		if (st->ioc_latch) {
+			int latched = 0;
+			mcp2221_error_code_t err = take_ioc_latch(dev, &latched);
+			if (err)
+				return err;
+
+			if (latched) {
+				activity = 1;
+				if (written < max_events && mask_allows(st->filter_mask, 1, MCP2221_GPIO_EVENT_IOC)) {
+					mcp2221_gpio_event_t *ev = &out_events[written];
+					ev->gpio = 1;
+					ev->type = MCP2221_GPIO_EVENT_IOC;
+					ev->time = wall_time_seconds();
+					ev->last_time = st->last_time;
+					snprintf(ev->id, sizeof(ev->id), "IOC");
+					written++;
+				}
+			} else if (ioc_latch_covers_filter(st->filter_mask)) {
+				read_levels = 0;
+			}
+		}
+
+		if (read_levels) {
+			int prev[4];
+			int was_initialized = st->initialized;
+			memcpy(prev, st->prev, sizeof(prev));
+
+			int n = mcp2221_gpio_poll_events(dev, st, NULL, out_events ? out_events + written : NULL,
+							 max_events - written);
+			if (n < 0)
+				return n;
+			written += (size_t)n;
+			if (was_initialized && memcmp(prev, st->prev, sizeof(prev)) != 0)
+				activity = 1;
+		}
+
+		if (activity)
+			st->wait_interval_ms = st->wait_min_interval_ms;
+		if (written > 0)
+			return (int)written;
+
+		uint64_t elapsed = mcp2221_internal_monotonic_ns() / 1000000u - start;
+		if (timeout_ms >= 0 && elapsed >= (uint64_t)timeout_ms)
+			return 0;
+
+		uint32_t delay = st->wait_interval_ms;
+		if (delay < st->wait_min_interval_ms || delay > st->wait_max_interval_ms)
+			delay = st->wait_min_interval_ms;
+		if (timeout_ms >= 0 && (uint64_t)delay > (uint64_t)timeout_ms - elapsed)
+			delay = (uint32_t)((uint64_t)timeout_ms - elapsed);
+		sleep_ms(delay);
+
+		if (!activity) {
+			uint32_t next = st->wait_interval_ms;
+			if (next < st->wait_min_interval_ms)
+				next = st->wait_min_interval_ms;
+			next = (next > st->wait_max_interval_ms / 2) ? st->wait_max_interval_ms : next * 2;
+			st->wait_interval_ms = next;
+		}
+	}
+}
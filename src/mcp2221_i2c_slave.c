@@ -7,6 +7,9 @@
 
 #define MCP2221_I2C_SLAVE_MAX_REGISTER_BYTES 4
 #define MCP2221_I2C_SLAVE_MAX_TRANSFER_BYTES 256
+#define MCP2221_I2C_MUX_MAX_CHANNELS 8
+#define MCP2221_I2C_MUX_SELECTOR_MAX_CHANNELS 4
+#define MCP2221_I2C_MUX_SELECTOR_ENABLE 0x04
 
 static int is_valid_register_bytes(int bytes) {
 	return bytes >= 1 && bytes <= MCP2221_I2C_SLAVE_MAX_REGISTER_BYTES;
@@ -28,11 +31,44 @@ static int is_valid_byte_order(mcp2221_i2c_byte_order_t byte_order) {
 	return byte_order == MCP2221_I2C_BYTE_ORDER_BIG || byte_order == MCP2221_I2C_BYTE_ORDER_LITTLE;
 }
 
+static int is_valid_mux(const mcp2221_i2c_mux_t *mux) {
+	if (!mux || !mux->mcp || mux->addr > MCP2221_I2C_ADDR_7BIT_MAX || mux->channels < 1)
+		return 0;
+	if (mux->type == MCP2221_I2C_MUX_SWITCH)
+		return mux->channels <= MCP2221_I2C_MUX_MAX_CHANNELS;
+	if (mux->type == MCP2221_I2C_MUX_SELECTOR)
+		return mux->channels <= MCP2221_I2C_MUX_SELECTOR_MAX_CHANNELS;
+	return 0;
+}
+
 static int is_valid_slave(const mcp2221_i2c_slave_t *slave) {
 	return slave && slave->mcp && slave->addr <= MCP2221_I2C_ADDR_7BIT_MAX && is_valid_register_bytes(slave->reg_bytes) &&
 		   is_valid_byte_order(slave->reg_byteorder);
 }
 
+static int is_valid_muxed_slave(const mcp2221_i2c_muxed_slave_t *target) {
+	return target && is_valid_slave(&target->slave) && is_valid_mux(target->mux) && target->mux->mcp == target->slave.mcp &&
+		   target->channel >= 0 && target->channel < target->mux->channels;
+}
+
+// Helper: write the control register unless the cache already holds the channel.
+static mcp2221_error_code_t mux_apply(mcp2221_i2c_mux_t *mux, int channel) {
+	if (mux->selected == channel) {
+		mux->select_skips++;
+		return MCP2221_ERR_OK;
+	}
+
+	uint8_t control = 0;
+	if (channel >= 0)
+		control = (mux->type == MCP2221_I2C_MUX_SWITCH) ? (uint8_t)(1u << channel) : (uint8_t)(MCP2221_I2C_MUX_SELECTOR_ENABLE | channel);
+
+	mux->select_writes++;
+	mcp2221_error_code_t err = mcp2221_i2c_write_ex(mux->mcp, mux->addr, &control, 1, MCP2221_I2C_KIND_NORMAL, 50);
+	/* A failed write may or may not have reached the multiplexer. */
+	mux->selected = (err == MCP2221_ERR_OK) ? channel : MCP2221_I2C_MUX_CHANNEL_UNKNOWN;
+	return err;
+}
+
 static mcp2221_error_code_t resolve_byte_order(const mcp2221_i2c_slave_t *slave, mcp2221_i2c_byte_order_t requested,
 						      mcp2221_i2c_byte_order_t *resolved) {
 	if (!slave || !resolved)
@@ -105,6 +141,137 @@ mcp2221_error_code_t mcp2221_i2c_slave_init(mcp2221_i2c_slave_t *slave, mcp2221_
 	return MCP2221_ERR_OK;
 }
 
+mcp2221_error_code_t mcp2221_i2c_mux_init(mcp2221_i2c_mux_t *mux, mcp2221_t *mcp, uint8_t addr, mcp2221_i2c_mux_type_t type, int channels) {
+	if (!mux)
+		return MCP2221_ERR_INVALID;
+
+	memset(mux, 0, sizeof(*mux));
+
+	mcp2221_i2c_mux_t tmp = {
+		.mcp = mcp,
+		.addr = addr,
+		.type = type,
+		.channels = channels,
+		.selected = MCP2221_I2C_MUX_CHANNEL_UNKNOWN
+	};
+	if (!is_valid_mux(&tmp))
+		return MCP2221_ERR_INVALID;
+
+	*mux = tmp;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_mux_select(mcp2221_i2c_mux_t *mux, int channel) {
+	if (!is_valid_mux(mux) || channel < 0 || channel >= mux->channels)
+		return MCP2221_ERR_INVALID;
+
+	return mux_apply(mux, channel);
+}
+
+mcp2221_error_code_t mcp2221_i2c_mux_deselect(mcp2221_i2c_mux_t *mux) {
+	if (!is_valid_mux(mux))
+		return MCP2221_ERR_INVALID;
+
+	return mux_apply(mux, MCP2221_I2C_MUX_CHANNEL_NONE);
+}
+
+void mcp2221_i2c_mux_invalidate(mcp2221_i2c_mux_t *mux) {
+	if (mux)
+		mux->selected = MCP2221_I2C_MUX_CHANNEL_UNKNOWN;
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_init_muxed(mcp2221_i2c_muxed_slave_t *target, mcp2221_i2c_mux_t *mux, int channel, uint8_t addr,
+						 int force, int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder) {
+	if (!target)
+		return MCP2221_ERR_INVALID;
+
+	memset(target, 0, sizeof(*target));
+
+	if (!is_valid_mux(mux) || channel < 0 || channel >= mux->channels || addr > MCP2221_I2C_ADDR_7BIT_MAX || addr == mux->addr)
+		return MCP2221_ERR_INVALID;
+
+	int rb = (reg_bytes <= 0) ? 1 : reg_bytes;
+	if (!is_valid_register_bytes(rb))
+		return MCP2221_ERR_INVALID;
+
+	if (reg_byteorder == MCP2221_I2C_BYTE_ORDER_DEFAULT)
+		reg_byteorder = MCP2221_I2C_BYTE_ORDER_BIG;
+	if (!is_valid_byte_order(reg_byteorder))
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_i2c_muxed_slave_t tmp = {
+		.slave = {
+			.mcp = mux->mcp,
+			.addr = addr,
+			.reg_bytes = rb,
+			.reg_byteorder = reg_byteorder
+		},
+		.mux = mux,
+		.channel = channel
+	};
+
+	if (!force) {
+		int is_present = 0;
+		mcp2221_error_code_t err = mcp2221_i2c_muxed_slave_check_present(&tmp, &is_present);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		if (!is_present)
+			return MCP2221_ERR_NOT_ACK;
+	}
+
+	*target = tmp;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_muxed_slave_select(mcp2221_i2c_muxed_slave_t *target) {
+	if (!is_valid_muxed_slave(target))
+		return MCP2221_ERR_INVALID;
+
+	return mux_apply(target->mux, target->channel);
+}
+
+mcp2221_error_code_t mcp2221_i2c_muxed_slave_check_present(mcp2221_i2c_muxed_slave_t *target, int *is_present) {
+	mcp2221_error_code_t err = mcp2221_i2c_muxed_slave_select(target);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	return mcp2221_i2c_slave_check_present(&target->slave, is_present);
+}
+
+mcp2221_error_code_t mcp2221_i2c_muxed_slave_read_register(mcp2221_i2c_muxed_slave_t *target, uint32_t reg, uint8_t *buffer, size_t length,
+							  int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder) {
+	mcp2221_error_code_t err = mcp2221_i2c_muxed_slave_select(target);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	return mcp2221_i2c_slave_read_register(&target->slave, reg, buffer, length, reg_bytes, reg_byteorder);
+}
+
+mcp2221_error_code_t mcp2221_i2c_muxed_slave_read(mcp2221_i2c_muxed_slave_t *target, uint8_t *buffer, size_t length) {
+	mcp2221_error_code_t err = mcp2221_i2c_muxed_slave_select(target);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	return mcp2221_i2c_slave_read(&target->slave, buffer, length);
+}
+
+mcp2221_error_code_t mcp2221_i2c_muxed_slave_write_register(mcp2221_i2c_muxed_slave_t *target, uint32_t reg, const uint8_t *data, size_t length,
+							   int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder) {
+	mcp2221_error_code_t err = mcp2221_i2c_muxed_slave_select(target);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	return mcp2221_i2c_slave_write_register(&target->slave, reg, data, length, reg_bytes, reg_byteorder);
+}
+
+mcp2221_error_code_t mcp2221_i2c_muxed_slave_write(mcp2221_i2c_muxed_slave_t *target, const uint8_t *data, size_t length) {
+	mcp2221_error_code_t err = mcp2221_i2c_muxed_slave_select(target);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	return mcp2221_i2c_slave_write(&target->slave, data, length);
+}
+
 mcp2221_error_code_t mcp2221_i2c_slave_check_present(mcp2221_i2c_slave_t *slave, int *is_present) {
 	if (!is_valid_slave(slave) || !is_present)
 		return MCP2221_ERR_INVALID;
@@ -195,3 +362,67 @@ mcp2221_error_code_t mcp2221_i2c_slave_write(mcp2221_i2c_slave_t *slave, const u
 
 	return mcp2221_i2c_write_ex(slave->mcp, slave->addr, data, length, MCP2221_I2C_KIND_NORMAL, 50);
 }
+
+// Helper: order requests by multiplexer and channel; the index keeps the sort stable.
+static int compare_batch_order(const void *a, const void *b, const mcp2221_i2c_slave_read_t *reqs) {
+	size_t ia = *(const size_t *)a;
+	size_t ib = *(const size_t *)b;
+	const mcp2221_i2c_muxed_slave_t *ta = reqs[ia].muxed;
+	const mcp2221_i2c_muxed_slave_t *tb = reqs[ib].muxed;
+	uintptr_t ma = ta ? (uintptr_t)ta->mux : 0;
+	uintptr_t mb = tb ? (uintptr_t)tb->mux : 0;
+
+	if (ma != mb)
+		return ma < mb ? -1 : 1;
+	if (ta && ta->channel != tb->channel)
+		return ta->channel < tb->channel ? -1 : 1;
+	return ia < ib ? -1 : (ia > ib);
+}
+
+// Insertion sort: batches are short and qsort() offers no context pointer in C99.
+static void sort_batch_order(size_t *order, size_t count, const mcp2221_i2c_slave_read_t *reqs) {
+	for (size_t i = 1; i < count; ++i) {
+		size_t cur = order[i];
+		size_t j = i;
+		while (j > 0 && compare_batch_order(&order[j - 1], &cur, reqs) > 0) {
+			order[j] = order[j - 1];
+			--j;
+		}
+		order[j] = cur;
+	}
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_read_register_batch(mcp2221_i2c_slave_read_t *reqs, size_t count) {
+	if (!reqs || count == 0)
+		return MCP2221_ERR_INVALID;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (reqs[i].muxed ? !is_valid_muxed_slave(reqs[i].muxed) : !is_valid_slave(reqs[i].slave))
+			return MCP2221_ERR_INVALID;
+	}
+
+	size_t *order = malloc(count * sizeof(*order));
+	if (!order)
+		return MCP2221_ERR_NO_MEMORY;
+
+	for (size_t i = 0; i < count; ++i)
+		order[i] = i;
+	sort_batch_order(order, count, reqs);
+
+	for (size_t i = 0; i < count; ++i) {
+		mcp2221_i2c_slave_read_t *req = &reqs[order[i]];
+		if (req->muxed)
+			req->status = mcp2221_i2c_muxed_slave_read_register(req->muxed, req->reg, req->buffer, req->length, 0,
+									    MCP2221_I2C_BYTE_ORDER_DEFAULT);
+		else
+			req->status = mcp2221_i2c_slave_read_register(req->slave, req->reg, req->buffer, req->length, 0,
+								      MCP2221_I2C_BYTE_ORDER_DEFAULT);
+	}
+	free(order);
+
+	for (size_t i = 0; i < count; ++i) {
+		if (reqs[i].status != MCP2221_ERR_OK)
+			return reqs[i].status;
+	}
+	return MCP2221_ERR_OK;
+}
@@ -0,0 +1,166 @@
+#include "mcp2221_internal_acq.h"
+
+#include <stdlib.h>
+
+static int req_before(const mcp2221_internal_acq_req_t *a, const mcp2221_internal_acq_req_t *b) {
+	if (a->target != b->target)
+		return a->target < b->target;
+	return a->reg < b->reg;
+}
+
+size_t mcp2221_internal_acq_plan_groups(
+	mcp2221_internal_acq_req_t *reqs,
+	size_t n,
+	mcp2221_internal_acq_group_t *groups) {
+	if (!reqs || !groups || n == 0)
+		return 0;
+
+	// Insertion sort: the number of due jobs per batch is small.
+	for (size_t i = 1; i < n; i++) {
+		mcp2221_internal_acq_req_t tmp = reqs[i];
+		size_t j = i;
+		while (j > 0 && req_before(&tmp, &reqs[j - 1])) {
+			reqs[j] = reqs[j - 1];
+			j--;
+		}
+		reqs[j] = tmp;
+	}
+
+	size_t count = 0;
+	mcp2221_internal_acq_group_t *cur = NULL;
+	uint32_t cur_end = 0;
+	int cur_mergeable = 0;
+
+	for (size_t i = 0; i < n; i++) {
+		const mcp2221_internal_acq_req_t *r = &reqs[i];
+		uint32_t end = r->reg + r->length;
+
+		if (cur && cur_mergeable && r->mergeable && r->target == reqs[cur->first].target &&
+		    r->reg <= cur_end + MCP2221_INTERNAL_ACQ_MERGE_GAP) {
+			uint32_t merged_end = end > cur_end ? end : cur_end;
+			if (merged_end - cur->reg <= MCP2221_INTERNAL_ACQ_MERGE_MAX) {
+				cur_end = merged_end;
+				cur->length = (uint16_t)(cur_end - cur->reg);
+				cur->count++;
+				continue;
+			}
+		}
+
+		cur = &groups[count++];
+		cur->first = i;
+		cur->count = 1;
+		cur->reg = r->reg;
+		cur->length = r->length;
+		cur_end = end;
+		cur_mergeable = r->mergeable;
+	}
+
+	return count;
+}
+
+static uint64_t gcd_u64(uint64_t a, uint64_t b) {
+	while (b) {
+		uint64_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+mcp2221_error_code_t mcp2221_internal_acq_assign_phases(
+	const uint32_t *period_us,
+	const uint32_t *cost,
+	int64_t *phase_us,
+	size_t n,
+	uint32_t *out_tick_us) {
+	if (!period_us || !cost || !phase_us || !out_tick_us)
+		return MCP2221_ERR_INVALID;
+
+	uint64_t tick = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (period_us[i] == 0)
+			return MCP2221_ERR_INVALID;
+		tick = gcd_u64(tick, period_us[i]);
+	}
+	if (tick < MCP2221_INTERNAL_ACQ_TICK_MIN_US)
+		tick = MCP2221_INTERNAL_ACQ_TICK_MIN_US;
+	*out_tick_us = (uint32_t)tick;
+
+	if (n == 0)
+		return MCP2221_ERR_OK;
+
+	// Horizon: least common multiple of all periods in ticks, capped.
+	uint64_t horizon = 1;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t p = (period_us[i] + tick - 1) / tick;
+		horizon = horizon / gcd_u64(horizon, p) * p;
+		if (horizon > MCP2221_INTERNAL_ACQ_HORIZON_MAX) {
+			horizon = MCP2221_INTERNAL_ACQ_HORIZON_MAX;
+			break;
+		}
+	}
+
+	uint64_t *load = calloc((size_t)horizon, sizeof(*load));
+	size_t *order = malloc(n * sizeof(*order));
+	if (!load || !order) {
+		free(load);
+		free(order);
+		return MCP2221_ERR_NO_MEMORY;
+	}
+
+	// Fixed phases first, then automatic ones by ascending period.
+	size_t fixed = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (phase_us[i] >= 0)
+			order[fixed++] = i;
+	}
+	size_t m = fixed;
+	for (size_t i = 0; i < n; i++) {
+		if (phase_us[i] >= 0)
+			continue;
+		size_t j = m++;
+		while (j > fixed && period_us[order[j - 1]] > period_us[i]) {
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = i;
+	}
+
+	for (size_t k = 0; k < n; k++) {
+		size_t i = order[k];
+		uint64_t p = (period_us[i] + tick - 1) / tick;
+		uint64_t c = (uint64_t)cost[i] + MCP2221_INTERNAL_ACQ_TXN_COST;
+		uint64_t best = 0;
+
+		if (phase_us[i] >= 0) {
+			best = ((uint64_t)phase_us[i] / tick) % p;
+		} else {
+			uint64_t best_peak = UINT64_MAX;
+			uint64_t best_sum = UINT64_MAX;
+			uint64_t candidates = p < horizon ? p : horizon;
+
+			for (uint64_t phi = 0; phi < candidates; phi++) {
+				uint64_t peak = 0;
+				uint64_t sum = 0;
+				for (uint64_t t = phi; t < horizon; t += p) {
+					if (load[t] > peak)
+						peak = load[t];
+					sum += load[t];
+				}
+				if (peak < best_peak || (peak == best_peak && sum < best_sum)) {
+					best_peak = peak;
+					best_sum = sum;
+					best = phi;
+				}
+			}
+			phase_us[i] = (int64_t)(best * tick);
+		}
+
+		for (uint64_t t = best; t < horizon; t += p)
+			load[t] += c;
+	}
+
+	free(order);
+	free(load);
+	return MCP2221_ERR_OK;
+}
@@ -4,8 +4,17 @@
 #ifdef LIBEASYMCP2221_HAVE_NEXTAFTER
 #include <math.h>
 #endif
+#include <string.h>
 #include <strings.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MCP2221_ANALOG_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MCP2221_ANALOG_NEON 1
+#endif
+
 #include "mcp2221_internal_constants.h"
 
 static double mcp2221_internal_analog_dac_stabilize_scaled(double scaled) {
@@ -39,6 +48,67 @@ mcp2221_error_code_t mcp2221_internal_analog_parse_voltage_reference(
 	return MCP2221_ERR_OK;
 }
 
+mcp2221_error_code_t mcp2221_internal_analog_parse_clock(
+	int duty_percent,
+	const char *freq_str,
+	int *bits) {
+	if (!freq_str || !bits)
+		return MCP2221_ERR_INVALID;
+
+	int duty_bits;
+	if (duty_percent == 0)
+		duty_bits = MCP2221_CLK_DUTY_0;
+	else if (duty_percent == 25)
+		duty_bits = MCP2221_CLK_DUTY_25;
+	else if (duty_percent == 50)
+		duty_bits = MCP2221_CLK_DUTY_50;
+	else if (duty_percent == 75)
+		duty_bits = MCP2221_CLK_DUTY_75;
+	else
+		return MCP2221_ERR_INVALID; /* like ValueError in Python */
+
+	int div_bits;
+	if (strcasecmp(freq_str, "375kHz") == 0)
+		div_bits = MCP2221_CLK_FREQ_375kHz;
+	else if (strcasecmp(freq_str, "750kHz") == 0)
+		div_bits = MCP2221_CLK_FREQ_750kHz;
+	else if (strcasecmp(freq_str, "1.5MHz") == 0)
+		div_bits = MCP2221_CLK_FREQ_1_5MHz;
+	else if (strcasecmp(freq_str, "3MHz") == 0)
+		div_bits = MCP2221_CLK_FREQ_3MHz;
+	else if (strcasecmp(freq_str, "6MHz") == 0)
+		div_bits = MCP2221_CLK_FREQ_6MHz;
+	else if (strcasecmp(freq_str, "12MHz") == 0)
+		div_bits = MCP2221_CLK_FREQ_12MHz;
+	else if (strcasecmp(freq_str, "24MHz") == 0)
+		div_bits = MCP2221_CLK_FREQ_24MHz;
+	else
+		return MCP2221_ERR_INVALID;
+
+	*bits = duty_bits | div_bits;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_parse_ioc_edge(
+	const char *edge,
+	int *bits) {
+	if (!edge || !bits)
+		return MCP2221_ERR_INVALID;
+
+	if (strcasecmp(edge, "none") == 0)
+		*bits = MCP2221_INT_POS_EDGE_DISABLE | MCP2221_INT_NEG_EDGE_DISABLE;
+	else if (strcasecmp(edge, "rising") == 0)
+		*bits = MCP2221_INT_POS_EDGE_ENABLE | MCP2221_INT_NEG_EDGE_DISABLE;
+	else if (strcasecmp(edge, "falling") == 0)
+		*bits = MCP2221_INT_POS_EDGE_DISABLE | MCP2221_INT_NEG_EDGE_ENABLE;
+	else if (strcasecmp(edge, "both") == 0)
+		*bits = MCP2221_INT_POS_EDGE_ENABLE | MCP2221_INT_NEG_EDGE_ENABLE;
+	else
+		return MCP2221_ERR_INVALID;
+
+	return MCP2221_ERR_OK;
+}
+
 mcp2221_error_code_t mcp2221_internal_analog_adc_reference_to_bits(
 	mcp2221_analog_voltage_reference_t reference,
 	int *bits) {
@@ -129,6 +199,183 @@ mcp2221_error_code_t mcp2221_internal_analog_adc_raw_to_volts(
 	return MCP2221_ERR_OK;
 }
 
+/*
+ * Bulk conversions.
+ *
+ * Each kernel validates the whole input first and writes nothing when an
+ * element is rejected, then converts with the same IEEE operations, in the
+ * same order, as the scalar helpers. The vector paths therefore give
+ * bit-identical results. Division by 1024.0 is replaced by multiplication
+ * with 2^-10, which is exact for every 10-bit input.
+ */
+
+// Helper: nonzero when every raw value fits in 10 bits.
+static int adc_raw_all_valid(const uint16_t *in, size_t n) {
+	uint16_t bits = 0;
+	for (size_t i = 0; i < n; i++)
+		bits |= in[i];
+	return (bits & ~(uint16_t)1023u) == 0;
+}
+
+// Helper: out[i] = in[i] * 2^-10 * reference_voltage; multiply by 1.0 for normalized values.
+static void adc_raw_scale_n(const uint16_t *in, double *out, size_t n, double reference_voltage, int apply_reference) {
+	const double scale = 1.0 / 1024.0;
+	size_t i = 0;
+
+#if defined(MCP2221_ANALOG_SSE2)
+	const __m128d vscale = _mm_set1_pd(scale);
+	const __m128d vref = _mm_set1_pd(reference_voltage);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 8 <= n; i += 8) {
+		__m128i raw = _mm_loadu_si128((const __m128i *)(const void *)(in + i));
+		__m128i lo = _mm_unpacklo_epi16(raw, zero);
+		__m128i hi = _mm_unpackhi_epi16(raw, zero);
+		__m128d d[4] = {
+			_mm_cvtepi32_pd(lo), _mm_cvtepi32_pd(_mm_srli_si128(lo, 8)),
+			_mm_cvtepi32_pd(hi), _mm_cvtepi32_pd(_mm_srli_si128(hi, 8))
+		};
+		for (int k = 0; k < 4; k++) {
+			d[k] = _mm_mul_pd(d[k], vscale);
+			if (apply_reference)
+				d[k] = _mm_mul_pd(d[k], vref);
+			_mm_storeu_pd(out + i + 2 * k, d[k]);
+		}
+	}
+#elif defined(MCP2221_ANALOG_NEON)
+	const float64x2_t vscale = vdupq_n_f64(scale);
+	const float64x2_t vref = vdupq_n_f64(reference_voltage);
+	for (; i + 8 <= n; i += 8) {
+		uint16x8_t raw = vld1q_u16(in + i);
+		uint32x4_t lo = vmovl_u16(vget_low_u16(raw));
+		uint32x4_t hi = vmovl_u16(vget_high_u16(raw));
+		float64x2_t d[4] = {
+			vcvtq_f64_u64(vmovl_u32(vget_low_u32(lo))), vcvtq_f64_u64(vmovl_u32(vget_high_u32(lo))),
+			vcvtq_f64_u64(vmovl_u32(vget_low_u32(hi))), vcvtq_f64_u64(vmovl_u32(vget_high_u32(hi)))
+		};
+		for (int k = 0; k < 4; k++) {
+			d[k] = vmulq_f64(d[k], vscale);
+			if (apply_reference)
+				d[k] = vmulq_f64(d[k], vref);
+			vst1q_f64(out + i + 2 * k, d[k]);
+		}
+	}
+#endif
+
+	for (; i < n; i++) {
+		double value = (double)in[i] * scale;
+		out[i] = apply_reference ? value * reference_voltage : value;
+	}
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_adc_raw_to_normalized_n(
+	const uint16_t *in,
+	double *out,
+	size_t n) {
+	if ((!in || !out) && n > 0)
+		return MCP2221_ERR_INVALID;
+	if (!adc_raw_all_valid(in, n))
+		return MCP2221_ERR_INVALID;
+
+	adc_raw_scale_n(in, out, n, 1.0, 0);
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_adc_raw_to_volts_n(
+	const uint16_t *in,
+	double *out,
+	size_t n,
+	double reference_voltage) {
+	if (((!in || !out) && n > 0) || !(reference_voltage > 0.0))
+		return MCP2221_ERR_INVALID;
+	if (!adc_raw_all_valid(in, n))
+		return MCP2221_ERR_INVALID;
+
+	adc_raw_scale_n(in, out, n, reference_voltage, 1);
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_dac_volts_to_raw_n(
+	const double *in,
+	uint8_t *out,
+	size_t n,
+	double reference_voltage) {
+	const double max_normalized =
+		(double)MCP2221_DAC_RAW_MAX / (double)MCP2221_DAC_LEVEL_COUNT;
+
+	if (((!in || !out) && n > 0) || !(reference_voltage > 0.0))
+		return MCP2221_ERR_INVALID;
+
+	const double max_volts = reference_voltage * max_normalized;
+	int valid = 1;
+	for (size_t i = 0; i < n; i++)
+		valid &= (in[i] >= 0.0) & (in[i] <= max_volts);
+	if (!valid)
+		return MCP2221_ERR_INVALID;
+
+	const double levels = (double)MCP2221_DAC_LEVEL_COUNT;
+	size_t i = 0;
+
+	/*
+	 * nextafter(x, INFINITY) of a non-negative finite double is the next bit
+	 * pattern. For -0.0 that is a negative subnormal instead of a positive
+	 * one; both truncate to code 0.
+	 */
+#if defined(MCP2221_ANALOG_SSE2)
+	const __m128d vref = _mm_set1_pd(reference_voltage);
+	const __m128d vlevels = _mm_set1_pd(levels);
+#ifdef LIBEASYMCP2221_HAVE_NEXTAFTER
+	const __m128i one = _mm_set_epi32(0, 1, 0, 1);
+#else
+	const __m128d veps = _mm_set1_pd(DBL_EPSILON);
+	const __m128d vtwo = _mm_set1_pd(2.0);
+#endif
+	for (; i + 4 <= n; i += 4) {
+		__m128i codes[2];
+		for (int k = 0; k < 2; k++) {
+			__m128d scaled = _mm_mul_pd(_mm_div_pd(_mm_loadu_pd(in + i + 2 * k), vref), vlevels);
+#ifdef LIBEASYMCP2221_HAVE_NEXTAFTER
+			scaled = _mm_castsi128_pd(_mm_add_epi64(_mm_castpd_si128(scaled), one));
+#else
+			scaled = _mm_add_pd(scaled, _mm_mul_pd(_mm_mul_pd(scaled, veps), vtwo));
+#endif
+			codes[k] = _mm_cvttpd_epi32(scaled);
+		}
+		__m128i packed = _mm_unpacklo_epi64(codes[0], codes[1]);
+		packed = _mm_packs_epi32(packed, packed);
+		packed = _mm_packus_epi16(packed, packed);
+		uint32_t four = (uint32_t)_mm_cvtsi128_si32(packed);
+		memcpy(out + i, &four, sizeof(four));
+	}
+#elif defined(MCP2221_ANALOG_NEON)
+	const float64x2_t vref = vdupq_n_f64(reference_voltage);
+	const float64x2_t vlevels = vdupq_n_f64(levels);
+#ifdef LIBEASYMCP2221_HAVE_NEXTAFTER
+	const uint64x2_t one = vdupq_n_u64(1);
+#else
+	const float64x2_t veps = vdupq_n_f64(DBL_EPSILON);
+	const float64x2_t vtwo = vdupq_n_f64(2.0);
+#endif
+	for (; i + 2 <= n; i += 2) {
+		float64x2_t scaled = vmulq_f64(vdivq_f64(vld1q_f64(in + i), vref), vlevels);
+#ifdef LIBEASYMCP2221_HAVE_NEXTAFTER
+		scaled = vreinterpretq_f64_u64(vaddq_u64(vreinterpretq_u64_f64(scaled), one));
+#else
+		scaled = vaddq_f64(scaled, vmulq_f64(vmulq_f64(scaled, veps), vtwo));
+#endif
+		uint64x2_t codes = vcvtq_u64_f64(scaled);
+		out[i] = (uint8_t)vgetq_lane_u64(codes, 0);
+		out[i + 1] = (uint8_t)vgetq_lane_u64(codes, 1);
+	}
+#endif
+
+	for (; i < n; i++) {
+		double scaled = in[i] / reference_voltage * levels;
+		out[i] = (uint8_t)mcp2221_internal_analog_dac_stabilize_scaled(scaled);
+	}
+
+	return MCP2221_ERR_OK;
+}
+
 mcp2221_error_code_t mcp2221_internal_analog_dac_reference_to_bits(
 	mcp2221_analog_voltage_reference_t reference,
 	int *bits) {
@@ -243,33 +490,199 @@ mcp2221_error_code_t mcp2221_internal_analog_dac_volts_to_raw(
 	return MCP2221_ERR_OK;
 }
 
-mcp2221_error_code_t mcp2221_internal_analog_get_reference_voltage(
-	const mcp2221_t *dev,
-	mcp2221_analog_voltage_reference_t reference,
-	double *volts) {
-	if (!volts)
-		return MCP2221_ERR_INVALID;
-
+// Helper: voltage of an internal VRM reference.
+static int fixed_reference_voltage(mcp2221_analog_voltage_reference_t reference, double *volts) {
 	switch (reference) {
 	case MCP2221_ANALOG_VOLTAGE_REF_1_024V:
 		*volts = 1.024;
-		return MCP2221_ERR_OK;
+		return 1;
 
 	case MCP2221_ANALOG_VOLTAGE_REF_2_048V:
 		*volts = 2.048;
-		return MCP2221_ERR_OK;
+		return 1;
 
 	case MCP2221_ANALOG_VOLTAGE_REF_4_096V:
 		*volts = 4.096;
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+// Helper: order-preserving integer key of a non-negative double.
+static uint64_t double_key(double value) {
+	uint64_t key;
+	memcpy(&key, &value, sizeof(key));
+	return key;
+}
+
+static double key_double(uint64_t key) {
+	double value;
+	memcpy(&value, &key, sizeof(value));
+	return value;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_dac_table_build(
+	mcp2221_internal_analog_dac_table_t *table,
+	double reference_voltage) {
+	const double max_normalized =
+		(double)MCP2221_DAC_RAW_MAX / (double)MCP2221_DAC_LEVEL_COUNT;
+
+	if (!table)
+		return MCP2221_ERR_INVALID;
+
+	table->valid = 0;
+	if (!(reference_voltage > 0.0) || !(reference_voltage <= DBL_MAX))
+		return MCP2221_ERR_INVALID;
+
+	table->reference_voltage = reference_voltage;
+	table->max_volts = reference_voltage * max_normalized;
+	table->threshold[0] = 0.0;
+
+	/*
+	 * The conversion is monotonic, and non-negative doubles order like their
+	 * bit patterns, so each threshold is a bisection over those patterns:
+	 * lo always converts below code k and hi to code k or above.
+	 */
+	for (unsigned k = 1; k < MCP2221_DAC_LEVEL_COUNT; k++) {
+		uint64_t lo = double_key(table->threshold[k - 1]);
+		uint64_t hi = double_key(table->max_volts);
+		uint8_t raw;
+
+		if (k > 1)
+			lo--;
+		while (hi - lo > 1) {
+			uint64_t mid = lo + (hi - lo) / 2;
+			if (mcp2221_internal_analog_dac_volts_to_raw(key_double(mid), reference_voltage, &raw) != MCP2221_ERR_OK)
+				return MCP2221_ERR_INVALID;
+			if (raw >= k)
+				hi = mid;
+			else
+				lo = mid;
+		}
+		table->threshold[k] = key_double(hi);
+	}
+
+	table->valid = 1;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_dac_table_lookup(
+	const mcp2221_internal_analog_dac_table_t *table,
+	double volts,
+	uint8_t *raw) {
+	if (!table || !table->valid || !raw ||
+	    !(volts >= 0.0) ||
+	    volts > table->max_volts)
+		return MCP2221_ERR_INVALID;
+
+	unsigned lo = 0;
+	unsigned hi = MCP2221_DAC_LEVEL_COUNT;
+	while (hi - lo > 1) {
+		unsigned mid = (lo + hi) / 2;
+		if (volts >= table->threshold[mid])
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	*raw = (uint8_t)lo;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_internal_analog_get_reference_voltage(
+	const mcp2221_t *dev,
+	mcp2221_analog_voltage_reference_t reference,
+	double *volts) {
+	if (!volts)
+		return MCP2221_ERR_INVALID;
+
+	if (fixed_reference_voltage(reference, volts))
 		return MCP2221_ERR_OK;
 
-	case MCP2221_ANALOG_VOLTAGE_REF_VDD:
+	if (reference == MCP2221_ANALOG_VOLTAGE_REF_VDD)
 		return mcp2221_internal_analog_get_vdd(dev, volts);
 
-	case MCP2221_ANALOG_VOLTAGE_REF_OFF:
-	default:
-		return MCP2221_ERR_INVALID;
+	return MCP2221_ERR_INVALID;
+}
+
+// Helper: resolve the voltage of the cached ADC reference.
+static void state_update_adc_reference_volts(mcp2221_internal_analog_state_t *state) {
+	state->adc_ref_volts_valid = 0;
+	if (!state->adc_ref_valid)
+		return;
+
+	if (fixed_reference_voltage(state->adc_ref, &state->adc_ref_volts)) {
+		state->adc_ref_volts_valid = 1;
+	} else if (state->adc_ref == MCP2221_ANALOG_VOLTAGE_REF_VDD && state->vdd_valid) {
+		state->adc_ref_volts = state->vdd;
+		state->adc_ref_volts_valid = 1;
+	}
+}
+
+void mcp2221_internal_analog_state_init(
+	mcp2221_internal_analog_state_t *state) {
+	if (state)
+		memset(state, 0, sizeof(*state));
+}
+
+void mcp2221_internal_analog_state_set_adc_reference(
+	mcp2221_internal_analog_state_t *state,
+	uint8_t bits,
+	double now) {
+	if (!state)
+		return;
+
+	state->adc_ref_valid =
+		mcp2221_internal_analog_adc_reference_from_bits(bits, &state->adc_ref) == MCP2221_ERR_OK;
+	state->adc_ref_time = now;
+	state_update_adc_reference_volts(state);
+}
+
+void mcp2221_internal_analog_state_set_dac_reference(
+	mcp2221_internal_analog_state_t *state,
+	uint8_t bits,
+	double now) {
+	if (!state)
+		return;
+
+	state->dac_ref_valid =
+		mcp2221_internal_analog_dac_reference_from_bits(bits, &state->dac_ref) == MCP2221_ERR_OK;
+	state->dac_ref_time = now;
+}
+
+void mcp2221_internal_analog_state_invalidate_references(
+	mcp2221_internal_analog_state_t *state) {
+	if (!state)
+		return;
+
+	state->adc_ref_valid = 0;
+	state->adc_ref_volts_valid = 0;
+	state->dac_ref_valid = 0;
+}
+
+const mcp2221_internal_analog_dac_table_t *mcp2221_internal_analog_state_dac_table(
+	mcp2221_internal_analog_state_t *state) {
+	if (!state || !state->dac_ref_valid)
+		return NULL;
+
+	mcp2221_internal_analog_dac_table_t *table = &state->dac_tables[state->dac_ref];
+	if (table->valid)
+		return table;
+
+	double reference_voltage;
+	if (fixed_reference_voltage(state->dac_ref, &reference_voltage)) {
+		// Fixed references always resolve.
+	} else if (state->dac_ref == MCP2221_ANALOG_VOLTAGE_REF_VDD && state->vdd_valid) {
+		reference_voltage = state->vdd;
+	} else {
+		return NULL;
 	}
+
+	if (mcp2221_internal_analog_dac_table_build(table, reference_voltage) != MCP2221_ERR_OK)
+		return NULL;
+	return table;
 }
 
 mcp2221_error_code_t mcp2221_internal_analog_state_set_vdd(
@@ -282,8 +695,11 @@ mcp2221_error_code_t mcp2221_internal_analog_state_set_vdd(
 	      volts <= MCP2221_MAX_VDD_VOLTS))
 		return MCP2221_ERR_INVALID;
 
+	if (!state->vdd_valid || state->vdd != volts)
+		state->dac_tables[MCP2221_ANALOG_VOLTAGE_REF_VDD].valid = 0;
 	state->vdd = volts;
 	state->vdd_valid = 1;
+	state_update_adc_reference_volts(state);
 
 	return MCP2221_ERR_OK;
 }
@@ -300,3 +716,11 @@ mcp2221_error_code_t mcp2221_internal_analog_state_get_vdd(
 	*volts = state->vdd;
 	return MCP2221_ERR_OK;
 }
+
+void mcp2221_internal_analog_adc_decode(
+	const uint8_t *rbuf,
+	uint16_t out[3]) {
+	out[0] = rbuf[MCP2221_I2C_POLL_RESP_ADC_CH0_LSB] + ((uint16_t)rbuf[MCP2221_I2C_POLL_RESP_ADC_CH0_MSB] << 8);
+	out[1] = rbuf[MCP2221_I2C_POLL_RESP_ADC_CH1_LSB] + ((uint16_t)rbuf[MCP2221_I2C_POLL_RESP_ADC_CH1_MSB] << 8);
+	out[2] = rbuf[MCP2221_I2C_POLL_RESP_ADC_CH2_LSB] + ((uint16_t)rbuf[MCP2221_I2C_POLL_RESP_ADC_CH2_MSB] << 8);
+}
@@ -0,0 +1,103 @@
+#include "mcp2221_internal_bus.h"
+
+#include <string.h>
+
+void mcp2221_internal_bus_sched_init(mcp2221_internal_bus_sched_t *sched) {
+	if (!sched)
+		return;
+
+	memset(sched, 0, sizeof(*sched));
+}
+
+void mcp2221_internal_bus_flow_attach(
+	mcp2221_internal_bus_sched_t *sched,
+	mcp2221_internal_bus_flow_t *flow,
+	int priority,
+	unsigned weight) {
+	if (!sched || !flow)
+		return;
+
+	memset(flow, 0, sizeof(*flow));
+	flow->priority = priority;
+	flow->weight = weight ? weight : 1u;
+	flow->last_finish = sched->virtual_time;
+	flow->next_flow = sched->flows;
+	sched->flows = flow;
+}
+
+void mcp2221_internal_bus_flow_detach(
+	mcp2221_internal_bus_sched_t *sched,
+	mcp2221_internal_bus_flow_t *flow) {
+	if (!sched || !flow)
+		return;
+
+	for (mcp2221_internal_bus_flow_t **it = &sched->flows; *it; it = &(*it)->next_flow) {
+		if (*it == flow) {
+			*it = flow->next_flow;
+			flow->next_flow = NULL;
+			return;
+		}
+	}
+}
+
+void mcp2221_internal_bus_sched_push(
+	mcp2221_internal_bus_sched_t *sched,
+	mcp2221_internal_bus_flow_t *flow,
+	mcp2221_internal_bus_node_t *node,
+	size_t cost) {
+	if (!sched || !flow || !node)
+		return;
+
+	/*
+	 * SCFQ: a node starts at the later of the current virtual time and the
+	 * finish tag of the flow's previous node, and finishes cost/weight later.
+	 * An idle flow therefore cannot bank credit while it is not sending.
+	 */
+	uint64_t start = flow->last_finish > sched->virtual_time ? flow->last_finish : sched->virtual_time;
+	uint64_t scaled = (uint64_t)(cost + MCP2221_INTERNAL_BUS_TXN_OVERHEAD) * MCP2221_INTERNAL_BUS_TAG_SCALE;
+
+	node->next = NULL;
+	node->flow = flow;
+	node->cost = cost;
+	node->finish_tag = start + scaled / flow->weight;
+	flow->last_finish = node->finish_tag;
+
+	if (flow->tail)
+		flow->tail->next = node;
+	else
+		flow->head = node;
+	flow->tail = node;
+	flow->queued++;
+	sched->queued++;
+}
+
+mcp2221_internal_bus_node_t *mcp2221_internal_bus_sched_pop(mcp2221_internal_bus_sched_t *sched) {
+	if (!sched || sched->queued == 0)
+		return NULL;
+
+	mcp2221_internal_bus_flow_t *best = NULL;
+	for (mcp2221_internal_bus_flow_t *flow = sched->flows; flow; flow = flow->next_flow) {
+		if (!flow->head)
+			continue;
+		if (!best || flow->priority > best->priority ||
+		    (flow->priority == best->priority && flow->head->finish_tag < best->head->finish_tag))
+			best = flow;
+	}
+
+	if (!best)
+		return NULL;
+
+	mcp2221_internal_bus_node_t *node = best->head;
+	best->head = node->next;
+	if (!best->head)
+		best->tail = NULL;
+	best->queued--;
+	sched->queued--;
+
+	/* Self-clocking: virtual time follows the tag of the node in service. */
+	if (node->finish_tag > sched->virtual_time)
+		sched->virtual_time = node->finish_tag;
+
+	node->next = NULL;
+	return node;
+}
@@ -0,0 +1,140 @@
+#include "mcp2221_internal_gpio.h"
+
+#include <string.h>
+
+#include "mcp2221_internal.h"
+
+void mcp2221_internal_gpio_snapshot_init(mcp2221_internal_gpio_snapshot_t *snap) {
+	if (!snap)
+		return;
+
+	memset(snap, 0, sizeof(*snap));
+	pthread_mutex_init(&snap->lock, NULL);
+	pthread_cond_init(&snap->done, NULL);
+}
+
+void mcp2221_internal_gpio_snapshot_destroy(mcp2221_internal_gpio_snapshot_t *snap) {
+	if (!snap)
+		return;
+
+	pthread_cond_destroy(&snap->done);
+	pthread_mutex_destroy(&snap->lock);
+}
+
+mcp2221_error_code_t mcp2221_internal_gpio_snapshot_acquire(mcp2221_internal_gpio_snapshot_t *snap, uint32_t max_age_us,
+							   mcp2221_internal_gpio_fetch_fn fetch, void *ctx, uint8_t out_values[4],
+							   uint64_t *out_issued_us) {
+	if (!snap || !fetch || !out_values)
+		return MCP2221_ERR_INVALID;
+
+	pthread_mutex_lock(&snap->lock);
+	for (;;) {
+		uint64_t now = mcp2221_internal_monotonic_ns() / 1000u;
+
+		if (snap->valid && now - snap->issued_us < max_age_us) {
+			snap->hits++;
+			memcpy(out_values, snap->values, 4);
+			if (out_issued_us)
+				*out_issued_us = snap->issued_us;
+			pthread_mutex_unlock(&snap->lock);
+			return MCP2221_ERR_OK;
+		}
+
+		if (!snap->in_flight)
+			break;
+
+		/*
+		 * Another reader is already asking the device. If its command was
+		 * issued recently enough and no invalidation happened since, share
+		 * its response; the last completed command is at least as new, even
+		 * if more have finished meanwhile. Otherwise wait for it and issue a
+		 * fresh one.
+		 */
+		uint64_t generation = snap->generation;
+		uint64_t epoch = snap->epoch;
+		int join = snap->pending_epoch == epoch && now - snap->pending_issued_us < max_age_us;
+		while (snap->generation == generation)
+			pthread_cond_wait(&snap->done, &snap->lock);
+
+		if (join && snap->epoch == epoch) {
+			mcp2221_error_code_t err = snap->last_error;
+			snap->coalesced++;
+			if (err == MCP2221_ERR_OK) {
+				memcpy(out_values, snap->last_values, 4);
+				if (out_issued_us)
+					*out_issued_us = snap->last_issued_us;
+			}
+			pthread_mutex_unlock(&snap->lock);
+			return err;
+		}
+	}
+
+	// This reader issues the command. Issue times are kept unique so they identify a response.
+	uint64_t issued = mcp2221_internal_monotonic_ns() / 1000u;
+	if (issued <= snap->pending_issued_us)
+		issued = snap->pending_issued_us + 1;
+	uint64_t epoch = snap->epoch;
+	snap->in_flight = 1;
+	snap->pending_issued_us = issued;
+	snap->pending_epoch = epoch;
+	snap->misses++;
+	pthread_mutex_unlock(&snap->lock);
+
+	uint8_t values[4];
+	mcp2221_error_code_t err = fetch(ctx, values);
+
+	pthread_mutex_lock(&snap->lock);
+	snap->in_flight = 0;
+	snap->generation++;
+	snap->last_error = err;
+	if (err == MCP2221_ERR_OK) {
+		memcpy(snap->last_values, values, 4);
+		snap->last_issued_us = issued;
+	}
+	if (err == MCP2221_ERR_OK && snap->epoch == epoch) {
+		memcpy(snap->values, values, 4);
+		snap->issued_us = issued;
+		snap->valid = 1;
+	}
+	pthread_cond_broadcast(&snap->done);
+	pthread_mutex_unlock(&snap->lock);
+
+	if (err == MCP2221_ERR_OK) {
+		memcpy(out_values, values, 4);
+		if (out_issued_us)
+			*out_issued_us = issued;
+	}
+	return err;
+}
+
+void mcp2221_internal_gpio_snapshot_invalidate(mcp2221_internal_gpio_snapshot_t *snap) {
+	if (!snap)
+		return;
+
+	pthread_mutex_lock(&snap->lock);
+	snap->valid = 0;
+	snap->epoch++;
+	pthread_mutex_unlock(&snap->lock);
+}
+
+void mcp2221_internal_gpio_snapshot_get_stats(mcp2221_internal_gpio_snapshot_t *snap, mcp2221_gpio_snapshot_stats_t *stats) {
+	if (!snap || !stats)
+		return;
+
+	pthread_mutex_lock(&snap->lock);
+	stats->hits = snap->hits;
+	stats->misses = snap->misses;
+	stats->coalesced = snap->coalesced;
+	pthread_mutex_unlock(&snap->lock);
+}
+
+void mcp2221_internal_gpio_snapshot_reset_stats(mcp2221_internal_gpio_snapshot_t *snap) {
+	if (!snap)
+		return;
+
+	pthread_mutex_lock(&snap->lock);
+	snap->hits = 0;
+	snap->misses = 0;
+	snap->coalesced = 0;
+	pthread_mutex_unlock(&snap->lock);
+}
@@ -0,0 +1,67 @@
+#include "mcp2221_internal_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * head and tail increase monotonically and are reduced with mask on access.
+ * The producer publishes a slot with a release store of head after copying
+ * the element; the consumer releases the slot with a release store of tail.
+ */
+#define RING_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define RING_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+mcp2221_error_code_t mcp2221_internal_ring_init(mcp2221_internal_ring_t *ring, size_t elem_size, size_t capacity) {
+	if (!ring || elem_size == 0 || capacity == 0 || capacity > ((size_t)1 << 24))
+		return MCP2221_ERR_INVALID;
+
+	size_t slots = 1;
+	while (slots < capacity)
+		slots <<= 1;
+
+	memset(ring, 0, sizeof(*ring));
+	ring->slots = calloc(slots, elem_size);
+	if (!ring->slots)
+		return MCP2221_ERR_NO_MEMORY;
+
+	ring->elem_size = elem_size;
+	ring->mask = slots - 1;
+	return MCP2221_ERR_OK;
+}
+
+void mcp2221_internal_ring_free(mcp2221_internal_ring_t *ring) {
+	if (!ring)
+		return;
+
+	free(ring->slots);
+	memset(ring, 0, sizeof(*ring));
+}
+
+size_t mcp2221_internal_ring_capacity(const mcp2221_internal_ring_t *ring) {
+	return ring && ring->slots ? ring->mask + 1 : 0;
+}
+
+int mcp2221_internal_ring_push(mcp2221_internal_ring_t *ring, const void *elem) {
+	size_t head = RING_LOAD_RELAXED(&ring->head);
+	size_t tail = RING_LOAD_ACQUIRE(&ring->tail);
+
+	if (head - tail > ring->mask)
+		return 0;
+
+	memcpy(ring->slots + (head & ring->mask) * ring->elem_size, elem, ring->elem_size);
+	RING_STORE_RELEASE(&ring->head, head + 1);
+	return 1;
+}
+
+int mcp2221_internal_ring_pop(mcp2221_internal_ring_t *ring, void *elem) {
+	size_t tail = RING_LOAD_RELAXED(&ring->tail);
+	size_t head = RING_LOAD_ACQUIRE(&ring->head);
+
+	if (head == tail)
+		return 0;
+
+	memcpy(elem, ring->slots + (tail & ring->mask) * ring->elem_size, ring->elem_size);
+	RING_STORE_RELEASE(&ring->tail, tail + 1);
+	return 1;
+}
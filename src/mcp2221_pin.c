@@ -2,6 +2,7 @@
 
 #include <string.h>
 
+#include "mcp2221_internal.h"
 #include "mcp2221_internal_constants.h"
 #include "mcp2221_sram.h"
 
@@ -165,6 +166,26 @@ static mcp2221_error_code_t fill_gp_config_from_function(mcp2221_gpio_pin_t pin,
 	}
 }
 
+mcp2221_error_code_t mcp2221_internal_pin_gp_byte(
+	mcp2221_gpio_pin_t pin, mcp2221_pin_function_t function, int out_value, uint8_t *gp_byte) {
+	if (!gp_byte || pin < 0 || pin > 3 || function == MCP2221_PIN_FUNC_KEEP)
+		return MCP2221_ERR_INVALID;
+	if ((out_value != 0 && out_value != 1) || !is_function_allowed(pin, function))
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_sram_gp_config_t gp;
+	mcp2221_error_code_t err = fill_gp_config_from_function(pin, function, out_value, &gp);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	*gp_byte = (uint8_t)gp.function;
+	if (gp.direction)
+		*gp_byte |= MCP2221_GPIO_DIR_IN;
+	if (gp.value)
+		*gp_byte |= MCP2221_GPIO_OUT_VAL_1;
+	return MCP2221_ERR_OK;
+}
+
 mcp2221_error_code_t mcp2221_pin_set_functions(mcp2221_t *dev, const mcp2221_pin_functions_t *cfg) {
 	if (!dev || !cfg)
 		return MCP2221_ERR_INVALID;
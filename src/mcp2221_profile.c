@@ -0,0 +1,621 @@
+#include "mcp2221_profile.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "mcp2221_config_txn.h"
+#include "mcp2221_flash.h"
+#include "mcp2221_flash_info.h"
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_analog.h"
+#include "mcp2221_internal_constants.h"
+#include "mcp2221_internal_usb.h"
+#include "mcp2221_usb.h"
+
+#define PROFILE_LINE_MAX 256
+
+typedef struct {
+	const char *name;
+	int value;
+} name_value_t;
+
+static const name_value_t pin_names[] = {
+	{"keep", MCP2221_PIN_FUNC_KEEP},
+	{"gpio_in", MCP2221_PIN_FUNC_GPIO_IN},
+	{"gpio_out", MCP2221_PIN_FUNC_GPIO_OUT},
+	{"gpio_out_high", MCP2221_PIN_FUNC_GPIO_OUT},
+	{"dedicated", MCP2221_PIN_FUNC_DEDICATED},
+	{"alt0", MCP2221_PIN_FUNC_ALT0},
+	{"alt1", MCP2221_PIN_FUNC_ALT1},
+	{"alt2", MCP2221_PIN_FUNC_ALT2},
+};
+
+// Names as accepted by mcp2221_adc_config() and mcp2221_dac_config().
+static const name_value_t ref_names[] = {
+	{"keep", MCP2221_PROFILE_REF_KEEP},
+	{"OFF", MCP2221_PROFILE_REF_OFF},
+	{"VDD", MCP2221_PROFILE_REF_VDD},
+	{"1.024V", MCP2221_PROFILE_REF_1_024V},
+	{"2.048V", MCP2221_PROFILE_REF_2_048V},
+	{"4.096V", MCP2221_PROFILE_REF_4_096V},
+};
+
+// Names as accepted by mcp2221_ioc_config().
+static const name_value_t ioc_names[] = {
+	{"keep", MCP2221_PROFILE_IOC_KEEP},
+	{"none", MCP2221_PROFILE_IOC_NONE},
+	{"rising", MCP2221_PROFILE_IOC_RISING},
+	{"falling", MCP2221_PROFILE_IOC_FALLING},
+	{"both", MCP2221_PROFILE_IOC_BOTH},
+};
+
+// Names as accepted by mcp2221_clock_config(), indexed by divider - 1.
+static const char *const clock_names[] = {"24MHz", "12MHz", "6MHz", "3MHz", "1.5MHz", "750kHz", "375kHz"};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static int lookup_name(const name_value_t *table, size_t n, const char *name, int *value) {
+	for (size_t i = 0; i < n; i++) {
+		if (strcasecmp(table[i].name, name) == 0) {
+			*value = table[i].value;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static const char *name_of(const name_value_t *table, size_t n, int value) {
+	for (size_t i = 0; i < n; i++) {
+		if (table[i].value == value)
+			return table[i].name;
+	}
+	return NULL;
+}
+
+static const char *clock_name(uint32_t hz) {
+	for (size_t i = 0; i < COUNT_OF(clock_names); i++) {
+		if (hz == (48000000u >> (i + 1)))
+			return clock_names[i];
+	}
+	return NULL;
+}
+
+static int parse_long(const char *text, long min, long max, long *value) {
+	char *end;
+	errno = 0;
+	long v = strtol(text, &end, 10);
+	if (errno != 0 || end == text || *end != '\0' || v < min || v > max)
+		return 0;
+	*value = v;
+	return 1;
+}
+
+static char *trim(char *s) {
+	while (*s == ' ' || *s == '\t')
+		s++;
+	size_t len = strlen(s);
+	while (len > 0 && (s[len - 1] == ' ' || s[len - 1] == '\t' || s[len - 1] == '\r'))
+		s[--len] = '\0';
+	return s;
+}
+
+typedef enum {
+	SECTION_NONE,
+	SECTION_PINS,
+	SECTION_ANALOG,
+	SECTION_CLOCK,
+	SECTION_IOC,
+	SECTION_I2C,
+	SECTION_USB
+} section_t;
+
+static const name_value_t section_names[] = {
+	{"pins", SECTION_PINS},
+	{"analog", SECTION_ANALOG},
+	{"clock", SECTION_CLOCK},
+	{"ioc", SECTION_IOC},
+	{"i2c", SECTION_I2C},
+	{"usb", SECTION_USB},
+};
+
+static int parse_key(mcp2221_profile_t *p, section_t section, const char *key, const char *value) {
+	long number;
+	int symbol;
+
+	switch (section) {
+	case SECTION_PINS:
+		if (strlen(key) == 3 && strncasecmp(key, "gp", 2) == 0 && key[2] >= '0' && key[2] <= '3') {
+			int pin = key[2] - '0';
+			if (!lookup_name(pin_names, COUNT_OF(pin_names), value, &symbol))
+				return 0;
+			p->gp[pin] = (mcp2221_pin_function_t)symbol;
+			p->gp_out[pin] = strcasecmp(value, "gpio_out_high") == 0;
+			return 1;
+		}
+		return 0;
+
+	case SECTION_ANALOG:
+		if (strcasecmp(key, "adc_ref") == 0 && lookup_name(ref_names, COUNT_OF(ref_names), value, &symbol)) {
+			p->adc_ref = (mcp2221_profile_ref_t)symbol;
+			return 1;
+		}
+		if (strcasecmp(key, "dac_ref") == 0 && lookup_name(ref_names, COUNT_OF(ref_names), value, &symbol)) {
+			p->dac_ref = (mcp2221_profile_ref_t)symbol;
+			return 1;
+		}
+		if (strcasecmp(key, "dac_value") == 0 && parse_long(value, -1, 31, &number)) {
+			p->dac_value = (int)number;
+			return 1;
+		}
+		return 0;
+
+	case SECTION_CLOCK:
+		if (strcasecmp(key, "duty") == 0 && parse_long(value, -1, 75, &number)) {
+			p->clock_duty_percent = (int)number;
+			return 1;
+		}
+		if (strcasecmp(key, "freq") == 0) {
+			if (strcasecmp(value, "keep") == 0) {
+				p->clock_hz = 0;
+				return 1;
+			}
+			for (size_t i = 0; i < COUNT_OF(clock_names); i++) {
+				if (strcasecmp(value, clock_names[i]) == 0) {
+					p->clock_hz = 48000000u >> (i + 1);
+					return 1;
+				}
+			}
+		}
+		return 0;
+
+	case SECTION_IOC:
+		if (strcasecmp(key, "edge") == 0 && lookup_name(ioc_names, COUNT_OF(ioc_names), value, &symbol)) {
+			p->ioc_edge = (mcp2221_profile_ioc_t)symbol;
+			return 1;
+		}
+		return 0;
+
+	case SECTION_I2C:
+		if (strcasecmp(key, "speed_hz") == 0 && parse_long(value, 0, MCP2221_I2C_SPEED_MAX_HZ, &number)) {
+			p->i2c_speed_hz = (uint32_t)number;
+			return 1;
+		}
+		return 0;
+
+	case SECTION_USB:
+		if (strcasecmp(key, "remote_wakeup") == 0 && parse_long(value, -1, 1, &number)) {
+			p->usb_remote_wakeup = (int)number;
+			return 1;
+		}
+		if (strcasecmp(key, "self_powered") == 0 && parse_long(value, -1, 1, &number)) {
+			p->usb_self_powered = (int)number;
+			return 1;
+		}
+		if (strcasecmp(key, "requested_current_ma") == 0 && parse_long(value, -1, 500, &number)) {
+			p->usb_requested_current_ma = (int)number;
+			return 1;
+		}
+		return 0;
+
+	case SECTION_NONE:
+	default:
+		return 0;
+	}
+}
+
+static int parse_line(mcp2221_profile_t *p, section_t *section, char *line) {
+	char *comment = strpbrk(line, "#;");
+	if (comment)
+		*comment = '\0';
+	line = trim(line);
+	if (*line == '\0')
+		return 1;
+
+	if (*line == '[') {
+		size_t len = strlen(line);
+		if (len < 3 || line[len - 1] != ']')
+			return 0;
+		line[len - 1] = '\0';
+		int value;
+		if (!lookup_name(section_names, COUNT_OF(section_names), trim(line + 1), &value))
+			return 0;
+		*section = (section_t)value;
+		return 1;
+	}
+
+	char *eq = strchr(line, '=');
+	if (!eq)
+		return 0;
+	*eq = '\0';
+	return parse_key(p, *section, trim(line), trim(eq + 1));
+}
+
+mcp2221_error_code_t mcp2221_profile_init(mcp2221_profile_t *profile) {
+	if (!profile)
+		return MCP2221_ERR_INVALID;
+
+	memset(profile, 0, sizeof(*profile));
+	for (int i = 0; i < 4; i++)
+		profile->gp[i] = MCP2221_PIN_FUNC_KEEP;
+	profile->adc_ref = MCP2221_PROFILE_REF_KEEP;
+	profile->dac_ref = MCP2221_PROFILE_REF_KEEP;
+	profile->dac_value = -1;
+	profile->clock_duty_percent = -1;
+	profile->ioc_edge = MCP2221_PROFILE_IOC_KEEP;
+	profile->usb_remote_wakeup = -1;
+	profile->usb_self_powered = -1;
+	profile->usb_requested_current_ma = -1;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_profile_parse(const char *text, mcp2221_profile_t *profile, int *out_line) {
+	if (out_line)
+		*out_line = 0;
+	if (!text || !profile)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_profile_init(profile);
+
+	section_t section = SECTION_NONE;
+	char line[PROFILE_LINE_MAX];
+	int line_no = 0;
+
+	while (*text) {
+		const char *end = strchr(text, '\n');
+		size_t len = end ? (size_t)(end - text) : strlen(text);
+		line_no++;
+
+		if (len >= sizeof(line) || (memcpy(line, text, len), line[len] = '\0', !parse_line(profile, &section, line))) {
+			if (out_line)
+				*out_line = line_no;
+			return MCP2221_ERR_INVALID;
+		}
+		text += len + (end ? 1 : 0);
+	}
+
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_profile_load(const char *path, mcp2221_profile_t *profile, int *out_line) {
+	if (out_line)
+		*out_line = 0;
+	if (!path || !profile)
+		return MCP2221_ERR_INVALID;
+
+	FILE *f = fopen(path, "r");
+	if (!f)
+		return MCP2221_ERR_NOT_FOUND;
+
+	size_t cap = 1024, len = 0;
+	char *text = malloc(cap);
+	while (text) {
+		len += fread(text + len, 1, cap - len - 1, f);
+		if (len < cap - 1)
+			break;
+		char *grown = realloc(text, cap * 2);
+		if (!grown) {
+			free(text);
+			text = NULL;
+			break;
+		}
+		text = grown;
+		cap *= 2;
+	}
+
+	int read_error = ferror(f);
+	fclose(f);
+	if (!text)
+		return MCP2221_ERR_NO_MEMORY;
+	if (read_error) {
+		free(text);
+		return MCP2221_ERR_GENERIC;
+	}
+
+	text[len] = '\0';
+	mcp2221_error_code_t err = mcp2221_profile_parse(text, profile, out_line);
+	free(text);
+	return err;
+}
+
+mcp2221_error_code_t mcp2221_profile_save(const char *path, const mcp2221_profile_t *profile) {
+	if (!path || !profile)
+		return MCP2221_ERR_INVALID;
+
+	const mcp2221_profile_t *p = profile;
+	const char *adc = name_of(ref_names, COUNT_OF(ref_names), p->adc_ref);
+	const char *dac = name_of(ref_names, COUNT_OF(ref_names), p->dac_ref);
+	const char *ioc = name_of(ioc_names, COUNT_OF(ioc_names), p->ioc_edge);
+	const char *clk = clock_name(p->clock_hz);
+	if (!adc || !dac || !ioc || (p->clock_hz && !clk))
+		return MCP2221_ERR_INVALID;
+
+	const char *pins[4];
+	for (int i = 0; i < 4; i++) {
+		if (p->gp[i] == MCP2221_PIN_FUNC_GPIO_OUT && p->gp_out[i])
+			pins[i] = "gpio_out_high";
+		else
+			pins[i] = name_of(pin_names, COUNT_OF(pin_names), p->gp[i]);
+		if (!pins[i])
+			return MCP2221_ERR_INVALID;
+	}
+
+	FILE *f = fopen(path, "w");
+	if (!f)
+		return MCP2221_ERR_GENERIC;
+
+	fprintf(f, "[pins]\n");
+	for (int i = 0; i < 4; i++) {
+		if (p->gp[i] != MCP2221_PIN_FUNC_KEEP)
+			fprintf(f, "gp%d = %s\n", i, pins[i]);
+	}
+	fprintf(f, "\n[analog]\n");
+	if (p->adc_ref != MCP2221_PROFILE_REF_KEEP)
+		fprintf(f, "adc_ref = %s\n", adc);
+	if (p->dac_ref != MCP2221_PROFILE_REF_KEEP)
+		fprintf(f, "dac_ref = %s\n", dac);
+	if (p->dac_value >= 0)
+		fprintf(f, "dac_value = %d\n", p->dac_value);
+	fprintf(f, "\n[clock]\n");
+	if (p->clock_duty_percent >= 0)
+		fprintf(f, "duty = %d\n", p->clock_duty_percent);
+	if (clk)
+		fprintf(f, "freq = %s\n", clk);
+	fprintf(f, "\n[ioc]\n");
+	if (p->ioc_edge != MCP2221_PROFILE_IOC_KEEP)
+		fprintf(f, "edge = %s\n", ioc);
+	fprintf(f, "\n[i2c]\n");
+	if (p->i2c_speed_hz)
+		fprintf(f, "speed_hz = %u\n", (unsigned)p->i2c_speed_hz);
+	fprintf(f, "\n[usb]\n");
+	if (p->usb_remote_wakeup >= 0)
+		fprintf(f, "remote_wakeup = %d\n", p->usb_remote_wakeup);
+	if (p->usb_self_powered >= 0)
+		fprintf(f, "self_powered = %d\n", p->usb_self_powered);
+	if (p->usb_requested_current_ma >= 0)
+		fprintf(f, "requested_current_ma = %d\n", p->usb_requested_current_ma);
+
+	int failed = ferror(f);
+	if (fclose(f) != 0 || failed)
+		return MCP2221_ERR_GENERIC;
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_profile_ref_t ref_from_semantic(mcp2221_analog_voltage_reference_t reference) {
+	switch (reference) {
+	case MCP2221_ANALOG_VOLTAGE_REF_OFF:
+		return MCP2221_PROFILE_REF_OFF;
+	case MCP2221_ANALOG_VOLTAGE_REF_VDD:
+		return MCP2221_PROFILE_REF_VDD;
+	case MCP2221_ANALOG_VOLTAGE_REF_1_024V:
+		return MCP2221_PROFILE_REF_1_024V;
+	case MCP2221_ANALOG_VOLTAGE_REF_2_048V:
+		return MCP2221_PROFILE_REF_2_048V;
+	case MCP2221_ANALOG_VOLTAGE_REF_4_096V:
+		return MCP2221_PROFILE_REF_4_096V;
+	default:
+		return MCP2221_PROFILE_REF_KEEP;
+	}
+}
+
+static mcp2221_pin_function_t pin_from_gp_byte(uint8_t gp, int *out) {
+	*out = 0;
+	switch (gp & 0x07) {
+	case MCP2221_GPIO_FUNC_GPIO:
+		if (gp & MCP2221_GPIO_DIR_IN)
+			return MCP2221_PIN_FUNC_GPIO_IN;
+		*out = (gp & MCP2221_GPIO_OUT_VAL_1) ? 1 : 0;
+		return MCP2221_PIN_FUNC_GPIO_OUT;
+	case MCP2221_GPIO_FUNC_DEDICATED:
+		return MCP2221_PIN_FUNC_DEDICATED;
+	case MCP2221_GPIO_FUNC_ALT_0:
+		return MCP2221_PIN_FUNC_ALT0;
+	case MCP2221_GPIO_FUNC_ALT_1:
+		return MCP2221_PIN_FUNC_ALT1;
+	case MCP2221_GPIO_FUNC_ALT_2:
+		return MCP2221_PIN_FUNC_ALT2;
+	default:
+		return MCP2221_PIN_FUNC_KEEP;
+	}
+}
+
+mcp2221_error_code_t mcp2221_profile_capture(mcp2221_t *dev, mcp2221_profile_t *profile) {
+	if (!dev || !profile)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_profile_init(profile);
+
+	uint8_t sram[MCP2221_PACKET_SIZE];
+	mcp2221_error_code_t err = mcp2221_internal_sram_read(dev, sram);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	uint8_t gp[4];
+	if (mcp2221_internal_ensure_gpio_status(dev) != MCP2221_ERR_OK ||
+	    mcp2221_internal_gpio_status_get(dev, gp) != MCP2221_ERR_OK)
+		memcpy(gp, &sram[MCP2221_SRAM_RESPONSE_GP0], sizeof(gp));
+	for (int i = 0; i < 4; i++)
+		profile->gp[i] = pin_from_gp_byte(gp[i], &profile->gp_out[i]);
+
+	mcp2221_analog_voltage_reference_t reference;
+	if (mcp2221_internal_analog_adc_reference_from_bits((sram[MCP2221_SRAM_RESPONSE_INT_ADC] >> 2) & 0x07,
+							  &reference) == MCP2221_ERR_OK)
+		profile->adc_ref = ref_from_semantic(reference);
+	if (mcp2221_internal_analog_dac_reference_from_bits((sram[MCP2221_SRAM_RESPONSE_DAC] >> 5) & 0x07,
+							  &reference) == MCP2221_ERR_OK)
+		profile->dac_ref = ref_from_semantic(reference);
+	profile->dac_value = sram[MCP2221_SRAM_RESPONSE_DAC] & 0x1F;
+
+	uint8_t clk = sram[MCP2221_SRAM_RESPONSE_CLOCK];
+	uint8_t div = clk & 0x07;
+	if (div >= MCP2221_CLK_DIV_1 && div <= MCP2221_CLK_DIV_7) {
+		profile->clock_hz = 48000000u >> div;
+		profile->clock_duty_percent = 25 * ((clk >> 3) & 0x03);
+	}
+
+	int pos = (sram[MCP2221_SRAM_RESPONSE_INT_ADC] & MCP2221_SRAM_RESPONSE_INT_POS_EDGE) != 0;
+	int neg = (sram[MCP2221_SRAM_RESPONSE_INT_ADC] & MCP2221_SRAM_RESPONSE_INT_NEG_EDGE) != 0;
+	profile->ioc_edge = pos ? (neg ? MCP2221_PROFILE_IOC_BOTH : MCP2221_PROFILE_IOC_RISING)
+				: (neg ? MCP2221_PROFILE_IOC_FALLING : MCP2221_PROFILE_IOC_NONE);
+
+	mcp2221_i2c_status_t status;
+	err = mcp2221_i2c_status(dev, &status);
+	if (err != MCP2221_ERR_OK)
+		return err;
+	profile->i2c_speed_hz =
+		(uint32_t)(MCP2221_I2C_BASE_CLOCK_HZ / (double)(status.div + MCP2221_I2C_CLOCK_DIVIDER_OFFSET) + 0.5);
+
+	uint8_t chip[60];
+	err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, chip);
+	if (err != MCP2221_ERR_OK)
+		return err;
+	profile->usb_remote_wakeup = (chip[MCP2221_FLASH_CHIP_SETTINGS_USBPWR] & MCP2221_USB_PWR_REMOTE_WAKEUP) ? 1 : 0;
+	profile->usb_self_powered = (chip[MCP2221_FLASH_CHIP_SETTINGS_USBPWR] & MCP2221_USB_PWR_SELF_POWERED) ? 1 : 0;
+	profile->usb_requested_current_ma = chip[MCP2221_FLASH_CHIP_SETTINGS_USBMA] * MCP2221_USB_CURRENT_UNIT_MA;
+
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_error_code_t build_txn(const mcp2221_profile_t *p, mcp2221_config_txn_t *txn) {
+	mcp2221_error_code_t err = mcp2221_config_txn_init(txn);
+
+	for (int i = 0; i < 4 && err == MCP2221_ERR_OK; i++) {
+		if (p->gp[i] != MCP2221_PIN_FUNC_KEEP)
+			err = mcp2221_config_txn_set_pin(txn, (mcp2221_gpio_pin_t)i, p->gp[i], p->gp_out[i]);
+		else if (p->gp_out[i] != 0)
+			err = MCP2221_ERR_INVALID;
+	}
+
+	if (err == MCP2221_ERR_OK && p->adc_ref != MCP2221_PROFILE_REF_KEEP) {
+		const char *name = name_of(ref_names, COUNT_OF(ref_names), p->adc_ref);
+		err = name ? mcp2221_config_txn_set_adc(txn, name) : MCP2221_ERR_INVALID;
+	}
+
+	if (err == MCP2221_ERR_OK && (p->dac_ref != MCP2221_PROFILE_REF_KEEP || p->dac_value != -1)) {
+		const char *name = NULL;
+		if (p->dac_ref != MCP2221_PROFILE_REF_KEEP) {
+			name = name_of(ref_names, COUNT_OF(ref_names), p->dac_ref);
+			if (!name)
+				return MCP2221_ERR_INVALID;
+		}
+		err = mcp2221_config_txn_set_dac(txn, name, p->dac_value);
+	}
+
+	if (err == MCP2221_ERR_OK && (p->clock_duty_percent != -1 || p->clock_hz != 0)) {
+		const char *name = clock_name(p->clock_hz);
+		err = name ? mcp2221_config_txn_set_clock(txn, p->clock_duty_percent, name) : MCP2221_ERR_INVALID;
+	}
+
+	if (err == MCP2221_ERR_OK && p->ioc_edge != MCP2221_PROFILE_IOC_KEEP) {
+		const char *name = name_of(ioc_names, COUNT_OF(ioc_names), p->ioc_edge);
+		err = name ? mcp2221_config_txn_set_ioc(txn, name) : MCP2221_ERR_INVALID;
+	}
+
+	return err;
+}
+
+static int is_keep_or_flag(int value) {
+	return value == -1 || value == 0 || value == 1;
+}
+
+/*
+ * Stage the USB attributes that differ from their effective value (staged,
+ * otherwise flash). Returns whether anything was staged.
+ */
+static mcp2221_error_code_t stage_usb(mcp2221_t *dev, const mcp2221_profile_t *p, const uint8_t chip[60], int *changed) {
+	const mcp2221_internal_usb_state_t *usb = mcp2221_internal_usb_get_state_const(dev);
+	uint8_t pwr, ma;
+	mcp2221_error_code_t err = mcp2221_internal_usb_state_apply_power_attr(usb, chip[MCP2221_FLASH_CHIP_SETTINGS_USBPWR], &pwr);
+	if (err == MCP2221_ERR_OK)
+		err = mcp2221_internal_usb_state_apply_requested_current(usb, chip[MCP2221_FLASH_CHIP_SETTINGS_USBMA], &ma);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	*changed = 0;
+	if (p->usb_remote_wakeup != -1 && p->usb_remote_wakeup != ((pwr & MCP2221_USB_PWR_REMOTE_WAKEUP) != 0)) {
+		err = mcp2221_usb_set_remote_wakeup(dev, p->usb_remote_wakeup);
+		*changed = 1;
+	}
+	if (err == MCP2221_ERR_OK && p->usb_self_powered != -1 &&
+	    p->usb_self_powered != ((pwr & MCP2221_USB_PWR_SELF_POWERED) != 0)) {
+		err = mcp2221_usb_set_self_powered(dev, p->usb_self_powered);
+		*changed = 1;
+	}
+	if (err == MCP2221_ERR_OK && p->usb_requested_current_ma != -1 &&
+	    (unsigned)p->usb_requested_current_ma != ma * MCP2221_USB_CURRENT_UNIT_MA) {
+		err = mcp2221_usb_set_requested_current(dev, (unsigned)p->usb_requested_current_ma);
+		*changed = 1;
+	}
+	return err;
+}
+
+static mcp2221_error_code_t apply_steps(mcp2221_t *dev, const mcp2221_profile_t *p, unsigned flags,
+					mcp2221_profile_result_t *r) {
+	if (!is_keep_or_flag(p->usb_remote_wakeup) || !is_keep_or_flag(p->usb_self_powered) ||
+	    p->usb_requested_current_ma < -1 || p->usb_requested_current_ma > 500 ||
+	    (p->usb_requested_current_ma > 0 && (p->usb_requested_current_ma % MCP2221_USB_CURRENT_UNIT_MA) != 0))
+		return MCP2221_ERR_INVALID;
+
+	uint8_t divider = 0;
+	if (p->i2c_speed_hz != 0 && mcp2221_internal_i2c_speed_divider(p->i2c_speed_hz, &divider) != MCP2221_ERR_OK)
+		return MCP2221_ERR_INVALID;
+
+	mcp2221_config_txn_t txn;
+	mcp2221_error_code_t err = build_txn(p, &txn);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	err = mcp2221_config_txn_commit(dev, &txn, &r->sram_commands);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	if (p->i2c_speed_hz != 0) {
+		mcp2221_i2c_status_t status;
+		err = mcp2221_i2c_status(dev, &status);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		if (status.div != divider) {
+			err = mcp2221_i2c_set_speed(dev, p->i2c_speed_hz);
+			if (err != MCP2221_ERR_OK)
+				return err;
+			r->i2c_speed_changed = 1;
+		}
+	}
+
+	if (p->usb_remote_wakeup != -1 || p->usb_self_powered != -1 || p->usb_requested_current_ma != -1) {
+		uint8_t chip[60];
+		err = mcp2221_flash_read(dev, MCP2221_FLASH_DATA_CHIP_SETTINGS, chip);
+		if (err != MCP2221_ERR_OK)
+			return err;
+		err = stage_usb(dev, p, chip, &r->usb_changed);
+		if (err != MCP2221_ERR_OK)
+			return err;
+	}
+
+	if (!(flags & MCP2221_PROFILE_PERSIST))
+		return MCP2221_ERR_OK;
+
+	unsigned written;
+	err = mcp2221_flash_save_config_ex(dev, &written);
+	r->persisted = written != 0;
+	return err;
+}
+
+mcp2221_error_code_t mcp2221_profile_apply(mcp2221_t *dev, const mcp2221_profile_t *profile, unsigned flags,
+					   mcp2221_profile_result_t *result) {
+	mcp2221_profile_result_t r;
+	memset(&r, 0, sizeof(r));
+
+	mcp2221_error_code_t err = MCP2221_ERR_INVALID;
+	if (dev && profile && (flags & ~MCP2221_PROFILE_PERSIST) == 0) {
+		uint64_t start_us = mcp2221_internal_monotonic_ns() / 1000u;
+		err = apply_steps(dev, profile, flags, &r);
+		r.duration_us = mcp2221_internal_monotonic_ns() / 1000u - start_us;
+	}
+
+	if (result)
+		*result = r;
+	return err;
+}
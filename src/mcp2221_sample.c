@@ -0,0 +1,52 @@
+#include "mcp2221_sample.h"
+
+#include <string.h>
+
+#include "mcp2221_gpio.h"
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_analog.h"
+#include "mcp2221_internal_constants.h"
+
+mcp2221_error_code_t mcp2221_sample_all(mcp2221_t *dev, mcp2221_sample_t *out_sample) {
+	if (!dev || !out_sample)
+		return MCP2221_ERR_INVALID;
+
+	memset(out_sample, 0, sizeof(*out_sample));
+
+	/*
+	 * Resolve the reference first, so that a one-time SRAM read does not
+	 * end up between the two commands of the sample.
+	 */
+	double reference_voltage = 0.0;
+	mcp2221_error_code_t err = mcp2221_internal_analog_get_adc_reference_voltage(dev, &reference_voltage);
+	if (err == MCP2221_ERR_OK)
+		out_sample->adc_volts_valid = 1;
+	else if (err != MCP2221_ERR_INVALID)
+		return err;
+
+	uint8_t cmd = MCP2221_CMD_POLL_STATUS_SET_PARAMETERS;
+	uint8_t rbuf[MCP2221_PACKET_SIZE];
+
+	out_sample->timestamp_us = mcp2221_internal_monotonic_ns() / 1000u;
+	err = mcp2221_internal_send_cmd_retry_safe(dev, &cmd, 1, rbuf);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	err = mcp2221_gpio_read_mask(dev, out_sample->gpio, &out_sample->gpio_valid_mask);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	mcp2221_internal_analog_adc_decode(rbuf, out_sample->adc_raw);
+	out_sample->ioc_flag = rbuf[MCP2221_I2C_POLL_RESP_INT_FLAG];
+	mcp2221_internal_i2c_status_decode(rbuf, &out_sample->i2c);
+
+	for (int i = 0; i < 3 && out_sample->adc_volts_valid; i++) {
+		if (mcp2221_internal_analog_adc_raw_to_volts(out_sample->adc_raw[i], reference_voltage,
+							     &out_sample->adc_volts[i]) != MCP2221_ERR_OK)
+			out_sample->adc_volts_valid = 0;
+	}
+	if (!out_sample->adc_volts_valid)
+		memset(out_sample->adc_volts, 0, sizeof(out_sample->adc_volts));
+
+	return MCP2221_ERR_OK;
+}
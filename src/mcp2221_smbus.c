@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "mcp2221.h"
+#include "mcp2221_internal_smbus.h"
 
 static int is_valid_bus(const mcp2221_smbus_t *bus) {
 	return bus && bus->mcp;
@@ -79,6 +80,101 @@ static mcp2221_error_code_t write_register(mcp2221_smbus_t *bus, uint8_t addr, u
 	return mcp2221_i2c_write_simple(bus->mcp, addr, temp, reg_bytes + len, MCP2221_I2C_KIND_NORMAL);
 }
 
+static mcp2221_internal_smbus_block_hint_t *block_hint_slot(mcp2221_internal_smbus_hint_state_t *hints, uint8_t addr,
+							     uint8_t cmd) {
+	return &hints->slots[((unsigned)addr * 31u + cmd) % MCP2221_INTERNAL_SMBUS_BLOCK_HINT_SLOTS];
+}
+
+/*
+ * Issue a command (NO_STOP write of @p tx) and read a length-prefixed block
+ * into @p frame using a repeated START. @p trailer is the number of bytes the
+ * target sends after the payload (1 for PEC). @p frame must hold
+ * MCP2221_I2C_SMBUS_BLOCK_MAX + 1 + @p trailer bytes.
+ *
+ * Without hinting the maximum block is read. With hinting, the last length
+ * seen for (addr, tx[0]) is read instead, and the transaction is repeated
+ * with the exact length if the target reports a longer block.
+ */
+static mcp2221_error_code_t transfer_block(mcp2221_smbus_t *bus, uint8_t addr, const uint8_t *tx, size_t tx_len, uint8_t *frame,
+					   size_t trailer) {
+	size_t want = MCP2221_I2C_SMBUS_BLOCK_MAX + 1 + trailer;
+	mcp2221_internal_smbus_hint_state_t *hints = mcp2221_internal_smbus_get_hint_state(bus->mcp);
+	mcp2221_internal_smbus_block_hint_t *hint = NULL;
+	int hinted = 0;
+
+	if (hints && hints->enabled) {
+		hint = block_hint_slot(hints, addr, tx[0]);
+		if (hint->valid && hint->addr == addr && hint->cmd == tx[0]) {
+			want = (size_t)hint->length + 1 + trailer;
+			hinted = 1;
+		}
+	}
+
+	mcp2221_error_code_t err = mcp2221_i2c_write_simple(bus->mcp, addr, tx, tx_len, MCP2221_I2C_KIND_NO_STOP);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	err = mcp2221_i2c_read_simple(bus->mcp, addr, frame, want, MCP2221_I2C_KIND_REPEATED_START);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	size_t len = frame[0];
+	if (len > MCP2221_I2C_SMBUS_BLOCK_MAX)
+		return MCP2221_ERR_INVALID;
+
+	if (!hint)
+		return MCP2221_ERR_OK;
+
+	if (len + 1 + trailer > want) {
+		// The block grew past the hint; the target restarts the block on
+		// a new transaction, so repeat it with the exact length.
+		hints->stats.misses++;
+		want = len + 1 + trailer;
+
+		err = mcp2221_i2c_write_simple(bus->mcp, addr, tx, tx_len, MCP2221_I2C_KIND_NO_STOP);
+		if (err != MCP2221_ERR_OK)
+			return err;
+
+		err = mcp2221_i2c_read_simple(bus->mcp, addr, frame, want, MCP2221_I2C_KIND_REPEATED_START);
+		if (err != MCP2221_ERR_OK)
+			return err;
+
+		if (frame[0] + 1 + trailer > want)
+			return MCP2221_ERR_INVALID;
+	} else if (hinted) {
+		hints->stats.hits++;
+	} else {
+		hints->stats.cold++;
+	}
+
+	hint->addr = addr;
+	hint->cmd = tx[0];
+	hint->length = frame[0];
+	hint->valid = 1;
+
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_smbus_set_block_hint(mcp2221_smbus_t *bus, int enable) {
+	mcp2221_internal_smbus_hint_state_t *hints = is_valid_bus(bus) ? mcp2221_internal_smbus_get_hint_state(bus->mcp) : NULL;
+	if (!hints)
+		return MCP2221_ERR_INVALID;
+
+	memset(hints, 0, sizeof(*hints));
+	hints->enabled = enable ? 1 : 0;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_smbus_get_block_hint_stats(const mcp2221_smbus_t *bus, mcp2221_smbus_block_hint_stats_t *stats) {
+	const mcp2221_internal_smbus_hint_state_t *hints =
+		is_valid_bus(bus) ? mcp2221_internal_smbus_get_hint_state(bus->mcp) : NULL;
+	if (!hints || !stats)
+		return MCP2221_ERR_INVALID;
+
+	*stats = hints->stats;
+	return MCP2221_ERR_OK;
+}
+
 // Basic smbus
 mcp2221_error_code_t mcp2221_smbus_read_byte(mcp2221_smbus_t *bus, uint8_t addr, uint8_t *value) {
 	if (!is_valid_bus(bus) || !value)
@@ -155,14 +251,11 @@ mcp2221_error_code_t mcp2221_smbus_read_block_data(mcp2221_smbus_t *bus, uint8_t
 	if (!is_valid_bus(bus) || !buffer || !length)
 		return MCP2221_ERR_INVALID;
 	uint8_t temp[MCP2221_I2C_SMBUS_BLOCK_MAX + 1];
-	mcp2221_error_code_t err = read_register(bus, addr, reg, 1, temp, MCP2221_I2C_SMBUS_BLOCK_MAX + 1);
+	mcp2221_error_code_t err = transfer_block(bus, addr, &reg, 1, temp, 0);
 	if (err != MCP2221_ERR_OK)
 		return err;
 
 	size_t len = temp[0];
-	if (len > MCP2221_I2C_SMBUS_BLOCK_MAX)
-		return MCP2221_ERR_INVALID;
-
 	memcpy(buffer, &temp[1], len);
 	*length = len;
 
@@ -192,19 +285,13 @@ mcp2221_error_code_t mcp2221_smbus_block_process_call(mcp2221_smbus_t *bus, uint
 	txbuf[1] = (uint8_t)length;
 	memcpy(&txbuf[2], data, length);
 
-	mcp2221_error_code_t err = mcp2221_i2c_write_simple(bus->mcp, addr, txbuf, 2 + length, MCP2221_I2C_KIND_NO_STOP);
-	if (err != MCP2221_ERR_OK)
-		return err;
-
 	// Read response
 	uint8_t rxbuf[MCP2221_I2C_SMBUS_BLOCK_MAX + 1];
-	err = mcp2221_i2c_read_simple(bus->mcp, addr, rxbuf, MCP2221_I2C_SMBUS_BLOCK_MAX + 1, MCP2221_I2C_KIND_REPEATED_START);
+	mcp2221_error_code_t err = transfer_block(bus, addr, txbuf, 2 + length, rxbuf, 0);
 	if (err != MCP2221_ERR_OK)
 		return err;
 
 	size_t len = rxbuf[0];
-	if (len > MCP2221_I2C_SMBUS_BLOCK_MAX)
-		return MCP2221_ERR_INVALID;
 	memcpy(response, &rxbuf[1], len);
 	*resp_len = len;
 
@@ -223,4 +310,142 @@ mcp2221_error_code_t mcp2221_smbus_write_i2c_block_data(mcp2221_smbus_t *bus, ui
 	return write_register(bus, addr, reg, 1, data, length);
 }
 
+// Packet Error Checking (PEC)
+
+static uint8_t pec_address_byte(uint8_t addr, int read) {
+	return (uint8_t)((addr << 1) | (read ? 1u : 0u));
+}
+
+/*
+ * Append the PEC to a write frame and send it. @p frame holds the command
+ * byte followed by the payload and must have room for one more byte at
+ * frame[len].
+ */
+static mcp2221_error_code_t write_frame_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t *frame, size_t len) {
+	uint8_t crc = mcp2221_internal_smbus_crc8_byte(MCP2221_INTERNAL_SMBUS_PEC_INIT, pec_address_byte(addr, 0));
+	frame[len] = mcp2221_internal_smbus_crc8_update(crc, frame, len);
+
+	return mcp2221_i2c_write_simple(bus->mcp, addr, frame, len + 1, MCP2221_I2C_KIND_NORMAL);
+}
 
+/*
+ * Verify the PEC of a combined write-command/read-data transaction. The last
+ * byte of @p frame is the PEC received from the target.
+ */
+static mcp2221_error_code_t check_read_pec(uint8_t addr, uint8_t reg, const uint8_t *frame, size_t len) {
+	uint8_t crc = mcp2221_internal_smbus_crc8_byte(MCP2221_INTERNAL_SMBUS_PEC_INIT, pec_address_byte(addr, 0));
+	crc = mcp2221_internal_smbus_crc8_byte(crc, reg);
+	crc = mcp2221_internal_smbus_crc8_byte(crc, pec_address_byte(addr, 1));
+	crc = mcp2221_internal_smbus_crc8_update(crc, frame, len - 1);
+
+	return crc == frame[len - 1] ? MCP2221_ERR_OK : MCP2221_ERR_PEC;
+}
+
+mcp2221_error_code_t mcp2221_smbus_read_byte_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t *value) {
+	if (!is_valid_bus(bus) || !value)
+		return MCP2221_ERR_INVALID;
+
+	uint8_t frame[2];
+	mcp2221_error_code_t err = mcp2221_i2c_read_simple(bus->mcp, addr, frame, sizeof(frame), MCP2221_I2C_KIND_NORMAL);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	uint8_t crc = mcp2221_internal_smbus_crc8_byte(MCP2221_INTERNAL_SMBUS_PEC_INIT, pec_address_byte(addr, 1));
+	if (mcp2221_internal_smbus_crc8_byte(crc, frame[0]) != frame[1])
+		return MCP2221_ERR_PEC;
+
+	*value = frame[0];
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_smbus_write_byte_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t value) {
+	if (!is_valid_bus(bus))
+		return MCP2221_ERR_INVALID;
+
+	uint8_t frame[2] = {value, 0};
+	return write_frame_pec(bus, addr, frame, 1);
+}
+
+mcp2221_error_code_t mcp2221_smbus_read_byte_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, uint8_t *value) {
+	if (!is_valid_bus(bus) || !value)
+		return MCP2221_ERR_INVALID;
+
+	uint8_t frame[2];
+	mcp2221_error_code_t err = read_register(bus, addr, reg, 1, frame, sizeof(frame));
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	err = check_read_pec(addr, reg, frame, sizeof(frame));
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	*value = frame[0];
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_smbus_write_byte_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, uint8_t value) {
+	if (!is_valid_bus(bus))
+		return MCP2221_ERR_INVALID;
+
+	uint8_t frame[3] = {reg, value, 0};
+	return write_frame_pec(bus, addr, frame, 2);
+}
+
+mcp2221_error_code_t mcp2221_smbus_read_word_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, int16_t *value) {
+	if (!is_valid_bus(bus) || !value)
+		return MCP2221_ERR_INVALID;
+
+	uint8_t frame[3];
+	mcp2221_error_code_t err = read_register(bus, addr, reg, 1, frame, sizeof(frame));
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	err = check_read_pec(addr, reg, frame, sizeof(frame));
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	*value = (int16_t)(frame[0] | ((uint16_t)frame[1] << 8));
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_smbus_write_word_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, int16_t value) {
+	if (!is_valid_bus(bus))
+		return MCP2221_ERR_INVALID;
+
+	uint16_t encoded = (uint16_t)value;
+	uint8_t frame[4] = {reg, (uint8_t)(encoded & 0xFFu), (uint8_t)(encoded >> 8), 0};
+	return write_frame_pec(bus, addr, frame, 3);
+}
+
+mcp2221_error_code_t mcp2221_smbus_read_block_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, uint8_t *buffer, size_t *length) {
+	if (!is_valid_bus(bus) || !buffer || !length)
+		return MCP2221_ERR_INVALID;
+
+	// Length byte, payload and trailing PEC byte.
+	uint8_t frame[MCP2221_I2C_SMBUS_BLOCK_MAX + 2];
+	mcp2221_error_code_t err = transfer_block(bus, addr, &reg, 1, frame, 1);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	size_t len = frame[0];
+	err = check_read_pec(addr, reg, frame, len + 2);
+	if (err != MCP2221_ERR_OK)
+		return err;
+
+	memcpy(buffer, &frame[1], len);
+	*length = len;
+
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_smbus_write_block_data_pec(mcp2221_smbus_t *bus, uint8_t addr, uint8_t reg, const uint8_t *data, size_t length) {
+	if (!is_valid_bus(bus) || !data || length > MCP2221_I2C_SMBUS_BLOCK_MAX)
+		return MCP2221_ERR_INVALID;
+
+	uint8_t frame[2 + MCP2221_I2C_SMBUS_BLOCK_MAX + 1];
+	frame[0] = reg;
+	frame[1] = (uint8_t)length;
+	memcpy(&frame[2], data, length);
+
+	return write_frame_pec(bus, addr, frame, 2 + length);
+}
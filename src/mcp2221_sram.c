@@ -125,10 +125,9 @@ mcp2221_error_code_t mcp2221_sram_config(mcp2221_t *dev, const mcp2221_sram_conf
 	// Ensure cached GP bytes are available (Python keeps a live cache because GPIO_write does not modify SRAM).
 	(void)mcp2221_internal_ensure_gpio_status(dev);
 
-	uint8_t getcmd = MCP2221_CMD_GET_SRAM_SETTINGS;
 	uint8_t resp[MCP2221_PACKET_SIZE];
 
-	mcp2221_error_code_t err = mcp2221_internal_send_cmd_retry_safe(dev, &getcmd, 1, resp);
+	mcp2221_error_code_t err = mcp2221_internal_sram_read(dev, resp);
 	if (err)
 		return err;
 
@@ -279,3 +278,11 @@ mcp2221_error_code_t mcp2221_sram_config(mcp2221_t *dev, const mcp2221_sram_conf
 		mcp2221_internal_gpio_status_set(dev, gp_new);
 	return err;
 }
+
+void mcp2221_sram_cache_set_max_age(mcp2221_t *dev, uint32_t max_age_ms) {
+	mcp2221_internal_sram_set_max_age(dev, max_age_ms);
+}
+
+void mcp2221_sram_cache_invalidate(mcp2221_t *dev) {
+	mcp2221_internal_sram_invalidate(dev);
+}
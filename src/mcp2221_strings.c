@@ -42,7 +42,45 @@ void mcp2221_internal_parse_wchar_structure(const uint8_t *buf, char *out, size_
 
 	/* Python: strlen = buf[2] - 2, data starts at buf[4]. */
 	size_t declared = (buf[2] >= 2) ? (size_t)(buf[2] - 2) : 0;
-	if (declared > 56)
-		declared = 56;
+	if (declared > 60)
+		declared = 60;
 	mcp2221_internal_utf16le_to_utf8(&buf[4], declared, out, out_len);
 }
+
+int mcp2221_internal_utf8_to_utf16le(const char *in, uint8_t *out, size_t max_units) {
+	if (!in)
+		return -1;
+
+	size_t units = 0;
+	const unsigned char *p = (const unsigned char *)in;
+	while (*p) {
+		uint32_t code;
+		if (p[0] < 0x80) {
+			code = p[0];
+			p += 1;
+		} else if ((p[0] & 0xE0) == 0xC0 && (p[1] & 0xC0) == 0x80) {
+			code = ((uint32_t)(p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+			if (code < 0x80)
+				return -1;
+			p += 2;
+		} else if ((p[0] & 0xF0) == 0xE0 && (p[1] & 0xC0) == 0x80 && (p[2] & 0xC0) == 0x80) {
+			code = ((uint32_t)(p[0] & 0x0F) << 12) | ((uint32_t)(p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+			if (code < 0x800 || (code >= 0xD800 && code <= 0xDFFF))
+				return -1;
+			p += 3;
+		} else {
+			// Malformed, or outside the Basic Multilingual Plane like the decoder.
+			return -1;
+		}
+
+		if (units == max_units)
+			return -1;
+		if (out) {
+			out[2 * units] = (uint8_t)(code & 0xFF);
+			out[2 * units + 1] = (uint8_t)(code >> 8);
+		}
+		units++;
+	}
+
+	return (int)units;
+}
@@ -0,0 +1,124 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mcp2221_internal_analog.h"
+
+/*
+ * Micro-benchmark for the bulk ADC/DAC conversion kernels.
+ *
+ * Compares the per-element helpers, called in a loop, against the array
+ * kernels over a cache-resident block, and checks that both give identical
+ * results. Usage:
+ *
+ *   bench_analog_conversion [iterations]
+ */
+
+/*
+ * Link stub required by mcp2221_internal_analog.c.
+ */
+mcp2221_error_code_t mcp2221_internal_analog_get_vdd(
+	const mcp2221_t *dev,
+	double *volts) {
+	(void)dev;
+	(void)volts;
+	return MCP2221_ERR_INVALID;
+}
+
+#define BENCH_BLOCK 4096
+#define BENCH_REFERENCE 3.3
+
+static uint16_t raw[BENCH_BLOCK];
+static double volts[BENCH_BLOCK];
+static double scalar[BENCH_BLOCK];
+static double bulk[BENCH_BLOCK];
+static uint8_t codes_scalar[BENCH_BLOCK];
+static uint8_t codes_bulk[BENCH_BLOCK];
+
+static double now_seconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, long iterations, double t_scalar, double t_bulk) {
+	double samples = (double)BENCH_BLOCK * (double)iterations;
+	printf("%-22s scalar %8.1f M/s, bulk %8.1f M/s (%.1fx)\n",
+	       name,
+	       samples / t_scalar / 1e6,
+	       samples / t_bulk / 1e6,
+	       t_scalar / t_bulk);
+}
+
+static void bench_adc_normalized(long iterations) {
+	double t0 = now_seconds();
+	for (long it = 0; it < iterations; it++) {
+		for (size_t i = 0; i < BENCH_BLOCK; i++)
+			(void)mcp2221_internal_analog_adc_raw_to_normalized(raw[i], &scalar[i]);
+	}
+	double t_scalar = now_seconds() - t0;
+
+	t0 = now_seconds();
+	for (long it = 0; it < iterations; it++)
+		(void)mcp2221_internal_analog_adc_raw_to_normalized_n(raw, bulk, BENCH_BLOCK);
+	double t_bulk = now_seconds() - t0;
+
+	report("adc_raw_to_normalized", iterations, t_scalar, t_bulk);
+}
+
+static void bench_adc_volts(long iterations) {
+	double t0 = now_seconds();
+	for (long it = 0; it < iterations; it++) {
+		for (size_t i = 0; i < BENCH_BLOCK; i++)
+			(void)mcp2221_internal_analog_adc_raw_to_volts(raw[i], BENCH_REFERENCE, &scalar[i]);
+	}
+	double t_scalar = now_seconds() - t0;
+
+	t0 = now_seconds();
+	for (long it = 0; it < iterations; it++)
+		(void)mcp2221_internal_analog_adc_raw_to_volts_n(raw, bulk, BENCH_BLOCK, BENCH_REFERENCE);
+	double t_bulk = now_seconds() - t0;
+
+	report("adc_raw_to_volts", iterations, t_scalar, t_bulk);
+}
+
+static void bench_dac(long iterations) {
+	double t0 = now_seconds();
+	for (long it = 0; it < iterations; it++) {
+		for (size_t i = 0; i < BENCH_BLOCK; i++)
+			(void)mcp2221_internal_analog_dac_volts_to_raw(volts[i], BENCH_REFERENCE, &codes_scalar[i]);
+	}
+	double t_scalar = now_seconds() - t0;
+
+	t0 = now_seconds();
+	for (long it = 0; it < iterations; it++)
+		(void)mcp2221_internal_analog_dac_volts_to_raw_n(volts, codes_bulk, BENCH_BLOCK, BENCH_REFERENCE);
+	double t_bulk = now_seconds() - t0;
+
+	report("dac_volts_to_raw", iterations, t_scalar, t_bulk);
+}
+
+int main(int argc, char **argv) {
+	long iterations = argc > 1 ? strtol(argv[1], NULL, 10) : 20000;
+
+	if (iterations <= 0)
+		iterations = 20000;
+
+	for (size_t i = 0; i < BENCH_BLOCK; i++) {
+		raw[i] = (uint16_t)((i * 613u + 7u) % 1024u);
+		volts[i] = BENCH_REFERENCE * (31.0 / 32.0) * (double)raw[i] / 1023.0;
+	}
+
+	bench_adc_normalized(iterations);
+	bench_adc_volts(iterations);
+	bench_dac(iterations);
+
+	if (memcmp(scalar, bulk, sizeof(bulk)) != 0 || memcmp(codes_scalar, codes_bulk, sizeof(codes_bulk)) != 0) {
+		fprintf(stderr, "Mismatch between scalar and bulk kernels\n");
+		return 1;
+	}
+
+	return 0;
+}
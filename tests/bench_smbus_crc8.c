@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "mcp2221_internal_smbus.h"
+
+/*
+ * Micro-benchmark for the SMBus PEC CRC kernel.
+ *
+ * Compares the table-driven mcp2221_internal_smbus_crc8_update() against a
+ * straightforward bitwise CRC-8 over typical SMBus frame sizes. Usage:
+ *
+ *   bench_smbus_crc8 [iterations]
+ */
+
+#define BENCH_BUFFER_SIZE (2 + 255 + 1)
+
+static uint8_t bitwise_crc8(uint8_t crc, const uint8_t *data, size_t len) {
+	while (len--) {
+		crc ^= *data++;
+		for (int bit = 0; bit < 8; bit++)
+			crc = (uint8_t)((crc & 0x80u) ? (unsigned)(crc << 1) ^ 0x07u : (unsigned)(crc << 1));
+	}
+	return crc;
+}
+
+static double now_seconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void run_case(const uint8_t *buf, size_t len, long iterations) {
+	volatile uint8_t sink = 0;
+	uint8_t crc;
+
+	double t0 = now_seconds();
+	crc = 0;
+	for (long i = 0; i < iterations; i++)
+		crc = bitwise_crc8(crc, buf, len);
+	double t_bitwise = now_seconds() - t0;
+	sink ^= crc;
+
+	t0 = now_seconds();
+	crc = 0;
+	for (long i = 0; i < iterations; i++)
+		crc = mcp2221_internal_smbus_crc8_update(crc, buf, len);
+	double t_table = now_seconds() - t0;
+	sink ^= crc;
+
+	double bytes = (double)len * (double)iterations;
+	printf("%4zu bytes: bitwise %8.1f MB/s, table %8.1f MB/s (%.1fx)\n",
+		   len,
+		   bytes / t_bitwise / 1e6,
+		   bytes / t_table / 1e6,
+		   t_bitwise / t_table);
+}
+
+int main(int argc, char **argv) {
+	long iterations = argc > 1 ? strtol(argv[1], NULL, 10) : 200000;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	static const size_t sizes[] = {2, 3, 4, 34, BENCH_BUFFER_SIZE};
+
+	if (iterations <= 0)
+		iterations = 200000;
+
+	for (size_t i = 0; i < sizeof(buf); i++)
+		buf[i] = (uint8_t)(i * 131u + 7u);
+
+	if (bitwise_crc8(0, buf, sizeof(buf)) != mcp2221_internal_smbus_crc8_update(0, buf, sizeof(buf))) {
+		fprintf(stderr, "CRC mismatch between bitwise and table kernels\n");
+		return 1;
+	}
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		run_case(buf, sizes[i], iterations);
+
+	return 0;
+}
@@ -0,0 +1,250 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "mcp2221_acq.h"
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_acq.h"
+
+struct mcp2221_device {
+	int unused;
+};
+
+static int read_calls;
+
+/*
+ * Link stub: every register returns its own address as data, so merged reads
+ * can be checked byte by byte.
+ */
+mcp2221_error_code_t mcp2221_i2c_slave_read_register(mcp2221_i2c_slave_t *slave, uint32_t reg, uint8_t *buffer, size_t length, int reg_bytes,
+						     mcp2221_i2c_byte_order_t reg_byteorder) {
+	(void)reg_bytes;
+	(void)reg_byteorder;
+	__atomic_add_fetch(&read_calls, 1, __ATOMIC_RELAXED);
+	if (slave->addr == 0x7f)
+		return MCP2221_ERR_NOT_ACK;
+	for (size_t i = 0; i < length; i++)
+		buffer[i] = (uint8_t)(reg + i);
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_muxed_slave_read_register(mcp2221_i2c_muxed_slave_t *target, uint32_t reg, uint8_t *buffer, size_t length,
+							  int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder) {
+	return mcp2221_i2c_slave_read_register(&target->slave, reg, buffer, length, reg_bytes, reg_byteorder);
+}
+
+static mcp2221_internal_acq_req_t make_req(uint32_t target, uint32_t reg, uint16_t length, uint16_t job, uint8_t mergeable) {
+	mcp2221_internal_acq_req_t req = {
+		.target = target,
+		.reg = reg,
+		.length = length,
+		.job = job,
+		.mergeable = mergeable
+	};
+	return req;
+}
+
+static void test_plan_groups_merges_adjacent_registers(void) {
+	mcp2221_internal_acq_req_t reqs[5];
+	mcp2221_internal_acq_group_t groups[5];
+
+	reqs[0] = make_req(0x48, 0x04, 2, 0, 1);
+	reqs[1] = make_req(0x48, 0x00, 2, 1, 1);
+	reqs[2] = make_req(0x49, 0x00, 2, 2, 1);
+	reqs[3] = make_req(0x48, 0x30, 2, 3, 1);
+	reqs[4] = make_req(0x49, 0x02, 2, 4, 0);
+
+	size_t count = mcp2221_internal_acq_plan_groups(reqs, 5, groups);
+	assert(count == 4);
+
+	// 0x48: 0x00..0x01 and 0x04..0x05 merge across a two-byte gap.
+	assert(groups[0].count == 2);
+	assert(groups[0].reg == 0x00);
+	assert(groups[0].length == 6);
+	assert(reqs[groups[0].first].job == 1);
+
+	// 0x48: 0x30 is too far away.
+	assert(groups[1].count == 1);
+	assert(groups[1].reg == 0x30);
+
+	// 0x49: the second request does not allow merging.
+	assert(groups[2].count == 1);
+	assert(groups[3].count == 1);
+	assert(reqs[groups[3].first].job == 4);
+}
+
+static void test_plan_groups_respects_merge_limit(void) {
+	mcp2221_internal_acq_req_t reqs[2];
+	mcp2221_internal_acq_group_t groups[2];
+
+	reqs[0] = make_req(0x50, 0, 32, 0, 1);
+	reqs[1] = make_req(0x50, 32, 32, 1, 1);
+
+	assert(mcp2221_internal_acq_plan_groups(reqs, 2, groups) == 2);
+}
+
+static void test_assign_phases_spreads_load(void) {
+	uint32_t periods[4] = {10000, 10000, 10000, 10000};
+	uint32_t costs[4] = {2, 2, 2, 2};
+	int64_t phases[4] = {-1, -1, -1, -1};
+	uint32_t tick = 0;
+
+	assert(mcp2221_internal_acq_assign_phases(periods, costs, phases, 4, &tick) == MCP2221_ERR_OK);
+	assert(tick == 10000);
+
+	// Only one slot exists, so everything lands in phase 0.
+	for (int i = 0; i < 4; i++)
+		assert(phases[i] == 0);
+
+	uint32_t mixed_periods[4] = {5000, 10000, 10000, 20000};
+	int64_t mixed_phases[4] = {-1, -1, -1, 0};
+
+	assert(mcp2221_internal_acq_assign_phases(mixed_periods, costs, mixed_phases, 4, &tick) == MCP2221_ERR_OK);
+	assert(tick == 5000);
+	assert(mixed_phases[3] == 0);
+
+	// The 5 ms job can only use tick 0. The 10 ms jobs then pick the
+	// emptier odd tick first and the lighter even tick second.
+	assert(mixed_phases[0] == 0);
+	assert(mixed_phases[1] == 5000);
+	assert(mixed_phases[2] == 0);
+
+	periods[0] = 0;
+	assert(mcp2221_internal_acq_assign_phases(periods, costs, phases, 1, &tick) == MCP2221_ERR_INVALID);
+}
+
+static void test_assign_phases_distinct_slots(void) {
+	// The 1 ms job forces a 1 ms tick, leaving four slots per 4 ms period.
+	uint32_t periods[5] = {4000, 4000, 4000, 4000, 1000};
+	uint32_t costs[5] = {8, 8, 8, 8, 0};
+	int64_t phases[5] = {-1, -1, -1, -1, -1};
+	uint32_t tick = 0;
+	int used[4] = {0};
+
+	assert(mcp2221_internal_acq_assign_phases(periods, costs, phases, 5, &tick) == MCP2221_ERR_OK);
+	assert(tick == 1000);
+
+	for (int i = 0; i < 4; i++) {
+		assert(phases[i] >= 0 && phases[i] < 4000 && phases[i] % 1000 == 0);
+		used[phases[i] / 1000]++;
+	}
+	for (int i = 0; i < 4; i++)
+		assert(used[i] == 1);
+}
+
+static void sleep_ms(long ms) {
+	struct timespec ts = {
+		.tv_sec = ms / 1000,
+		.tv_nsec = (ms % 1000) * 1000000L
+	};
+	nanosleep(&ts, NULL);
+}
+
+static void test_acq_end_to_end(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_i2c_slave_t sensor = {
+		.mcp = &dev,
+		.addr = 0x48,
+		.reg_bytes = 1,
+		.reg_byteorder = MCP2221_I2C_BYTE_ORDER_BIG
+	};
+	mcp2221_i2c_slave_t absent = sensor;
+	mcp2221_acq_t *acq = NULL;
+	mcp2221_acq_job_t job = {
+		.slave = &sensor,
+		.reg = 0x10,
+		.length = 2,
+		.period_us = 5000,
+		.phase_us = MCP2221_ACQ_PHASE_AUTO,
+		.flags = MCP2221_ACQ_JOB_MERGE
+	};
+	int ids[3];
+	mcp2221_acq_sample_t samples[64];
+	mcp2221_acq_job_stats_t job_stats;
+	mcp2221_acq_stats_t stats;
+
+	absent.addr = 0x7f;
+
+	assert(mcp2221_acq_create(&dev, 256, &acq) == MCP2221_ERR_OK);
+	assert(mcp2221_acq_start(acq) == MCP2221_ERR_INVALID);
+
+	assert(mcp2221_acq_add_job(acq, &job, &ids[0]) == MCP2221_ERR_OK);
+	job.reg = 0x12;
+	assert(mcp2221_acq_add_job(acq, &job, &ids[1]) == MCP2221_ERR_OK);
+	job.slave = &absent;
+	job.period_us = 20000;
+	assert(mcp2221_acq_add_job(acq, &job, &ids[2]) == MCP2221_ERR_OK);
+
+	job.length = MCP2221_ACQ_SAMPLE_MAX + 1;
+	assert(mcp2221_acq_add_job(acq, &job, NULL) == MCP2221_ERR_INVALID);
+
+	assert(mcp2221_acq_start(acq) == MCP2221_ERR_OK);
+	assert(mcp2221_acq_start(acq) == MCP2221_ERR_BUSY);
+	assert(mcp2221_acq_add_job(acq, &job, NULL) == MCP2221_ERR_INVALID);
+	job.length = 2;
+	assert(mcp2221_acq_add_job(acq, &job, NULL) == MCP2221_ERR_BUSY);
+
+	sleep_ms(60);
+	mcp2221_acq_stop(acq);
+
+	int n = mcp2221_acq_drain(acq, samples, 64);
+	assert(n > 0);
+
+	int seen_ok = 0;
+	int seen_err = 0;
+	for (int i = 0; i < n; i++) {
+		assert(samples[i].timestamp_ns >= samples[i].release_ns);
+		if (samples[i].job == ids[2]) {
+			assert(samples[i].status == MCP2221_ERR_NOT_ACK);
+			assert(samples[i].length == 0);
+			seen_err++;
+		} else {
+			uint8_t base = samples[i].job == ids[0] ? 0x10 : 0x12;
+			assert(samples[i].status == MCP2221_ERR_OK);
+			assert(samples[i].length == 2);
+			assert(samples[i].data[0] == base);
+			assert(samples[i].data[1] == base + 1);
+			seen_ok++;
+		}
+	}
+	assert(seen_ok > 0);
+	assert(seen_err > 0);
+
+	assert(mcp2221_acq_get_job_stats(acq, ids[0], &job_stats) == MCP2221_ERR_OK);
+	assert(job_stats.samples > 0);
+	assert(job_stats.releases >= job_stats.samples);
+	assert(job_stats.achieved_rate_hz > 0.0);
+	assert(mcp2221_acq_get_job_stats(acq, 3, &job_stats) == MCP2221_ERR_INVALID);
+
+	// Jobs 0 and 1 share a period and phase and are read as one transaction.
+	assert(mcp2221_acq_get_stats(acq, &stats) == MCP2221_ERR_OK);
+	assert(stats.batches > 0);
+	assert(stats.transactions < (uint64_t)n);
+	assert(stats.ring_overruns == 0);
+
+	// Samples left over from a previous run are not drained after a restart.
+	assert(mcp2221_acq_start(acq) == MCP2221_ERR_OK);
+	sleep_ms(20);
+	mcp2221_acq_stop(acq);
+	uint64_t restart_ns = mcp2221_internal_monotonic_ns();
+	assert(mcp2221_acq_start(acq) == MCP2221_ERR_OK);
+	sleep_ms(20);
+	mcp2221_acq_stop(acq);
+	n = mcp2221_acq_drain(acq, samples, 64);
+	assert(n > 0);
+	for (int i = 0; i < n; i++)
+		assert(samples[i].release_ns >= restart_ns);
+
+	mcp2221_acq_destroy(acq);
+}
+
+int main(void) {
+	test_plan_groups_merges_adjacent_registers();
+	test_plan_groups_respects_merge_limit();
+	test_assign_phases_spreads_load();
+	test_assign_phases_distinct_slots();
+	test_acq_end_to_end();
+	return 0;
+}
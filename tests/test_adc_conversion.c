@@ -1,6 +1,8 @@
 #include <assert.h>
 #include <math.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "mcp2221_internal_analog.h"
 
@@ -141,6 +143,70 @@ static void test_raw_to_volts_rejects_invalid_input(void) {
 			NULL) == MCP2221_ERR_INVALID);
 }
 
+static void test_bulk_matches_scalar(void) {
+	static const double references[] = {1.024, 2.048, 4.096, 3.3, 5.0, 1.0 / 3.0};
+	uint16_t raw[1024 + 7];
+	double bulk[1024 + 7];
+	size_t i, r, offset;
+
+	for (i = 0; i < 1024; ++i)
+		raw[i] = (uint16_t)((i * 613u) % 1024u);
+	for (; i < sizeof(raw) / sizeof(raw[0]); ++i)
+		raw[i] = (uint16_t)(i % 1024u);
+
+	// Odd offsets and lengths exercise unaligned vector loads and the scalar tail.
+	for (offset = 0; offset < 4; ++offset) {
+		size_t n = 1024 + 3 - offset;
+
+		assert(
+			mcp2221_internal_analog_adc_raw_to_normalized_n(
+				raw + offset,
+				bulk + offset,
+				n) == MCP2221_ERR_OK);
+		for (i = 0; i < n; ++i) {
+			double expected;
+			assert(mcp2221_internal_analog_adc_raw_to_normalized(raw[offset + i], &expected) == MCP2221_ERR_OK);
+			assert(memcmp(&bulk[offset + i], &expected, sizeof(expected)) == 0);
+		}
+
+		for (r = 0; r < sizeof(references) / sizeof(references[0]); ++r) {
+			assert(
+				mcp2221_internal_analog_adc_raw_to_volts_n(
+					raw + offset,
+					bulk + offset,
+					n,
+					references[r]) == MCP2221_ERR_OK);
+			for (i = 0; i < n; ++i) {
+				double expected;
+				assert(mcp2221_internal_analog_adc_raw_to_volts(raw[offset + i], references[r], &expected) ==
+				       MCP2221_ERR_OK);
+				assert(memcmp(&bulk[offset + i], &expected, sizeof(expected)) == 0);
+			}
+		}
+	}
+}
+
+static void test_bulk_rejects_invalid_input(void) {
+	uint16_t raw[20] = {0};
+	double out[20];
+	size_t i;
+
+	assert(mcp2221_internal_analog_adc_raw_to_normalized_n(NULL, NULL, 0) == MCP2221_ERR_OK);
+	assert(mcp2221_internal_analog_adc_raw_to_normalized_n(NULL, out, 1) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_adc_raw_to_volts_n(raw, NULL, 1, 3.3) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_adc_raw_to_volts_n(raw, out, 1, 0.0) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_adc_raw_to_volts_n(raw, out, 1, NAN) == MCP2221_ERR_INVALID);
+
+	// One bad element anywhere rejects the whole array and leaves the output alone.
+	for (i = 0; i < 20; ++i)
+		out[i] = -1.0;
+	raw[17] = 1024;
+	assert(mcp2221_internal_analog_adc_raw_to_normalized_n(raw, out, 20) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_adc_raw_to_volts_n(raw, out, 20, 3.3) == MCP2221_ERR_INVALID);
+	for (i = 0; i < 20; ++i)
+		assert(out[i] == -1.0);
+}
+
 int main(void) {
 	test_zero();
 	test_midpoint();
@@ -151,6 +217,8 @@ int main(void) {
 	test_raw_to_volts_midpoint();
 	test_raw_to_volts_maximum();
 	test_raw_to_volts_rejects_invalid_input();
+	test_bulk_matches_scalar();
+	test_bulk_rejects_invalid_input();
 
 	return 0;
 }
\ No newline at end of file
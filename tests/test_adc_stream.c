@@ -0,0 +1,164 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "mcp2221_adc_stream.h"
+#include "mcp2221_analog.h"
+
+struct mcp2221_device {
+	int unused;
+};
+
+#define FAILING_CALL 3
+
+static int read_calls;
+
+/* Channel 0 reports the call index; the third call fails. */
+mcp2221_error_code_t mcp2221_adc_read_raw(mcp2221_t *dev, uint16_t out[3]) {
+	(void)dev;
+
+	int call = __atomic_fetch_add(&read_calls, 1, __ATOMIC_ACQ_REL);
+	if (call == FAILING_CALL)
+		return MCP2221_ERR_TIMEOUT;
+
+	out[0] = (uint16_t)call;
+	out[1] = 100;
+	out[2] = 1023;
+	return MCP2221_ERR_OK;
+}
+
+static void run_until_calls(mcp2221_adc_stream_t *stream, int calls) {
+	__atomic_store_n(&read_calls, 0, __ATOMIC_RELEASE);
+	assert(mcp2221_adc_stream_start(stream) == MCP2221_ERR_OK);
+
+	struct timespec ts = {0, 1000000L};
+	while (__atomic_load_n(&read_calls, __ATOMIC_ACQUIRE) < calls)
+		nanosleep(&ts, NULL);
+	mcp2221_adc_stream_stop(stream);
+}
+
+static void test_create_validates_arguments(void) {
+	struct mcp2221_device dev;
+	mcp2221_adc_stream_config_t config = {0, 16, 0};
+	mcp2221_adc_stream_t *stream = NULL;
+
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_INVALID);
+	assert(stream == NULL);
+	config.rate_hz = MCP2221_ADC_STREAM_MAX_RATE_HZ + 1;
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_INVALID);
+	config.rate_hz = UINT32_MAX;
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_INVALID);
+	config.rate_hz = MCP2221_ADC_STREAM_MAX_RATE_HZ;
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_OK);
+	mcp2221_adc_stream_destroy(stream);
+	stream = NULL;
+	config.rate_hz = 1000;
+	config.ring_capacity = 0;
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_INVALID);
+	config.ring_capacity = 16;
+	assert(mcp2221_adc_stream_create(NULL, &config, &stream) == MCP2221_ERR_INVALID);
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_OK);
+
+	assert(mcp2221_adc_stream_start(stream) == MCP2221_ERR_OK);
+	assert(mcp2221_adc_stream_start(stream) == MCP2221_ERR_BUSY);
+	mcp2221_adc_stream_destroy(stream);
+}
+
+static void test_samples_are_queued_in_order(void) {
+	struct mcp2221_device dev;
+	mcp2221_adc_stream_config_t config = {2000, 64, 0};
+	mcp2221_adc_stream_t *stream = NULL;
+
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_OK);
+	run_until_calls(stream, 10);
+
+	mcp2221_adc_stream_sample_t samples[64];
+	int count = mcp2221_adc_stream_drain(stream, samples, 64);
+	assert(count >= 9);
+	assert(samples[0].raw[0] == 0 && samples[0].raw[1] == 100 && samples[0].raw[2] == 1023);
+	assert(samples[3].raw[0] == FAILING_CALL + 1);
+	for (int i = 1; i < count; i++)
+		assert(samples[i].time_ns > samples[i - 1].time_ns);
+
+	mcp2221_adc_stream_stats_t stats;
+	assert(mcp2221_adc_stream_get_stats(stream, &stats) == MCP2221_ERR_OK);
+	assert(stats.samples == (uint64_t)count);
+	assert(stats.acquisitions == stats.samples);
+	assert(stats.errors == 1);
+	assert(stats.last_error == MCP2221_ERR_TIMEOUT);
+	assert(stats.overruns == 0);
+	assert(stats.effective_rate_hz > 0.0);
+	mcp2221_adc_stream_destroy(stream);
+}
+
+static void test_decimation_averages_acquisitions(void) {
+	struct mcp2221_device dev;
+	mcp2221_adc_stream_config_t config = {2000, 64, 2};
+	mcp2221_adc_stream_t *stream = NULL;
+
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_OK);
+	run_until_calls(stream, 10);
+
+	mcp2221_adc_stream_sample_t samples[64];
+	int count = mcp2221_adc_stream_drain(stream, samples, 64);
+	assert(count >= 4);
+	// Calls 0 and 1, then 2 and 4 around the failed call; halves round up.
+	assert(samples[0].raw[0] == 1 && samples[0].raw[2] == 1023);
+	assert(samples[1].raw[0] == 3);
+
+	mcp2221_adc_stream_stats_t stats;
+	assert(mcp2221_adc_stream_get_stats(stream, &stats) == MCP2221_ERR_OK);
+	assert(stats.samples == (uint64_t)count);
+	assert(stats.acquisitions / 2 == stats.samples);
+	mcp2221_adc_stream_destroy(stream);
+}
+
+static void test_full_ring_counts_overruns(void) {
+	struct mcp2221_device dev;
+	mcp2221_adc_stream_config_t config = {2000, 1, 0};
+	mcp2221_adc_stream_t *stream = NULL;
+
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_OK);
+	run_until_calls(stream, 10);
+
+	mcp2221_adc_stream_sample_t sample;
+	assert(mcp2221_adc_stream_drain(stream, &sample, 1) == 1);
+	assert(sample.raw[0] == 0);
+	assert(mcp2221_adc_stream_drain(stream, &sample, 1) == 0);
+
+	mcp2221_adc_stream_stats_t stats;
+	assert(mcp2221_adc_stream_get_stats(stream, &stats) == MCP2221_ERR_OK);
+	assert(stats.overruns == stats.samples - 1);
+	mcp2221_adc_stream_destroy(stream);
+}
+
+static void test_restart_discards_previous_samples(void) {
+	struct mcp2221_device dev;
+	mcp2221_adc_stream_config_t config = {2000, 64, 0};
+	mcp2221_adc_stream_t *stream = NULL;
+
+	assert(mcp2221_adc_stream_create(&dev, &config, &stream) == MCP2221_ERR_OK);
+	run_until_calls(stream, 6);
+	run_until_calls(stream, 6);
+
+	// Only the second run is drained; channel 0 restarts at call 0.
+	mcp2221_adc_stream_sample_t samples[64];
+	int count = mcp2221_adc_stream_drain(stream, samples, 64);
+	mcp2221_adc_stream_stats_t stats;
+	assert(mcp2221_adc_stream_get_stats(stream, &stats) == MCP2221_ERR_OK);
+	assert(count > 0 && (uint64_t)count == stats.samples);
+	assert(samples[0].raw[0] == 0);
+	for (int i = 1; i < count; i++)
+		assert(samples[i].time_ns > samples[i - 1].time_ns);
+	mcp2221_adc_stream_destroy(stream);
+}
+
+int main(void) {
+	test_create_validates_arguments();
+	test_samples_are_queued_in_order();
+	test_decimation_averages_acquisitions();
+	test_full_ring_counts_overruns();
+	test_restart_discards_previous_samples();
+	return 0;
+}
@@ -0,0 +1,338 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mcp2221_bus.h"
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_bus.h"
+
+struct mcp2221_device {
+	int closed;
+};
+
+static uint32_t last_reg;
+static size_t last_length;
+static int slave_calls;
+
+/* Register reads in execution order, and a client the first read waits for. */
+static struct {
+	uint8_t addr;
+	uint32_t reg;
+	size_t length;
+} read_log[32];
+static size_t read_log_count;
+static mcp2221_bus_client_t *wait_for_client;
+
+/*
+ * Wait until a client has a transaction queued. A client handle starts with
+ * its scheduler flow.
+ */
+static void wait_until_queued(mcp2221_bus_client_t *client) {
+	const mcp2221_internal_bus_flow_t *flow = (const mcp2221_internal_bus_flow_t *)client;
+
+	for (int i = 0; i < 5000 && __atomic_load_n(&flow->queued, __ATOMIC_ACQUIRE) == 0; i++)
+		mcp2221_internal_sleep_until_ns(mcp2221_internal_monotonic_ns() + 1000000u);
+}
+
+/*
+ * Link stubs for the I2C slave helpers executed by the bus worker. They do
+ * not touch a real device.
+ */
+mcp2221_error_code_t mcp2221_i2c_slave_read_register(mcp2221_i2c_slave_t *slave, uint32_t reg, uint8_t *buffer, size_t length, int reg_bytes,
+						     mcp2221_i2c_byte_order_t reg_byteorder) {
+	(void)reg_bytes;
+	(void)reg_byteorder;
+	last_reg = reg;
+	last_length = length;
+	slave_calls++;
+	if (read_log_count < sizeof(read_log) / sizeof(read_log[0])) {
+		read_log[read_log_count].addr = slave->addr;
+		read_log[read_log_count].reg = reg;
+		read_log[read_log_count].length = length;
+		__atomic_store_n(&read_log_count, read_log_count + 1, __ATOMIC_RELEASE);
+	}
+	if (wait_for_client) {
+		wait_until_queued(wait_for_client);
+		wait_for_client = NULL;
+	}
+	memset(buffer, 0xa5, length);
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_write_register(mcp2221_i2c_slave_t *slave, uint32_t reg, const uint8_t *data, size_t length,
+						      int reg_bytes, mcp2221_i2c_byte_order_t reg_byteorder) {
+	(void)slave;
+	(void)data;
+	(void)reg_bytes;
+	(void)reg_byteorder;
+	last_reg = reg;
+	last_length = length;
+	slave_calls++;
+	return MCP2221_ERR_NOT_ACK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_read(mcp2221_i2c_slave_t *slave, uint8_t *buffer, size_t length) {
+	(void)slave;
+	(void)buffer;
+	(void)length;
+	return MCP2221_ERR_INVALID;
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_write(mcp2221_i2c_slave_t *slave, const uint8_t *data, size_t length) {
+	(void)slave;
+	(void)data;
+	(void)length;
+	return MCP2221_ERR_INVALID;
+}
+
+void mcp2221_close(mcp2221_t *dev) {
+	dev->closed = 1;
+}
+
+static mcp2221_internal_bus_flow_t *pop_flow(mcp2221_internal_bus_sched_t *sched) {
+	mcp2221_internal_bus_node_t *node = mcp2221_internal_bus_sched_pop(sched);
+	assert(node != NULL);
+	return node->flow;
+}
+
+static void test_equal_weights_alternate(void) {
+	mcp2221_internal_bus_sched_t sched;
+	mcp2221_internal_bus_flow_t a;
+	mcp2221_internal_bus_flow_t b;
+	mcp2221_internal_bus_node_t nodes[8];
+
+	mcp2221_internal_bus_sched_init(&sched);
+	mcp2221_internal_bus_flow_attach(&sched, &a, 0, 1);
+	mcp2221_internal_bus_flow_attach(&sched, &b, 0, 1);
+
+	for (int i = 0; i < 4; i++)
+		mcp2221_internal_bus_sched_push(&sched, &a, &nodes[i], 32);
+	for (int i = 4; i < 8; i++)
+		mcp2221_internal_bus_sched_push(&sched, &b, &nodes[i], 32);
+
+	for (int i = 0; i < 4; i++) {
+		mcp2221_internal_bus_flow_t *first = pop_flow(&sched);
+		mcp2221_internal_bus_flow_t *second = pop_flow(&sched);
+		assert(first != second);
+	}
+	assert(mcp2221_internal_bus_sched_pop(&sched) == NULL);
+}
+
+static void test_weights_share_bandwidth(void) {
+	mcp2221_internal_bus_sched_t sched;
+	mcp2221_internal_bus_flow_t heavy;
+	mcp2221_internal_bus_flow_t light;
+	mcp2221_internal_bus_node_t nodes[40];
+	int heavy_served = 0;
+
+	mcp2221_internal_bus_sched_init(&sched);
+	mcp2221_internal_bus_flow_attach(&sched, &heavy, 0, 3);
+	mcp2221_internal_bus_flow_attach(&sched, &light, 0, 1);
+
+	for (int i = 0; i < 20; i++) {
+		mcp2221_internal_bus_sched_push(&sched, &heavy, &nodes[i], 48);
+		mcp2221_internal_bus_sched_push(&sched, &light, &nodes[20 + i], 48);
+	}
+
+	// In the first 16 services the weight-3 flow gets three out of four.
+	for (int i = 0; i < 16; i++) {
+		if (pop_flow(&sched) == &heavy)
+			heavy_served++;
+	}
+	assert(heavy_served == 12);
+}
+
+static void test_small_transactions_pass_bulk_transfer(void) {
+	mcp2221_internal_bus_sched_t sched;
+	mcp2221_internal_bus_flow_t bulk;
+	mcp2221_internal_bus_flow_t small;
+	mcp2221_internal_bus_node_t bulk_nodes[16];
+	mcp2221_internal_bus_node_t small_node;
+
+	mcp2221_internal_bus_sched_init(&sched);
+	mcp2221_internal_bus_flow_attach(&sched, &bulk, 0, 1);
+	mcp2221_internal_bus_flow_attach(&sched, &small, 0, 1);
+
+	// A 4 KiB dump queued as 256-byte pages.
+	for (int i = 0; i < 16; i++)
+		mcp2221_internal_bus_sched_push(&sched, &bulk, &bulk_nodes[i], 256);
+	assert(pop_flow(&sched) == &bulk);
+
+	mcp2221_internal_bus_sched_push(&sched, &small, &small_node, 2);
+	assert(pop_flow(&sched) == &small);
+}
+
+static void test_priority_is_strict(void) {
+	mcp2221_internal_bus_sched_t sched;
+	mcp2221_internal_bus_flow_t low;
+	mcp2221_internal_bus_flow_t high;
+	mcp2221_internal_bus_node_t low_nodes[4];
+	mcp2221_internal_bus_node_t high_nodes[2];
+
+	mcp2221_internal_bus_sched_init(&sched);
+	mcp2221_internal_bus_flow_attach(&sched, &low, 0, 100);
+	mcp2221_internal_bus_flow_attach(&sched, &high, 1, 1);
+
+	for (int i = 0; i < 4; i++)
+		mcp2221_internal_bus_sched_push(&sched, &low, &low_nodes[i], 1);
+	for (int i = 0; i < 2; i++)
+		mcp2221_internal_bus_sched_push(&sched, &high, &high_nodes[i], 256);
+
+	assert(pop_flow(&sched) == &high);
+	assert(pop_flow(&sched) == &high);
+	for (int i = 0; i < 4; i++)
+		assert(pop_flow(&sched) == &low);
+
+	mcp2221_internal_bus_flow_detach(&sched, &high);
+	mcp2221_internal_bus_flow_detach(&sched, &low);
+	assert(sched.flows == NULL);
+}
+
+static void test_fifo_within_flow(void) {
+	mcp2221_internal_bus_sched_t sched;
+	mcp2221_internal_bus_flow_t flow;
+	mcp2221_internal_bus_node_t nodes[3];
+
+	mcp2221_internal_bus_sched_init(&sched);
+	mcp2221_internal_bus_flow_attach(&sched, &flow, 0, 0);
+	assert(flow.weight == 1);
+
+	mcp2221_internal_bus_sched_push(&sched, &flow, &nodes[0], 100);
+	mcp2221_internal_bus_sched_push(&sched, &flow, &nodes[1], 1);
+	mcp2221_internal_bus_sched_push(&sched, &flow, &nodes[2], 50);
+
+	for (int i = 0; i < 3; i++)
+		assert(mcp2221_internal_bus_sched_pop(&sched) == &nodes[i]);
+}
+
+static void test_bus_manager_round_trip(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_bus_t *bus = NULL;
+	mcp2221_bus_client_t *client = NULL;
+	mcp2221_bus_client_stats_t stats;
+	mcp2221_i2c_slave_t slave = {
+		.mcp = &dev,
+		.addr = 0x50,
+		.reg_bytes = 1,
+		.reg_byteorder = MCP2221_I2C_BYTE_ORDER_BIG
+	};
+	mcp2221_i2c_slave_t foreign = slave;
+	struct mcp2221_device other = {0};
+	uint8_t buffer[4] = {0};
+
+	foreign.mcp = &other;
+
+	assert(mcp2221_bus_open(&dev, &bus) == MCP2221_ERR_OK);
+	assert(mcp2221_bus_get_device(bus) == &dev);
+	assert(mcp2221_bus_client_add(bus, &foreign, 0, 1, &client) == MCP2221_ERR_INVALID);
+	assert(client == NULL);
+	assert(mcp2221_bus_client_add(bus, &slave, 0, 1, &client) == MCP2221_ERR_OK);
+
+	assert(mcp2221_bus_read_register(client, 0x12, buffer, sizeof(buffer)) == MCP2221_ERR_OK);
+	assert(last_reg == 0x12);
+	assert(last_length == sizeof(buffer));
+	assert(buffer[3] == 0xa5);
+
+	assert(mcp2221_bus_write_register(client, 0x13, buffer, 2) == MCP2221_ERR_NOT_ACK);
+	assert(slave_calls == 2);
+
+	assert(mcp2221_bus_client_get_stats(client, &stats) == MCP2221_ERR_OK);
+	assert(stats.transactions == 2);
+	assert(stats.errors == 1);
+	assert(stats.bytes == sizeof(buffer));
+	assert(stats.queue_delay_max_us <= stats.queue_delay_total_us);
+
+	assert(mcp2221_bus_client_reset_stats(client) == MCP2221_ERR_OK);
+	assert(mcp2221_bus_client_get_stats(client, &stats) == MCP2221_ERR_OK);
+	assert(stats.transactions == 0);
+
+	mcp2221_bus_close(bus);
+	assert(dev.closed == 1);
+}
+
+typedef struct {
+	mcp2221_bus_client_t *client;
+	uint8_t *buffer;
+	size_t length;
+	mcp2221_error_code_t result;
+} bulk_read_t;
+
+static void *bulk_reader(void *arg) {
+	bulk_read_t *read = arg;
+
+	read->result = mcp2221_bus_read_register(read->client, 0x0000, read->buffer, read->length);
+	return NULL;
+}
+
+static void test_bus_manager_splits_long_register_reads(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_bus_t *bus = NULL;
+	mcp2221_bus_client_t *eeprom = NULL;
+	mcp2221_bus_client_t *sensor = NULL;
+	mcp2221_bus_client_stats_t stats;
+	mcp2221_i2c_slave_t eeprom_slave = {
+		.mcp = &dev,
+		.addr = 0x50,
+		.reg_bytes = 2,
+		.reg_byteorder = MCP2221_I2C_BYTE_ORDER_BIG
+	};
+	mcp2221_i2c_slave_t sensor_slave = eeprom_slave;
+	static uint8_t dump[4096];
+	uint8_t value[2];
+	pthread_t thread;
+
+	sensor_slave.addr = 0x48;
+	sensor_slave.reg_bytes = 1;
+
+	assert(mcp2221_bus_open(&dev, &bus) == MCP2221_ERR_OK);
+	assert(mcp2221_bus_client_add(bus, &eeprom_slave, 0, 1, &eeprom) == MCP2221_ERR_OK);
+	assert(mcp2221_bus_client_add(bus, &sensor_slave, 1, 1, &sensor) == MCP2221_ERR_OK);
+
+	// Addresses of a split read must fit the register width.
+	assert(mcp2221_bus_read_register(sensor, 0x00, dump, 512) == MCP2221_ERR_INVALID);
+
+	// The first 256-byte chunk waits until the sensor read is queued.
+	read_log_count = 0;
+	wait_for_client = sensor;
+	bulk_read_t bulk = {
+		.client = eeprom,
+		.buffer = dump,
+		.length = sizeof(dump)
+	};
+	assert(pthread_create(&thread, NULL, bulk_reader, &bulk) == 0);
+	while (__atomic_load_n(&read_log_count, __ATOMIC_ACQUIRE) == 0)
+		mcp2221_internal_sleep_until_ns(mcp2221_internal_monotonic_ns() + 1000000u);
+	assert(mcp2221_bus_read_register(sensor, 0x05, value, sizeof(value)) == MCP2221_ERR_OK);
+	assert(pthread_join(thread, NULL) == 0);
+	assert(bulk.result == MCP2221_ERR_OK);
+
+	// The sensor read runs right after the first chunk, not after 4 KiB.
+	assert(read_log_count == 17);
+	assert(read_log[0].addr == 0x50 && read_log[0].reg == 0 && read_log[0].length == 256);
+	assert(read_log[1].addr == 0x48 && read_log[1].reg == 0x05);
+	for (size_t i = 2; i < read_log_count; i++) {
+		assert(read_log[i].addr == 0x50);
+		assert(read_log[i].reg == (i - 1) * 256);
+		assert(read_log[i].length == 256);
+	}
+	assert(dump[sizeof(dump) - 1] == 0xa5);
+
+	assert(mcp2221_bus_client_get_stats(eeprom, &stats) == MCP2221_ERR_OK);
+	assert(stats.transactions == 16);
+	assert(stats.bytes == sizeof(dump));
+
+	mcp2221_bus_close(bus);
+}
+
+int main(void) {
+	test_equal_weights_alternate();
+	test_weights_share_bandwidth();
+	test_small_transactions_pass_bulk_transfer();
+	test_priority_is_strict();
+	test_fifo_within_flow();
+	test_bus_manager_round_trip();
+	test_bus_manager_splits_long_register_reads();
+	return 0;
+}
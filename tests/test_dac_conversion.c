@@ -2,6 +2,7 @@
 #include <math.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "mcp2221_internal_analog.h"
 
@@ -219,6 +220,150 @@ static void test_volts_rejects_invalid_values(void) {
 			NULL) == MCP2221_ERR_INVALID);
 }
 
+static double next_up(double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	bits++;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static double next_down(double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	bits--;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static void assert_table_matches(const mcp2221_internal_analog_dac_table_t *table, double volts) {
+	uint8_t expected;
+	uint8_t raw;
+	mcp2221_error_code_t err =
+		mcp2221_internal_analog_dac_volts_to_raw(
+			volts,
+			table->reference_voltage,
+			&expected);
+
+	assert(mcp2221_internal_analog_dac_table_lookup(table, volts, &raw) == err);
+	if (err == MCP2221_ERR_OK)
+		assert(raw == expected);
+}
+
+static void test_table_matches_conversion(void) {
+	static const double references[] = {1.024, 2.048, 4.096, 1.8, 3.3, 5.0, 5.5};
+	size_t i;
+	int k;
+
+	for (i = 0; i < sizeof(references) / sizeof(references[0]); ++i) {
+		mcp2221_internal_analog_dac_table_t table;
+
+		assert(
+			mcp2221_internal_analog_dac_table_build(
+				&table,
+				references[i]) == MCP2221_ERR_OK);
+
+		// Every threshold and its neighbours.
+		for (k = 1; k < 32; ++k) {
+			assert(table.threshold[k] > table.threshold[k - 1]);
+			assert_table_matches(&table, next_down(table.threshold[k]));
+			assert_table_matches(&table, table.threshold[k]);
+			assert_table_matches(&table, next_up(table.threshold[k]));
+		}
+
+		// A sweep across and beyond the range.
+		for (k = -10; k <= 110000; ++k)
+			assert_table_matches(&table, references[i] * k / 100000.0);
+
+		assert_table_matches(&table, table.max_volts);
+		assert_table_matches(&table, next_up(table.max_volts));
+		assert_table_matches(&table, -0.0);
+		assert_table_matches(&table, NAN);
+		assert_table_matches(&table, INFINITY);
+	}
+}
+
+static void test_table_rejects_invalid_values(void) {
+	mcp2221_internal_analog_dac_table_t table;
+	uint8_t raw;
+
+	assert(mcp2221_internal_analog_dac_table_build(&table, 0.0) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_dac_table_build(&table, NAN) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_dac_table_build(&table, INFINITY) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_dac_table_build(NULL, 3.3) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_dac_table_lookup(&table, 1.0, &raw) == MCP2221_ERR_INVALID);
+
+	assert(mcp2221_internal_analog_dac_table_build(&table, 3.3) == MCP2221_ERR_OK);
+	assert(mcp2221_internal_analog_dac_table_lookup(&table, 1.0, NULL) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_dac_table_lookup(NULL, 1.0, &raw) == MCP2221_ERR_INVALID);
+}
+
+static void test_bulk_matches_scalar(void) {
+	static const double references[] = {1.024, 2.048, 4.096, 1.8, 3.3, 5.0};
+	enum { COUNT = 32 * 3 + 20001 };
+	static double volts[COUNT];
+	static uint8_t bulk[COUNT];
+	size_t r, i, offset;
+
+	for (r = 0; r < sizeof(references) / sizeof(references[0]); ++r) {
+		mcp2221_internal_analog_dac_table_t table;
+		size_t count = 0;
+		int k;
+
+		// Every step boundary and its neighbours, then a sweep of the range.
+		assert(mcp2221_internal_analog_dac_table_build(&table, references[r]) == MCP2221_ERR_OK);
+		for (k = 0; k < 32; ++k) {
+			volts[count++] = k > 0 ? next_down(table.threshold[k]) : -0.0;
+			volts[count++] = table.threshold[k];
+			if (next_up(table.threshold[k]) <= table.max_volts)
+				volts[count++] = next_up(table.threshold[k]);
+		}
+		for (k = 0; k <= 20000; ++k)
+			volts[count++] = table.max_volts * k / 20000.0;
+		assert(count <= COUNT);
+
+		for (offset = 0; offset < 3; ++offset) {
+			size_t n = count - offset;
+
+			assert(
+				mcp2221_internal_analog_dac_volts_to_raw_n(
+					volts + offset,
+					bulk + offset,
+					n,
+					references[r]) == MCP2221_ERR_OK);
+			for (i = 0; i < n; ++i) {
+				uint8_t expected;
+				assert(
+					mcp2221_internal_analog_dac_volts_to_raw(
+						volts[offset + i],
+						references[r],
+						&expected) == MCP2221_ERR_OK);
+				assert(bulk[offset + i] == expected);
+			}
+		}
+	}
+}
+
+static void test_bulk_rejects_invalid_values(void) {
+	double volts[9] = {0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0, 0.1, 0.2};
+	uint8_t out[9];
+	size_t i;
+
+	assert(mcp2221_internal_analog_dac_volts_to_raw_n(NULL, NULL, 0, 3.3) == MCP2221_ERR_OK);
+	assert(mcp2221_internal_analog_dac_volts_to_raw_n(volts, NULL, 9, 3.3) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_dac_volts_to_raw_n(volts, out, 9, 0.0) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_analog_dac_volts_to_raw_n(volts, out, 9, NAN) == MCP2221_ERR_INVALID);
+
+	static const double bad[] = {-0.001, 3.3, NAN, INFINITY};
+	for (size_t b = 0; b < sizeof(bad) / sizeof(bad[0]); ++b) {
+		volts[6] = bad[b];
+		memset(out, 0xAA, sizeof(out));
+		assert(mcp2221_internal_analog_dac_volts_to_raw_n(volts, out, 9, 3.3) == MCP2221_ERR_INVALID);
+		for (i = 0; i < 9; ++i)
+			assert(out[i] == 0xAA);
+	}
+}
+
 int main(void) {
 	test_zero();
 	test_single_step();
@@ -233,6 +378,10 @@ int main(void) {
     test_volts_maximum_fixed_references();
     test_volts_truncates_between_steps();
     test_volts_rejects_invalid_values();
+    test_table_matches_conversion();
+    test_table_rejects_invalid_values();
+    test_bulk_matches_scalar();
+    test_bulk_rejects_invalid_values();
 
 	return 0;
 }
\ No newline at end of file
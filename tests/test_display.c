@@ -0,0 +1,277 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mcp2221_display.h"
+
+struct mcp2221_device {
+	int unused;
+};
+
+#define MAX_WRITES 32
+
+typedef struct {
+	uint8_t data[257];
+	size_t length;
+} write_record_t;
+
+static write_record_t log_writes[MAX_WRITES];
+static int write_count;
+static int fail_at = -1;
+
+/* Simulated SSD1306 GDDRAM in horizontal addressing mode. */
+static uint8_t gddram[8][128];
+static int win_col_lo, win_col_hi, win_page_lo, win_page_hi;
+static int cur_col, cur_page;
+
+static void reset_log(void) {
+	memset(log_writes, 0, sizeof(log_writes));
+	write_count = 0;
+	fail_at = -1;
+}
+
+static void apply_ssd1306(const uint8_t *data, size_t length) {
+	if (data[0] == 0x00) {
+		for (size_t i = 1; i < length; ++i) {
+			if (data[i] == 0x21 && i + 2 < length) {
+				win_col_lo = cur_col = data[i + 1];
+				win_col_hi = data[i + 2];
+				i += 2;
+			} else if (data[i] == 0x22 && i + 2 < length) {
+				win_page_lo = cur_page = data[i + 1];
+				win_page_hi = data[i + 2];
+				i += 2;
+			}
+		}
+		return;
+	}
+
+	assert(data[0] == 0x40);
+	for (size_t i = 1; i < length; ++i) {
+		gddram[cur_page][cur_col] = data[i];
+		if (++cur_col > win_col_hi) {
+			cur_col = win_col_lo;
+			if (++cur_page > win_page_hi)
+				cur_page = win_page_lo;
+		}
+	}
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_write(mcp2221_i2c_slave_t *slave, const uint8_t *data, size_t length) {
+	(void)slave;
+	assert(length >= 2 && length <= 256);
+	assert(write_count < MAX_WRITES);
+	if (write_count == fail_at) {
+		write_count++;
+		return MCP2221_ERR_NOT_ACK;
+	}
+	memcpy(log_writes[write_count].data, data, length);
+	log_writes[write_count].length = length;
+	write_count++;
+	apply_ssd1306(data, length);
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_display_t *make_display(mcp2221_display_controller_t controller, int width, int height, int offset) {
+	static struct mcp2221_device dev;
+	mcp2221_i2c_slave_t slave;
+	memset(&slave, 0, sizeof(slave));
+	slave.mcp = &dev;
+	slave.addr = 0x3c;
+	slave.reg_bytes = 1;
+
+	mcp2221_display_config_t config = {
+		.controller = controller,
+		.width = width,
+		.height = height,
+		.column_offset = offset
+	};
+	mcp2221_display_t *display = NULL;
+	assert(mcp2221_display_create(&slave, &config, &display) == MCP2221_ERR_OK);
+	return display;
+}
+
+static void assert_gddram_matches(mcp2221_display_t *display, int width, int pages) {
+	const uint8_t *fb = mcp2221_display_buffer(display, NULL);
+	for (int page = 0; page < pages; ++page)
+		assert(memcmp(gddram[page], fb + page * width, (size_t)width) == 0);
+}
+
+static void test_create_validates_geometry(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_slave_t slave;
+	memset(&slave, 0, sizeof(slave));
+	slave.mcp = &dev;
+	mcp2221_display_t *display = NULL;
+
+	mcp2221_display_config_t config = {MCP2221_DISPLAY_SSD1306, 128, 30, 0};
+	assert(mcp2221_display_create(&slave, &config, &display) == MCP2221_ERR_INVALID);
+	config.height = 72;
+	assert(mcp2221_display_create(&slave, &config, &display) == MCP2221_ERR_INVALID);
+	config.height = 64;
+	config.column_offset = 2;
+	assert(mcp2221_display_create(&slave, &config, &display) == MCP2221_ERR_INVALID);
+
+	config.controller = MCP2221_DISPLAY_SH1106;
+	assert(mcp2221_display_create(&slave, &config, &display) == MCP2221_ERR_OK);
+
+	size_t size = 0;
+	assert(mcp2221_display_buffer(display, &size) != NULL);
+	assert(size == 1024);
+	mcp2221_display_destroy(display);
+}
+
+static void test_first_flush_sends_full_frame(void) {
+	reset_log();
+	mcp2221_display_t *display = make_display(MCP2221_DISPLAY_SSD1306, 128, 32, 0);
+	uint8_t *fb = mcp2221_display_buffer(display, NULL);
+	for (int i = 0; i < 512; ++i)
+		fb[i] = (uint8_t)(i * 13);
+
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	// One window, then 512 bytes in chunks of 255, 255 and 2.
+	assert(write_count == 4);
+	const uint8_t window[] = {0x00, 0x21, 0, 127, 0x22, 0, 3};
+	assert(log_writes[0].length == sizeof(window));
+	assert(memcmp(log_writes[0].data, window, sizeof(window)) == 0);
+	assert(log_writes[1].length == 256);
+	assert(log_writes[3].length == 3);
+	assert_gddram_matches(display, 128, 4);
+
+	// Nothing changed: nothing is sent.
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	assert(write_count == 4);
+	mcp2221_display_destroy(display);
+}
+
+static void test_small_change_sends_small_window(void) {
+	reset_log();
+	mcp2221_display_t *display = make_display(MCP2221_DISPLAY_SSD1306, 128, 32, 0);
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	reset_log();
+
+	// A digit-sized change on one page.
+	for (int x = 60; x < 66; ++x)
+		mcp2221_display_set_pixel(display, x, 10, 1);
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	assert(write_count == 2);
+	const uint8_t window[] = {0x00, 0x21, 60, 65, 0x22, 1, 1};
+	assert(memcmp(log_writes[0].data, window, sizeof(window)) == 0);
+	assert(log_writes[1].length == 7);
+	assert_gddram_matches(display, 128, 4);
+
+	mcp2221_display_stats_t stats;
+	assert(mcp2221_display_get_stats(display, &stats) == MCP2221_ERR_OK);
+	assert(stats.flushes == 2);
+	assert(stats.regions == 2);
+	mcp2221_display_destroy(display);
+}
+
+static void test_neighboring_pages_share_a_window(void) {
+	reset_log();
+	mcp2221_display_t *display = make_display(MCP2221_DISPLAY_SSD1306, 128, 64, 0);
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	reset_log();
+
+	// A 12-pixel-high glyph spanning pages 2 and 3.
+	for (int y = 20; y < 32; ++y)
+		mcp2221_display_set_pixel(display, 40 + (y % 4), y, 1);
+	// Far away on page 7, a single column.
+	mcp2221_display_set_pixel(display, 120, 60, 1);
+
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	assert(write_count == 4);
+	const uint8_t first[] = {0x00, 0x21, 40, 43, 0x22, 2, 3};
+	const uint8_t second[] = {0x00, 0x21, 120, 120, 0x22, 7, 7};
+	assert(memcmp(log_writes[0].data, first, sizeof(first)) == 0);
+	assert(log_writes[1].length == 1 + 8);
+	assert(memcmp(log_writes[2].data, second, sizeof(second)) == 0);
+	assert_gddram_matches(display, 128, 8);
+	mcp2221_display_destroy(display);
+}
+
+static void test_distant_spans_use_separate_windows(void) {
+	reset_log();
+	mcp2221_display_t *display = make_display(MCP2221_DISPLAY_SSD1306, 128, 16, 0);
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	reset_log();
+
+	// Merging would resend almost two full pages.
+	mcp2221_display_set_pixel(display, 0, 0, 1);
+	mcp2221_display_set_pixel(display, 127, 8, 1);
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	assert(write_count == 4);
+	assert(log_writes[1].length == 2);
+	assert(log_writes[3].length == 2);
+	assert_gddram_matches(display, 128, 2);
+	mcp2221_display_destroy(display);
+}
+
+static void test_sh1106_uses_page_addressing(void) {
+	reset_log();
+	mcp2221_display_t *display = make_display(MCP2221_DISPLAY_SH1106, 128, 64, 2);
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	// Eight pages, each with one position write and one data write.
+	assert(write_count == 16);
+	reset_log();
+
+	mcp2221_display_set_pixel(display, 30, 45, 1);
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	assert(write_count == 2);
+	const uint8_t position[] = {0x00, 0xB5, 0x00, 0x12};
+	assert(log_writes[0].length == sizeof(position));
+	assert(memcmp(log_writes[0].data, position, sizeof(position)) == 0);
+	assert(log_writes[1].data[0] == 0x40);
+	assert(log_writes[1].data[1] == 0x20);
+	mcp2221_display_destroy(display);
+}
+
+static void test_failed_flush_resends_everything(void) {
+	reset_log();
+	mcp2221_display_t *display = make_display(MCP2221_DISPLAY_SSD1306, 128, 32, 0);
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	reset_log();
+
+	mcp2221_display_set_pixel(display, 5, 5, 1);
+	fail_at = 1;
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_NOT_ACK);
+
+	reset_log();
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	assert(write_count == 4);
+	assert_gddram_matches(display, 128, 4);
+
+	mcp2221_display_invalidate(display);
+	reset_log();
+	assert(mcp2221_display_flush(display) == MCP2221_ERR_OK);
+	assert(write_count == 4);
+	mcp2221_display_destroy(display);
+}
+
+static void test_send_commands_packs_one_write(void) {
+	reset_log();
+	mcp2221_display_t *display = make_display(MCP2221_DISPLAY_SSD1306, 128, 32, 0);
+	const uint8_t init[] = {0xAE, 0x20, 0x00, 0x8D, 0x14, 0xAF};
+
+	assert(mcp2221_display_send_commands(display, init, sizeof(init)) == MCP2221_ERR_OK);
+	assert(write_count == 1);
+	assert(log_writes[0].length == 1 + sizeof(init));
+	assert(log_writes[0].data[0] == 0x00);
+	assert(memcmp(log_writes[0].data + 1, init, sizeof(init)) == 0);
+
+	assert(mcp2221_display_send_commands(display, init, 0) == MCP2221_ERR_INVALID);
+	mcp2221_display_destroy(display);
+}
+
+int main(void) {
+	test_create_validates_geometry();
+	test_first_flush_sends_full_frame();
+	test_small_change_sends_small_window();
+	test_neighboring_pages_share_a_window();
+	test_distant_spans_use_separate_windows();
+	test_sh1106_uses_page_addressing();
+	test_failed_flush_resends_everything();
+	test_send_commands_packs_one_write();
+	return 0;
+}
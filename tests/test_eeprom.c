@@ -0,0 +1,382 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mcp2221_eeprom.h"
+
+struct mcp2221_device {
+	int unused;
+};
+
+#define EEPROM_SIZE 4096
+#define PAGE_SIZE 32
+
+/*
+ * Simulated 24xx EEPROM: page writes wrap within the page, and the device
+ * ignores its address for busy_polls probes after each write.
+ */
+static uint8_t memory[EEPROM_SIZE];
+static int busy;
+static int busy_polls;
+static int reads;
+static int writes;
+static size_t last_read_len;
+static mcp2221_error_code_t read_result;
+
+static void reset_device(void) {
+	for (size_t i = 0; i < EEPROM_SIZE; ++i)
+		memory[i] = (uint8_t)(i * 7);
+	busy = 0;
+	busy_polls = 0;
+	reads = 0;
+	writes = 0;
+	last_read_len = 0;
+	read_result = MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_check_present(mcp2221_i2c_slave_t *slave, int *is_present) {
+	(void)slave;
+	if (busy > 0) {
+		busy--;
+		*is_present = 0;
+	} else {
+		*is_present = 1;
+	}
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_read_register(mcp2221_i2c_slave_t *slave, uint32_t reg, uint8_t *buffer, size_t length, int reg_bytes,
+						     mcp2221_i2c_byte_order_t reg_byteorder) {
+	(void)slave;
+	(void)reg_bytes;
+	(void)reg_byteorder;
+	// A real device would NACK during its write cycle.
+	assert(busy == 0);
+	assert(length <= 256);
+	assert(reg + length <= EEPROM_SIZE);
+	reads++;
+	last_read_len = length;
+	if (read_result != MCP2221_ERR_OK)
+		return read_result;
+	memcpy(buffer, memory + reg, length);
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_slave_write_register(mcp2221_i2c_slave_t *slave, uint32_t reg, const uint8_t *data, size_t length, int reg_bytes,
+						      mcp2221_i2c_byte_order_t reg_byteorder) {
+	(void)slave;
+	(void)reg_bytes;
+	(void)reg_byteorder;
+	assert(busy == 0);
+	// Writes must not cross a page boundary.
+	assert(reg / PAGE_SIZE == (reg + length - 1) / PAGE_SIZE);
+	writes++;
+	memcpy(memory + reg, data, length);
+	busy = busy_polls;
+	return MCP2221_ERR_OK;
+}
+
+static mcp2221_eeprom_map_t *open_map(size_t cache_pages, size_t read_ahead) {
+	static struct mcp2221_device dev;
+	mcp2221_i2c_slave_t slave;
+	memset(&slave, 0, sizeof(slave));
+	slave.mcp = &dev;
+	slave.addr = 0x50;
+	slave.reg_bytes = 2;
+	slave.reg_byteorder = MCP2221_I2C_BYTE_ORDER_BIG;
+
+	mcp2221_eeprom_map_config_t config = {
+		.size = EEPROM_SIZE,
+		.page_size = PAGE_SIZE,
+		.cache_pages = cache_pages,
+		.read_ahead_pages = read_ahead,
+		.write_cycle_ms = 0
+	};
+
+	mcp2221_eeprom_map_t *map = NULL;
+	assert(mcp2221_eeprom_map_create(&slave, &config, &map) == MCP2221_ERR_OK);
+	assert(map != NULL);
+	return map;
+}
+
+static void test_create_validates_config(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_slave_t slave;
+	mcp2221_eeprom_map_t *map = (mcp2221_eeprom_map_t *)&dev;
+	memset(&slave, 0, sizeof(slave));
+	slave.mcp = &dev;
+	slave.reg_bytes = 1;
+
+	mcp2221_eeprom_map_config_t config = {.size = 256, .page_size = 16};
+	assert(mcp2221_eeprom_map_create(&slave, NULL, &map) == MCP2221_ERR_INVALID);
+	assert(map == NULL);
+
+	config.page_size = 24;
+	assert(mcp2221_eeprom_map_create(&slave, &config, &map) == MCP2221_ERR_INVALID);
+	config.page_size = 512;
+	assert(mcp2221_eeprom_map_create(&slave, &config, &map) == MCP2221_ERR_INVALID);
+	config.page_size = 16;
+	config.size = 250;
+	assert(mcp2221_eeprom_map_create(&slave, &config, &map) == MCP2221_ERR_INVALID);
+
+	// One address byte reaches 256 bytes only.
+	config.size = 512;
+	assert(mcp2221_eeprom_map_create(&slave, &config, &map) == MCP2221_ERR_INVALID);
+
+	config.size = 256;
+	config.cache_pages = 4;
+	config.read_ahead_pages = 4;
+	assert(mcp2221_eeprom_map_create(&slave, &config, &map) == MCP2221_ERR_INVALID);
+
+	config.read_ahead_pages = 3;
+	assert(mcp2221_eeprom_map_create(&slave, &config, &map) == MCP2221_ERR_OK);
+
+	uint8_t buf[4];
+	assert(mcp2221_eeprom_map_read(map, 254, buf, 4) == MCP2221_ERR_INVALID);
+	assert(mcp2221_eeprom_map_write(map, 256, buf, 1) == MCP2221_ERR_INVALID);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_small_reads_hit_cache(void) {
+	reset_device();
+	mcp2221_eeprom_map_t *map = open_map(8, 0);
+	uint8_t b;
+
+	for (size_t i = 0; i < PAGE_SIZE; i += 3) {
+		size_t offset = 512 + (i * 5) % PAGE_SIZE;
+		assert(mcp2221_eeprom_map_read(map, offset, &b, 1) == MCP2221_ERR_OK);
+		assert(b == memory[offset]);
+	}
+	assert(reads == 1);
+	assert(last_read_len == PAGE_SIZE);
+
+	mcp2221_eeprom_map_stats_t stats;
+	assert(mcp2221_eeprom_map_get_stats(map, &stats) == MCP2221_ERR_OK);
+	assert(stats.read_misses == 1);
+	assert(stats.read_hits == 10);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_sequential_reads_trigger_read_ahead(void) {
+	reset_device();
+	mcp2221_eeprom_map_t *map = open_map(16, 3);
+	uint8_t buf[PAGE_SIZE];
+
+	// The first access has no history, so only its page is fetched.
+	assert(mcp2221_eeprom_map_read(map, 0, buf, PAGE_SIZE) == MCP2221_ERR_OK);
+	assert(reads == 1 && last_read_len == PAGE_SIZE);
+
+	// Continuing sequentially fetches page 1 and three pages ahead at once.
+	assert(mcp2221_eeprom_map_read(map, PAGE_SIZE, buf, PAGE_SIZE) == MCP2221_ERR_OK);
+	assert(reads == 2 && last_read_len == 4 * PAGE_SIZE);
+	for (size_t page = 2; page <= 4; ++page) {
+		assert(mcp2221_eeprom_map_read(map, page * PAGE_SIZE, buf, PAGE_SIZE) == MCP2221_ERR_OK);
+		assert(memcmp(buf, memory + page * PAGE_SIZE, PAGE_SIZE) == 0);
+	}
+	assert(reads == 2);
+
+	// A random access does not read ahead.
+	assert(mcp2221_eeprom_map_read(map, 40 * PAGE_SIZE, buf, 1) == MCP2221_ERR_OK);
+	assert(reads == 3 && last_read_len == PAGE_SIZE);
+
+	mcp2221_eeprom_map_stats_t stats;
+	assert(mcp2221_eeprom_map_get_stats(map, &stats) == MCP2221_ERR_OK);
+	assert(stats.read_ahead_pages == 3);
+	assert(stats.read_transactions == 3);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_large_read_uses_long_transactions(void) {
+	reset_device();
+	mcp2221_eeprom_map_t *map = open_map(32, 0);
+	uint8_t buf[600];
+
+	assert(mcp2221_eeprom_map_read(map, 100, buf, sizeof(buf)) == MCP2221_ERR_OK);
+	assert(memcmp(buf, memory + 100, sizeof(buf)) == 0);
+	// Pages 3..21: 19 pages in reads of 8, 8 and 3 pages.
+	assert(reads == 3);
+	assert(last_read_len == 3 * PAGE_SIZE);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_writes_are_coalesced_per_page(void) {
+	reset_device();
+	mcp2221_eeprom_map_t *map = open_map(8, 0);
+	uint8_t expect[EEPROM_SIZE];
+	memcpy(expect, memory, sizeof(expect));
+
+	for (uint8_t i = 0; i < 8; ++i) {
+		uint8_t v = (uint8_t)(0xa0 + i);
+		assert(mcp2221_eeprom_map_write(map, 64 + i, &v, 1) == MCP2221_ERR_OK);
+		expect[64 + i] = v;
+	}
+	// A write spanning two pages touches both.
+	const uint8_t span[4] = {1, 2, 3, 4};
+	assert(mcp2221_eeprom_map_write(map, 126, span, sizeof(span)) == MCP2221_ERR_OK);
+	memcpy(expect + 126, span, sizeof(span));
+
+	// Nothing has reached the device yet, and no page had to be read.
+	assert(writes == 0);
+	assert(reads == 0);
+
+	uint8_t b;
+	assert(mcp2221_eeprom_map_read(map, 66, &b, 1) == MCP2221_ERR_OK);
+	assert(b == 0xa2);
+	assert(reads == 0);
+
+	mcp2221_eeprom_map_stats_t stats;
+	assert(mcp2221_eeprom_map_get_stats(map, &stats) == MCP2221_ERR_OK);
+	assert(stats.dirty_pages == 3);
+	assert(stats.dirty_bytes == 12);
+	assert(stats.write_calls == 9);
+
+	assert(mcp2221_eeprom_map_sync(map) == MCP2221_ERR_OK);
+	assert(writes == 3);
+	assert(memcmp(memory, expect, sizeof(expect)) == 0);
+
+	assert(mcp2221_eeprom_map_get_stats(map, &stats) == MCP2221_ERR_OK);
+	assert(stats.dirty_pages == 0);
+	assert(stats.bytes_written == 12);
+
+	// Reading part of a flushed partial page fetches it from the device.
+	assert(mcp2221_eeprom_map_read(map, 80, &b, 1) == MCP2221_ERR_OK);
+	assert(b == expect[80]);
+	assert(reads == 1);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_gap_in_partial_page_is_filled(void) {
+	reset_device();
+	mcp2221_eeprom_map_t *map = open_map(8, 0);
+	uint8_t expect[EEPROM_SIZE];
+	memcpy(expect, memory, sizeof(expect));
+
+	const uint8_t a[2] = {0x11, 0x22};
+	const uint8_t b[2] = {0x33, 0x44};
+	assert(mcp2221_eeprom_map_write(map, 200, a, 2) == MCP2221_ERR_OK);
+	assert(mcp2221_eeprom_map_write(map, 210, b, 2) == MCP2221_ERR_OK);
+	memcpy(expect + 200, a, 2);
+	memcpy(expect + 210, b, 2);
+	assert(reads == 1);
+
+	assert(mcp2221_eeprom_map_sync(map) == MCP2221_ERR_OK);
+	assert(writes == 1);
+	assert(memcmp(memory, expect, sizeof(expect)) == 0);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_write_cycle_is_ack_polled(void) {
+	reset_device();
+	busy_polls = 3;
+	mcp2221_eeprom_map_t *map = open_map(8, 0);
+	uint8_t page[PAGE_SIZE];
+	memset(page, 0x5a, sizeof(page));
+
+	assert(mcp2221_eeprom_map_write(map, 0, page, sizeof(page)) == MCP2221_ERR_OK);
+	assert(mcp2221_eeprom_map_write(map, PAGE_SIZE, page, sizeof(page)) == MCP2221_ERR_OK);
+	assert(mcp2221_eeprom_map_sync(map) == MCP2221_ERR_OK);
+	assert(writes == 2);
+	assert(busy == 0);
+
+	mcp2221_eeprom_map_stats_t stats;
+	assert(mcp2221_eeprom_map_get_stats(map, &stats) == MCP2221_ERR_OK);
+	// Two write cycles, each answered on the fourth probe.
+	assert(stats.ack_polls == 8);
+
+	// Full-page writes leave valid pages behind.
+	uint8_t b;
+	assert(mcp2221_eeprom_map_read(map, 5, &b, 1) == MCP2221_ERR_OK);
+	assert(b == 0x5a);
+	assert(reads == 0);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_read_waits_for_pending_write(void) {
+	reset_device();
+	busy_polls = 2;
+	mcp2221_eeprom_map_t *map = open_map(1, 0);
+	uint8_t v = 0x99;
+	uint8_t b;
+
+	assert(mcp2221_eeprom_map_write(map, 0, &v, 1) == MCP2221_ERR_OK);
+	// The single cache slot is dirty, so storing this page writes it back.
+	assert(mcp2221_eeprom_map_read(map, 1000, &b, 1) == MCP2221_ERR_OK);
+	assert(writes == 1 && reads == 1);
+	assert(memory[0] == 0x99);
+
+	mcp2221_eeprom_map_stats_t stats;
+	assert(mcp2221_eeprom_map_get_stats(map, &stats) == MCP2221_ERR_OK);
+	assert(stats.dirty_evictions == 1);
+	assert(stats.evictions == 1);
+	assert(stats.ack_polls == 0);
+
+	// The next transaction waits for the write cycle; the stub asserts it.
+	assert(mcp2221_eeprom_map_read(map, 2000, &b, 1) == MCP2221_ERR_OK);
+	assert(reads == 2);
+	assert(mcp2221_eeprom_map_get_stats(map, &stats) == MCP2221_ERR_OK);
+	assert(stats.ack_polls == 3);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_write_cycle_timeout(void) {
+	reset_device();
+	busy_polls = 1 << 30;
+	mcp2221_eeprom_map_t *map = open_map(4, 0);
+	uint8_t v = 1;
+
+	assert(mcp2221_eeprom_map_write(map, 0, &v, 1) == MCP2221_ERR_OK);
+	assert(mcp2221_eeprom_map_sync(map) == MCP2221_ERR_TIMEOUT);
+
+	busy = 0;
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+static void test_destroy_flushes_and_invalidate_keeps_dirty(void) {
+	reset_device();
+	mcp2221_eeprom_map_t *map = open_map(4, 0);
+	uint8_t v = 0x42;
+	uint8_t b;
+
+	assert(mcp2221_eeprom_map_read(map, 300, &b, 1) == MCP2221_ERR_OK);
+	assert(mcp2221_eeprom_map_write(map, 2000, &v, 1) == MCP2221_ERR_OK);
+	memory[300] = 0x17;
+	mcp2221_eeprom_map_invalidate(map);
+
+	assert(mcp2221_eeprom_map_read(map, 300, &b, 1) == MCP2221_ERR_OK);
+	assert(b == 0x17);
+	assert(mcp2221_eeprom_map_read(map, 2000, &b, 1) == MCP2221_ERR_OK);
+	assert(b == 0x42);
+	assert(memory[2000] != 0x42);
+
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+	assert(memory[2000] == 0x42);
+}
+
+static void test_read_error_is_reported(void) {
+	reset_device();
+	mcp2221_eeprom_map_t *map = open_map(4, 0);
+	uint8_t b;
+
+	read_result = MCP2221_ERR_NOT_ACK;
+	assert(mcp2221_eeprom_map_read(map, 0, &b, 1) == MCP2221_ERR_NOT_ACK);
+	read_result = MCP2221_ERR_OK;
+	assert(mcp2221_eeprom_map_read(map, 0, &b, 1) == MCP2221_ERR_OK);
+	assert(b == memory[0]);
+	assert(mcp2221_eeprom_map_destroy(map) == MCP2221_ERR_OK);
+}
+
+int main(void) {
+	test_create_validates_config();
+	test_small_reads_hit_cache();
+	test_sequential_reads_trigger_read_ahead();
+	test_large_read_uses_long_transactions();
+	test_writes_are_coalesced_per_page();
+	test_gap_in_partial_page_is_filled();
+	test_write_cycle_is_ack_polled();
+	test_read_waits_for_pending_write();
+	test_write_cycle_timeout();
+	test_destroy_flushes_and_invalidate_keeps_dirty();
+	test_read_error_is_reported();
+	return 0;
+}
@@ -35,6 +35,7 @@ int main(void) {
         {MCP2221_ERR_USB_CLAIM, "USBClaimError"},
         {MCP2221_ERR_COMMAND_FAILED, "CommandFailedError"},
         {MCP2221_ERR_PROTOCOL, "ProtocolError"},
+        {MCP2221_ERR_PEC, "PECError"},
     };
 
     for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
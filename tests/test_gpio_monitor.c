@@ -0,0 +1,202 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "mcp2221_gpio_monitor.h"
+#include "mcp2221_internal.h"
+#include "mcp2221_internal_gpio.h"
+
+struct mcp2221_device {
+	int unused;
+};
+
+#define SCRIPT_LENGTH 5
+
+/* One GET_GPIO_VALUES response per sample; 0xFF marks a failed command. */
+static const uint8_t script[SCRIPT_LENGTH][4] = {
+	{0, 0, 0xEE, 1},
+	{1, 0, 0xEE, 1},	// GP0 rises
+	{0xFF, 0, 0, 0},	// transport error
+	{1, 0, 0xEE, 0},	// GP3 falls
+	{0, 1, 1, 0},		// GP0 falls, GP1 rises, GP2 becomes GPIO
+};
+
+static int sample_calls;
+static uint64_t first_issued_us;	// issue time of the first sample of a run; later ones are 1 ms apart
+
+mcp2221_error_code_t mcp2221_internal_gpio_read_values(mcp2221_t *dev, uint32_t max_age_us, uint8_t out_values[4],
+						      uint64_t *out_issued_us) {
+	(void)dev;
+	assert(max_age_us == 0);
+
+	int call = __atomic_fetch_add(&sample_calls, 1, __ATOMIC_ACQ_REL);
+	int step = call < SCRIPT_LENGTH ? call : SCRIPT_LENGTH - 1;
+	if (script[step][0] == 0xFF)
+		return MCP2221_ERR_TIMEOUT;
+
+	if (call == 0)
+		first_issued_us = mcp2221_internal_monotonic_ns() / 1000u;
+
+	memcpy(out_values, script[step], 4);
+	if (out_issued_us)
+		*out_issued_us = first_issued_us + 1000u * (uint64_t)call;
+	return MCP2221_ERR_OK;
+}
+
+static void run_until_script_done(mcp2221_gpio_monitor_t *monitor) {
+	__atomic_store_n(&sample_calls, 0, __ATOMIC_RELEASE);
+	assert(mcp2221_gpio_monitor_start(monitor) == MCP2221_ERR_OK);
+
+	struct timespec ts = {0, 1000000L};
+	while (__atomic_load_n(&sample_calls, __ATOMIC_ACQUIRE) < SCRIPT_LENGTH + 2)
+		nanosleep(&ts, NULL);
+	mcp2221_gpio_monitor_stop(monitor);
+}
+
+typedef struct {
+	int calls;
+	uint8_t gpio;
+	uint8_t type;
+} callback_record_t;
+
+static void record_callback(const mcp2221_gpio_monitor_event_t *event, void *user) {
+	callback_record_t *record = user;
+	record->calls++;
+	record->gpio = event->gpio;
+	record->type = event->type;
+}
+
+static void test_create_validates_arguments(void) {
+	struct mcp2221_device dev;
+	mcp2221_gpio_monitor_config_t config = {0, 16, 0};
+	mcp2221_gpio_monitor_t *monitor = NULL;
+
+	assert(mcp2221_gpio_monitor_create(&dev, &config, &monitor) == MCP2221_ERR_INVALID);
+	assert(monitor == NULL);
+	config.period_us = 1000;
+	assert(mcp2221_gpio_monitor_create(NULL, &config, &monitor) == MCP2221_ERR_INVALID);
+	assert(mcp2221_gpio_monitor_create(&dev, &config, &monitor) == MCP2221_ERR_OK);
+
+	assert(mcp2221_gpio_monitor_set_callback(monitor, 4, MCP2221_GPIO_EVENT_RISE, record_callback, NULL) ==
+	       MCP2221_ERR_INVALID);
+	assert(mcp2221_gpio_monitor_set_callback(monitor, 0, MCP2221_GPIO_EVENT_IOC, record_callback, NULL) ==
+	       MCP2221_ERR_INVALID);
+	mcp2221_gpio_monitor_destroy(monitor);
+}
+
+static void test_edges_are_queued_and_dispatched(void) {
+	struct mcp2221_device dev;
+	mcp2221_gpio_monitor_config_t config = {500, 16, MCP2221_GPIO_MONITOR_REALTIME};
+	mcp2221_gpio_monitor_t *monitor = NULL;
+	callback_record_t gp0_rise = {0}, gp1_rise = {0}, gp3_rise = {0};
+
+	assert(mcp2221_gpio_monitor_create(&dev, &config, &monitor) == MCP2221_ERR_OK);
+	assert(mcp2221_gpio_monitor_set_callback(monitor, 0, MCP2221_GPIO_EVENT_RISE, record_callback, &gp0_rise) ==
+	       MCP2221_ERR_OK);
+	assert(mcp2221_gpio_monitor_set_callback(monitor, 1, MCP2221_GPIO_EVENT_RISE, record_callback, &gp1_rise) ==
+	       MCP2221_ERR_OK);
+	assert(mcp2221_gpio_monitor_set_callback(monitor, 3, MCP2221_GPIO_EVENT_RISE, record_callback, &gp3_rise) ==
+	       MCP2221_ERR_OK);
+
+	run_until_script_done(monitor);
+
+	mcp2221_gpio_monitor_event_t events[8];
+	assert(mcp2221_gpio_monitor_drain(monitor, events, 8) == 4);
+	assert(events[0].gpio == 0 && events[0].type == MCP2221_GPIO_EVENT_RISE);
+	assert(events[0].time_ns == first_issued_us * 1000u + 1000000u);
+	assert(events[0].prev_time_ns == first_issued_us * 1000u);
+	assert(events[0].realtime_ns != 0);
+	assert(events[1].gpio == 3 && events[1].type == MCP2221_GPIO_EVENT_FALL);
+	assert(events[1].prev_time_ns == events[0].time_ns);
+	assert(events[2].gpio == 0 && events[2].type == MCP2221_GPIO_EVENT_FALL);
+	assert(events[3].gpio == 1 && events[3].type == MCP2221_GPIO_EVENT_RISE);
+	assert(mcp2221_gpio_monitor_drain(monitor, events, 8) == 0);
+
+	assert(gp0_rise.calls == 1 && gp0_rise.gpio == 0);
+	assert(gp1_rise.calls == 1 && gp1_rise.type == MCP2221_GPIO_EVENT_RISE);
+	assert(gp3_rise.calls == 0);
+
+	mcp2221_gpio_monitor_stats_t stats;
+	assert(mcp2221_gpio_monitor_get_stats(monitor, &stats) == MCP2221_ERR_OK);
+	assert(stats.events == 4);
+	assert(stats.errors == 1);
+	assert(stats.last_error == MCP2221_ERR_TIMEOUT);
+	assert(stats.samples >= SCRIPT_LENGTH + 1);
+	assert(stats.ring_overruns == 0);
+
+	mcp2221_gpio_monitor_destroy(monitor);
+}
+
+static void test_full_ring_counts_overruns(void) {
+	struct mcp2221_device dev;
+	mcp2221_gpio_monitor_config_t config = {500, 1, 0};
+	mcp2221_gpio_monitor_t *monitor = NULL;
+
+	assert(mcp2221_gpio_monitor_create(&dev, &config, &monitor) == MCP2221_ERR_OK);
+	run_until_script_done(monitor);
+
+	mcp2221_gpio_monitor_event_t event;
+	assert(mcp2221_gpio_monitor_drain(monitor, &event, 1) == 1);
+	assert(event.realtime_ns == 0);
+
+	mcp2221_gpio_monitor_stats_t stats;
+	assert(mcp2221_gpio_monitor_get_stats(monitor, &stats) == MCP2221_ERR_OK);
+	assert(stats.events == 4);
+	assert(stats.ring_overruns == 3);
+	mcp2221_gpio_monitor_destroy(monitor);
+}
+
+static void test_callbacks_only_without_ring(void) {
+	struct mcp2221_device dev;
+	mcp2221_gpio_monitor_config_t config = {500, 0, 0};
+	mcp2221_gpio_monitor_t *monitor = NULL;
+	callback_record_t gp0_fall = {0};
+
+	assert(mcp2221_gpio_monitor_create(&dev, &config, &monitor) == MCP2221_ERR_OK);
+	assert(mcp2221_gpio_monitor_set_callback(monitor, 0, MCP2221_GPIO_EVENT_FALL, record_callback, &gp0_fall) ==
+	       MCP2221_ERR_OK);
+	assert(mcp2221_gpio_monitor_start(monitor) == MCP2221_ERR_OK);
+	assert(mcp2221_gpio_monitor_start(monitor) == MCP2221_ERR_BUSY);
+	assert(mcp2221_gpio_monitor_set_callback(monitor, 0, MCP2221_GPIO_EVENT_FALL, NULL, NULL) == MCP2221_ERR_BUSY);
+	mcp2221_gpio_monitor_stop(monitor);
+
+	run_until_script_done(monitor);
+	mcp2221_gpio_monitor_event_t event;
+	assert(mcp2221_gpio_monitor_drain(monitor, &event, 1) == 0);
+	assert(gp0_fall.calls == 1);
+
+	mcp2221_gpio_monitor_stats_t stats;
+	assert(mcp2221_gpio_monitor_get_stats(monitor, &stats) == MCP2221_ERR_OK);
+	assert(stats.ring_overruns == 0);
+	mcp2221_gpio_monitor_destroy(monitor);
+}
+
+static void test_restart_discards_previous_events(void) {
+	struct mcp2221_device dev;
+	// A 1 ms period keeps the scripted issue times from running ahead of the clock.
+	mcp2221_gpio_monitor_config_t config = {1000, 16, 0};
+	mcp2221_gpio_monitor_t *monitor = NULL;
+
+	assert(mcp2221_gpio_monitor_create(&dev, &config, &monitor) == MCP2221_ERR_OK);
+	run_until_script_done(monitor);
+	run_until_script_done(monitor);
+
+	// Only the four edges of the second run are drained.
+	mcp2221_gpio_monitor_event_t events[16];
+	assert(mcp2221_gpio_monitor_drain(monitor, events, 16) == 4);
+	assert(events[0].gpio == 0 && events[0].type == MCP2221_GPIO_EVENT_RISE);
+	assert(events[0].prev_time_ns == first_issued_us * 1000u);
+	mcp2221_gpio_monitor_destroy(monitor);
+}
+
+int main(void) {
+	test_create_validates_arguments();
+	test_edges_are_queued_and_dispatched();
+	test_full_ring_counts_overruns();
+	test_callbacks_only_without_ring();
+	test_restart_discards_previous_events();
+	return 0;
+}
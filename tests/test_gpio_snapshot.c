@@ -0,0 +1,299 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "mcp2221_internal_gpio.h"
+
+#define JOINERS 4
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int calls;
+	int block;	// hold the fetch until released
+	int entered;
+	mcp2221_error_code_t result;
+	uint8_t values[4];
+} fake_device_t;
+
+static void fake_init(fake_device_t *fake) {
+	memset(fake, 0, sizeof(*fake));
+	pthread_mutex_init(&fake->lock, NULL);
+	pthread_cond_init(&fake->cond, NULL);
+	fake->values[0] = 1;
+	fake->values[1] = 0;
+	fake->values[2] = 0xEE;
+	fake->values[3] = 1;
+}
+
+static void fake_free(fake_device_t *fake) {
+	pthread_cond_destroy(&fake->cond);
+	pthread_mutex_destroy(&fake->lock);
+}
+
+static mcp2221_error_code_t fake_fetch(void *ctx, uint8_t values[4]) {
+	fake_device_t *fake = ctx;
+
+	pthread_mutex_lock(&fake->lock);
+	fake->calls++;
+	fake->entered = 1;
+	pthread_cond_broadcast(&fake->cond);
+	while (fake->block)
+		pthread_cond_wait(&fake->cond, &fake->lock);
+	memcpy(values, fake->values, 4);
+	mcp2221_error_code_t err = fake->result;
+	pthread_mutex_unlock(&fake->lock);
+	return err;
+}
+
+static void sleep_ms(long ms) {
+	struct timespec ts = {0, ms * 1000000L};
+	nanosleep(&ts, NULL);
+}
+
+static void test_age_window(void) {
+	mcp2221_internal_gpio_snapshot_t snap;
+	fake_device_t fake;
+	uint8_t values[4];
+	uint64_t first = 0, second = 0;
+
+	mcp2221_internal_gpio_snapshot_init(&snap);
+	fake_init(&fake);
+
+	// An age of 0 always asks the device.
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 0, fake_fetch, &fake, values, &first) == MCP2221_ERR_OK);
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 0, fake_fetch, &fake, values, &second) == MCP2221_ERR_OK);
+	assert(fake.calls == 2);
+	assert(second >= first);
+	assert(memcmp(values, fake.values, 4) == 0);
+
+	// A generous window is served from the stored response.
+	fake.values[0] = 0;
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 1000000, fake_fetch, &fake, values, &first) == MCP2221_ERR_OK);
+	assert(fake.calls == 2);
+	assert(first == second);
+	assert(values[0] == 1);
+
+	// A response older than the window is not.
+	sleep_ms(5);
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 1000, fake_fetch, &fake, values, NULL) == MCP2221_ERR_OK);
+	assert(fake.calls == 3);
+	assert(values[0] == 0);
+
+	mcp2221_gpio_snapshot_stats_t stats;
+	mcp2221_internal_gpio_snapshot_get_stats(&snap, &stats);
+	assert(stats.hits == 1);
+	assert(stats.misses == 3);
+	assert(stats.coalesced == 0);
+
+	mcp2221_internal_gpio_snapshot_reset_stats(&snap);
+	mcp2221_internal_gpio_snapshot_get_stats(&snap, &stats);
+	assert(stats.hits == 0 && stats.misses == 0);
+
+	fake_free(&fake);
+	mcp2221_internal_gpio_snapshot_destroy(&snap);
+}
+
+static void test_invalidate_and_errors(void) {
+	mcp2221_internal_gpio_snapshot_t snap;
+	fake_device_t fake;
+	uint8_t values[4];
+
+	mcp2221_internal_gpio_snapshot_init(&snap);
+	fake_init(&fake);
+
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 1000000, fake_fetch, &fake, values, NULL) == MCP2221_ERR_OK);
+	mcp2221_internal_gpio_snapshot_invalidate(&snap);
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 1000000, fake_fetch, &fake, values, NULL) == MCP2221_ERR_OK);
+	assert(fake.calls == 2);
+
+	// A failed command reports its error and is not stored.
+	mcp2221_internal_gpio_snapshot_invalidate(&snap);
+	fake.result = MCP2221_ERR_TIMEOUT;
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 1000000, fake_fetch, &fake, values, NULL) == MCP2221_ERR_TIMEOUT);
+	fake.result = MCP2221_ERR_OK;
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 1000000, fake_fetch, &fake, values, NULL) == MCP2221_ERR_OK);
+	assert(fake.calls == 4);
+
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 0, NULL, &fake, values, NULL) == MCP2221_ERR_INVALID);
+
+	fake_free(&fake);
+	mcp2221_internal_gpio_snapshot_destroy(&snap);
+}
+
+typedef struct {
+	mcp2221_internal_gpio_snapshot_t *snap;
+	fake_device_t *fake;
+	uint32_t max_age_us;
+	mcp2221_error_code_t err;
+	uint8_t values[4];
+} reader_t;
+
+static void *reader_thread(void *arg) {
+	reader_t *reader = arg;
+	reader->err = mcp2221_internal_gpio_snapshot_acquire(reader->snap, reader->max_age_us, fake_fetch, reader->fake,
+							     reader->values, NULL);
+	return NULL;
+}
+
+static void release_fetch(fake_device_t *fake) {
+	pthread_mutex_lock(&fake->lock);
+	fake->block = 0;
+	pthread_cond_broadcast(&fake->cond);
+	pthread_mutex_unlock(&fake->lock);
+}
+
+static void start_blocked_leader(mcp2221_internal_gpio_snapshot_t *snap, fake_device_t *fake, reader_t *leader, pthread_t *thread) {
+	fake->block = 1;
+	fake->entered = 0;
+	leader->snap = snap;
+	leader->fake = fake;
+	leader->max_age_us = 0;
+	assert(pthread_create(thread, NULL, reader_thread, leader) == 0);
+
+	pthread_mutex_lock(&fake->lock);
+	while (!fake->entered)
+		pthread_cond_wait(&fake->cond, &fake->lock);
+	pthread_mutex_unlock(&fake->lock);
+}
+
+static void test_concurrent_readers_share_one_command(void) {
+	mcp2221_internal_gpio_snapshot_t snap;
+	fake_device_t fake;
+	reader_t leader, joiners[JOINERS];
+	pthread_t leader_thread, threads[JOINERS];
+
+	mcp2221_internal_gpio_snapshot_init(&snap);
+	fake_init(&fake);
+	start_blocked_leader(&snap, &fake, &leader, &leader_thread);
+
+	for (int i = 0; i < JOINERS; i++) {
+		joiners[i].snap = &snap;
+		joiners[i].fake = &fake;
+		joiners[i].max_age_us = 1000000;
+		assert(pthread_create(&threads[i], NULL, reader_thread, &joiners[i]) == 0);
+	}
+	sleep_ms(20);
+	release_fetch(&fake);
+
+	pthread_join(leader_thread, NULL);
+	for (int i = 0; i < JOINERS; i++) {
+		pthread_join(threads[i], NULL);
+		assert(joiners[i].err == MCP2221_ERR_OK);
+		assert(memcmp(joiners[i].values, fake.values, 4) == 0);
+	}
+	assert(leader.err == MCP2221_ERR_OK);
+	assert(fake.calls == 1);
+
+	// Readers that did not get to wait were served from the stored response.
+	mcp2221_gpio_snapshot_stats_t stats;
+	mcp2221_internal_gpio_snapshot_get_stats(&snap, &stats);
+	assert(stats.misses == 1);
+	assert(stats.hits + stats.coalesced == JOINERS);
+
+	fake_free(&fake);
+	mcp2221_internal_gpio_snapshot_destroy(&snap);
+}
+
+static void test_invalidate_during_flight_is_not_stored(void) {
+	mcp2221_internal_gpio_snapshot_t snap;
+	fake_device_t fake;
+	reader_t leader;
+	pthread_t leader_thread;
+	uint8_t values[4];
+
+	mcp2221_internal_gpio_snapshot_init(&snap);
+	fake_init(&fake);
+	start_blocked_leader(&snap, &fake, &leader, &leader_thread);
+
+	mcp2221_internal_gpio_snapshot_invalidate(&snap);
+	release_fetch(&fake);
+	pthread_join(leader_thread, NULL);
+	assert(leader.err == MCP2221_ERR_OK);
+
+	assert(mcp2221_internal_gpio_snapshot_acquire(&snap, 1000000, fake_fetch, &fake, values, NULL) == MCP2221_ERR_OK);
+	assert(fake.calls == 2);
+
+	fake_free(&fake);
+	mcp2221_internal_gpio_snapshot_destroy(&snap);
+}
+
+static void test_invalidate_during_flight_is_not_shared(void) {
+	mcp2221_internal_gpio_snapshot_t snap;
+	fake_device_t fake;
+	reader_t leader, before, after;
+	pthread_t leader_thread, before_thread, after_thread;
+
+	mcp2221_internal_gpio_snapshot_init(&snap);
+	fake_init(&fake);
+	start_blocked_leader(&snap, &fake, &leader, &leader_thread);
+
+	// One reader waits before the invalidation, one arrives after it.
+	before.snap = &snap;
+	before.fake = &fake;
+	before.max_age_us = 1000000;
+	assert(pthread_create(&before_thread, NULL, reader_thread, &before) == 0);
+	sleep_ms(10);
+	mcp2221_internal_gpio_snapshot_invalidate(&snap);
+	after = before;
+	assert(pthread_create(&after_thread, NULL, reader_thread, &after) == 0);
+	sleep_ms(10);
+	release_fetch(&fake);
+
+	pthread_join(leader_thread, NULL);
+	pthread_join(before_thread, NULL);
+	pthread_join(after_thread, NULL);
+	assert(leader.err == MCP2221_ERR_OK);
+	assert(before.err == MCP2221_ERR_OK && after.err == MCP2221_ERR_OK);
+
+	// Neither shares the command issued before the invalidation.
+	assert(fake.calls == 2);
+	mcp2221_gpio_snapshot_stats_t stats;
+	mcp2221_internal_gpio_snapshot_get_stats(&snap, &stats);
+	assert(stats.misses + stats.coalesced + stats.hits == 3);
+	assert(stats.misses == 2);
+
+	fake_free(&fake);
+	mcp2221_internal_gpio_snapshot_destroy(&snap);
+}
+
+static void test_stale_waiter_issues_its_own_command(void) {
+	mcp2221_internal_gpio_snapshot_t snap;
+	fake_device_t fake;
+	reader_t leader, late;
+	pthread_t leader_thread, late_thread;
+
+	mcp2221_internal_gpio_snapshot_init(&snap);
+	fake_init(&fake);
+	start_blocked_leader(&snap, &fake, &leader, &leader_thread);
+
+	// The command in flight is older than this reader accepts.
+	sleep_ms(5);
+	late.snap = &snap;
+	late.fake = &fake;
+	late.max_age_us = 1000;
+	assert(pthread_create(&late_thread, NULL, reader_thread, &late) == 0);
+	sleep_ms(5);
+	release_fetch(&fake);
+
+	pthread_join(leader_thread, NULL);
+	pthread_join(late_thread, NULL);
+	assert(late.err == MCP2221_ERR_OK);
+	assert(fake.calls == 2);
+
+	fake_free(&fake);
+	mcp2221_internal_gpio_snapshot_destroy(&snap);
+}
+
+int main(void) {
+	test_age_window();
+	test_invalidate_and_errors();
+	test_concurrent_readers_share_one_command();
+	test_invalidate_during_flight_is_not_stored();
+	test_invalidate_during_flight_is_not_shared();
+	test_stale_waiter_issues_its_own_command();
+	return 0;
+}
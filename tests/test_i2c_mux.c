@@ -0,0 +1,302 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mcp2221_i2c_slave.h"
+
+struct mcp2221_device {
+	int unused;
+};
+
+#define MUX_ADDR 0x70
+#define MAX_LOG 64
+
+typedef struct {
+	uint8_t addr;
+	uint8_t data;
+	int is_write;
+} bus_op_t;
+
+static bus_op_t ops[MAX_LOG];
+static int op_count;
+static mcp2221_error_code_t mux_write_result;
+static int absent_channel = -1;
+static int mux_channel_state = -1;
+
+static void reset_bus(void) {
+	memset(ops, 0, sizeof(ops));
+	op_count = 0;
+	mux_write_result = MCP2221_ERR_OK;
+	absent_channel = -1;
+	mux_channel_state = -1;
+}
+
+static void log_op(uint8_t addr, uint8_t data, int is_write) {
+	assert(op_count < MAX_LOG);
+	ops[op_count].addr = addr;
+	ops[op_count].data = data;
+	ops[op_count].is_write = is_write;
+	op_count++;
+}
+
+static int count_mux_writes(void) {
+	int n = 0;
+	for (int i = 0; i < op_count; ++i)
+		n += ops[i].addr == MUX_ADDR;
+	return n;
+}
+
+mcp2221_error_code_t mcp2221_i2c_set_speed(mcp2221_t *dev, uint32_t i2c_speed_hz) {
+	(void)dev;
+	(void)i2c_speed_hz;
+	return MCP2221_ERR_OK;
+}
+
+mcp2221_error_code_t mcp2221_i2c_write_ex(mcp2221_t *dev, uint8_t addr, const uint8_t *data, size_t len, mcp2221_i2c_kind_t kind,
+					  int i2c_timeout_ms) {
+	(void)dev;
+	(void)kind;
+	(void)i2c_timeout_ms;
+	assert(len > 0);
+	log_op(addr, data[0], 1);
+
+	if (addr == MUX_ADDR) {
+		assert(len == 1);
+		if (mux_write_result != MCP2221_ERR_OK)
+			return mux_write_result;
+		mux_channel_state = data[0];
+	}
+	return MCP2221_ERR_OK;
+}
+
+/* Reads return the switch control byte, so tests can see which channel was routed. */
+mcp2221_error_code_t mcp2221_i2c_read_ex(mcp2221_t *dev, uint8_t addr, uint8_t *data, size_t len, mcp2221_i2c_kind_t kind,
+					 int i2c_timeout_ms) {
+	(void)dev;
+	(void)kind;
+	(void)i2c_timeout_ms;
+	log_op(addr, 0, 0);
+
+	if (absent_channel >= 0 && mux_channel_state == (1 << absent_channel))
+		return MCP2221_ERR_NOT_ACK;
+	memset(data, mux_channel_state, len);
+	return MCP2221_ERR_OK;
+}
+
+static void test_mux_init_validates_arguments(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_mux_t mux;
+
+	assert(mcp2221_i2c_mux_init(NULL, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 8) == MCP2221_ERR_INVALID);
+	assert(mcp2221_i2c_mux_init(&mux, NULL, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 8) == MCP2221_ERR_INVALID);
+	assert(mux.mcp == NULL);
+	assert(mcp2221_i2c_mux_init(&mux, &dev, 0x80, MCP2221_I2C_MUX_SWITCH, 8) == MCP2221_ERR_INVALID);
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 0) == MCP2221_ERR_INVALID);
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 9) == MCP2221_ERR_INVALID);
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SELECTOR, 5) == MCP2221_ERR_INVALID);
+
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 8) == MCP2221_ERR_OK);
+	assert(mux.selected == MCP2221_I2C_MUX_CHANNEL_UNKNOWN);
+	assert(mcp2221_i2c_mux_select(&mux, 8) == MCP2221_ERR_INVALID);
+	assert(mcp2221_i2c_mux_select(&mux, -1) == MCP2221_ERR_INVALID);
+}
+
+static void test_select_is_cached(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_mux_t mux;
+
+	reset_bus();
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 8) == MCP2221_ERR_OK);
+
+	assert(mcp2221_i2c_mux_select(&mux, 3) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_mux_select(&mux, 3) == MCP2221_ERR_OK);
+	assert(op_count == 1);
+	assert(ops[0].addr == MUX_ADDR && ops[0].data == 0x08);
+	assert(mux.select_writes == 1);
+	assert(mux.select_skips == 1);
+
+	assert(mcp2221_i2c_mux_deselect(&mux) == MCP2221_ERR_OK);
+	assert(ops[1].data == 0x00);
+	assert(mux.selected == MCP2221_I2C_MUX_CHANNEL_NONE);
+
+	mcp2221_i2c_mux_invalidate(&mux);
+	assert(mcp2221_i2c_mux_deselect(&mux) == MCP2221_ERR_OK);
+	assert(op_count == 3);
+}
+
+static void test_selector_encoding(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_mux_t mux;
+
+	reset_bus();
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SELECTOR, 4) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_mux_select(&mux, 2) == MCP2221_ERR_OK);
+	assert(ops[0].data == 0x06);
+	assert(mcp2221_i2c_mux_deselect(&mux) == MCP2221_ERR_OK);
+	assert(ops[1].data == 0x00);
+}
+
+static void test_failed_select_forgets_channel(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_mux_t mux;
+
+	reset_bus();
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 8) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_mux_select(&mux, 1) == MCP2221_ERR_OK);
+
+	mux_write_result = MCP2221_ERR_TIMEOUT;
+	assert(mcp2221_i2c_mux_select(&mux, 2) == MCP2221_ERR_TIMEOUT);
+	assert(mux.selected == MCP2221_I2C_MUX_CHANNEL_UNKNOWN);
+
+	// Channel 1 may no longer be routed, so it must be written again.
+	mux_write_result = MCP2221_ERR_OK;
+	assert(mcp2221_i2c_mux_select(&mux, 1) == MCP2221_ERR_OK);
+	assert(count_mux_writes() == 3);
+}
+
+static void test_muxed_slave_selects_channel(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_mux_t mux;
+	mcp2221_i2c_muxed_slave_t a;
+	mcp2221_i2c_muxed_slave_t b;
+	uint8_t value = 0;
+
+	reset_bus();
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 8) == MCP2221_ERR_OK);
+
+	assert(mcp2221_i2c_slave_init_muxed(&a, &mux, 8, 0x48, 1, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_INVALID);
+	assert(a.slave.mcp == NULL);
+	assert(mcp2221_i2c_slave_init_muxed(&a, &mux, 0, MUX_ADDR, 1, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_INVALID);
+
+	assert(mcp2221_i2c_slave_init_muxed(&a, &mux, 0, 0x48, 1, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_slave_init_muxed(&b, &mux, 5, 0x48, 1, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+	assert(a.slave.mcp == &dev);
+	assert(op_count == 0);
+
+	assert(mcp2221_i2c_muxed_slave_read_register(&a, 0x00, &value, 1, 0, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+	assert(value == 0x01);
+	assert(mcp2221_i2c_muxed_slave_read_register(&a, 0x01, &value, 1, 0, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+	assert(count_mux_writes() == 1);
+
+	assert(mcp2221_i2c_muxed_slave_read(&b, &value, 1) == MCP2221_ERR_OK);
+	assert(value == 0x20);
+	assert(mcp2221_i2c_muxed_slave_write_register(&b, 0x02, &value, 1, 0, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_muxed_slave_write(&a, &value, 1) == MCP2221_ERR_OK);
+	assert(count_mux_writes() == 3);
+	assert(mux.select_skips == 2);
+
+	// The plain helpers leave the route alone.
+	assert(mcp2221_i2c_slave_read(&b.slave, &value, 1) == MCP2221_ERR_OK);
+	assert(value == 0x01);
+	assert(count_mux_writes() == 3);
+
+	// The plain context keeps its 2.0 layout.
+	assert(sizeof(mcp2221_i2c_slave_t) ==
+	       sizeof(struct {
+		       mcp2221_t *mcp;
+		       uint8_t addr;
+		       int reg_bytes;
+		       mcp2221_i2c_byte_order_t reg_byteorder;
+	       }));
+}
+
+static void test_muxed_presence_check(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_mux_t mux;
+	mcp2221_i2c_muxed_slave_t slave;
+
+	reset_bus();
+	absent_channel = 2;
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 4) == MCP2221_ERR_OK);
+
+	assert(mcp2221_i2c_slave_init_muxed(&slave, &mux, 1, 0x48, 0, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_slave_init_muxed(&slave, &mux, 2, 0x48, 0, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_NOT_ACK);
+	assert(slave.slave.mcp == NULL);
+	assert(ops[0].addr == MUX_ADDR && ops[0].data == 0x02);
+	assert(ops[2].addr == MUX_ADDR && ops[2].data == 0x04);
+}
+
+static void test_batch_selects_each_channel_once(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_mux_t mux;
+	mcp2221_i2c_muxed_slave_t on_ch[3];
+	mcp2221_i2c_slave_t direct;
+	mcp2221_i2c_slave_read_t reqs[7];
+	uint8_t buf[7][2];
+
+	reset_bus();
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 8) == MCP2221_ERR_OK);
+	for (int ch = 0; ch < 3; ++ch)
+		assert(mcp2221_i2c_slave_init_muxed(&on_ch[ch], &mux, ch, 0x48, 1, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_slave_init(&direct, &dev, 0x20, 1, 100000, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+
+	// Interleaved channels would cost one select per request without grouping.
+	mcp2221_i2c_muxed_slave_t *order[7] = {&on_ch[2], &on_ch[0], NULL, &on_ch[1], &on_ch[2], &on_ch[0], &on_ch[1]};
+	for (int i = 0; i < 7; ++i) {
+		reqs[i].slave = order[i] ? NULL : &direct;
+		reqs[i].muxed = order[i];
+		reqs[i].reg = (uint32_t)i;
+		reqs[i].buffer = buf[i];
+		reqs[i].length = sizeof(buf[i]);
+		reqs[i].status = MCP2221_ERR_INVALID;
+	}
+
+	assert(mcp2221_i2c_slave_read_register_batch(reqs, 7) == MCP2221_ERR_OK);
+	assert(count_mux_writes() == 3);
+	for (int i = 0; i < 7; ++i) {
+		assert(reqs[i].status == MCP2221_ERR_OK);
+		if (order[i])
+			assert(buf[i][0] == (uint8_t)(1u << order[i]->channel));
+	}
+
+	// Direct targets first, then channels in order; array order within a channel.
+	const uint8_t expected_regs[6] = {1, 5, 3, 6, 0, 4};
+	int reg_writes = 0;
+	for (int i = 0; i < op_count; ++i) {
+		if (ops[i].is_write && ops[i].addr == 0x48) {
+			assert(reg_writes < 6);
+			assert(ops[i].data == expected_regs[reg_writes]);
+			reg_writes++;
+		}
+	}
+	assert(reg_writes == 6);
+	assert(ops[0].addr == 0x20);
+}
+
+static void test_batch_reports_failures(void) {
+	struct mcp2221_device dev;
+	mcp2221_i2c_mux_t mux;
+	mcp2221_i2c_muxed_slave_t ok;
+	mcp2221_i2c_muxed_slave_t missing;
+	mcp2221_i2c_slave_read_t reqs[2];
+	uint8_t buf[2];
+
+	reset_bus();
+	absent_channel = 1;
+	assert(mcp2221_i2c_mux_init(&mux, &dev, MUX_ADDR, MCP2221_I2C_MUX_SWITCH, 2) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_slave_init_muxed(&missing, &mux, 1, 0x48, 1, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+	assert(mcp2221_i2c_slave_init_muxed(&ok, &mux, 0, 0x48, 1, 1, MCP2221_I2C_BYTE_ORDER_DEFAULT) == MCP2221_ERR_OK);
+
+	reqs[0] = (mcp2221_i2c_slave_read_t){.muxed = &missing, .reg = 0, .buffer = &buf[0], .length = 1};
+	reqs[1] = (mcp2221_i2c_slave_read_t){.muxed = &ok, .reg = 0, .buffer = &buf[1], .length = 1};
+
+	assert(mcp2221_i2c_slave_read_register_batch(reqs, 2) == MCP2221_ERR_NOT_ACK);
+	assert(reqs[0].status == MCP2221_ERR_NOT_ACK);
+	assert(reqs[1].status == MCP2221_ERR_OK);
+
+	assert(mcp2221_i2c_slave_read_register_batch(NULL, 2) == MCP2221_ERR_INVALID);
+	assert(mcp2221_i2c_slave_read_register_batch(reqs, 0) == MCP2221_ERR_INVALID);
+}
+
+int main(void) {
+	test_mux_init_validates_arguments();
+	test_select_is_cached();
+	test_selector_encoding();
+	test_failed_select_forgets_channel();
+	test_muxed_slave_selects_channel();
+	test_muxed_presence_check();
+	test_batch_selects_each_channel_once();
+	test_batch_reports_failures();
+	return 0;
+}
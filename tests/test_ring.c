@@ -0,0 +1,89 @@
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcp2221_internal_ring.h"
+
+#define THREADED_COUNT 100000u
+
+static void test_capacity_rounds_up(void) {
+	mcp2221_internal_ring_t ring;
+
+	assert(mcp2221_internal_ring_init(&ring, sizeof(uint32_t), 5) == MCP2221_ERR_OK);
+	assert(mcp2221_internal_ring_capacity(&ring) == 8);
+	mcp2221_internal_ring_free(&ring);
+	assert(mcp2221_internal_ring_capacity(&ring) == 0);
+
+	assert(mcp2221_internal_ring_init(&ring, 0, 4) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_ring_init(&ring, 4, 0) == MCP2221_ERR_INVALID);
+	assert(mcp2221_internal_ring_init(NULL, 4, 4) == MCP2221_ERR_INVALID);
+}
+
+static void test_fifo_full_and_empty(void) {
+	mcp2221_internal_ring_t ring;
+	uint32_t value;
+
+	assert(mcp2221_internal_ring_init(&ring, sizeof(value), 4) == MCP2221_ERR_OK);
+	assert(mcp2221_internal_ring_pop(&ring, &value) == 0);
+
+	for (uint32_t i = 0; i < 4; i++)
+		assert(mcp2221_internal_ring_push(&ring, &i) == 1);
+	value = 99;
+	assert(mcp2221_internal_ring_push(&ring, &value) == 0);
+
+	for (uint32_t i = 0; i < 4; i++) {
+		assert(mcp2221_internal_ring_pop(&ring, &value) == 1);
+		assert(value == i);
+	}
+	assert(mcp2221_internal_ring_pop(&ring, &value) == 0);
+
+	// Wrap around several times.
+	for (uint32_t i = 0; i < 10; i++) {
+		assert(mcp2221_internal_ring_push(&ring, &i) == 1);
+		assert(mcp2221_internal_ring_pop(&ring, &value) == 1);
+		assert(value == i);
+	}
+
+	mcp2221_internal_ring_free(&ring);
+}
+
+static void *producer(void *arg) {
+	mcp2221_internal_ring_t *ring = arg;
+
+	for (uint32_t i = 0; i < THREADED_COUNT; i++) {
+		while (!mcp2221_internal_ring_push(ring, &i))
+			sched_yield();
+	}
+	return NULL;
+}
+
+static void test_single_producer_single_consumer(void) {
+	mcp2221_internal_ring_t ring;
+	pthread_t thread;
+	uint32_t expected = 0;
+	uint32_t value;
+
+	assert(mcp2221_internal_ring_init(&ring, sizeof(value), 64) == MCP2221_ERR_OK);
+	assert(pthread_create(&thread, NULL, producer, &ring) == 0);
+
+	while (expected < THREADED_COUNT) {
+		if (mcp2221_internal_ring_pop(&ring, &value)) {
+			assert(value == expected);
+			expected++;
+		} else {
+			sched_yield();
+		}
+	}
+
+	pthread_join(thread, NULL);
+	mcp2221_internal_ring_free(&ring);
+}
+
+int main(void) {
+	test_capacity_rounds_up();
+	test_fifo_full_and_empty();
+	test_single_producer_single_consumer();
+	return 0;
+}
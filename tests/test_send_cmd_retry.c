@@ -1,26 +1,52 @@
 #include <assert.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <libusb.h>
 
 #include "mcp2221_constants.h"
 #include "mcp2221_internal_constants.h"
 #include "mcp2221_flash.h"
+#include "mcp2221_flash_image.h"
 #include "mcp2221_flash_info.h"
 #include "mcp2221_flash_settings.h"
 #include "mcp2221_gpio_poll.h"
 #include "mcp2221_smbus.h"
 #include "mcp2221_gpio.h"
 #include "mcp2221_pin.h"
+#include "mcp2221_analog.h"
+#include "mcp2221_config_txn.h"
+#include "mcp2221_profile.h"
+#include "mcp2221_sample.h"
+#include "mcp2221_internal_analog.h"
 #include "mcp2221_sram.h"
 #include "mcp2221_usb.h"
 
 static int mock_write_count;
 static int mock_read_count;
 static int mock_sram_read_count;
+static int mock_poll_status_count;
+static const int *mock_gpio_script;
+static int mock_gpio_script_length;
+static int mock_gpio_read_count;
 static int mock_mode;
 static uint8_t mock_last_cmd;
+static uint8_t mock_last_section;
+// MOCK_ECHO_OK: INT/ADC byte of GET_SRAM_SETTINGS responses.
+static uint8_t mock_sram_int_adc;
+static uint8_t mock_sram_set[4][12];
+static int mock_sram_set_count;
+static uint8_t mock_flash_chip_write[MCP2221_PACKET_SIZE];
+static int mock_flash_write_count;
+static int mock_flash_read_count;
+// MOCK_FLASH_MEMORY: READ_FLASH_DATA responses per section, kept current by WRITE_FLASH_DATA.
+static uint8_t mock_flash[5][MCP2221_PACKET_SIZE];
+static uint8_t mock_flash_password[8];
+static int mock_flash_unlocked;
+static uint8_t mock_flash_status;
 
 enum {
 	MOCK_READ_TIMEOUT = 1,
@@ -35,9 +61,38 @@ enum {
 	MOCK_OPEN_INIT_FAILURE,
 	MOCK_OPEN_NOT_FOUND,
 	MOCK_SRAM_TIMEOUT_THEN_OK,
-	MOCK_I2C_SPEED_OK
+	MOCK_I2C_SPEED_OK,
+	MOCK_ECHO_OK,
+	MOCK_IOC_LATCHED_ONCE,
+	MOCK_GPIO_SCRIPT,
+	MOCK_FLASH_MEMORY
 };
 
+static void mock_flash_command(const unsigned char *data) {
+	mock_flash_status = MCP2221_RESPONSE_RESULT_OK;
+	if (data[0] == MCP2221_CMD_SEND_FLASH_ACCESS_PASSWORD) {
+		mock_flash_unlocked = memcmp(&data[1], mock_flash_password, 8) == 0;
+		if (!mock_flash_unlocked)
+			mock_flash_status = 0x03;
+		return;
+	}
+	if (data[0] != MCP2221_CMD_WRITE_FLASH_DATA || data[1] > MCP2221_FLASH_DATA_USB_SERIALNUM)
+		return;
+	if ((mock_flash[0][4] & MCP2221_CDCSEC_CHIPPROT_PROTECTED) && !mock_flash_unlocked) {
+		mock_flash_status = 0x03;
+		return;
+	}
+
+	uint8_t *section = mock_flash[data[1]];
+	if (data[1] >= MCP2221_FLASH_DATA_USB_MANUFACTURER) {
+		memcpy(&section[2], &data[2], MCP2221_PACKET_SIZE - 2);
+	} else {
+		memcpy(&section[4], &data[2], 60);
+		if (data[1] == MCP2221_FLASH_DATA_CHIP_SETTINGS)
+			memcpy(mock_flash_password, &data[2 + MCP2221_FLASH_CHIP_SETTINGS_PWD1], 8);
+	}
+}
+
 int libusb_init(libusb_context **ctx) {
 	if (mock_mode == MOCK_OPEN_INIT_NO_MEMORY) {
 		if (ctx)
@@ -83,6 +138,16 @@ int libusb_interrupt_transfer(libusb_device_handle *dev_handle, unsigned char en
 	if ((endpoint & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_OUT) {
 		mock_write_count++;
 		mock_last_cmd = data[0];
+		mock_last_section = data[1];
+		if (data[0] == MCP2221_CMD_SET_SRAM_SETTINGS && mock_sram_set_count < 4)
+			memcpy(mock_sram_set[mock_sram_set_count++], data, sizeof(mock_sram_set[0]));
+		if (data[0] == MCP2221_CMD_WRITE_FLASH_DATA) {
+			mock_flash_write_count++;
+			if (data[1] == MCP2221_FLASH_DATA_CHIP_SETTINGS)
+				memcpy(mock_flash_chip_write, data, sizeof(mock_flash_chip_write));
+		}
+		if (mock_mode == MOCK_FLASH_MEMORY)
+			mock_flash_command(data);
 		*transferred = length;
 		return 0;
 	}
@@ -91,6 +156,10 @@ int libusb_interrupt_transfer(libusb_device_handle *dev_handle, unsigned char en
 
 	if (mock_last_cmd == MCP2221_CMD_GET_SRAM_SETTINGS)
 		mock_sram_read_count++;
+	if (mock_last_cmd == MCP2221_CMD_POLL_STATUS_SET_PARAMETERS)
+		mock_poll_status_count++;
+	if (mock_last_cmd == MCP2221_CMD_READ_FLASH_DATA)
+		mock_flash_read_count++;
 
 	if (mock_mode == MOCK_READ_TIMEOUT) {
 		*transferred = 0;
@@ -147,6 +216,37 @@ int libusb_interrupt_transfer(libusb_device_handle *dev_handle, unsigned char en
 		return 0;
 	}
 
+	if (mock_mode == MOCK_GPIO_SCRIPT) {
+		data[MCP2221_RESPONSE_ECHO_BYTE] = mock_last_cmd;
+		data[MCP2221_RESPONSE_STATUS_BYTE] = MCP2221_RESPONSE_RESULT_OK;
+		if (mock_last_cmd == MCP2221_CMD_GET_GPIO_VALUES) {
+			int step = mock_gpio_read_count < mock_gpio_script_length ? mock_gpio_read_count
+										     : mock_gpio_script_length - 1;
+			data[MCP2221_GPIO_GET_RESP_GP0_VALUE] = (uint8_t)mock_gpio_script[step];
+			mock_gpio_read_count++;
+		}
+		*transferred = length;
+		return 0;
+	}
+
+	if (mock_mode == MOCK_IOC_LATCHED_ONCE) {
+		data[MCP2221_RESPONSE_ECHO_BYTE] = mock_last_cmd;
+		data[MCP2221_RESPONSE_STATUS_BYTE] = MCP2221_RESPONSE_RESULT_OK;
+		if (mock_last_cmd == MCP2221_CMD_POLL_STATUS_SET_PARAMETERS && mock_poll_status_count == 2)
+			data[MCP2221_I2C_POLL_RESP_INT_FLAG] = 1;
+		*transferred = length;
+		return 0;
+	}
+
+	if (mock_mode == MOCK_FLASH_MEMORY) {
+		if (mock_last_cmd == MCP2221_CMD_READ_FLASH_DATA && mock_last_section < 5)
+			memcpy(data, mock_flash[mock_last_section], MCP2221_PACKET_SIZE);
+		data[MCP2221_RESPONSE_ECHO_BYTE] = mock_last_cmd;
+		data[MCP2221_RESPONSE_STATUS_BYTE] = mock_flash_status;
+		*transferred = length;
+		return 0;
+	}
+
 	if (mock_mode == MOCK_I2C_SPEED_OK) {
 		data[MCP2221_RESPONSE_ECHO_BYTE] = mock_last_cmd;
 		data[MCP2221_RESPONSE_STATUS_BYTE] = MCP2221_RESPONSE_RESULT_OK;
@@ -155,10 +255,13 @@ int libusb_interrupt_transfer(libusb_device_handle *dev_handle, unsigned char en
 		return 0;
 	}
 
+	if (mock_mode == MOCK_ECHO_OK && mock_last_cmd == MCP2221_CMD_GET_SRAM_SETTINGS)
+		data[MCP2221_SRAM_RESPONSE_INT_ADC] = mock_sram_int_adc;
+
 	data[MCP2221_RESPONSE_ECHO_BYTE] =
 		(mock_mode == MOCK_PROTOCOL_ERROR)
 			? MCP2221_CMD_GET_GPIO_VALUES
-			: (mock_mode == MOCK_SRAM_TIMEOUT_THEN_OK)
+			: (mock_mode == MOCK_SRAM_TIMEOUT_THEN_OK || mock_mode == MOCK_ECHO_OK)
 				? mock_last_cmd
 				: MCP2221_CMD_GET_SRAM_SETTINGS;
 	data[MCP2221_RESPONSE_STATUS_BYTE] = MCP2221_RESPONSE_RESULT_OK;
@@ -177,8 +280,19 @@ static void reset_mock(int mode) {
 	mock_write_count = 0;
 	mock_read_count = 0;
 	mock_sram_read_count = 0;
+	mock_poll_status_count = 0;
+	mock_gpio_read_count = 0;
+	mock_sram_set_count = 0;
+	memset(mock_flash_chip_write, 0, sizeof(mock_flash_chip_write));
+	mock_flash_write_count = 0;
+	mock_flash_read_count = 0;
 	mock_mode = mode;
 	mock_last_cmd = 0;
+	mock_sram_int_adc = 0;
+	memset(mock_flash, 0, sizeof(mock_flash));
+	memset(mock_flash_password, 0, sizeof(mock_flash_password));
+	mock_flash_unlocked = 0;
+	mock_flash_status = MCP2221_RESPONSE_RESULT_OK;
 }
 
 static mcp2221_t make_test_device(void) {
@@ -189,6 +303,7 @@ static mcp2221_t make_test_device(void) {
 	dev.ep_in = MCP2221_DEFAULT_EP_IN;
 	dev.usb_read_timeout_ms = 10;
 	dev.cmd_retries = 3;
+	dev.sram_max_age_ms = MCP2221_SRAM_CACHE_FOREVER;
 	return dev;
 }
 
@@ -434,6 +549,156 @@ static void test_flash_read_info_maps_command_failure(void) {
 	assert(mcp2221_flash_read_info(&dev, &info) == MCP2221_ERR_FLASH_READ);
 }
 
+static void test_flash_read_info_caches_string_sections(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_flash_info_t info;
+	uint8_t section[60] = {0};
+
+	reset_mock(MOCK_ECHO_OK);
+
+	assert(mcp2221_flash_read_info(&dev, &info) == MCP2221_ERR_OK);
+	assert(mock_flash_read_count == 6);
+
+	// Only the chip and GP settings are read again.
+	assert(mcp2221_flash_read_info(&dev, &info) == MCP2221_ERR_OK);
+	assert(mock_flash_read_count == 8);
+
+	// Writing a section forgets it; the raw read always asks the device.
+	assert(mcp2221_flash_write(&dev, MCP2221_FLASH_DATA_USB_PRODUCT, section) == MCP2221_ERR_OK);
+	assert(mcp2221_flash_read_info(&dev, &info) == MCP2221_ERR_OK);
+	assert(mock_flash_read_count == 11);
+	assert(mcp2221_flash_read(&dev, MCP2221_FLASH_DATA_CHIP_SERIALNUM, section) == MCP2221_ERR_OK);
+	assert(mock_flash_read_count == 12);
+
+	mcp2221_flash_cache_invalidate(&dev);
+	assert(mcp2221_flash_read_info(&dev, &info) == MCP2221_ERR_OK);
+	assert(mock_flash_read_count == 18);
+}
+
+// Helper: store a USB string descriptor as READ_FLASH_DATA returns it.
+static void mock_flash_store_string(uint8_t section, const char *s) {
+	uint8_t *resp = mock_flash[section];
+	size_t n = strlen(s);
+
+	resp[2] = (uint8_t)(2 * n + 2);
+	resp[3] = 0x03;
+	for (size_t i = 0; i < n; i++) {
+		resp[4 + 2 * i] = (uint8_t)s[i];
+		resp[5 + 2 * i] = 0;
+	}
+}
+
+static void test_flash_read_info_decodes_strings(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_flash_info_t info;
+
+	// The structure length sits at byte 2 of the response, not of the payload.
+	reset_mock(MOCK_FLASH_MEMORY);
+	mock_flash_store_string(MCP2221_FLASH_DATA_USB_MANUFACTURER, "Acme");
+	mock_flash_store_string(MCP2221_FLASH_DATA_USB_PRODUCT, "Widget");
+	mock_flash_store_string(MCP2221_FLASH_DATA_USB_SERIALNUM, "012345678901234567890123456789");
+
+	assert(mcp2221_flash_read_info(&dev, &info) == MCP2221_ERR_OK);
+	assert(strcmp(info.usb_manufacturer_str, "Acme") == 0);
+	assert(strcmp(info.usb_product_str, "Widget") == 0);
+	assert(strcmp(info.usb_serial_str, "012345678901234567890123456789") == 0);
+	assert(info.usb_product[0] == 'W' && info.usb_product[1] == 0);
+
+	// Cached responses decode the same way.
+	assert(mcp2221_flash_read_info(&dev, &info) == MCP2221_ERR_OK);
+	assert(strcmp(info.usb_product_str, "Widget") == 0);
+}
+
+static void test_flash_image_apply_skips_matching_sections(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_flash_image_t image, copy;
+	mcp2221_flash_image_result_t result, many[2];
+	mcp2221_flash_info_t info;
+	unsigned mismatch;
+
+	reset_mock(MOCK_FLASH_MEMORY);
+
+	memset(&image, 0, sizeof(image));
+	image.sections = MCP2221_FLASH_IMAGE_ALL;
+	image.chip_settings[MCP2221_FLASH_CHIP_SETTINGS_CLOCK] = 0x12;
+	image.chip_settings[MCP2221_FLASH_CHIP_SETTINGS_LVID] = 0xD8;
+	image.chip_settings[MCP2221_FLASH_CHIP_SETTINGS_HVID] = 0x04;
+	image.chip_settings[MCP2221_FLASH_CHIP_SETTINGS_USBMA] = 50;
+	image.gp_settings[MCP2221_FLASH_GP_SETTINGS_GP0] = MCP2221_GPIO_DIR_IN;
+	image.gp_settings[MCP2221_FLASH_GP_SETTINGS_GP3] = MCP2221_GPIO_FUNC_ALT_1;
+	strcpy(image.usb_manufacturer, "Acme");
+	strcpy(image.usb_product, "Widget");
+	strcpy(image.usb_serial, "SN-###");
+
+	assert(mcp2221_flash_image_apply(&dev, &image, 7, &result) == MCP2221_ERR_OK);
+	assert(result.error == MCP2221_ERR_OK);
+	assert(result.written == MCP2221_FLASH_IMAGE_ALL && result.skipped == 0);
+	assert(strcmp(result.usb_serial, "SN-007") == 0);
+	assert(mock_flash_write_count == 5);
+	assert(mock_flash[MCP2221_FLASH_DATA_USB_SERIALNUM][2] == 2 * 6 + 2);
+
+	assert(mcp2221_flash_image_verify(&dev, &image, 7, &mismatch) == MCP2221_ERR_OK);
+	assert(mismatch == 0);
+	assert(mcp2221_flash_image_verify(&dev, &image, 8, &mismatch) == MCP2221_ERR_OK);
+	assert(mismatch == MCP2221_FLASH_IMAGE_USB_SERIAL);
+
+	// Applying it again reads every section and programs none.
+	assert(mcp2221_flash_image_apply(&dev, &image, 7, &result) == MCP2221_ERR_OK);
+	assert(result.written == 0 && result.skipped == MCP2221_FLASH_IMAGE_ALL);
+	assert(mock_flash_write_count == 5);
+
+	// Strings decode from the full READ_FLASH_DATA response.
+	assert(mcp2221_flash_read_info(&dev, &info) == MCP2221_ERR_OK);
+	assert(strcmp(info.usb_manufacturer_str, "Acme") == 0);
+	assert(strcmp(info.usb_product_str, "Widget") == 0);
+	assert(strcmp(info.usb_serial_str, "SN-007") == 0);
+
+	assert(mcp2221_flash_image_capture(&dev, &copy) == MCP2221_ERR_OK);
+	assert(copy.sections == MCP2221_FLASH_IMAGE_ALL);
+	assert(memcmp(copy.chip_settings, image.chip_settings, MCP2221_FLASH_CHIP_SETTINGS_USBMA + 1) == 0);
+	assert(strcmp(copy.usb_product, "Widget") == 0 && strcmp(copy.usb_serial, "SN-007") == 0);
+
+	// Enabling protection stores the password; later applies must unlock first.
+	image.sections |= MCP2221_FLASH_IMAGE_PASSWORD;
+	image.chip_settings[MCP2221_FLASH_CHIP_SETTINGS_CDCSEC] = MCP2221_CDCSEC_CHIPPROT_PROTECTED;
+	memcpy(image.password, "line4pwd", 8);
+	assert(mcp2221_flash_image_apply(&dev, &image, 7, &result) == MCP2221_ERR_OK);
+	assert(result.written == MCP2221_FLASH_IMAGE_CHIP_SETTINGS);
+	assert(memcmp(mock_flash_password, "line4pwd", 8) == 0);
+
+	mock_flash_unlocked = 0;
+	assert(mcp2221_flash_image_apply(&dev, &copy, 7, &result) == MCP2221_ERR_FLASH_PASSWD);
+	memcpy(copy.password, "wrongpwd", 8);
+	copy.sections |= MCP2221_FLASH_IMAGE_PASSWORD;
+	assert(mcp2221_flash_image_apply(&dev, &copy, 7, &result) == MCP2221_ERR_FLASH_PASSWD);
+	assert(mcp2221_flash_image_apply(&dev, &image, 7, &result) == MCP2221_ERR_OK);
+	assert(result.written == 0);
+
+	many[0].error = MCP2221_ERR_GENERIC;
+	mcp2221_t *devs[2] = {&dev, &dev};
+	assert(mcp2221_flash_image_apply_many(devs, 1, &image, 7, many) == MCP2221_ERR_OK);
+	assert(many[0].error == MCP2221_ERR_OK && many[0].skipped == MCP2221_FLASH_IMAGE_ALL);
+	assert(mcp2221_flash_image_apply_many(devs, 2, &image, 7, many) == MCP2221_ERR_INVALID);
+
+	char path[] = "/tmp/mcp2221_image_XXXXXX";
+	int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+	assert(mcp2221_flash_image_save(path, &image) == MCP2221_ERR_OK);
+	assert(mcp2221_flash_image_load(path, &copy) == MCP2221_ERR_OK);
+	assert(memcmp(&copy, &image, sizeof(image)) == 0);
+	FILE *f = fopen(path, "r+b");
+	assert(f && fseek(f, 100, SEEK_SET) == 0 && fputc(0x5A, f) != EOF && fclose(f) == 0);
+	assert(mcp2221_flash_image_load(path, &copy) == MCP2221_ERR_INVALID);
+	unlink(path);
+
+	char serial[16];
+	assert(mcp2221_flash_image_expand_serial(&image, 1000, serial, sizeof(serial)) == MCP2221_ERR_INVALID);
+	image.chip_settings[MCP2221_FLASH_CHIP_SETTINGS_CDCSEC] = MCP2221_CDCSEC_CHIPPROT_LOCKED;
+	assert(mcp2221_flash_image_apply(&dev, &image, 7, &result) == MCP2221_ERR_INVALID);
+	assert(mcp2221_flash_image_verify(&dev, &image, 7, &mismatch) == MCP2221_ERR_INVALID);
+}
+
 static void test_flash_save_config_preserves_timeout(void) {
 	mcp2221_t dev = make_test_device();
 
@@ -467,6 +732,52 @@ static void test_flash_save_config_retries_sram_timeout(void) {
 	assert(mock_sram_read_count >= 2);
 }
 
+static void test_flash_save_config_maps_sram_chip_settings(void) {
+	mcp2221_t dev = make_test_device();
+
+	// The chip settings start at byte 4 of the GET_SRAM_SETTINGS response.
+	reset_mock(MOCK_ECHO_OK);
+	mock_sram_int_adc = 0x5A;
+
+	assert(mcp2221_flash_save_config(&dev) == MCP2221_ERR_OK);
+	assert(mock_flash_chip_write[0] == MCP2221_CMD_WRITE_FLASH_DATA);
+	assert(mock_flash_chip_write[MCP2221_FLASH_OFFSET_WRITE + MCP2221_FLASH_CHIP_SETTINGS_INT_ADC] == 0x5A);
+}
+
+static void test_flash_save_config_skips_unchanged_sections(void) {
+	mcp2221_t dev = make_test_device();
+	unsigned written = 0xFF;
+
+	// Mocked flash and SRAM both read as zeros: nothing to write.
+	reset_mock(MOCK_ECHO_OK);
+	assert(mcp2221_flash_save_config_ex(&dev, &written) == MCP2221_ERR_OK);
+	assert(written == 0);
+	assert(mock_flash_write_count == 0);
+
+	// A staged USB attribute changes the chip-settings section only.
+	assert(mcp2221_usb_set_requested_current(&dev, 100) == MCP2221_ERR_OK);
+	assert(mcp2221_flash_save_config_ex(&dev, &written) == MCP2221_ERR_OK);
+	assert(written == MCP2221_FLASH_SAVED_CHIP_SETTINGS);
+	assert(mock_flash_write_count == 1);
+
+	assert(mcp2221_flash_save_config_ex(NULL, &written) == MCP2221_ERR_INVALID);
+	assert(written == 0);
+}
+
+static void test_flash_save_config_ignores_flash_password_bytes(void) {
+	mcp2221_t dev = make_test_device();
+	unsigned written = 0xFF;
+
+	// Flash reads return undefined data in the password bytes of the chip settings.
+	reset_mock(MOCK_FLASH_MEMORY);
+	for (int i = MCP2221_FLASH_CHIP_SETTINGS_PWD1; i <= MCP2221_FLASH_CHIP_SETTINGS_PWD8; i++)
+		mock_flash[MCP2221_FLASH_DATA_CHIP_SETTINGS][MCP2221_FLASH_OFFSET_READ + i] = (uint8_t)(0xA5 ^ i);
+
+	assert(mcp2221_flash_save_config_ex(&dev, &written) == MCP2221_ERR_OK);
+	assert(written == 0);
+	assert(mock_flash_write_count == 0);
+}
+
 static void test_usb_get_remote_wakeup_preserves_timeout(void) {
 	mcp2221_t dev = make_test_device();
 	int enabled = 0;
@@ -635,6 +946,644 @@ static void test_gpio_write_rejects_out_of_contract_values(void) {
 	assert(mock_read_count == 0);
 }
 
+static void test_gpio_write_elision_skips_redundant_writes(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_write_t wr = {
+		.gp0 = 1,
+		.gp1 = MCP2221_GPIO_KEEP,
+		.gp2 = MCP2221_GPIO_KEEP,
+		.gp3 = MCP2221_GPIO_KEEP
+	};
+	mcp2221_gpio_write_stats_t stats;
+
+	reset_mock(MOCK_ECHO_OK);
+	mcp2221_gpio_set_write_elision(&dev, 1);
+
+	// The first write of a pin is always sent, without loading the SRAM cache.
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mock_write_count == 1);
+	assert(mock_sram_read_count == 0);
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mock_write_count == 1);
+
+	wr.gp0 = 0;
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mock_write_count == 2);
+
+	// GP1 has not been written yet.
+	wr.gp1 = 0;
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mock_write_count == 3);
+
+	// Pin configuration changes forget the remembered levels.
+	uint8_t gp[4] = {0};
+	mcp2221_internal_gpio_status_set(&dev, gp);
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mock_write_count == 4);
+
+	assert(mcp2221_gpio_get_write_stats(&dev, &stats) == MCP2221_ERR_OK);
+	assert(stats.commands == 4);
+	assert(stats.elided == 2);
+	assert(mock_sram_read_count == 0);
+}
+
+static void test_gpio_write_without_elision_always_sends(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_write_t wr = {
+		.gp0 = 1,
+		.gp1 = MCP2221_GPIO_KEEP,
+		.gp2 = MCP2221_GPIO_KEEP,
+		.gp3 = MCP2221_GPIO_KEEP
+	};
+
+	reset_mock(MOCK_ECHO_OK);
+
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	// Two GPIO commands plus one SRAM read to load the cache.
+	assert(mock_write_count == 3);
+	assert(mock_sram_read_count == 1);
+}
+
+static void test_gpio_sequence_run_schedules_steps(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_step_t steps[4] = {
+		{{1, MCP2221_GPIO_KEEP, MCP2221_GPIO_KEEP, MCP2221_GPIO_KEEP}, 0},
+		{{0, MCP2221_GPIO_KEEP, MCP2221_GPIO_KEEP, MCP2221_GPIO_KEEP}, 2000},
+		{{1, 1, MCP2221_GPIO_KEEP, MCP2221_GPIO_KEEP}, 2000},
+		{{0, 0, MCP2221_GPIO_KEEP, MCP2221_GPIO_KEEP}, 4000}
+	};
+	uint64_t offsets[4];
+	mcp2221_gpio_sequence_stats_t stats;
+	mcp2221_gpio_write_stats_t write_stats;
+
+	reset_mock(MOCK_ECHO_OK);
+	mcp2221_gpio_set_write_elision(&dev, 1);
+
+	assert(mcp2221_gpio_sequence_run(&dev, steps, 4, offsets, &stats) == MCP2221_ERR_OK);
+	assert(mock_write_count == 4);
+	assert(mock_sram_read_count == 0);
+	assert(stats.steps_sent == 4);
+	// Targets are cumulative: 0, 2, 4 and 8 ms after the start.
+	assert(offsets[1] >= 2000 && offsets[2] >= 4000 && offsets[3] >= 8000);
+	assert(stats.duration_us >= 8000);
+	assert(stats.max_lag_us >= stats.mean_lag_us);
+	assert(stats.jitter_us <= stats.max_lag_us);
+
+	// The accepted levels are remembered for elision.
+	mcp2221_gpio_write_t wr = {0, 0, MCP2221_GPIO_KEEP, MCP2221_GPIO_KEEP};
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mock_write_count == 4);
+	assert(mcp2221_gpio_get_write_stats(&dev, &write_stats) == MCP2221_ERR_OK);
+	assert(write_stats.commands == 4);
+
+	// Invalid steps are rejected before anything is sent.
+	steps[2].write.gp3 = 2;
+	assert(mcp2221_gpio_sequence_run(&dev, steps, 4, NULL, &stats) == MCP2221_ERR_INVALID);
+	assert(stats.steps_sent == 0);
+	assert(mock_write_count == 4);
+	assert(mcp2221_gpio_sequence_run(&dev, NULL, 1, NULL, NULL) == MCP2221_ERR_INVALID);
+	assert(mcp2221_gpio_sequence_run(&dev, NULL, 0, NULL, NULL) == MCP2221_ERR_OK);
+}
+
+static void test_sram_shadow_answers_setting_reads(void) {
+	mcp2221_t dev = make_test_device();
+	double volts[3];
+
+	reset_mock(MOCK_ECHO_OK);
+	assert(mcp2221_analog_set_vdd(&dev, 3.3) == MCP2221_ERR_OK);
+
+	// One read fills the shadow; writes after it need only their SET command.
+	assert(mcp2221_dac_write_volts(&dev, 1.0) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 1);
+	assert(mock_write_count == 2);
+	assert(mcp2221_dac_write_volts(&dev, 2.0) == MCP2221_ERR_OK);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 1);
+	assert(mock_write_count == 4);
+	assert((dev.sram_shadow[MCP2221_SRAM_RESPONSE_DAC] & 0x1F) == (uint8_t)(2.0 / 3.3 * 32));
+
+	// Reference changes are applied to the shadow.
+	int bits;
+	assert(mcp2221_internal_analog_dac_reference_to_bits(MCP2221_ANALOG_VOLTAGE_REF_2_048V, &bits) == MCP2221_ERR_OK);
+	assert(mcp2221_dac_config(&dev, "2.048V") == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 1);
+	assert(((dev.sram_shadow[MCP2221_SRAM_RESPONSE_DAC] >> 5) & 0x07) == bits);
+	mcp2221_sram_config_t cfg;
+	memset(&cfg, 0xFF, sizeof(cfg));	// every field MCP2221_CONFIG_KEEP
+	cfg.dac_val.value = 5;
+	assert(mcp2221_sram_config(&dev, &cfg) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 1);
+	assert((dev.sram_shadow[MCP2221_SRAM_RESPONSE_DAC] & 0x1F) == 5);
+
+	// Interrupt-edge changes are not mirrored and discard the shadow; the
+	// cached ADC and DAC references are not affected.
+	assert(mcp2221_ioc_config(&dev, "rising") == MCP2221_ERR_OK);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mcp2221_dac_write_volts(&dev, 1.0) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 1);
+	assert(mcp2221_sram_config(&dev, &cfg) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 2);
+
+	mcp2221_sram_cache_invalidate(&dev);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 3);
+
+	// An age limit of 0 restores a read per call.
+	mcp2221_sram_cache_set_max_age(&dev, 0);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 5);
+}
+
+static void test_adc_read_volts_uses_cached_reference(void) {
+	mcp2221_t dev = make_test_device();
+	double volts[3];
+
+	// The reference bits sit at bits 2..4 of the INT/ADC byte; bit 0 is not the VRM select.
+	reset_mock(MOCK_ECHO_OK);
+	mock_sram_int_adc = (uint8_t)((MCP2221_ADC_REF_VRM | MCP2221_ADC_VRM_2048) << 2);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mock_write_count == 2);
+	assert(dev.analog.adc_ref == MCP2221_ANALOG_VOLTAGE_REF_2_048V);
+	assert(dev.analog.adc_ref_volts == 2.048);
+
+	// Later reads cost one POLL_STATUS command each.
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mock_write_count == 4);
+	assert(mock_sram_read_count == 1);
+
+	// Configuring the reference updates the cache; VDD needs a configured VDD.
+	assert(mcp2221_adc_config(&dev, "VDD") == MCP2221_ERR_OK);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_INVALID);
+	assert(mcp2221_analog_set_vdd(&dev, 3.3) == MCP2221_ERR_OK);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(dev.analog.adc_ref_volts == 3.3);
+	assert(mock_write_count == 6);
+	assert(mock_sram_read_count == 1);
+
+	// Pin configuration may reset the VRM and forgets the reference.
+	mcp2221_sram_config_t cfg;
+	memset(&cfg, 0xFF, sizeof(cfg));	// every field MCP2221_CONFIG_KEEP
+	cfg.gp[0].function = MCP2221_GPIO_FUNC_GPIO;
+	cfg.gp[0].direction = MCP2221_DIR_INPUT;
+	assert(mcp2221_sram_config(&dev, &cfg) == MCP2221_ERR_OK);
+	int reads = mock_sram_read_count;
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == reads + 1);
+	assert(dev.analog.adc_ref == MCP2221_ANALOG_VOLTAGE_REF_2_048V);
+
+	// So does a reset.
+	uint8_t reset[4] = {MCP2221_CMD_RESET_CHIP, 0xAB, 0xCD, 0xEF};
+	assert(mcp2221_send_cmd(&dev, reset, sizeof(reset), NULL) == MCP2221_ERR_OK);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == reads + 2);
+}
+
+static void test_dac_write_volts_uses_code_table(void) {
+	mcp2221_t dev = make_test_device();
+
+	reset_mock(MOCK_ECHO_OK);
+	assert(mcp2221_analog_set_vdd(&dev, 3.3) == MCP2221_ERR_OK);
+
+	// The reference (VDD) is read once; each write is then one SET command.
+	assert(mcp2221_dac_write_volts(&dev, 1.0) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 1);
+	for (int i = 0; i < 31; i++)
+		assert(mcp2221_dac_write_volts(&dev, 3.3 * i / 32.0) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 1);
+	assert(mock_write_count == 33);
+	assert(dev.analog.dac_tables[MCP2221_ANALOG_VOLTAGE_REF_VDD].valid);
+	assert(mcp2221_dac_write_volts(&dev, 3.3) == MCP2221_ERR_INVALID);
+
+	// The codes match the direct conversion.
+	uint8_t raw;
+	for (int i = 0; i <= 1000; i++) {
+		double volts = 3.3 * (31.0 / 32.0) * i / 1000.0;
+		uint8_t expected;
+		assert(mcp2221_internal_analog_dac_volts_to_raw(volts, 3.3, &expected) == MCP2221_ERR_OK);
+		assert(mcp2221_internal_analog_get_dac_code(&dev, volts, &raw) == MCP2221_ERR_OK);
+		assert(raw == expected);
+	}
+
+	// A new VDD rebuilds the VDD table.
+	assert(mcp2221_analog_set_vdd(&dev, 5.0) == MCP2221_ERR_OK);
+	assert(!dev.analog.dac_tables[MCP2221_ANALOG_VOLTAGE_REF_VDD].valid);
+	assert(mcp2221_dac_write_volts(&dev, 4.0) == MCP2221_ERR_OK);
+	assert((dev.sram_shadow[MCP2221_SRAM_RESPONSE_DAC] & 0x1F) == 25);
+
+	// Configuring the reference updates the cache without a read.
+	assert(mcp2221_dac_config(&dev, "1.024V") == MCP2221_ERR_OK);
+	int reads = mock_sram_read_count;
+	assert(mcp2221_dac_write_volts(&dev, 0.5) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == reads);
+	assert(dev.analog.dac_ref == MCP2221_ANALOG_VOLTAGE_REF_1_024V);
+	assert((dev.sram_shadow[MCP2221_SRAM_RESPONSE_DAC] & 0x1F) == 15);
+	assert(mcp2221_dac_config(&dev, "OFF") == MCP2221_ERR_OK);
+	assert(mcp2221_dac_write_volts(&dev, 0.5) == MCP2221_ERR_INVALID);
+
+	// A reset forgets the reference.
+	uint8_t reset[4] = {MCP2221_CMD_RESET_CHIP, 0xAB, 0xCD, 0xEF};
+	assert(mcp2221_send_cmd(&dev, reset, sizeof(reset), NULL) == MCP2221_ERR_OK);
+	reads = mock_sram_read_count;
+	assert(mcp2221_dac_write_volts(&dev, 1.0) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == reads + 1);
+}
+
+static void test_dac_play_skips_duplicate_codes(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_dac_play_stats_t stats;
+	static const uint8_t codes[] = {1, 1, 2, 2, 3};
+
+	reset_mock(MOCK_ECHO_OK);
+	assert(mcp2221_dac_play(&dev, codes, 5, 200, 2, &stats) == MCP2221_ERR_OK);
+	// At most one command per change of code; a slot missed under scheduling
+	// delay can turn the following duplicate into a send, so only the totals
+	// are fixed.
+	assert(stats.slots_played == 10);
+	assert(stats.commands_sent <= 6);
+	assert(stats.commands_sent + stats.duplicates_skipped + stats.missed_slots == 10);
+	assert(stats.duplicates_skipped + stats.missed_slots >= 4);
+	assert(stats.duration_us >= 50000);
+	assert(stats.achieved_rate_hz > 0.0 && stats.achieved_rate_hz <= 200.0);
+	assert(mock_write_count == (int)stats.commands_sent);
+	assert(mock_sram_read_count == 0);
+	assert(mock_sram_set[0][4] == (MCP2221_ALTER_DAC_VALUE | 1));
+	assert(mock_sram_set[0][7] == MCP2221_PRESERVE_GPIO_CONF);
+	assert(dev.sram_shadow[MCP2221_SRAM_RESPONSE_DAC] == 3);
+
+	uint8_t bad = 32;
+	assert(mcp2221_dac_play(&dev, &bad, 1, 200, 1, &stats) == MCP2221_ERR_INVALID);
+	assert(mcp2221_dac_play(&dev, codes, 5, 0, 1, NULL) == MCP2221_ERR_INVALID);
+	assert(mcp2221_dac_play(&dev, codes, 5, 200, 0, NULL) == MCP2221_ERR_INVALID);
+	assert(mcp2221_dac_play(&dev, NULL, 5, 200, 1, NULL) == MCP2221_ERR_INVALID);
+
+	// A failing command stops playback.
+	reset_mock(MOCK_READ_TIMEOUT);
+	assert(mcp2221_dac_play(&dev, codes, 5, 200, 1, &stats) == MCP2221_ERR_TIMEOUT);
+	assert(stats.commands_sent == 0);
+	assert(mock_write_count == 1);
+}
+
+static void test_dac_wave_builders(void) {
+	uint8_t wave[32];
+	assert(mcp2221_dac_wave_ramp(wave, 32, 0, 31) == MCP2221_ERR_OK);
+	for (int i = 0; i < 32; i++)
+		assert(wave[i] == i);
+	assert(mcp2221_dac_wave_ramp(wave, 3, 31, 0) == MCP2221_ERR_OK);
+	assert(wave[0] == 31 && wave[1] == 16 && wave[2] == 0);
+	assert(mcp2221_dac_wave_sine(wave, 4, 0, 30) == MCP2221_ERR_OK);
+	assert(wave[0] == 15 && wave[1] == 30 && wave[2] == 15 && wave[3] == 0);
+	assert(mcp2221_dac_wave_sine(wave, 32, 0, 31) == MCP2221_ERR_OK);
+	for (int i = 1; i < 8; i++)
+		assert(wave[i] >= wave[i - 1] && wave[16 + i] <= wave[16 + i - 1]);
+	assert(mcp2221_dac_wave_sine(wave, 4, 20, 10) == MCP2221_ERR_INVALID);
+	assert(mcp2221_dac_wave_ramp(wave, 0, 0, 31) == MCP2221_ERR_INVALID);
+
+	static const double volts[] = {0.0, 1.0, 2.0};
+	reset_mock(MOCK_ECHO_OK);
+	mcp2221_t dev = make_test_device();
+	assert(mcp2221_analog_set_vdd(&dev, 3.2) == MCP2221_ERR_OK);
+	assert(mcp2221_dac_wave_from_volts(&dev, volts, 3, wave) == MCP2221_ERR_OK);
+	assert(wave[0] == 0 && wave[1] == 10 && wave[2] == 20);
+	assert(mock_sram_read_count == 1);
+}
+
+static void test_sample_all_uses_two_commands(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_sample_t sample;
+
+	reset_mock(MOCK_ECHO_OK);
+
+	// The ADC reference (VDD) is read once; VDD itself is not known yet.
+	assert(mcp2221_sample_all(&dev, &sample) == MCP2221_ERR_OK);
+	assert(mock_write_count == 3);
+	assert(mock_sram_read_count == 1);
+	assert(mock_poll_status_count == 1);
+	assert(sample.gpio_valid_mask == 0x0F);
+	assert(sample.adc_volts_valid == 0);
+	assert(sample.timestamp_us != 0);
+
+	assert(mcp2221_analog_set_vdd(&dev, 3.3) == MCP2221_ERR_OK);
+	assert(mcp2221_sample_all(&dev, &sample) == MCP2221_ERR_OK);
+	assert(mock_write_count == 5);
+	assert(mock_sram_read_count == 1);
+	assert(mock_poll_status_count == 2);
+	assert(sample.adc_volts_valid == 1);
+	assert(sample.adc_volts[0] == 0.0);
+
+	// Configuring the reference through the library keeps it known.
+	assert(mcp2221_adc_config(&dev, "2.048V") == MCP2221_ERR_OK);
+	assert(mcp2221_sample_all(&dev, &sample) == MCP2221_ERR_OK);
+	assert(mock_write_count == 8);
+	assert(mock_sram_read_count == 1);
+
+	// A reset forgets it.
+	uint8_t reset[4] = {MCP2221_CMD_RESET_CHIP, 0xAB, 0xCD, 0xEF};
+	assert(mcp2221_send_cmd(&dev, reset, sizeof(reset), NULL) == MCP2221_ERR_OK);
+	assert(mcp2221_sample_all(&dev, &sample) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 2);
+
+	assert(mcp2221_sample_all(&dev, NULL) == MCP2221_ERR_INVALID);
+}
+
+static void test_config_txn_sends_only_differences(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_config_txn_t txn;
+	int commands = -1;
+
+	reset_mock(MOCK_ECHO_OK);
+
+	// The mocked SRAM reads as all zeros: VDD references, GPIO outputs low.
+	assert(mcp2221_config_txn_init(&txn) == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_set_pin(&txn, MCP2221_GPIO_PIN_GP0, MCP2221_PIN_FUNC_GPIO_OUT, 0) == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_set_adc(&txn, "VDD") == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_set_clock(&txn, 0, "24MHz") == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_commit(&dev, &txn, &commands) == MCP2221_ERR_OK);
+	assert(commands == 1);
+	assert(mock_sram_read_count == 1);
+	assert(mock_sram_set[0][2] == (MCP2221_ALTER_CLK_OUTPUT | MCP2221_CLK_DUTY_0 | MCP2221_CLK_FREQ_24MHz));
+	assert(mock_sram_set[0][3] == 0 && mock_sram_set[0][4] == 0 && mock_sram_set[0][5] == 0);
+	assert(mock_sram_set[0][6] == MCP2221_PRESERVE_INT_CONF);
+	assert(mock_sram_set[0][7] == MCP2221_PRESERVE_GPIO_CONF);
+
+	// Committing it again finds nothing to do.
+	assert(mcp2221_config_txn_commit(&dev, &txn, &commands) == MCP2221_ERR_OK);
+	assert(commands == 0);
+	assert(mock_sram_set_count == 1);
+	assert(mock_sram_read_count == 1);
+
+	// A pin change, VRM references and an edge change fit in two commands.
+	int dac_bits, adc_bits;
+	assert(mcp2221_internal_analog_dac_reference_to_bits(MCP2221_ANALOG_VOLTAGE_REF_2_048V, &dac_bits) == MCP2221_ERR_OK);
+	assert(mcp2221_internal_analog_adc_reference_to_bits(MCP2221_ANALOG_VOLTAGE_REF_4_096V, &adc_bits) == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_init(&txn) == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_set_pin(&txn, MCP2221_GPIO_PIN_GP2, MCP2221_PIN_FUNC_ALT1, 0) == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_set_dac(&txn, "2.048V", 10) == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_set_adc(&txn, "4.096V") == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_set_ioc(&txn, "rising") == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_commit(&dev, &txn, &commands) == MCP2221_ERR_OK);
+	assert(commands == 2);
+	assert(mock_sram_set[1][3] == (MCP2221_ALTER_DAC_REF | MCP2221_DAC_REF_VRM | MCP2221_DAC_VRM_OFF));
+	assert(mock_sram_set[1][4] == MCP2221_ALTER_DAC_VALUE);
+	assert(mock_sram_set[1][5] == (MCP2221_ALTER_ADC_REF | MCP2221_ADC_REF_VRM | MCP2221_ADC_VRM_OFF));
+	assert(mock_sram_set[1][6] == (MCP2221_ALTER_INT_CONF | MCP2221_INT_POS_EDGE_ENABLE));
+	assert(mock_sram_set[1][7] == MCP2221_ALTER_GPIO_CONF);
+	assert(mock_sram_set[1][10] == MCP2221_GPIO_FUNC_ALT_1);
+	assert(mock_sram_set[2][2] == MCP2221_PRESERVE_CLK_OUTPUT);
+	assert(mock_sram_set[2][3] == (MCP2221_ALTER_DAC_REF | dac_bits));
+	assert(mock_sram_set[2][4] == (MCP2221_ALTER_DAC_VALUE | 10));
+	assert(mock_sram_set[2][5] == (MCP2221_ALTER_ADC_REF | adc_bits));
+	assert(mock_sram_set[2][6] == MCP2221_PRESERVE_INT_CONF);
+	assert(mock_sram_set[2][7] == MCP2221_PRESERVE_GPIO_CONF);
+
+	// Clearing the interrupt flag is an action and is always sent.
+	assert(mcp2221_config_txn_init(&txn) == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_clear_ioc(&txn) == MCP2221_ERR_OK);
+	assert(mcp2221_config_txn_commit(&dev, &txn, NULL) == MCP2221_ERR_OK);
+	assert(mock_sram_set_count == 4);
+	assert(mock_sram_set[3][6] == (MCP2221_ALTER_INT_CONF | MCP2221_INT_FLAG_CLEAR));
+
+	assert(mcp2221_config_txn_set_pin(&txn, MCP2221_GPIO_PIN_GP0, MCP2221_PIN_FUNC_KEEP, 0) == MCP2221_ERR_INVALID);
+	assert(mcp2221_config_txn_set_pin(&txn, MCP2221_GPIO_PIN_GP0, MCP2221_PIN_FUNC_ALT0, 1) == MCP2221_ERR_INVALID);
+	assert(mcp2221_config_txn_set_dac(&txn, NULL, 32) == MCP2221_ERR_INVALID);
+	assert(mcp2221_config_txn_set_clock(&txn, 33, "24MHz") == MCP2221_ERR_INVALID);
+	assert(mcp2221_config_txn_set_ioc(&txn, "sideways") == MCP2221_ERR_INVALID);
+	assert(mcp2221_config_txn_commit(NULL, &txn, &commands) == MCP2221_ERR_INVALID);
+	assert(commands == 0);
+}
+
+static void test_profile_apply_is_idempotent(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_profile_t profile, loaded;
+	mcp2221_profile_result_t result;
+	int line = -1;
+
+	const char *text = "# bench fixture\n"
+			   "[pins]\n"
+			   "gp0 = gpio_out\n"
+			   "[analog]\n"
+			   "adc_ref = vdd\n"
+			   "dac_value = 16\n"
+			   "[clock]\n"
+			   "duty = 50 ; half\n"
+			   "freq = 12MHz\n"
+			   "[i2c]\n"
+			   "speed_hz = 400000\n";
+	assert(mcp2221_profile_parse(text, &profile, &line) == MCP2221_ERR_OK);
+	assert(line == 0);
+	assert(profile.gp[0] == MCP2221_PIN_FUNC_GPIO_OUT && profile.gp[1] == MCP2221_PIN_FUNC_KEEP);
+	assert(profile.adc_ref == MCP2221_PROFILE_REF_VDD && profile.dac_ref == MCP2221_PROFILE_REF_KEEP);
+	assert(profile.dac_value == 16);
+	assert(profile.clock_duty_percent == 50 && profile.clock_hz == 12000000u);
+	assert(profile.i2c_speed_hz == 400000u);
+	assert(profile.usb_requested_current_ma == -1);
+
+	assert(mcp2221_profile_parse("[pins]\ngp4 = alt0\n", &loaded, &line) == MCP2221_ERR_INVALID);
+	assert(line == 2);
+	assert(mcp2221_profile_parse("[clock]\nfreq = 13MHz\n", &loaded, &line) == MCP2221_ERR_INVALID);
+	assert(line == 2);
+
+	// The mocked SRAM reads as all zeros, so only the DAC code and clock differ.
+	reset_mock(MOCK_I2C_SPEED_OK);
+	assert(mcp2221_profile_apply(&dev, &profile, 0, &result) == MCP2221_ERR_OK);
+	assert(result.sram_commands == 1);
+	assert(result.i2c_speed_changed == 1);
+	assert(result.usb_changed == 0 && result.persisted == 0);
+	assert(mock_sram_set[0][2] == (MCP2221_ALTER_CLK_OUTPUT | MCP2221_CLK_DUTY_50 | MCP2221_CLK_FREQ_12MHz));
+	assert(mock_sram_set[0][4] == (MCP2221_ALTER_DAC_VALUE | 16));
+	assert(mock_sram_set[0][7] == MCP2221_PRESERVE_GPIO_CONF);
+
+	assert(mcp2221_profile_apply(&dev, &profile, 0, &result) == MCP2221_ERR_OK);
+	assert(result.sram_commands == 0);
+	assert(mock_sram_set_count == 1);
+
+	// USB attributes are staged against flash; PERSIST saves the result.
+	reset_mock(MOCK_ECHO_OK);
+	profile.i2c_speed_hz = 0;
+	profile.usb_requested_current_ma = 100;
+	assert(mcp2221_profile_apply(&dev, &profile, MCP2221_PROFILE_PERSIST, &result) == MCP2221_ERR_OK);
+	assert(result.sram_commands == 0);
+	assert(result.usb_changed == 1 && result.persisted == 1);
+
+	assert(mcp2221_profile_capture(&dev, &loaded) == MCP2221_ERR_OK);
+	assert(loaded.gp[0] == MCP2221_PIN_FUNC_GPIO_OUT && loaded.gp_out[0] == 0);
+	assert(loaded.dac_ref == MCP2221_PROFILE_REF_VDD && loaded.dac_value == 16);
+	assert(loaded.clock_duty_percent == 50 && loaded.clock_hz == 12000000u);
+	assert(loaded.ioc_edge == MCP2221_PROFILE_IOC_NONE);
+
+	char path[] = "/tmp/mcp2221_profile_XXXXXX";
+	int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+	assert(mcp2221_profile_save(path, &profile) == MCP2221_ERR_OK);
+	assert(mcp2221_profile_load(path, &loaded, &line) == MCP2221_ERR_OK);
+	assert(memcmp(&loaded, &profile, sizeof(profile)) == 0);
+	unlink(path);
+	assert(mcp2221_profile_load(path, &loaded, &line) == MCP2221_ERR_NOT_FOUND);
+
+	profile.clock_hz = 0;
+	assert(mcp2221_profile_apply(&dev, &profile, 0, &result) == MCP2221_ERR_INVALID);
+	assert(mcp2221_profile_apply(&dev, &profile, 0x80, NULL) == MCP2221_ERR_INVALID);
+}
+
+static void test_gpio_wait_events_backs_off_when_idle(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_poll_state_t state;
+	mcp2221_gpio_event_t events[4];
+
+	reset_mock(MOCK_ECHO_OK);
+	mcp2221_gpio_poll_init(&state);
+
+	assert(mcp2221_gpio_wait_events(&dev, &state, events, 4, 40) == 0);
+	// Polls at 0, 1, 3, 7, 15 and 31 ms instead of forty times.
+	assert(mock_write_count >= 3);
+	assert(mock_write_count <= 10);
+	assert(state.wait_interval_ms == MCP2221_GPIO_WAIT_MAX_INTERVAL_MS);
+
+	assert(mcp2221_gpio_poll_set_wait_interval(&state, 0, 4) == MCP2221_ERR_INVALID);
+	assert(mcp2221_gpio_poll_set_wait_interval(&state, 5, 4) == MCP2221_ERR_INVALID);
+	assert(mcp2221_gpio_wait_events(&dev, NULL, events, 4, 0) == MCP2221_ERR_INVALID);
+}
+
+static void test_gpio_wait_events_reports_ioc_latch(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_poll_state_t state;
+	mcp2221_gpio_event_t events[4];
+
+	reset_mock(MOCK_IOC_LATCHED_ONCE);
+	mcp2221_gpio_poll_init(&state);
+	mcp2221_gpio_poll_set_ioc_latch(&state, 1);
+
+	assert(mcp2221_gpio_wait_events(&dev, &state, events, 4, 1000) == 1);
+	assert(events[0].type == MCP2221_GPIO_EVENT_IOC);
+	assert(events[0].gpio == 1);
+	assert(strcmp(events[0].id, "IOC") == 0);
+	assert(mock_poll_status_count == 2);
+	assert(state.wait_interval_ms == MCP2221_GPIO_WAIT_MIN_INTERVAL_MS);
+
+	// IOC events can be filtered out like edges.
+	mcp2221_gpio_poll_set_filter_mask(&state, MCP2221_GPIO_POLL_MASK_RISE(0));
+	reset_mock(MOCK_IOC_LATCHED_ONCE);
+	assert(mcp2221_gpio_wait_events(&dev, &state, events, 4, 10) == 0);
+}
+
+static void test_gpio_wait_events_ioc_latch_keeps_idle_cost(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_poll_state_t state;
+	mcp2221_gpio_event_t events[4];
+	int plain_writes;
+
+	reset_mock(MOCK_ECHO_OK);
+	mcp2221_gpio_poll_init(&state);
+	mcp2221_gpio_poll_set_filter_mask(&state, MCP2221_GPIO_POLL_MASK_IOC);
+	for (int i = 0; i < 5; i++)
+		assert(mcp2221_gpio_wait_events(&dev, &state, events, 4, 0) == 0);
+	plain_writes = mock_write_count;
+	assert(plain_writes == 5);
+
+	// The clear flag stands in for the GPIO read of the GP1-only filter.
+	reset_mock(MOCK_ECHO_OK);
+	mcp2221_gpio_poll_init(&state);
+	mcp2221_gpio_poll_set_filter_mask(&state, MCP2221_GPIO_POLL_MASK_IOC);
+	mcp2221_gpio_poll_set_ioc_latch(&state, 1);
+	for (int i = 0; i < 5; i++)
+		assert(mcp2221_gpio_wait_events(&dev, &state, events, 4, 0) == 0);
+	assert(mock_write_count == plain_writes);
+	assert(mock_poll_status_count == 5);
+
+	// Other pins still need their levels read after the flag check.
+	reset_mock(MOCK_ECHO_OK);
+	mcp2221_gpio_poll_set_filter_mask(&state, MCP2221_GPIO_POLL_MASK_RISE(0) | MCP2221_GPIO_POLL_MASK_IOC);
+	assert(mcp2221_gpio_wait_events(&dev, &state, events, 4, 0) == 0);
+	assert(mock_write_count == 2);
+}
+
+static void test_gpio_poll_counts_edges(void) {
+	static const int levels[] = {0, 1, 0, 1, 0, 1};
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_poll_state_t state;
+	mcp2221_gpio_change_t changes[4];
+	mcp2221_gpio_pin_stats_t stats;
+
+	reset_mock(MOCK_GPIO_SCRIPT);
+	mock_gpio_script = levels;
+	mock_gpio_script_length = 6;
+	mcp2221_gpio_poll_init(&state);
+
+	for (int i = 0; i < 6; i++) {
+		assert(mcp2221_gpio_poll(&dev, &state, changes) == MCP2221_ERR_OK);
+		assert(changes[0].changed == (i > 0));
+	}
+	assert(mcp2221_gpio_poll_get_pin_stats(&state, 0, &stats) == MCP2221_ERR_OK);
+	assert(stats.rises == 3);
+	assert(stats.falls == 2);
+	assert(stats.last_edge_us == state.last_sample_us);
+
+	// Pins that stay low have no edges.
+	assert(mcp2221_gpio_poll_get_pin_stats(&state, 1, &stats) == MCP2221_ERR_OK);
+	assert(stats.rises == 0 && stats.falls == 0 && stats.frequency_hz == 0.0);
+
+	mcp2221_gpio_poll_reset_counters(&state);
+	assert(mcp2221_gpio_poll_get_pin_stats(&state, 0, &stats) == MCP2221_ERR_OK);
+	assert(stats.rises == 0 && stats.period_us == 0.0);
+	assert(mcp2221_gpio_poll_get_pin_stats(&state, 4, &stats) == MCP2221_ERR_INVALID);
+}
+
+static void test_gpio_poll_debounce_rejects_glitches(void) {
+	static const int levels[] = {0, 1, 0, 1, 1, 0, 0};
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_poll_state_t state;
+	mcp2221_gpio_event_t events[4];
+	mcp2221_gpio_pin_stats_t stats;
+	int counts[7];
+
+	reset_mock(MOCK_GPIO_SCRIPT);
+	mock_gpio_script = levels;
+	mock_gpio_script_length = 7;
+	mcp2221_gpio_poll_init(&state);
+	assert(mcp2221_gpio_poll_set_debounce(&state, 0, 2, 0) == MCP2221_ERR_OK);
+	assert(mcp2221_gpio_poll_set_debounce(&state, 4, 2, 0) == MCP2221_ERR_INVALID);
+
+	for (int i = 0; i < 7; i++)
+		counts[i] = mcp2221_gpio_poll_events(&dev, &state, NULL, events, 4);
+
+	// The one-sample pulse is dropped; the rise and fall each need two samples.
+	assert(counts[1] == 0 && counts[2] == 0 && counts[3] == 0);
+	assert(counts[4] == 1);
+	assert(counts[5] == 0);
+	assert(counts[6] == 1);
+	assert(events[0].type == MCP2221_GPIO_EVENT_FALL);
+
+	assert(mcp2221_gpio_poll_get_pin_stats(&state, 0, &stats) == MCP2221_ERR_OK);
+	assert(stats.rises == 1);
+	assert(stats.falls == 1);
+	assert(stats.last_edge_us < state.last_sample_us);
+}
+
+static void test_gpio_poll_frequency_estimate(void) {
+	mcp2221_gpio_poll_state_t state;
+	mcp2221_gpio_pin_stats_t stats;
+
+	mcp2221_gpio_poll_init(&state);
+	state.pins[2].rises = 5;
+	state.pins[2].period_us = 1000.0;
+	state.pins[2].last_rise_us = 50000;
+
+	state.last_sample_us = 50500;
+	assert(mcp2221_gpio_poll_get_pin_stats(&state, 2, &stats) == MCP2221_ERR_OK);
+	assert(stats.period_us == 1000.0);
+	assert(stats.frequency_hz == 1000.0);
+
+	// No rise for 4 ms: the signal is at most 250 Hz now.
+	state.last_sample_us = 54000;
+	assert(mcp2221_gpio_poll_get_pin_stats(&state, 2, &stats) == MCP2221_ERR_OK);
+	assert(stats.period_us == 4000.0);
+	assert(stats.frequency_hz == 250.0);
+}
+
 static void test_pin_functions_rejects_non_boolean_outputs(void) {
 	mcp2221_t dev = make_test_device();
 	mcp2221_pin_functions_t cfg = {
@@ -698,6 +1647,29 @@ static void assert_sram_invalid_without_usb(
 	assert(mock_read_count == 0);
 }
 
+static void test_gpio_write_elision_keeps_levels_for_sram_config(void) {
+	mcp2221_t dev = make_test_device();
+	mcp2221_gpio_write_t wr = {
+		.gp0 = 1,
+		.gp1 = MCP2221_GPIO_KEEP,
+		.gp2 = MCP2221_GPIO_KEEP,
+		.gp3 = MCP2221_GPIO_KEEP
+	};
+	mcp2221_sram_config_t cfg = make_keep_sram_config();
+
+	reset_mock(MOCK_ECHO_OK);
+	mcp2221_gpio_set_write_elision(&dev, 1);
+	assert(mcp2221_gpio_write(&dev, &wr) == MCP2221_ERR_OK);
+	assert(mock_sram_read_count == 0);
+
+	// The SRAM readback shows GP0 low; the written level must be pushed back.
+	cfg.gp[1].value = 0;
+	assert(mcp2221_sram_config(&dev, &cfg) == MCP2221_ERR_OK);
+	assert(mock_sram_set_count == 1);
+	assert(mock_sram_set[0][8] & MCP2221_GPIO_OUT_VAL_1);
+	assert(!(mock_sram_set[0][9] & MCP2221_GPIO_OUT_VAL_1));
+}
+
 static void test_sram_rejects_invalid_gpio_fields(void) {
 	mcp2221_t dev = make_test_device();
 	mcp2221_sram_config_t cfg = make_keep_sram_config();
@@ -786,6 +1758,25 @@ static void test_sram_rejects_invalid_clock_fields(void) {
 	assert_sram_invalid_without_usb(&dev, &cfg);
 }
 
+static void test_adc_read_volts_decodes_reference_bits(void) {
+	mcp2221_t dev = make_test_device();
+	double volts[3];
+
+	// Send GET_SRAM_SETTINGS on every call, so each read sees the mocked byte.
+	mcp2221_sram_cache_set_max_age(&dev, 0);
+
+	// The reference bits sit at bits 2..4 of the INT/ADC byte; bit 0 is not the VRM select.
+	reset_mock(MOCK_ECHO_OK);
+	mock_sram_int_adc = (uint8_t)((MCP2221_ADC_REF_VRM | MCP2221_ADC_VRM_1024) << 2);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+
+	// VDD needs a configured supply voltage.
+	mock_sram_int_adc = (uint8_t)(MCP2221_ADC_REF_VDD << 2) | MCP2221_ADC_REF_VRM;
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_INVALID);
+	assert(mcp2221_analog_set_vdd(&dev, 3.3) == MCP2221_ERR_OK);
+	assert(mcp2221_adc_read_volts(&dev, volts) == MCP2221_ERR_OK);
+}
+
 static void test_open_rejects_null_output_pointer(void) {
 	reset_mock(0);
 
@@ -955,10 +1946,16 @@ int main(void) {
 	test_flash_read_info_preserves_timeout();
 	test_flash_read_info_preserves_protocol_error();
 	test_flash_read_info_maps_command_failure();
+	test_flash_read_info_caches_string_sections();
+	test_flash_read_info_decodes_strings();
+	test_flash_image_apply_skips_matching_sections();
 	test_flash_save_config_preserves_timeout();
 	test_flash_save_config_preserves_protocol_error();
 	test_flash_save_config_maps_command_failure();
 	test_flash_save_config_retries_sram_timeout();
+	test_flash_save_config_maps_sram_chip_settings();
+	test_flash_save_config_skips_unchanged_sections();
+	test_flash_save_config_ignores_flash_password_bytes();
 	test_usb_get_remote_wakeup_preserves_timeout();
 	test_usb_get_self_powered_preserves_protocol_error();
 	test_usb_get_requested_current_maps_flash_command_failure();
@@ -967,12 +1964,31 @@ int main(void) {
 	test_gpio_poll_rejects_null_arguments();
 	test_smbus_rejects_invalid_context_and_pointers();
 	test_gpio_write_rejects_out_of_contract_values();
+	test_gpio_write_elision_skips_redundant_writes();
+	test_gpio_write_elision_keeps_levels_for_sram_config();
+	test_gpio_write_without_elision_always_sends();
+	test_gpio_sequence_run_schedules_steps();
+	test_sram_shadow_answers_setting_reads();
+	test_adc_read_volts_uses_cached_reference();
+	test_dac_write_volts_uses_code_table();
+	test_dac_play_skips_duplicate_codes();
+	test_dac_wave_builders();
+	test_sample_all_uses_two_commands();
+	test_config_txn_sends_only_differences();
+	test_profile_apply_is_idempotent();
+	test_gpio_wait_events_backs_off_when_idle();
+	test_gpio_wait_events_reports_ioc_latch();
+	test_gpio_wait_events_ioc_latch_keeps_idle_cost();
+	test_gpio_poll_counts_edges();
+	test_gpio_poll_debounce_rejects_glitches();
+	test_gpio_poll_frequency_estimate();
 	test_pin_functions_rejects_non_boolean_outputs();
 	test_sram_rejects_invalid_gpio_fields();
 	test_sram_rejects_invalid_interrupt_fields();
 	test_sram_rejects_invalid_reference_fields();
 	test_sram_rejects_invalid_dac_value();
 	test_sram_rejects_invalid_clock_fields();
+	test_adc_read_volts_decodes_reference_bits();
 	test_open_rejects_null_output_pointer();
 	test_open_propagates_no_memory();
 	test_open_propagates_usb_init_failure();
@@ -5,16 +5,25 @@
 #include <string.h>
 
 #include "mcp2221.h"
+#include "mcp2221_internal_smbus.h"
 #include "mcp2221_smbus.h"
 
 struct mcp2221_device {
-	int unused;
+	mcp2221_internal_smbus_hint_state_t smbus_hints;
 };
 
-static uint8_t captured_write[8];
+static uint8_t captured_write[2 + MCP2221_I2C_SMBUS_BLOCK_MAX + 1];
 static size_t captured_write_len;
 static mcp2221_i2c_kind_t captured_write_kind;
-static uint8_t read_response[2];
+static uint8_t read_response[MCP2221_I2C_SMBUS_BLOCK_MAX + 2];
+static size_t read_response_len = 2;
+static mcp2221_i2c_kind_t read_expected_kind = MCP2221_I2C_KIND_REPEATED_START;
+static size_t write_calls;
+static size_t read_calls;
+
+/* Optional per-call read lengths; read_response_len is used when empty. */
+static size_t expected_read_lens[4];
+static size_t expected_read_count;
 
 mcp2221_error_code_t mcp2221_open_simple(
 	uint16_t vid, uint16_t pid, int devnum, const char *usbserial,
@@ -32,12 +41,17 @@ void mcp2221_close(mcp2221_t *dev) {
 	(void)dev;
 }
 
+mcp2221_internal_smbus_hint_state_t *mcp2221_internal_smbus_get_hint_state(mcp2221_t *dev) {
+	return dev ? &dev->smbus_hints : NULL;
+}
+
 mcp2221_error_code_t mcp2221_i2c_write_simple(
 	mcp2221_t *dev, uint8_t addr, const uint8_t *data, size_t len,
 	mcp2221_i2c_kind_t kind) {
 	(void)dev;
 	(void)addr;
 	assert(len <= sizeof(captured_write));
+	write_calls++;
 	memcpy(captured_write, data, len);
 	captured_write_len = len;
 	captured_write_kind = kind;
@@ -49,8 +63,14 @@ mcp2221_error_code_t mcp2221_i2c_read_simple(
 	mcp2221_i2c_kind_t kind) {
 	(void)dev;
 	(void)addr;
-	assert(kind == MCP2221_I2C_KIND_REPEATED_START);
-	assert(len == sizeof(read_response));
+	assert(kind == read_expected_kind);
+	if (expected_read_count) {
+		assert(read_calls < expected_read_count);
+		assert(len == expected_read_lens[read_calls]);
+	} else {
+		assert(len == read_response_len);
+	}
+	read_calls++;
 	memcpy(data, read_response, len);
 	return MCP2221_ERR_OK;
 }
@@ -101,8 +121,324 @@ static void test_process_call_word_encoding_and_decode(void) {
 	assert((uint16_t)response == 0x9234u);
 }
 
+static uint8_t reference_crc8(uint8_t crc, const uint8_t *data, size_t len) {
+	while (len--) {
+		crc ^= *data++;
+		for (int bit = 0; bit < 8; bit++)
+			crc = (uint8_t)((crc & 0x80u) ? (unsigned)(crc << 1) ^ 0x07u : (unsigned)(crc << 1));
+	}
+	return crc;
+}
+
+static void test_crc8_known_vectors(void) {
+	static const uint8_t check[] = "123456789";
+	uint8_t buf[300];
+
+	assert(mcp2221_internal_smbus_crc8_update(0, check, 9) == 0xf4);
+	assert(mcp2221_internal_smbus_crc8_update(0x5a, NULL, 0) == 0x5a);
+
+	for (size_t i = 0; i < sizeof(buf); i++)
+		buf[i] = (uint8_t)(i * 37u + 11u);
+
+	for (size_t len = 0; len <= sizeof(buf); len++) {
+		assert(mcp2221_internal_smbus_crc8_update(0, buf, len) ==
+			reference_crc8(0, buf, len));
+	}
+
+	// Chained updates must match a single pass.
+	uint8_t crc = mcp2221_internal_smbus_crc8_update(0, buf, 5);
+	crc = mcp2221_internal_smbus_crc8_byte(crc, buf[5]);
+	crc = mcp2221_internal_smbus_crc8_update(crc, &buf[6], 7);
+	assert(crc == reference_crc8(0, buf, 13));
+}
+
+static void test_write_word_data_pec(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_smbus_t bus = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	const uint8_t expected_frame[] = {0x50 << 1, 0x2a, 0x34, 0x12};
+
+	assert(mcp2221_smbus_write_word_data_pec(
+		&bus, 0x50, 0x2a, (int16_t)0x1234) == MCP2221_ERR_OK);
+	assert(captured_write_len == 4);
+	assert(captured_write_kind == MCP2221_I2C_KIND_NORMAL);
+	assert(captured_write[0] == 0x2a);
+	assert(captured_write[1] == 0x34);
+	assert(captured_write[2] == 0x12);
+	assert(captured_write[3] ==
+		reference_crc8(0, expected_frame, sizeof(expected_frame)));
+}
+
+static void test_write_block_data_pec(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_smbus_t bus = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	const uint8_t payload[] = {0x01, 0x02, 0x03};
+	const uint8_t expected_frame[] = {0x0b << 1, 0x44, 3, 0x01, 0x02, 0x03};
+
+	assert(mcp2221_smbus_write_block_data_pec(
+		&bus, 0x0b, 0x44, payload, sizeof(payload)) == MCP2221_ERR_OK);
+	assert(captured_write_len == 6);
+	assert(captured_write[0] == 0x44);
+	assert(captured_write[1] == 3);
+	assert(memcmp(&captured_write[2], payload, sizeof(payload)) == 0);
+	assert(captured_write[5] ==
+		reference_crc8(0, expected_frame, sizeof(expected_frame)));
+}
+
+static void test_read_word_data_pec(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_smbus_t bus = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	const uint8_t frame[] = {0x0b << 1, 0x09, (0x0b << 1) | 1, 0xc8, 0x32};
+	int16_t value = 0;
+
+	read_response[0] = 0xc8;
+	read_response[1] = 0x32;
+	read_response[2] = reference_crc8(0, frame, sizeof(frame));
+	read_response_len = 3;
+
+	assert(mcp2221_smbus_read_word_data_pec(
+		&bus, 0x0b, 0x09, &value) == MCP2221_ERR_OK);
+	assert(captured_write_len == 1);
+	assert(captured_write[0] == 0x09);
+	assert(captured_write_kind == MCP2221_I2C_KIND_NO_STOP);
+	assert(value == 0x32c8);
+
+	// A corrupted PEC is reported and leaves the output untouched.
+	read_response[2] ^= 0x01;
+	value = 0x1111;
+	assert(mcp2221_smbus_read_word_data_pec(
+		&bus, 0x0b, 0x09, &value) == MCP2221_ERR_PEC);
+	assert(value == 0x1111);
+
+	read_response_len = 2;
+}
+
+static void test_read_block_data_pec(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_smbus_t bus = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	const uint8_t frame[] = {0x0b << 1, 0x20, (0x0b << 1) | 1, 2, 0xab, 0xcd};
+	uint8_t buffer[MCP2221_I2C_SMBUS_BLOCK_MAX];
+	size_t length = 0;
+
+	memset(read_response, 0xff, sizeof(read_response));
+	read_response[0] = 2;
+	read_response[1] = 0xab;
+	read_response[2] = 0xcd;
+	read_response[3] = reference_crc8(0, frame, sizeof(frame));
+	read_response_len = MCP2221_I2C_SMBUS_BLOCK_MAX + 2;
+
+	assert(mcp2221_smbus_read_block_data_pec(
+		&bus, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_OK);
+	assert(length == 2);
+	assert(buffer[0] == 0xab);
+	assert(buffer[1] == 0xcd);
+
+	read_response[2] = 0xce;
+	assert(mcp2221_smbus_read_block_data_pec(
+		&bus, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_PEC);
+
+	read_response_len = 2;
+}
+
+static void test_read_byte_pec(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_smbus_t bus = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	const uint8_t frame[] = {(0x0c << 1) | 1, 0x5a};
+	uint8_t value = 0;
+
+	read_response[0] = 0x5a;
+	read_response[1] = reference_crc8(0, frame, sizeof(frame));
+	read_expected_kind = MCP2221_I2C_KIND_NORMAL;
+
+	assert(mcp2221_smbus_read_byte_pec(&bus, 0x0c, &value) == MCP2221_ERR_OK);
+	assert(value == 0x5a);
+
+	read_response[1] ^= 0x80;
+	assert(mcp2221_smbus_read_byte_pec(&bus, 0x0c, &value) == MCP2221_ERR_PEC);
+
+	read_expected_kind = MCP2221_I2C_KIND_REPEATED_START;
+}
+
+static void expect_reads(size_t first, size_t second) {
+	expected_read_lens[0] = first;
+	expected_read_lens[1] = second;
+	expected_read_count = second ? 2 : 1;
+	read_calls = 0;
+	write_calls = 0;
+}
+
+static void test_block_hint_disabled_reads_full_block(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_smbus_t bus = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	uint8_t buffer[MCP2221_I2C_SMBUS_BLOCK_MAX];
+	size_t length = 0;
+	mcp2221_smbus_block_hint_stats_t stats;
+
+	memset(read_response, 0, sizeof(read_response));
+	read_response[0] = 2;
+
+	for (int i = 0; i < 2; i++) {
+		expect_reads(MCP2221_I2C_SMBUS_BLOCK_MAX + 1, 0);
+		assert(mcp2221_smbus_read_block_data(
+			&bus, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_OK);
+		assert(read_calls == 1);
+		assert(length == 2);
+	}
+
+	assert(mcp2221_smbus_get_block_hint_stats(&bus, &stats) == MCP2221_ERR_OK);
+	assert(stats.hits == 0 && stats.misses == 0 && stats.cold == 0);
+
+	expected_read_count = 0;
+}
+
+static void test_block_hint_read_block_data(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_smbus_t bus = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	uint8_t buffer[MCP2221_I2C_SMBUS_BLOCK_MAX];
+	size_t length = 0;
+	mcp2221_smbus_block_hint_stats_t stats;
+
+	assert(mcp2221_smbus_set_block_hint(&bus, 1) == MCP2221_ERR_OK);
+
+	memset(read_response, 0, sizeof(read_response));
+	read_response[0] = 2;
+	read_response[1] = 0x11;
+	read_response[2] = 0x22;
+
+	// First access has no hint and reads the maximum block.
+	expect_reads(MCP2221_I2C_SMBUS_BLOCK_MAX + 1, 0);
+	assert(mcp2221_smbus_read_block_data(
+		&bus, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_OK);
+	assert(length == 2);
+
+	// Second access reads only the length byte and two payload bytes.
+	expect_reads(3, 0);
+	assert(mcp2221_smbus_read_block_data(
+		&bus, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_OK);
+	assert(length == 2);
+	assert(buffer[0] == 0x11 && buffer[1] == 0x22);
+	assert(write_calls == 1);
+
+	// A different command on the same target has its own hint.
+	expect_reads(MCP2221_I2C_SMBUS_BLOCK_MAX + 1, 0);
+	assert(mcp2221_smbus_read_block_data(
+		&bus, 0x0b, 0x21, buffer, &length) == MCP2221_ERR_OK);
+
+	// A longer block repeats the transaction with the exact length.
+	read_response[0] = 4;
+	read_response[3] = 0x33;
+	read_response[4] = 0x44;
+	expect_reads(3, 5);
+	assert(mcp2221_smbus_read_block_data(
+		&bus, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_OK);
+	assert(write_calls == 2);
+	assert(captured_write_len == 1 && captured_write[0] == 0x20);
+	assert(length == 4);
+	assert(buffer[3] == 0x44);
+
+	// The grown length is remembered.
+	expect_reads(5, 0);
+	assert(mcp2221_smbus_read_block_data(
+		&bus, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_OK);
+	assert(length == 4);
+
+	assert(mcp2221_smbus_get_block_hint_stats(&bus, &stats) == MCP2221_ERR_OK);
+	assert(stats.cold == 2);
+	assert(stats.hits == 2);
+	assert(stats.misses == 1);
+
+	// Contexts on the same device share the hints.
+	mcp2221_smbus_t other = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	expect_reads(5, 0);
+	assert(mcp2221_smbus_read_block_data(
+		&other, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_OK);
+	assert(mcp2221_smbus_get_block_hint_stats(&other, &stats) == MCP2221_ERR_OK);
+	assert(stats.hits == 3);
+
+	// Re-enabling clears hints and statistics.
+	assert(mcp2221_smbus_set_block_hint(&bus, 1) == MCP2221_ERR_OK);
+	assert(mcp2221_smbus_get_block_hint_stats(&bus, &stats) == MCP2221_ERR_OK);
+	assert(stats.hits == 0 && stats.misses == 0 && stats.cold == 0);
+	expect_reads(MCP2221_I2C_SMBUS_BLOCK_MAX + 1, 0);
+	assert(mcp2221_smbus_read_block_data(
+		&bus, 0x0b, 0x20, buffer, &length) == MCP2221_ERR_OK);
+
+	expected_read_count = 0;
+}
+
+static void test_block_hint_process_call_and_pec(void) {
+	struct mcp2221_device dev = {0};
+	mcp2221_smbus_t bus = {
+		.mcp = &dev,
+		.owns_mcp = 0
+	};
+	const uint8_t data[] = {0x01};
+	const uint8_t pec_frame[] = {0x0b << 1, 0x30, (0x0b << 1) | 1, 1, 0x7e};
+	uint8_t response[MCP2221_I2C_SMBUS_BLOCK_MAX];
+	size_t resp_len = 0;
+
+	assert(mcp2221_smbus_set_block_hint(&bus, 1) == MCP2221_ERR_OK);
+
+	memset(read_response, 0, sizeof(read_response));
+	read_response[0] = 1;
+	read_response[1] = 0x7e;
+
+	expect_reads(MCP2221_I2C_SMBUS_BLOCK_MAX + 1, 0);
+	assert(mcp2221_smbus_block_process_call(
+		&bus, 0x0b, 0x31, data, sizeof(data), response, &resp_len) == MCP2221_ERR_OK);
+	expect_reads(2, 0);
+	assert(mcp2221_smbus_block_process_call(
+		&bus, 0x0b, 0x31, data, sizeof(data), response, &resp_len) == MCP2221_ERR_OK);
+	assert(resp_len == 1 && response[0] == 0x7e);
+	assert(captured_write_len == 3);
+
+	// PEC block reads include the trailing PEC byte in the hinted length.
+	read_response[2] = reference_crc8(0, pec_frame, sizeof(pec_frame));
+	expect_reads(MCP2221_I2C_SMBUS_BLOCK_MAX + 2, 0);
+	assert(mcp2221_smbus_read_block_data_pec(
+		&bus, 0x0b, 0x30, response, &resp_len) == MCP2221_ERR_OK);
+	expect_reads(3, 0);
+	assert(mcp2221_smbus_read_block_data_pec(
+		&bus, 0x0b, 0x30, response, &resp_len) == MCP2221_ERR_OK);
+	assert(resp_len == 1 && response[0] == 0x7e);
+
+	expected_read_count = 0;
+}
+
 int main(void) {
 	test_write_word_encoding();
 	test_process_call_word_encoding_and_decode();
+	test_crc8_known_vectors();
+	test_write_word_data_pec();
+	test_write_block_data_pec();
+	test_read_word_data_pec();
+	test_read_block_data_pec();
+	test_read_byte_pec();
+	test_block_hint_disabled_reads_full_block();
+	test_block_hint_read_block_data();
+	test_block_hint_process_call_and_pec();
 	return 0;
 }